@@ -26,6 +26,7 @@
 #include "base64.hh"
 
 #include <ctype.h>
+#include <iterator>
 
 
 // Arrays for quickly converting to and from an integer between 0 and 63,
@@ -77,11 +78,11 @@ std::string base64_encode(bytes_view in) {
     return ret;
 }
 
-static std::string base64_decode_string(std::string_view in) {
+// Decodes `in` into the output iterator `out`, see base64_decode().
+template <typename OutputIt>
+static OutputIt base64_decode_to(std::string_view in, OutputIt out) {
     int i = 0;
     int8_t chunk4[4]; // chunk of input, each byte converted to 0..63;
-    std::string ret;
-    ret.reserve(in.size() * 3 / 4);
     for (unsigned char c : in) {
         uint8_t dc = base64_chars.from[c];
         if (dc == 255) {
@@ -91,28 +92,48 @@ static std::string base64_decode_string(std::string_view in) {
         }
         chunk4[i++] = dc;
         if (i == 4) {
-            ret += (chunk4[0] << 2) + ((chunk4[1] & 0x30) >> 4);
-            ret += ((chunk4[1] & 0xf) << 4) + ((chunk4[2] & 0x3c) >> 2);
-            ret += ((chunk4[2] & 0x3) << 6) + chunk4[3];
+            *out++ = (chunk4[0] << 2) + ((chunk4[1] & 0x30) >> 4);
+            *out++ = ((chunk4[1] & 0xf) << 4) + ((chunk4[2] & 0x3c) >> 2);
+            *out++ = ((chunk4[2] & 0x3) << 6) + chunk4[3];
             i = 0;
         }
     }
     if (i) {
         // i can be 2 or 3, meaning 1 or 2 more output characters
         if (i>=2)
-            ret += (chunk4[0] << 2) + ((chunk4[1] & 0x30) >> 4);
+            *out++ = (chunk4[0] << 2) + ((chunk4[1] & 0x30) >> 4);
         if (i==3)
-            ret += ((chunk4[1] & 0xf) << 4) + ((chunk4[2] & 0x3c) >> 2);
+            *out++ = ((chunk4[1] & 0xf) << 4) + ((chunk4[2] & 0x3c) >> 2);
     }
+    return out;
+}
+
+static std::string base64_decode_string(std::string_view in) {
+    std::string ret;
+    ret.reserve(in.size() * 3 / 4);
+    base64_decode_to(in, std::back_inserter(ret));
     return ret;
 }
 
+size_t base64_decoded_size(std::string_view in) {
+    size_t n = 0;
+    for (unsigned char c : in) {
+        if (uint8_t(base64_chars.from[c]) == 255) {
+            break;
+        }
+        ++n;
+    }
+    return n / 4 * 3 + (n % 4 ? n % 4 - 1 : 0);
+}
+
+void base64_decode(std::string_view in, int8_t* out) {
+    base64_decode_to(in, out);
+}
+
 bytes base64_decode(std::string_view in) {
-    // FIXME: This copy is sad. The problem is we need back "bytes"
-    // but "bytes" doesn't have efficient append and std::string.
-    // To fix this we need to use bytes' "uninitialized" feature.
-    std::string ret = base64_decode_string(in);
-    return bytes(ret.begin(), ret.end());
+    bytes ret(bytes::initialized_later(), base64_decoded_size(in));
+    base64_decode_to(in, ret.begin());
+    return ret;
 }
 
 static size_t base64_padding_len(std::string_view str) {
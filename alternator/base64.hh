@@ -29,6 +29,13 @@ std::string base64_encode(bytes_view);
 
 bytes base64_decode(std::string_view);
 
+// The size of base64_decode(in), computed without decoding it.
+size_t base64_decoded_size(std::string_view in);
+
+// Decodes `in` into `out`, which must have room for base64_decoded_size(in)
+// bytes. Lets callers decode straight into a larger buffer.
+void base64_decode(std::string_view in, int8_t* out);
+
 inline bytes base64_decode(const rjson::value& v) {
   return base64_decode(std::string_view(v.GetString(), v.GetStringLength()));
 }
@@ -88,6 +88,33 @@ std::string json_string::to_json() const {
     return _value;
 }
 
+static future<> write_chunks(lw_shared_ptr<rjson::chunked_content> content, output_stream<char> os) {
+    std::exception_ptr ex;
+    try {
+        for (auto& chunk : *content) {
+            co_await os.write(std::exchange(chunk, temporary_buffer<char>()));
+        }
+        co_await os.flush();
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await os.close();
+    if (ex) {
+        std::rethrow_exception(ex);
+    }
+}
+
+// make_streamed() returns a response whose body is the JSON text built by
+// an rjson::chunked_writer. Unlike make_jsonable(), the text is not copied
+// into a single string, but written to the HTTP output stream chunk by
+// chunk, each chunk being freed as soon as it was written.
+static json::json_return_type make_streamed(rjson::chunked_content&& content) {
+    // json_return_type's body writer is a std::function, so it must be copyable.
+    return json::json_return_type([content = make_lw_shared<rjson::chunked_content>(std::move(content))] (output_stream<char>&& os) {
+        return write_chunks(content, std::move(os));
+    });
+}
+
 void executor::supplement_table_info(rjson::value& descr, const schema& schema) const {
     rjson::set(descr, "CreationDateTime", rjson::value(std::chrono::duration_cast<std::chrono::seconds>(gc_clock::now().time_since_epoch()).count()));
     rjson::set(descr, "TableStatus", "ACTIVE");
@@ -1765,12 +1792,22 @@ static future<> do_batch_write(service::storage_proxy& proxy,
         return rmw_operation::get_write_isolation_for_schema(schema) == rmw_operation::write_isolation::LWT_ALWAYS;
     });
     if (!needs_lwt) {
-        // Do a normal write, without LWT:
+        // Do a normal write, without LWT.
+        // Items of the same partition are joined into one mutation, so that
+        // each replica applies the partition's items in a single write.
         std::vector<mutation> mutations;
         mutations.reserve(mutation_builders.size());
+        std::unordered_map<schema_decorated_key, size_t, schema_decorated_key_hash, schema_decorated_key_equal>
+            partition_mutations(mutation_builders.size(), schema_decorated_key_hash{}, schema_decorated_key_equal{});
         api::timestamp_type now = api::new_timestamp();
         for (auto& b : mutation_builders) {
-            mutations.push_back(b.second.build(b.first, now));
+            mutation m = b.second.build(b.first, now);
+            auto [it, added] = partition_mutations.try_emplace(schema_decorated_key{b.first, m.decorated_key()}, mutations.size());
+            if (added) {
+                mutations.push_back(std::move(m));
+            } else {
+                mutations[it->second].apply(std::move(m));
+            }
         }
         return proxy.mutate(std::move(mutations),
                 db::consistency_level::LOCAL_QUORUM,
@@ -2092,6 +2129,21 @@ static attrs_to_get calculate_attrs_to_get(const rjson::value& req, std::unorder
     return {};
 }
 
+// attrs_selection() returns the selection of the cells of the attrs column
+// holding the top-level attributes of attrs_to_get, for the replicas to only
+// send those instead of all the attributes of the items. attrs_to_get must
+// not be empty, as an empty attrs_to_get asks for all attributes.
+// Attributes which are columns of their own, like key attributes, are read
+// anyway, and looking them up in the attrs column is harmless.
+static query::collection_keys_selection attrs_selection(const attrs_to_get& attrs_to_get) {
+    query::collection_keys_selection sel{bytes(executor::ATTRS_COLUMN_NAME), {}};
+    sel.keys.reserve(attrs_to_get.size());
+    for (const auto& attr : attrs_to_get) {
+        sel.keys.push_back(to_bytes(attr.first));
+    }
+    return sel;
+}
+
 /**
  * Helper routine to extract data when we already have 
  * row, etc etc.
@@ -2147,6 +2199,26 @@ void executor::describe_single_item(const cql3::selection::selection& selection,
     }
 }
 
+// Like describe_single_item(), but for a query result which may hold any
+// number of items, of any number of partitions.
+static std::vector<rjson::value> describe_multiple_items(schema_ptr schema,
+        const query::partition_slice& slice,
+        const cql3::selection::selection& selection,
+        const query::result& query_result,
+        const attrs_to_get& attrs_to_get) {
+    cql3::selection::result_set_builder builder(selection, gc_clock::now(), cql_serialization_format::latest());
+    query::result_view::consume(query_result, slice, cql3::selection::result_set_builder::visitor(builder, *schema, selection));
+    auto result_set = builder.build();
+    std::vector<rjson::value> ret;
+    ret.reserve(result_set->size());
+    for (auto& result_row : result_set->rows()) {
+        rjson::value item = rjson::empty_object();
+        executor::describe_single_item(selection, result_row, attrs_to_get, item);
+        ret.push_back(std::move(item));
+    }
+    return ret;
+}
+
 std::optional<rjson::value> executor::describe_single_item(schema_ptr schema,
         const query::partition_slice& slice,
         const cql3::selection::selection& selection,
@@ -2782,19 +2854,21 @@ future<executor::request_return_type> executor::get_item(client_state& client_st
     }
     check_key(query_key, schema);
 
-    //TODO(sarna): It would be better to fetch only some attributes of the map, not all
+    std::unordered_set<std::string> used_attribute_names;
+    auto attrs_to_get = calculate_attrs_to_get(request, used_attribute_names);
+    verify_all_are_used(request, "ExpressionAttributeNames", used_attribute_names, "GetItem");
+
     auto regular_columns = boost::copy_range<query::column_id_vector>(
             schema->regular_columns() | boost::adaptors::transformed([] (const column_definition& cdef) { return cdef.id; }));
 
     auto selection = cql3::selection::selection::wildcard(schema);
 
     auto partition_slice = query::partition_slice(std::move(bounds), {}, std::move(regular_columns), selection->get_query_options());
+    if (!attrs_to_get.empty()) {
+        partition_slice.collection_keys.push_back(attrs_selection(attrs_to_get));
+    }
     auto command = ::make_lw_shared<query::read_command>(schema->id(), schema->version(), partition_slice, _proxy.get_max_result_size(partition_slice));
 
-    std::unordered_set<std::string> used_attribute_names;
-    auto attrs_to_get = calculate_attrs_to_get(request, used_attribute_names);
-    verify_all_are_used(request, "ExpressionAttributeNames", used_attribute_names, "GetItem");
-
     return _proxy.query(schema, std::move(command), std::move(partition_ranges), cl,
             service::storage_proxy::coordinator_query_options(executor::default_timeout(), std::move(permit), client_state, trace_state)).then(
             [this, schema, partition_slice = std::move(partition_slice), selection = std::move(selection), attrs_to_get = std::move(attrs_to_get), start_time = std::move(start_time)] (service::storage_proxy::coordinator_query_result qr) mutable {
@@ -2836,38 +2910,70 @@ future<executor::request_return_type> executor::batch_get_item(client_state& cli
         rs.attrs_to_get = ::make_shared<const attrs_to_get>(calculate_attrs_to_get(it->value, used_attribute_names));
         verify_all_are_used(request, "ExpressionAttributeNames", used_attribute_names, "GetItem");
         auto& keys = (it->value)["Keys"];
+        std::unordered_set<primary_key, primary_key_hash, primary_key_equal> used_keys(
+                1, primary_key_hash{rs.schema}, primary_key_equal{rs.schema});
         for (const rjson::value& key : keys.GetArray()) {
             rs.requests.push_back({pk_from_json(key, rs.schema), ck_from_json(key, rs.schema)});
             check_key(key, rs.schema);
+            auto mut_key = std::make_pair(rs.requests.back().pk, rs.requests.back().ck);
+            if (used_keys.contains(mut_key)) {
+                throw api_error::validation("Provided list of item keys contains duplicates");
+            }
+            used_keys.insert(std::move(mut_key));
         }
         requests.emplace_back(std::move(rs));
     }
 
     // If got here, all "requests" are valid, so let's start them all
     // in parallel. The requests object are then immediately destroyed.
-    std::vector<future<std::tuple<std::string, std::optional<rjson::value>>>> response_futures;
+    // Items are read together rather than one by one: all the partitions
+    // of a table without a clustering key are read with one multi-partition
+    // read, which storage_proxy sends as a single request to each replica,
+    // and all the items of one partition of a table with a clustering key
+    // are read with one read of their clustering keys.
+    std::vector<future<std::tuple<std::string, std::vector<rjson::value>>>> response_futures;
     for (const auto& rs : requests) {
-        for (const auto &r : rs.requests) {
-            dht::partition_range_vector partition_ranges{dht::partition_range(dht::decorate_key(*rs.schema, std::move(r.pk)))};
-            std::vector<query::clustering_range> bounds;
-            if (rs.schema->clustering_key_size() == 0) {
-                bounds.push_back(query::clustering_range::make_open_ended_both_sides());
-            } else {
-                bounds.push_back(query::clustering_range::make_singular(std::move(r.ck)));
-            }
+        auto read = [&] (dht::partition_range_vector partition_ranges, std::vector<query::clustering_range> bounds) {
             auto regular_columns = boost::copy_range<query::column_id_vector>(
                     rs.schema->regular_columns() | boost::adaptors::transformed([] (const column_definition& cdef) { return cdef.id; }));
             auto selection = cql3::selection::selection::wildcard(rs.schema);
             auto partition_slice = query::partition_slice(std::move(bounds), {}, std::move(regular_columns), selection->get_query_options());
+            if (!rs.attrs_to_get->empty()) {
+                partition_slice.collection_keys.push_back(attrs_selection(*rs.attrs_to_get));
+            }
             auto command = ::make_lw_shared<query::read_command>(rs.schema->id(), rs.schema->version(), partition_slice, _proxy.get_max_result_size(partition_slice));
-            future<std::tuple<std::string, std::optional<rjson::value>>> f = _proxy.query(rs.schema, std::move(command), std::move(partition_ranges), rs.cl,
+            future<std::tuple<std::string, std::vector<rjson::value>>> f = _proxy.query(rs.schema, std::move(command), std::move(partition_ranges), rs.cl,
                     service::storage_proxy::coordinator_query_options(executor::default_timeout(), permit, client_state, trace_state)).then(
                     [schema = rs.schema, partition_slice = std::move(partition_slice), selection = std::move(selection), attrs_to_get = rs.attrs_to_get] (service::storage_proxy::coordinator_query_result qr) mutable {
-                std::optional<rjson::value> json = describe_single_item(schema, partition_slice, *selection, *qr.query_result, *attrs_to_get);
-                return make_ready_future<std::tuple<std::string, std::optional<rjson::value>>>(
-                        std::make_tuple(schema->cf_name(), std::move(json)));
+                std::vector<rjson::value> items = describe_multiple_items(schema, partition_slice, *selection, *qr.query_result, *attrs_to_get);
+                return make_ready_future<std::tuple<std::string, std::vector<rjson::value>>>(
+                        std::make_tuple(schema->cf_name(), std::move(items)));
             });
             response_futures.push_back(std::move(f));
+        };
+        // Group the keys by partition, in ring order.
+        std::map<dht::decorated_key, std::vector<clustering_key>, dht::decorated_key::less_comparator> keys_by_partition{
+                dht::decorated_key::less_comparator(rs.schema)};
+        for (const auto& r : rs.requests) {
+            keys_by_partition[dht::decorate_key(*rs.schema, r.pk)].push_back(r.ck);
+        }
+        if (rs.schema->clustering_key_size() == 0) {
+            dht::partition_range_vector partition_ranges;
+            partition_ranges.reserve(keys_by_partition.size());
+            for (const auto& [dk, cks] : keys_by_partition) {
+                partition_ranges.emplace_back(dk);
+            }
+            read(std::move(partition_ranges), {query::clustering_range::make_open_ended_both_sides()});
+        } else {
+            for (auto& [dk, cks] : keys_by_partition) {
+                std::sort(cks.begin(), cks.end(), clustering_key::less_compare(*rs.schema));
+                std::vector<query::clustering_range> bounds;
+                bounds.reserve(cks.size());
+                for (auto& ck : cks) {
+                    bounds.push_back(query::clustering_range::make_singular(std::move(ck)));
+                }
+                read({dht::partition_range(dk)}, std::move(bounds));
+            }
         }
     }
 
@@ -2879,19 +2985,34 @@ future<executor::request_return_type> executor::batch_get_item(client_state& cli
     // handled it above), but this case does include things like timeouts,
     // unavailable CL, etc.
     return when_all_succeed(response_futures.begin(), response_futures.end()).then(
-            [] (std::vector<std::tuple<std::string, std::optional<rjson::value>>> responses) {
-        rjson::value response = rjson::empty_object();
-        rjson::set(response, "Responses", rjson::empty_object());
-        rjson::set(response, "UnprocessedKeys", rjson::empty_object());
-        for (auto& t : responses) {
-            if (!response["Responses"].HasMember(std::get<0>(t).c_str())) {
-                rjson::set_with_string_name(response["Responses"], std::get<0>(t), rjson::empty_array());
-            }
-            if (std::get<1>(t)) {
-                rjson::push_back(response["Responses"][std::get<0>(t)], std::move(*std::get<1>(t)));
+            [] (std::vector<std::tuple<std::string, std::vector<rjson::value>>> responses) {
+        // The responses of a table are consecutive, unless the table was
+        // listed more than once in RequestItems.
+        std::stable_sort(responses.begin(), responses.end(), [] (const auto& a, const auto& b) {
+            return std::get<0>(a) < std::get<0>(b);
+        });
+        rjson::chunked_writer writer;
+        writer.start_object();
+        writer.key("Responses");
+        writer.start_object();
+        for (auto it = responses.begin(); it != responses.end();) {
+            const std::string& table_name = std::get<0>(*it);
+            writer.key(table_name);
+            writer.start_array();
+            for (; it != responses.end() && std::get<0>(*it) == table_name; ++it) {
+                for (const auto& item : std::get<1>(*it)) {
+                    writer.write(item);
+                }
+                // The items were written, free them early.
+                std::get<1>(*it) = {};
             }
+            writer.end_array();
         }
-        return make_ready_future<executor::request_return_type>(make_jsonable(std::move(response)));
+        writer.end_object();
+        writer.key("UnprocessedKeys");
+        writer.write(rjson::empty_object());
+        writer.end_object();
+        return make_ready_future<executor::request_return_type>(make_streamed(std::move(writer).finish()));
     });
 }
 
@@ -3029,25 +3150,30 @@ void filter::for_filters_on(const noncopyable_function<void(std::string_view)>&
     }
 }
 
+// describe_items_visitor writes the items it is given, once filtered, to an
+// rjson::chunked_writer, so only the item being described is ever held as an
+// rjson::value.
 class describe_items_visitor {
     typedef std::vector<const column_definition*> columns_t;
     const columns_t& _columns;
     const attrs_to_get& _attrs_to_get;
     std::unordered_set<std::string> _extra_filter_attrs;
     const filter& _filter;
+    rjson::chunked_writer& _writer;
     typename columns_t::const_iterator _column_it;
     rjson::value _item;
-    rjson::value _items;
+    size_t _count;
     size_t _scanned_count;
 
 public:
-    describe_items_visitor(const columns_t& columns, const attrs_to_get& attrs_to_get, filter& filter)
+    describe_items_visitor(const columns_t& columns, const attrs_to_get& attrs_to_get, filter& filter, rjson::chunked_writer& writer)
             : _columns(columns)
             , _attrs_to_get(attrs_to_get)
             , _filter(filter)
+            , _writer(writer)
             , _column_it(columns.begin())
             , _item(rjson::empty_object())
-            , _items(rjson::empty_array())
+            , _count(0)
             , _scanned_count(0)
     {
         // _filter.check() may need additional attributes not listed in
@@ -3124,14 +3250,15 @@ class describe_items_visitor {
                 rjson::remove_member(_item, attr);
             }
 
-            rjson::push_back(_items, std::move(_item));
+            _writer.write(_item);
+            ++_count;
         }
         _item = rjson::empty_object();
         ++_scanned_count;
     }
 
-    rjson::value get_items() && {
-        return std::move(_items);
+    size_t get_count() {
+        return _count;
     }
 
     size_t get_scanned_count() {
@@ -3139,16 +3266,20 @@ class describe_items_visitor {
     }
 };
 
-static rjson::value describe_items(schema_ptr schema, const query::partition_slice& slice, const cql3::selection::selection& selection, std::unique_ptr<cql3::result_set> result_set, attrs_to_get&& attrs_to_get, filter&& filter) {
-    describe_items_visitor visitor(selection.get_columns(), attrs_to_get, filter);
+// Writes the "Items", "Count" and "ScannedCount" members of the response to
+// a Query or Scan to the object being written by writer. Returns the number
+// of items written.
+static size_t describe_items(const cql3::selection::selection& selection, std::unique_ptr<cql3::result_set> result_set, attrs_to_get&& attrs_to_get, filter&& filter, rjson::chunked_writer& writer) {
+    describe_items_visitor visitor(selection.get_columns(), attrs_to_get, filter, writer);
+    writer.key("Items");
+    writer.start_array();
     result_set->visit(visitor);
-    auto scanned_count = visitor.get_scanned_count();
-    rjson::value items = std::move(visitor).get_items();
-    rjson::value items_descr = rjson::empty_object();
-    rjson::set(items_descr, "Count", rjson::value(items.Size()));
-    rjson::set(items_descr, "ScannedCount", rjson::value(scanned_count));
-    rjson::set(items_descr, "Items", std::move(items));
-    return items_descr;
+    writer.end_array();
+    writer.key("Count");
+    writer.write(rjson::value(visitor.get_count()));
+    writer.key("ScannedCount");
+    writer.write(rjson::value(visitor.get_scanned_count()));
+    return visitor.get_count();
 }
 
 static rjson::value encode_paging_state(const schema& schema, const service::pager::paging_state& paging_state) {
@@ -3210,6 +3341,14 @@ static future<executor::request_return_type> do_query(service::storage_proxy& pr
     query::partition_slice::option_set opts = selection->get_query_options();
     opts.add(custom_opts);
     auto partition_slice = query::partition_slice(std::move(ck_bounds), std::move(static_columns), std::move(regular_columns), opts);
+    if (!attrs_to_get.empty()) {
+        // The filter may need attributes which weren't asked for.
+        auto sel = attrs_selection(attrs_to_get);
+        filter.for_filters_on([&] (std::string_view attr) {
+            sel.keys.push_back(bytes(reinterpret_cast<const int8_t*>(attr.data()), attr.size()));
+        });
+        partition_slice.collection_keys.push_back(std::move(sel));
+    }
     auto command = ::make_lw_shared<query::read_command>(schema->id(), schema->version(), partition_slice, proxy.get_max_result_size(partition_slice));
 
     auto query_state_ptr = std::make_unique<service::query_state>(client_state, trace_state, std::move(permit));
@@ -3220,7 +3359,7 @@ static future<executor::request_return_type> do_query(service::storage_proxy& pr
     auto p = service::pager::query_pagers::pager(schema, selection, *query_state_ptr, *query_options, command, std::move(partition_ranges), nullptr);
 
     return p->fetch_page(limit, gc_clock::now(), executor::default_timeout()).then(
-            [p = std::move(p), schema, cql_stats, partition_slice = std::move(partition_slice),
+            [p = std::move(p), schema, cql_stats,
              selection = std::move(selection), query_state_ptr = std::move(query_state_ptr),
              attrs_to_get = std::move(attrs_to_get),
              query_options = std::move(query_options),
@@ -3230,16 +3369,20 @@ static future<executor::request_return_type> do_query(service::storage_proxy& pr
         }
         auto paging_state = rs->get_metadata().paging_state();
         bool has_filter = filter;
-        auto items = describe_items(schema, partition_slice, *selection, std::move(rs), std::move(attrs_to_get), std::move(filter));
+        rjson::chunked_writer writer;
+        writer.start_object();
+        auto count = describe_items(*selection, std::move(rs), std::move(attrs_to_get), std::move(filter), writer);
         if (paging_state) {
-            rjson::set(items, "LastEvaluatedKey", encode_paging_state(*schema, *paging_state));
+            writer.key("LastEvaluatedKey");
+            writer.write(encode_paging_state(*schema, *paging_state));
         }
+        writer.end_object();
         if (has_filter){
             cql_stats.filtered_rows_read_total += p->stats().rows_read_total;
             // update our "filtered_row_matched_total" for all the rows matched, despited the filter
-            cql_stats.filtered_rows_matched_total += items["Items"].Size();
+            cql_stats.filtered_rows_matched_total += count;
         }
-        return make_ready_future<executor::request_return_type>(make_jsonable(std::move(items)));
+        return make_ready_future<executor::request_return_type>(make_streamed(std::move(writer).finish()));
     });
 }
 
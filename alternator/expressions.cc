@@ -26,6 +26,7 @@
 #include "alternator/expressionsLexer.hpp"
 #include "alternator/expressionsParser.hpp"
 #include "utils/overloaded_functor.hh"
+#include "utils/hash.hh"
 #include "error.hh"
 
 #include "seastarx.hh"
@@ -37,7 +38,9 @@
 #include <boost/algorithm/cxx11/all_of.hpp>
 
 #include <functional>
+#include <list>
 #include <unordered_map>
+#include <variant>
 
 namespace alternator {
 
@@ -56,31 +59,123 @@ Result do_with_parser(std::string input, Func&& f) {
     return result;
 }
 
+// The maximum number of entries of each shard's expression_cache. It is
+// always overwritten in main.cc, which calls set_expression_cache_size().
+static size_t expression_cache_size = 1000;
+
+void set_expression_cache_size(size_t max_entries) {
+    expression_cache_size = max_entries;
+}
+
+// Longer expressions aren't cached. The texts of expressions come from the
+// clients, so without this bound a few distinct huge expressions could pin
+// a lot of memory in the cache. This is DynamoDB's limit on the length of
+// an expression, so real expressions are all cached.
+static constexpr size_t max_cached_expression_length = 4096;
+
+// A per-shard LRU cache of the parse trees of expressions, keyed by the kind
+// of the expression and its text.
+class expression_cache {
+public:
+    enum class kind : uint8_t { update, projection, condition };
+    using parse_tree = std::variant<parsed::update_expression, std::vector<parsed::path>, parsed::condition_expression>;
+private:
+    struct key {
+        kind k;
+        std::string text;
+        bool operator==(const key& o) const {
+            return k == o.k && text == o.text;
+        }
+    };
+    struct key_hash {
+        size_t operator()(const key& k) const {
+            return utils::hash_combine(std::hash<std::string>()(k.text), size_t(k.k));
+        }
+    };
+    struct entry {
+        key k;
+        parse_tree tree;
+    };
+    // MRU entry at the front, LRU at the back.
+    std::list<entry> _lru;
+    std::unordered_map<key, std::list<entry>::iterator, key_hash> _entries;
+    expression_cache_stats _stats;
+public:
+    // Returns a copy of the parse tree of `text`, calling parse(text) to
+    // parse it if it isn't cached.
+    template <typename Tree, typename Parse>
+    Tree get(kind k, std::string text, Parse&& parse) {
+        if (!expression_cache_size || text.size() > max_cached_expression_length) {
+            return parse(text);
+        }
+        key lookup_key{k, std::move(text)};
+        auto it = _entries.find(lookup_key);
+        if (it != _entries.end()) {
+            ++_stats.hits;
+            _lru.splice(_lru.begin(), _lru, it->second);
+            return std::get<Tree>(it->second->tree);
+        }
+        ++_stats.misses;
+        Tree tree = parse(lookup_key.text);
+        while (_entries.size() >= expression_cache_size) {
+            _entries.erase(_lru.back().k);
+            _lru.pop_back();
+            ++_stats.evictions;
+        }
+        _lru.push_front(entry{lookup_key, tree});
+        _entries.emplace(std::move(lookup_key), _lru.begin());
+        return tree;
+    }
+
+    const expression_cache_stats& stats() const {
+        return _stats;
+    }
+    size_t size() const {
+        return _entries.size();
+    }
+};
+
+static thread_local expression_cache the_expression_cache;
+
+const expression_cache_stats& get_expression_cache_stats() {
+    return the_expression_cache.stats();
+}
+
+size_t get_expression_cache_entries() {
+    return the_expression_cache.size();
+}
+
 parsed::update_expression
 parse_update_expression(std::string query) {
-    try {
-        return do_with_parser(query,  std::mem_fn(&expressionsParser::update_expression));
-    } catch (...) {
-        throw expressions_syntax_error(format("Failed parsing UpdateExpression '{}': {}", query, std::current_exception()));
-    }
+    return the_expression_cache.get<parsed::update_expression>(expression_cache::kind::update, std::move(query), [] (const std::string& query) {
+        try {
+            return do_with_parser(query,  std::mem_fn(&expressionsParser::update_expression));
+        } catch (...) {
+            throw expressions_syntax_error(format("Failed parsing UpdateExpression '{}': {}", query, std::current_exception()));
+        }
+    });
 }
 
 std::vector<parsed::path>
 parse_projection_expression(std::string query) {
-    try {
-        return do_with_parser(query,  std::mem_fn(&expressionsParser::projection_expression));
-    } catch (...) {
-        throw expressions_syntax_error(format("Failed parsing ProjectionExpression '{}': {}", query, std::current_exception()));
-    }
+    return the_expression_cache.get<std::vector<parsed::path>>(expression_cache::kind::projection, std::move(query), [] (const std::string& query) {
+        try {
+            return do_with_parser(query,  std::mem_fn(&expressionsParser::projection_expression));
+        } catch (...) {
+            throw expressions_syntax_error(format("Failed parsing ProjectionExpression '{}': {}", query, std::current_exception()));
+        }
+    });
 }
 
 parsed::condition_expression
 parse_condition_expression(std::string query) {
-    try {
-        return do_with_parser(query,  std::mem_fn(&expressionsParser::condition_expression));
-    } catch (...) {
-        throw expressions_syntax_error(format("Failed parsing ConditionExpression '{}': {}", query, std::current_exception()));
-    }
+    return the_expression_cache.get<parsed::condition_expression>(expression_cache::kind::condition, std::move(query), [] (const std::string& query) {
+        try {
+            return do_with_parser(query,  std::mem_fn(&expressionsParser::condition_expression));
+        } catch (...) {
+            throw expressions_syntax_error(format("Failed parsing ConditionExpression '{}': {}", query, std::current_exception()));
+        }
+    });
 }
 
 namespace parsed {
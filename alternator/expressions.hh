@@ -39,10 +39,29 @@ class expressions_syntax_error : public std::runtime_error {
     using runtime_error::runtime_error;
 };
 
+// Parsing an expression with the ANTLR grammar is costly, while clients
+// tend to send the same few expressions over and over. So the functions
+// below keep the parse trees of the expressions they parsed in a per-shard
+// LRU cache, and return copies of the cached trees, which callers are free
+// to resolve in place. Expressions which fail to parse, or are longer than
+// 4 KB, aren't cached.
 parsed::update_expression parse_update_expression(std::string query);
 std::vector<parsed::path> parse_projection_expression(std::string query);
 parsed::condition_expression parse_condition_expression(std::string query);
 
+struct expression_cache_stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
+// Sets the maximum number of expressions cached by each shard, 0 disables
+// the cache. Must be called before the shards start parsing expressions.
+void set_expression_cache_size(size_t max_entries);
+// Statistics of the cache of the current shard.
+const expression_cache_stats& get_expression_cache_stats();
+size_t get_expression_cache_entries();
+
 void resolve_update_expression(parsed::update_expression& ue,
         const rjson::value* expression_attribute_names,
         const rjson::value* expression_attribute_values,
@@ -98,6 +98,23 @@ bytes serialize_item(const rjson::value& item) {
         return bytes{int8_t(type_info.atype)} + to_bytes(rjson::print(item));
     }
 
+    // Strings and binary values, which make up most items, are written
+    // straight into the serialized value, copied (or decoded) only once.
+    if (type_info.atype == alternator_type::S) {
+        std::string_view str = rjson::to_string_view(it->value);
+        bytes ret(bytes::initialized_later(), 1 + str.size());
+        ret[0] = int8_t(type_info.atype);
+        std::copy(str.begin(), str.end(), ret.begin() + 1);
+        return ret;
+    }
+    if (type_info.atype == alternator_type::B) {
+        std::string_view b64 = rjson::to_string_view(it->value);
+        bytes ret(bytes::initialized_later(), 1 + base64_decoded_size(b64));
+        ret[0] = int8_t(type_info.atype);
+        base64_decode(b64, ret.begin() + 1);
+        return ret;
+    }
+
     bytes_ostream bo;
     bo.write(bytes{int8_t(type_info.atype)});
     visit(*type_info.dtype, from_json_visitor{it->value, bo});
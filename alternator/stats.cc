@@ -20,6 +20,7 @@
  */
 
 #include "stats.hh"
+#include "expressions.hh"
 #include "utils/histogram_metrics_helper.hh"
 #include <seastar/core/metrics.hh>
 
@@ -104,6 +105,14 @@ stats::stats() : api_operations{} {
                     seastar::metrics::description("number of rows read and matched during filtering operations")),
             seastar::metrics::make_total_operations("filtered_rows_dropped_total", [this] { return cql_stats.filtered_rows_read_total - cql_stats.filtered_rows_matched_total; },
                     seastar::metrics::description("number of rows read and dropped during filtering operations")),
+            seastar::metrics::make_total_operations("expression_cache_hits", [] { return get_expression_cache_stats().hits; },
+                    seastar::metrics::description("number of expressions found in the cache of parsed expressions")),
+            seastar::metrics::make_total_operations("expression_cache_misses", [] { return get_expression_cache_stats().misses; },
+                    seastar::metrics::description("number of expressions which had to be parsed as they were not found in the cache of parsed expressions")),
+            seastar::metrics::make_total_operations("expression_cache_evictions", [] { return get_expression_cache_stats().evictions; },
+                    seastar::metrics::description("number of expressions evicted from the cache of parsed expressions")),
+            seastar::metrics::make_gauge("expression_cache_entries", [] { return get_expression_cache_entries(); },
+                    seastar::metrics::description("number of expressions in the cache of parsed expressions")),
     });
 }
 
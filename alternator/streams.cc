@@ -662,23 +662,40 @@ struct shard_iterator {
     // (inclusive of threshold) or >threshold (exclusive).
     static auto constexpr inclusive_marker = 'I';
     static auto constexpr exclusive_marker = 'i';
+    // Prefixes the iterator with a resume_point.
+    static auto constexpr resume_marker = 'r';
 
     static auto constexpr uuid_str_length = 36;
 
+    // The previous GetRecords stopped reading right after the row
+    // (threshold, batch_seq_no) of the log, and the replicas may have
+    // kept their readers in their querier cache under query_id.
+    struct resume_point {
+        utils::UUID query_id;
+        int32_t batch_seq_no;
+    };
+
     utils::UUID table;
     utils::UUID threshold;
     shard_id shard;
     bool inclusive;
+    std::optional<resume_point> resume;
 
     shard_iterator(const sstring&);
-
-    shard_iterator(utils::UUID t, shard_id i, utils::UUID th, bool inclusive)
+private:
+    shard_iterator(const sstring&, size_t pos);
+public:
+    shard_iterator(utils::UUID t, shard_id i, utils::UUID th, bool inclusive, std::optional<resume_point> resume = std::nullopt)
         : table(t)
         , threshold(th)
         , shard(i)
         , inclusive(inclusive)
+        , resume(std::move(resume))
     {}
     friend std::ostream& operator<<(std::ostream& os, const shard_iterator& id) {
+        if (id.resume) {
+            os << resume_marker << id.resume->query_id << ':' << std::dec << id.resume->batch_seq_no << ':';
+        }
         return os << (id.inclusive ? inclusive_marker : exclusive_marker) << std::hex
             << id.table
             << ':' << id.threshold
@@ -687,15 +704,23 @@ struct shard_iterator {
     }
 };
 
-shard_iterator::shard_iterator(const sstring& s) 
-    : table(s.substr(1, uuid_str_length))
-    , threshold(s.substr(2 + uuid_str_length, uuid_str_length))
-    , shard(s.substr(3 + 2 * uuid_str_length))
-    , inclusive(s.at(0) == inclusive_marker)
+shard_iterator::shard_iterator(const sstring& s)
+    : shard_iterator(s, s.empty() || s[0] != resume_marker ? 0 : s.find(':', 2 + uuid_str_length) + 1)
+{}
+
+// Parses the iterator starting at `pos`, past its resume point if any.
+shard_iterator::shard_iterator(const sstring& s, size_t pos)
+    : table(s.substr(pos + 1, uuid_str_length))
+    , threshold(s.substr(pos + 2 + uuid_str_length, uuid_str_length))
+    , shard(s.substr(pos + 3 + 2 * uuid_str_length))
+    , inclusive(s.at(pos) == inclusive_marker)
 {
-    if (s.at(0) != inclusive_marker && s.at(0) != exclusive_marker) {
+    if (s.at(pos) != inclusive_marker && s.at(pos) != exclusive_marker) {
         throw std::invalid_argument(s);
     }
+    if (pos) {
+        resume = resume_point{utils::UUID(s.substr(1, uuid_str_length)), std::stoi(s.substr(2 + uuid_str_length, pos - 3 - uuid_str_length))};
+    }
 }
 }
 
@@ -835,7 +860,11 @@ future<executor::request_return_type> executor::get_records(client_state& client
 
     auto high_ts = db_clock::now() - confidence_interval(db);
     auto high_uuid = utils::UUID_gen::min_time_UUID(high_ts.time_since_epoch());
-    auto lo = clustering_key_prefix::from_exploded(*schema, { iter.threshold.serialize() });
+    // A resumed read has to start exactly after the last row read by the
+    // previous one, for the replicas to find their cached readers usable.
+    auto lo = iter.resume
+            ? clustering_key_prefix::from_exploded(*schema, { iter.threshold.serialize(), int32_type->decompose(iter.resume->batch_seq_no) })
+            : clustering_key_prefix::from_exploded(*schema, { iter.threshold.serialize() });
     auto hi = clustering_key_prefix::from_exploded(*schema, { high_uuid.serialize() });
 
     std::vector<query::clustering_range> bounds;
@@ -843,6 +872,7 @@ future<executor::request_return_type> executor::get_records(client_state& client
     bounds.push_back(query::clustering_range::make(bound(lo, iter.inclusive), bound(hi, false)));
 
     static const bytes timestamp_column_name = cdc::log_meta_column_name_bytes("time");
+    static const bytes seq_column_name = cdc::log_meta_column_name_bytes("batch_seq_no");
     static const bytes op_column_name = cdc::log_meta_column_name_bytes("operation");
     static const bytes eor_column_name = cdc::log_meta_column_name_bytes("end_of_batch");
 
@@ -889,11 +919,19 @@ future<executor::request_return_type> executor::get_records(client_state& client
     if (opts.postimage()) {
         ++mul;
     }
+    uint64_t row_limit = limit * mul;
+    // Like the pages of a CQL query, consecutive reads of a shard share a
+    // query id, so that replicas keep their readers between them in the
+    // querier cache rather than looking the position up again. Nodes which
+    // predate resume points can't parse iterators carrying one, so they are
+    // only handed out once every node can.
+    bool can_resume = _proxy.features().cluster_supports_alternator_streams_resume();
+    auto query_id = iter.resume ? iter.resume->query_id : (can_resume ? utils::make_random_uuid() : utils::UUID());
     auto command = ::make_lw_shared<query::read_command>(schema->id(), schema->version(), partition_slice, _proxy.get_max_result_size(partition_slice),
-            query::row_limit(limit * mul));
+            query::row_limit(row_limit), query::partition_limit::max, gc_clock::now(), std::nullopt, query_id, query::is_first_page(!iter.resume));
 
     return _proxy.query(schema, std::move(command), std::move(partition_ranges), cl, service::storage_proxy::coordinator_query_options(default_timeout(), std::move(permit), client_state)).then(
-            [this, schema, partition_slice = std::move(partition_slice), selection = std::move(selection), start_time = std::move(start_time), limit, key_names = std::move(key_names), attr_names = std::move(attr_names), type, iter, high_ts] (service::storage_proxy::coordinator_query_result qr) mutable {       
+            [this, schema, partition_slice = std::move(partition_slice), selection = std::move(selection), start_time = std::move(start_time), limit, row_limit, query_id, can_resume, key_names = std::move(key_names), attr_names = std::move(attr_names), type, iter, high_ts] (service::storage_proxy::coordinator_query_result qr) mutable {       
         cql3::selection::result_set_builder builder(*selection, gc_clock::now(), cql_serialization_format::latest());
         query::result_view::consume(*qr.query_result, partition_slice, cql3::selection::result_set_builder::visitor(builder, *schema, *selection));
 
@@ -917,6 +955,11 @@ future<executor::request_return_type> executor::get_records(client_state& client
                 return cdef->name->name() == eor_column_name;
             })
         );
+        auto seq_index = std::distance(metadata.get_names().begin(),
+            std::find_if(metadata.get_names().begin(), metadata.get_names().end(), [](const lw_shared_ptr<cql3::column_specification>& cdef) {
+                return cdef->name->name() == seq_column_name;
+            })
+        );
 
         std::optional<utils::UUID> timestamp;
         auto dynamodb = rjson::empty_object();
@@ -939,7 +982,10 @@ future<executor::request_return_type> executor::get_records(client_state& client
             }
         };
 
+        size_t consumed_rows = 0;
+        bool consumed_whole_records = true;
         for (auto& row : result_set->rows()) {
+            ++consumed_rows;
             auto op = static_cast<cdc::operation>(value_cast<op_utype>(data_type_for<op_utype>()->deserialize(*row[op_index])));
             auto ts = value_cast<utils::UUID>(data_type_for<utils::UUID>()->deserialize(*row[ts_index]));
             auto eor = row[eor_index].has_value() ? value_cast<bool>(boolean_type->deserialize(*row[eor_index])) : false;
@@ -995,6 +1041,7 @@ future<executor::request_return_type> executor::get_records(client_state& client
                 rjson::set(record, "eventName", "REMOVE");
                 break;
             }
+            consumed_whole_records = eor;
             if (eor) {
                 maybe_add_record();
                 timestamp = ts;
@@ -1009,8 +1056,16 @@ future<executor::request_return_type> executor::get_records(client_state& client
         rjson::set(ret, "Records", std::move(records));
 
         if (nrecords != 0) {
+            // The replicas kept their readers only if they stopped because
+            // of the row limit, and these can only be resumed if we returned
+            // all the records they read.
+            std::optional<shard_iterator::resume_point> resume;
+            if (can_resume && result_set->size() == row_limit && consumed_rows == row_limit && consumed_whole_records) {
+                auto& last_row = result_set->rows().back();
+                resume = shard_iterator::resume_point{query_id, value_cast<int32_t>(int32_type->deserialize(*last_row[seq_index]))};
+            }
             // #9642. Set next iterators threshold to > last
-            shard_iterator next_iter(iter.table, iter.shard, *timestamp, false);
+            shard_iterator next_iter(iter.table, iter.shard, *timestamp, false, std::move(resume));
             // Note that here we unconditionally return NextShardIterator,
             // without checking if maybe we reached the end-of-shard. If the
             // shard did end, then the next read will have nrecords == 0 and
@@ -27,6 +27,7 @@
 #include "db/config.hh"
 #include "utils/histogram.hh"
 #include "database.hh"
+#include "locator/dynamic_snitch.hh"
 #include "seastar/core/scheduling_specific.hh"
 
 namespace api {
@@ -363,6 +364,34 @@ void set_storage_proxy(http_context& ctx, routes& r) {
         return sum_stats_storage_proxy(ctx.sp, &service::storage_proxy_stats::stats::read_repair_repaired_background);
     });
 
+    sp::get_dynamic_snitch_scores.set(r, [&ctx](std::unique_ptr<request> req)  {
+        using score_sums = std::unordered_map<gms::inet_address, std::pair<double, unsigned>>;
+        return ctx.sp.map_reduce0([] (service::storage_proxy& sp) {
+            score_sums res;
+            for (auto& [ep, score] : sp.get_dynamic_snitch().get_scores()) {
+                res.emplace(ep, std::make_pair(score, 1u));
+            }
+            return res;
+        }, score_sums(), [] (score_sums a, const score_sums& b) {
+            for (auto& [ep, sum] : b) {
+                auto& s = a[ep];
+                s.first += sum.first;
+                s.second += sum.second;
+            }
+            return a;
+        }).then([] (score_sums sums) {
+            std::vector<sp::endpoint_score> res;
+            res.reserve(sums.size());
+            for (auto& [ep, sum] : sums) {
+                sp::endpoint_score entry;
+                entry.endpoint = ep.to_sstring();
+                entry.score = sum.first / sum.second;
+                res.emplace_back(std::move(entry));
+            }
+            return make_ready_future<json::json_return_type>(std::move(res));
+        });
+    });
+
     sp::get_schema_versions.set(r, [](std::unique_ptr<request> req)  {
         return service::get_local_storage_service().describe_schema_versions().then([] (auto result) {
             std::vector<sp::mapper_list> res;
@@ -369,6 +369,7 @@ scylla_tests = set([
     'test/boost/counter_test',
     'test/boost/cql_auth_query_test',
     'test/boost/cql_auth_syntax_test',
+    'test/boost/cql_segment_test',
     'test/boost/cql_query_test',
     'test/boost/cql_query_large_test',
     'test/boost/cql_query_like_test',
@@ -380,6 +381,7 @@ scylla_tests = set([
     'test/boost/double_decker_test',
     'test/boost/duration_test',
     'test/boost/dynamic_bitset_test',
+    'test/boost/dynamic_snitch_test',
     'test/boost/enum_option_test',
     'test/boost/enum_set_test',
     'test/boost/extensions_test',
@@ -424,6 +426,7 @@ scylla_tests = set([
     'test/boost/nonwrapping_range_test',
     'test/boost/observable_test',
     'test/boost/partitioner_test',
+    'test/boost/paxos_state_cache_test',
     'test/boost/querier_cache_test',
     'test/boost/query_processor_test',
     'test/boost/range_test',
@@ -465,6 +468,7 @@ scylla_tests = set([
     'test/boost/view_schema_ckey_test',
     'test/boost/vint_serialization_test',
     'test/boost/virtual_reader_test',
+    'test/boost/zstd_rpc_compressor_test',
     'test/boost/bptree_test',
     'test/boost/btree_test',
     'test/boost/radix_tree_test',
@@ -513,6 +517,7 @@ perf_tests = set([
     'test/perf/perf_idl',
     'test/perf/perf_vint',
     'test/perf/perf_big_decimal',
+    'test/perf/perf_rpc_compressors',
 ])
 
 raft_tests = set([
@@ -687,6 +692,7 @@ scylla_core = (['database.cc',
                 'sstables/metadata_collector.cc',
                 'sstables/writer.cc',
                 'transport/cql_protocol_extension.cc',
+                'transport/cql_segment.cc',
                 'transport/event.cc',
                 'transport/event_notifier.cc',
                 'transport/server.cc',
@@ -783,15 +789,18 @@ scylla_core = (['database.cc',
                 'service/priority_manager.cc',
                 'service/migration_manager.cc',
                 'service/storage_proxy.cc',
+                'service/forward_service.cc',
                 'service/paxos/proposal.cc',
                 'service/paxos/prepare_response.cc',
                 'service/paxos/paxos_state.cc',
+                'service/paxos/paxos_state_cache.cc',
                 'service/paxos/prepare_summary.cc',
                 'cql3/relation.cc',
                 'cql3/column_identifier.cc',
                 'cql3/column_specification.cc',
                 'cql3/constants.cc',
                 'cql3/query_processor.cc',
+                'cql3/unprepared_statements_cache.cc',
                 'cql3/query_options.cc',
                 'cql3/single_column_relation.cc',
                 'cql3/token_relation.cc',
@@ -879,7 +888,9 @@ scylla_core = (['database.cc',
                 'locator/ec2_snitch.cc',
                 'locator/ec2_multi_region_snitch.cc',
                 'locator/gce_snitch.cc',
+                'locator/dynamic_snitch.cc',
                 'message/messaging_service.cc',
+                'message/zstd_rpc_compressor.cc',
                 'service/client_state.cc',
                 'service/storage_service.cc',
                 'service/misc_services.cc',
@@ -940,6 +951,8 @@ scylla_core = (['database.cc',
                 'vint-serialization.cc',
                 'utils/arch/powerpc/crc32-vpmsum/crc32_wrapper.cc',
                 'querier.cc',
+                'read_coalescer.cc',
+                'row_filter.cc',
                 'mutation_writer/multishard_writer.cc',
                 'multishard_mutation_query.cc',
                 'reader_concurrency_semaphore.cc',
@@ -1056,6 +1069,7 @@ idls = ['idl/gossip_digest.idl.hh',
         'idl/messaging_service.idl.hh',
         'idl/paxos.idl.hh',
         'idl/raft.idl.hh',
+        'idl/forward_request.idl.hh',
         ]
 
 headers = find_headers('.', excluded_dirs=['idl', 'build', 'seastar', '.git'])
@@ -1102,6 +1116,7 @@ pure_boost_tests = set([
     'test/boost/compound_test',
     'test/boost/compress_test',
     'test/boost/cql_auth_syntax_test',
+    'test/boost/cql_segment_test',
     'test/boost/crc_test',
     'test/boost/duration_test',
     'test/boost/dynamic_bitset_test',
@@ -1122,6 +1137,7 @@ pure_boost_tests = set([
     'test/boost/small_vector_test',
     'test/boost/top_k_test',
     'test/boost/vint_serialization_test',
+    'test/boost/zstd_rpc_compressor_test',
     'test/boost/bptree_test',
     'test/boost/utf8_test',
     'test/boost/btree_test',
@@ -886,6 +886,68 @@ expression replace_column_def(const expression& expr, const column_definition* n
         }, expr);
 }
 
+void to_column_restrictions(const expression& e, const query_options& options,
+                            std::vector<query::column_restriction>& out) {
+    std::visit(overloaded_functor{
+            [] (bool) {},
+            [&] (const conjunction& conj) {
+                for (auto& child : conj.children) {
+                    to_column_restrictions(child, options, out);
+                }
+            },
+            [&] (const binary_operator& oper) {
+                auto col = std::get_if<column_value>(&oper.lhs);
+                if (!col || col->sub || !col->col->is_atomic() || col->col->is_counter()) {
+                    return;
+                }
+                std::vector<bytes> values;
+                query::restriction_op op;
+                if (oper.op == oper_t::IN) {
+                    op = query::restriction_op::in;
+                    if (auto dv = dynamic_pointer_cast<lists::delayed_value>(oper.rhs)) {
+                        for (auto& t : dv->get_elements()) {
+                            auto v = t->bind_and_get(options);
+                            if (v.is_unset_value()) {
+                                return;
+                            }
+                            if (!v.is_null()) {
+                                values.push_back(to_bytes(v));
+                            }
+                        }
+                    } else if (auto mkr = dynamic_pointer_cast<lists::marker>(oper.rhs)) {
+                        const auto val = mkr->bind(options);
+                        if (!val || val == constants::UNSET_VALUE) {
+                            return;
+                        }
+                        for (auto& v : static_pointer_cast<lists::value>(val)->get_elements() | non_null | deref) {
+                            values.push_back(to_bytes(v));
+                        }
+                    } else {
+                        return;
+                    }
+                } else {
+                    switch (oper.op) {
+                    case oper_t::EQ: op = query::restriction_op::in; break;
+                    case oper_t::LT: op = query::restriction_op::lt; break;
+                    case oper_t::LTE: op = query::restriction_op::lte; break;
+                    case oper_t::GT: op = query::restriction_op::gt; break;
+                    case oper_t::GTE: op = query::restriction_op::gte; break;
+                    default: return;
+                    }
+                    auto v = oper.rhs->bind_and_get(options);
+                    if (v.is_unset_value()) {
+                        return;
+                    }
+                    // A comparison with null is false, hence a restriction without values.
+                    if (!v.is_null()) {
+                        values.push_back(to_bytes(v));
+                    }
+                }
+                out.push_back(query::column_restriction{col->col->name(), op, std::move(values)});
+            },
+        }, e);
+}
+
 std::ostream& operator<<(std::ostream& s, oper_t op) {
     switch (op) {
     case oper_t::EQ:
@@ -35,6 +35,7 @@
 #include "database_fwd.hh"
 #include "gc_clock.hh"
 #include "mutation_partition.hh"
+#include "query-request.hh"
 #include "query-result-reader.hh"
 #include "range.hh"
 #include "seastarx.hh"
@@ -263,6 +264,12 @@ extern bool is_on_collection(const binary_operator&);
 /// column_value.
 extern expression replace_column_def(const expression&, const column_definition*);
 
+/// Appends to out the restrictions of single, non-subscripted, atomic columns in the conjunction e, with values bound
+/// from options, so that replicas can evaluate them (see query::partition_slice::filter).  Other restrictions, and
+/// restrictions with unset values, are skipped, so rows satisfying out may still not satisfy e.
+extern void to_column_restrictions(const expression& e, const query_options& options,
+                                   std::vector<query::column_restriction>& out);
+
 inline oper_t pick_operator(statements::bound b, bool inclusive) {
     return is_start(b) ?
             (inclusive ? oper_t::GTE : oper_t::GT) :
@@ -45,6 +45,7 @@
 #include "functions.hh"
 #include "native_aggregate_function.hh"
 #include "exceptions/exceptions.hh"
+#include <seastar/core/byteorder.hh>
 
 using namespace cql3;
 using namespace functions;
@@ -60,6 +61,12 @@ class impl_count_function : public aggregate_function::aggregate {
     virtual opt_bytes compute(cql_serialization_format sf) override {
         return long_type->decompose(_count);
     }
+    virtual opt_bytes get_state() const override {
+        return long_type->decompose(_count);
+    }
+    virtual void merge_state(const opt_bytes& state) override {
+        _count += value_cast<int64_t>(long_type->deserialize(*state));
+    }
     virtual void add_input(cql_serialization_format sf, const std::vector<opt_bytes>& values) override {
         ++_count;
     }
@@ -92,6 +99,21 @@ struct int128_accumulator_for {
         }
         return ret;
     }
+
+    static bytes serialize(type acc) {
+        bytes b(bytes::initialized_later(), 2 * sizeof(int64_t));
+        auto p = reinterpret_cast<char*>(b.data());
+        seastar::write_be<int64_t>(p, static_cast<int64_t>(acc >> 64));
+        seastar::write_be<uint64_t>(p + sizeof(int64_t), static_cast<uint64_t>(acc));
+        return b;
+    }
+
+    static type deserialize(bytes_view b) {
+        auto p = reinterpret_cast<const char*>(b.data());
+        auto high = seastar::read_be<int64_t>(p);
+        auto low = seastar::read_be<uint64_t>(p + sizeof(int64_t));
+        return (static_cast<type>(high) << 64) | low;
+    }
 };
 
 template <typename T>
@@ -101,6 +123,14 @@ struct same_type_accumulator_for {
     static T narrow(type acc) {
         return acc;
     }
+
+    static bytes serialize(const type& acc) {
+        return data_type_for<T>()->decompose(data_value(acc));
+    }
+
+    static type deserialize(bytes_view b) {
+        return value_cast<T>(data_type_for<T>()->deserialize(b));
+    }
 };
 
 template <typename T>
@@ -126,6 +156,12 @@ class impl_sum_function_for final : public aggregate_function::aggregate {
         }
         _sum += value_cast<Type>(data_type_for<Type>()->deserialize(*values[0]));
     }
+    virtual opt_bytes get_state() const override {
+        return accumulator_for<Type>::serialize(_sum);
+    }
+    virtual void merge_state(const opt_bytes& state) override {
+        _sum += accumulator_for<Type>::deserialize(*state);
+    }
 };
 
 template <typename Type>
@@ -184,6 +220,15 @@ class impl_avg_function_for final : public aggregate_function::aggregate {
         ++_count;
         _sum += value_cast<Type>(data_type_for<Type>()->deserialize(*values[0]));
     }
+    // The state is the count, followed by the sum.
+    virtual opt_bytes get_state() const override {
+        return long_type->decompose(_count) + accumulator_for<Type>::serialize(_sum);
+    }
+    virtual void merge_state(const opt_bytes& state) override {
+        bytes_view v(*state);
+        _count += value_cast<int64_t>(long_type->deserialize(v.substr(0, sizeof(int64_t))));
+        _sum += accumulator_for<Type>::deserialize(v.substr(sizeof(int64_t)));
+    }
 };
 
 template <typename Type>
@@ -270,6 +315,15 @@ class impl_max_function_for final : public aggregate_function::aggregate {
             _max = max_wrapper(*_max, val);
         }
     }
+    virtual opt_bytes get_state() const override {
+        if (!_max) {
+            return {};
+        }
+        return data_type_for<Type>()->decompose(data_value(Type{*_max}));
+    }
+    virtual void merge_state(const opt_bytes& state) override {
+        add_input(cql_serialization_format::internal(), {state});
+    }
 };
 
 /// The same as `impl_max_function_for' but without compile-time dependency on `Type'.
@@ -293,6 +347,12 @@ class impl_max_dynamic_function final : public aggregate_function::aggregate {
             _max = values[0];
         }
     }
+    virtual opt_bytes get_state() const override {
+        return _max;
+    }
+    virtual void merge_state(const opt_bytes& state) override {
+        add_input(cql_serialization_format::internal(), {state});
+    }
 };
 
 template <typename Type>
@@ -371,6 +431,15 @@ class impl_min_function_for final : public aggregate_function::aggregate {
             _min = min_wrapper(*_min, val);
         }
     }
+    virtual opt_bytes get_state() const override {
+        if (!_min) {
+            return {};
+        }
+        return data_type_for<Type>()->decompose(data_value(Type{*_min}));
+    }
+    virtual void merge_state(const opt_bytes& state) override {
+        add_input(cql_serialization_format::internal(), {state});
+    }
 };
 
 /// The same as `impl_min_function_for' but without compile-time dependency on `Type'.
@@ -394,6 +463,12 @@ class impl_min_dynamic_function final : public aggregate_function::aggregate {
             _min = values[0];
         }
     }
+    virtual opt_bytes get_state() const override {
+        return _min;
+    }
+    virtual void merge_state(const opt_bytes& state) override {
+        add_input(cql_serialization_format::internal(), {state});
+    }
 };
 
 template <typename Type>
@@ -439,6 +514,12 @@ class impl_count_function_for final : public aggregate_function::aggregate {
     virtual opt_bytes compute(cql_serialization_format sf) override {
         return long_type->decompose(_count);
     }
+    virtual opt_bytes get_state() const override {
+        return long_type->decompose(_count);
+    }
+    virtual void merge_state(const opt_bytes& state) override {
+        _count += value_cast<int64_t>(long_type->deserialize(*state));
+    }
     virtual void add_input(cql_serialization_format sf, const std::vector<opt_bytes>& values) override {
         if (!values[0]) {
             return;
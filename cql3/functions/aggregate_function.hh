@@ -91,6 +91,22 @@ class aggregate_function : public virtual function {
          * Reset this aggregate.
          */
         virtual void reset() = 0;
+
+        /**
+         * Returns the intermediate state of this aggregate. Aggregates of parts of the
+         * data, e.g. of the data owned by different replicas, can be combined by
+         * merging their states into an aggregate of the same function.
+         *
+         * @return the aggregate state, in an internal format.
+         */
+        virtual opt_bytes get_state() const = 0;
+
+        /**
+         * Merges the state of another aggregate of the same function into this one.
+         *
+         * @param state the state, as returned by <code>get_state()</code>
+         */
+        virtual void merge_state(const opt_bytes& state) = 0;
     };
 };
 
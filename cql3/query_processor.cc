@@ -84,10 +84,11 @@ class query_processor::internal_state {
     }
 };
 
-query_processor::query_processor(service::storage_proxy& proxy, database& db, service::migration_notifier& mn, service::migration_manager& mm, query_processor::memory_config mcfg, cql_config& cql_cfg,
+query_processor::query_processor(service::storage_proxy& proxy, service::forward_service& forwarder, database& db, service::migration_notifier& mn, service::migration_manager& mm, query_processor::memory_config mcfg, cql_config& cql_cfg,
         sharded<qos::service_level_controller> &sl_controller)
         : _migration_subscriber{std::make_unique<migration_subscriber>(this)}
         , _proxy(proxy)
+        , _forwarder(forwarder)
         , _db(db)
         , _mnotifier(mn)
         , _mm(mm)
@@ -97,7 +98,8 @@ query_processor::query_processor(service::storage_proxy& proxy, database& db, se
         , _authorized_prepared_cache(std::min(std::chrono::milliseconds(_db.get_config().permissions_validity_in_ms()),
                                               std::chrono::duration_cast<std::chrono::milliseconds>(prepared_statements_cache::entry_expiry)),
                                      std::chrono::milliseconds(_db.get_config().permissions_update_interval_in_ms()),
-                                     mcfg.authorized_prepared_cache_size, authorized_prepared_statements_cache_log) {
+                                     mcfg.authorized_prepared_cache_size, authorized_prepared_statements_cache_log)
+        , _unprepared_statements_cache(_db.get_config().unprepared_statements_cache_size) {
     namespace sm = seastar::metrics;
     namespace stm = statements;
     using clevel = db::consistency_level;
@@ -475,8 +477,21 @@ future<> query_processor::stop() {
 future<::shared_ptr<result_message>>
 query_processor::execute_direct(const sstring_view& query_string, service::query_state& query_state, query_options& options) {
     log.trace("execute_direct: \"{}\"", query_string);
-    tracing::trace(query_state.get_trace_state(), "Parsing a statement");
-    auto p = get_statement(query_string, query_state.get_client_state());
+    auto& keyspace = query_state.get_client_state().get_raw_keyspace();
+    // Only used synchronously, the statement itself is kept alive by
+    // cql_statement below.
+    const statements::prepared_statement* p = _unprepared_statements_cache.find(keyspace, query_string);
+    std::unique_ptr<statements::prepared_statement> uncached;
+    if (p) {
+        tracing::trace(query_state.get_trace_state(), "Using a cached statement");
+    } else {
+        tracing::trace(query_state.get_trace_state(), "Parsing a statement");
+        uncached = get_statement(query_string, query_state.get_client_state());
+        p = uncached.get();
+        if (_unprepared_statements_cache.should_cache(query_string, *uncached)) {
+            p = _unprepared_statements_cache.insert(keyspace, query_string, std::move(uncached));
+        }
+    }
     auto cql_statement = p->statement;
     if (cql_statement->get_bound_terms() != options.get_values_count()) {
         const auto msg = format("Invalid amount of bind variables: expected {:d} received {:d}",
@@ -938,6 +953,9 @@ void query_processor::migration_subscriber::remove_invalid_prepared_statements(
     _qp->_prepared_cache.remove_if([&] (::shared_ptr<cql_statement> stmt) {
         return this->should_invalidate(ks_name, cf_name, stmt);
     });
+    _qp->_unprepared_statements_cache.remove_if([&] (::shared_ptr<cql_statement> stmt) {
+        return this->should_invalidate(ks_name, cf_name, stmt);
+    });
 }
 
 bool query_processor::migration_subscriber::should_invalidate(
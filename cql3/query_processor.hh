@@ -50,6 +50,7 @@
 
 #include "cql3/prepared_statements_cache.hh"
 #include "cql3/authorized_prepared_statements_cache.hh"
+#include "cql3/unprepared_statements_cache.hh"
 #include "cql3/query_options.hh"
 #include "cql3/statements/prepared_statement.hh"
 #include "exceptions/exceptions.hh"
@@ -60,6 +61,7 @@
 
 namespace service {
 class migration_manager;
+class forward_service;
 }
 
 namespace cql3 {
@@ -117,6 +119,7 @@ class query_processor {
 private:
     std::unique_ptr<migration_subscriber> _migration_subscriber;
     service::storage_proxy& _proxy;
+    service::forward_service& _forwarder;
     database& _db;
     service::migration_notifier& _mnotifier;
     service::migration_manager& _mm;
@@ -136,6 +139,7 @@ class query_processor {
 
     prepared_statements_cache _prepared_cache;
     authorized_prepared_statements_cache _authorized_prepared_cache;
+    unprepared_statements_cache _unprepared_statements_cache;
 
     // A map for prepared statements used internally (which we don't want to mix with user statement, in particular we
     // don't bother with expiration on those.
@@ -154,7 +158,7 @@ class query_processor {
 
     static std::unique_ptr<statements::raw::parsed_statement> parse_statement(const std::string_view& query);
 
-    query_processor(service::storage_proxy& proxy, database& db, service::migration_notifier& mn, service::migration_manager& mm, memory_config mcfg, cql_config& cql_cfg,
+    query_processor(service::storage_proxy& proxy, service::forward_service& forwarder, database& db, service::migration_notifier& mn, service::migration_manager& mm, memory_config mcfg, cql_config& cql_cfg,
             sharded<qos::service_level_controller> &sl_controller);
 
     ~query_processor();
@@ -171,6 +175,10 @@ class query_processor {
         return _proxy;
     }
 
+    service::forward_service& forwarder() {
+        return _forwarder;
+    }
+
     const service::migration_manager& get_migration_manager() const noexcept { return _mm; }
     service::migration_manager& get_migration_manager() noexcept { return _mm; }
 
@@ -178,6 +186,10 @@ class query_processor {
         return _cql_stats;
     }
 
+    const unprepared_statements_cache& get_unprepared_statements_cache() const {
+        return _unprepared_statements_cache;
+    }
+
     statements::prepared_statement::checked_weak_ptr get_prepared(const std::optional<auth::authenticated_user>& user, const prepared_cache_key_type& key) {
         if (user) {
             auto it = _authorized_prepared_cache.find(*user, key);
@@ -38,8 +38,14 @@ class result_generator {
     template<typename Visitor>
     class query_result_visitor {
         const schema& _schema;
-        std::vector<bytes> _partition_key;
-        std::vector<bytes> _clustering_key;
+        // The keys are owned by query::result_view::consume(), which keeps
+        // the partition key alive until after accept_partition_end(), and
+        // the clustering key until the end of accept_new_row(). Their
+        // components are passed to the visitor as views, and are only valid
+        // for the duration of accept_value().
+        const partition_key* _partition_key = nullptr;
+        const clustering_key* _clustering_key = nullptr;
+        bytes _linearized_component;
         uint64_t _partition_row_count = 0;
         uint64_t _total_row_count = 0;
         Visitor& _visitor;
@@ -53,12 +59,24 @@ class result_generator {
                 _visitor.accept_value(cell ? std::optional<query::result_bytes_view>(cell->value()) : std::optional<query::result_bytes_view>());
             }
         }
+        template<typename Key>
+        void accept_key_component(const Key& key, size_t idx) {
+            auto component = key.get_component(_schema, idx);
+            // Keys are at most 64kB, so their components are contiguous in
+            // practice.
+            if (component.current_fragment().size() == component.size_bytes()) {
+                _visitor.accept_value(query::result_bytes_view(component.current_fragment()));
+            } else {
+                _linearized_component = linearized(component);
+                _visitor.accept_value(query::result_bytes_view(bytes_view(_linearized_component)));
+            }
+        }
     public:
         query_result_visitor(const schema& s, Visitor& visitor, const selection::selection& select)
             : _schema(s), _visitor(visitor), _selection(select) { }
 
         void accept_new_partition(const partition_key& key, uint64_t row_count) {
-            _partition_key = key.explode(_schema);
+            _partition_key = &key;
             accept_new_partition(row_count);
         }
         void accept_new_partition(uint64_t row_count) {
@@ -68,8 +86,9 @@ class result_generator {
 
         void accept_new_row(const clustering_key& key, query::result_row_view static_row,
                             query::result_row_view row) {
-            _clustering_key = key.explode(_schema);
+            _clustering_key = &key;
             accept_new_row(static_row, row);
+            _clustering_key = nullptr;
         }
         void accept_new_row(query::result_row_view static_row, query::result_row_view row) {
             auto static_row_iterator = static_row.iterator();
@@ -78,11 +97,11 @@ class result_generator {
             for (auto&& def : _selection.get_columns()) {
                 switch (def->kind) {
                 case column_kind::partition_key:
-                    _visitor.accept_value(query::result_bytes_view(bytes_view(_partition_key[def->component_index()])));
+                    accept_key_component(*_partition_key, def->component_index());
                     break;
                 case column_kind::clustering_key:
-                    if (_clustering_key.size() > def->component_index()) {
-                        _visitor.accept_value(query::result_bytes_view(bytes_view(_clustering_key[def->component_index()])));
+                    if (_clustering_key && _clustering_key->size(_schema) > def->component_index()) {
+                        accept_key_component(*_clustering_key, def->component_index());
                     } else {
                         _visitor.accept_value(std::nullopt);
                     }
@@ -105,7 +124,7 @@ class result_generator {
                 auto static_row_iterator = static_row.iterator();
                 for (auto&& def : _selection.get_columns()) {
                     if (def->is_partition_key()) {
-                        _visitor.accept_value(query::result_bytes_view(bytes_view(_partition_key[def->component_index()])));
+                        accept_key_component(*_partition_key, def->component_index());
                     } else if (def->is_static()) {
                         accept_cell_value(*def, static_row_iterator);
                     } else {
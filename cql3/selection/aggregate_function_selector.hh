@@ -73,6 +73,14 @@ class aggregate_function_selector : public abstract_function_selector_for<functi
         _aggregate->reset();
     }
 
+    virtual bytes_opt get_state() const override {
+        return _aggregate->get_state();
+    }
+
+    virtual void merge_state(const bytes_opt& state) override {
+        _aggregate->merge_state(state);
+    }
+
     aggregate_function_selector(shared_ptr<functions::function> func,
                 std::vector<shared_ptr<selector>> arg_selectors)
             : abstract_function_selector_for<functions::aggregate_function>(
@@ -100,6 +100,14 @@ class selectable::with_function : public selectable {
         : _function_name(std::move(fname)), _args(std::move(args)) {
     }
 
+    const functions::function_name& function_name() const {
+        return _function_name;
+    }
+
+    const std::vector<shared_ptr<selectable>>& args() const {
+        return _args;
+    }
+
     virtual sstring to_string() const override;
 
     virtual shared_ptr<selector::factory> new_selector_factory(database& db, schema_ptr s, std::vector<const column_definition*>& defs) override;
@@ -171,6 +171,10 @@ class selection_with_processing : public selection {
     virtual bool is_aggregate() const override {
         return _factories->does_aggregation();
     }
+
+    virtual bool is_reducible() const override {
+        return _factories->contains_only_reducible_aggregates();
+    }
 protected:
     class selectors_with_processing : public selectors {
     private:
@@ -212,6 +216,24 @@ class selection_with_processing : public selection {
                 s->add_input(sf, rs);
             }
         }
+
+        virtual std::vector<bytes_opt> get_state_row() const override {
+            std::vector<bytes_opt> states;
+            states.reserve(_selectors.size());
+            for (auto&& s : _selectors) {
+                states.emplace_back(s->get_state());
+            }
+            return states;
+        }
+
+        virtual void merge_state_row(const std::vector<bytes_opt>& states) override {
+            if (states.size() != _selectors.size()) {
+                throw std::runtime_error(format("Expected {} aggregate states, got {}", _selectors.size(), states.size()));
+            }
+            for (size_t i = 0; i < states.size(); ++i) {
+                _selectors[i]->merge_state(states[i]);
+            }
+        }
     };
 
     std::unique_ptr<selectors> new_selectors() const override  {
@@ -382,6 +404,20 @@ std::unique_ptr<result_set> result_set_builder::build() {
     return std::move(_result_set);
 }
 
+std::vector<bytes_opt> result_set_builder::build_state() {
+    // Unlike build(), doesn't compute the results of the aggregates, which
+    // can fail for a part of the data (e.g. on sum overflow) and not for all.
+    if (current) {
+        _selectors->add_input_row(_cql_serialization_format, *this);
+        current.reset();
+    }
+    return _selectors->get_state_row();
+}
+
+void result_set_builder::merge_state(const std::vector<bytes_opt>& states) {
+    _selectors->merge_state_row(states);
+}
+
 result_set_builder::restrictions_filter::restrictions_filter(::shared_ptr<restrictions::statement_restrictions> restrictions,
         const query_options& options,
         uint64_t remaining,
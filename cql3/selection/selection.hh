@@ -83,6 +83,20 @@ class selectors {
     virtual std::vector<bytes_opt> get_output_row(cql_serialization_format sf) = 0;
 
     virtual void reset() = 0;
+
+    /**
+     * Returns the intermediate states of the aggregates, see selection::is_reducible().
+     */
+    virtual std::vector<bytes_opt> get_state_row() const {
+        throw std::logic_error("selection is not reducible");
+    }
+
+    /**
+     * Merges the intermediate states of the aggregates of another instance of these selectors.
+     */
+    virtual void merge_state_row(const std::vector<bytes_opt>& states) {
+        throw std::logic_error("selection is not reducible");
+    }
 };
 
 class selection {
@@ -198,6 +212,15 @@ class selection {
 
     virtual bool is_aggregate() const = 0;
 
+    /**
+     * Checks if the selection consists only of aggregate functions, which can be
+     * computed for parts of the data separately, and then combined by merging
+     * their intermediate states.
+     */
+    virtual bool is_reducible() const {
+        return false;
+    }
+
     /**
      * Checks that selectors are either all aggregates or that none of them is.
      *
@@ -304,6 +327,11 @@ class result_set_builder {
     void add_collection(const column_definition& def, bytes_view c);
     void new_row();
     std::unique_ptr<result_set> build();
+    /// For reducible selections only: returns the intermediate states of the aggregates
+    /// instead of their results, to be merged into another builder with merge_state().
+    std::vector<bytes_opt> build_state();
+    /// For reducible selections only: merges the states returned by build_state().
+    void merge_state(const std::vector<bytes_opt>& states);
     api::timestamp_type timestamp_of(size_t idx);
     int32_t ttl_of(size_t idx);
 
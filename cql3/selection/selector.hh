@@ -42,6 +42,7 @@
 #pragma once
 
 #include <vector>
+#include <stdexcept>
 #include "cql3/assignment_testable.hh"
 #include "types.hh"
 #include "schema_fwd.hh"
@@ -107,6 +108,21 @@ class selector : public assignment_testable {
      */
     virtual void reset() = 0;
 
+    /**
+     * Returns the intermediate state of an aggregating <code>selector</code>, see
+     * <code>aggregate_function::aggregate::get_state()</code>.
+     */
+    virtual bytes_opt get_state() const {
+        throw std::logic_error("selector has no intermediate state");
+    }
+
+    /**
+     * Merges the intermediate state of another instance of this <code>selector</code>.
+     */
+    virtual void merge_state(const bytes_opt& state) {
+        throw std::logic_error("selector has no intermediate state");
+    }
+
     virtual assignment_testable::test_result test_assignment(database& db, const sstring& keyspace, const column_specification& receiver) const override {
         auto t1 = receiver.type->underlying_type();
         auto t2 = get_type()->underlying_type();
@@ -157,6 +173,14 @@ class selector::factory {
         return false;
     }
 
+    /**
+     * Checks if this factory creates selectors instances that are aggregates themselves,
+     * which have an intermediate state.
+     */
+    virtual bool is_reducible_selector_factory() const {
+        return false;
+    }
+
     /**
      * Checks if this factory creates <code>writetime</code> selectors instances.
      *
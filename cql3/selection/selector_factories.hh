@@ -42,6 +42,7 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 #include "cql3/selection/selector.hh"
 #include "cql3/selection/selectable.hh"
 
@@ -118,6 +119,16 @@ class selector_factories {
         return size != 0 && _number_of_aggregate_factories  == (size - _number_of_factories_for_post_processing);
     }
 
+    /**
+     * Checks if all factories create aggregates with an intermediate state, i.e. whose
+     * arguments are not aggregates themselves and which are not arguments of other functions.
+     */
+    bool contains_only_reducible_aggregates() const {
+        return !_factories.empty() && std::all_of(_factories.begin(), _factories.end(), [] (auto& f) {
+            return f->is_reducible_selector_factory();
+        });
+    }
+
     /**
      * Whether the selector built by this factory does aggregation or not (either directly or in a sub-selector).
      *
@@ -188,32 +188,56 @@ future<std::vector<mutation>> batch_statement::get_mutations(service::storage_pr
         db::timeout_clock::time_point timeout, bool local, api::timestamp_type now, service::query_state& query_state) const {
     // Do not process in parallel because operations like list append/prepend depend on execution order.
     using mutation_set_type = std::unordered_set<mutation, mutation_hash_by_key, mutation_equals_by_key>;
-    return do_with(mutation_set_type(), [this, &storage, &options, timeout, now, local, &query_state] (auto& result) mutable {
-        result.reserve(_statements.size());
+    struct state {
+        mutation_set_type result;
+        // The mutation the previous statement wrote to. Batches often modify
+        // a single partition, or several statements in a row modify the same
+        // one: checking it first saves computing the token of the key and
+        // looking it up in the set for each statement.
+        mutation* last = nullptr;
+    };
+    return do_with(state(), [this, &storage, &options, timeout, now, local, &query_state] (state& st) mutable {
+        st.result.reserve(_statements.size());
         return do_for_each(boost::make_counting_iterator<size_t>(0),
                            boost::make_counting_iterator<size_t>(_statements.size()),
-                           [this, &storage, &options, now, local, &result, timeout, &query_state] (size_t i) {
+                           [this, &storage, &options, now, local, &st, timeout, &query_state] (size_t i) {
             auto&& statement = _statements[i].statement;
             statement->inc_cql_stats(query_state.get_client_state().is_internal());
             auto&& statement_options = options.for_statement(i);
             auto timestamp = _attrs->get_timestamp(now, statement_options);
-            return statement->get_mutations(storage, statement_options, timeout, local, timestamp, query_state).then([&result] (auto&& more) {
+            if (!statement->requires_read()) {
+                // Apply the updates directly to the mutation of the partition,
+                // rather than building a mutation per statement and merging it.
+                statement->add_updates(statement_options, timestamp, [&st, &s = statement->s] (const partition_key& key) -> mutation& {
+                    if (st.last && st.last->schema() == s && st.last->key().equal(*s, key)) {
+                        return *st.last;
+                    }
+                    auto pos = st.result.emplace(s, key).first;
+                    st.last = &const_cast<mutation&>(*pos); // Won't change key
+                    return *st.last;
+                });
+                return make_ready_future<>();
+            }
+            return statement->get_mutations(storage, statement_options, timeout, local, timestamp, query_state).then([&st] (auto&& more) {
                 for (auto&& m : more) {
                     // We want unordered_set::try_emplace(), but we don't have it
-                    auto pos = result.find(m);
-                    if (pos == result.end()) {
-                        result.emplace(std::move(m));
+                    auto pos = st.result.find(m);
+                    if (pos == st.result.end()) {
+                        pos = st.result.emplace(std::move(m)).first;
                     } else {
                         const_cast<mutation&>(*pos).apply(std::move(m)); // Won't change key
                     }
+                    st.last = &const_cast<mutation&>(*pos);
                 }
             });
-        }).then([&result] {
+        }).then([&st] {
             // can't use range adaptors, because we want to move
             auto vresult = std::vector<mutation>();
-            vresult.reserve(result.size());
-            for (auto&& m : result) {
-                vresult.push_back(std::move(m));
+            vresult.reserve(st.result.size());
+            for (auto&& m : st.result) {
+                // The set is discarded right after, it doesn't need the
+                // moved-from mutations to keep their keys.
+                vresult.push_back(std::move(const_cast<mutation&>(m)));
             }
             return vresult;
         });
@@ -173,6 +173,31 @@ modification_statement::get_mutations(service::storage_proxy& proxy, const query
     });
 }
 
+void modification_statement::add_updates(const query_options& options, int64_t now,
+        noncopyable_function<mutation& (const partition_key&)> mutation_for) const {
+    assert(!requires_read());
+    auto cl = options.get_consistency();
+    auto json_cache = maybe_prepare_json_cache(options);
+    auto keys = build_partition_keys(options, json_cache);
+    auto ranges = create_clustering_ranges(options, json_cache);
+
+    if (is_counter()) {
+        db::validate_counter_for_write(*s, cl);
+    } else {
+        db::validate_for_write(cl);
+    }
+
+    update_parameters params(s, options, this->get_timestamp(now, options),
+            this->get_time_to_live(options), update_parameters::prefetch_data(s));
+    for (auto&& key : keys) {
+        // We know key.start() must be defined since we only allow EQ relations on the partition key.
+        auto& m = mutation_for(*key.start()->value().key());
+        for (auto&& r : ranges) {
+            this->add_update_for_key(m, r, params, json_cache);
+        }
+    }
+}
+
 bool modification_statement::applies_to(const update_parameters::prefetch_data::row* row,
         const query_options& options) const {
 
@@ -57,6 +57,7 @@
 
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/future-util.hh>
+#include <seastar/util/noncopyable_function.hh>
 
 #include "unimplemented.hh"
 #include "validation.hh"
@@ -291,6 +292,15 @@ class modification_statement : public cql_statement_opt_metadata {
      */
     future<std::vector<mutation>> get_mutations(service::storage_proxy& proxy, const query_options& options, db::timeout_clock::time_point timeout, bool local, int64_t now, service::query_state& qs) const;
 
+    /**
+     * Like get_mutations(), but applies the updates to the mutations returned by
+     * `mutation_for(key)` for each modified partition instead of creating a new
+     * mutation for each of them. Lets batches build the mutation of a partition
+     * modified by many statements in place. Only valid for statements which
+     * don't require a read.
+     */
+    void add_updates(const query_options& options, int64_t now, noncopyable_function<mutation& (const partition_key&)> mutation_for) const;
+
     virtual json_cache_opt maybe_prepare_json_cache(const query_options& options) const;
 protected:
     /**
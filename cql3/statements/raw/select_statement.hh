@@ -48,6 +48,7 @@
 #include "cql3/selection/raw_selector.hh"
 #include "cql3/restrictions/statement_restrictions.hh"
 #include "cql3/result_set.hh"
+#include "query-request.hh"
 #include "cql3/attributes.hh"
 #include "exceptions/unrecognized_entity_exception.hh"
 #include "service/client_state.hh"
@@ -158,6 +159,10 @@ class select_statement : public cf_statement
     /// Returns indices of GROUP BY cells in fetched rows.
     std::vector<size_t> prepare_group_by(const schema& schema, selection::selection& selection) const;
 
+    /// Returns the aggregates of the select clause and the columns they are applied to,
+    /// if it consists of aggregates of plain columns only.
+    std::optional<std::vector<query::forward_request::aggregation_info>> prepare_aggregation_infos(const schema& schema) const;
+
     bool contains_alias(const column_identifier& name) const;
 
     lw_shared_ptr<column_specification> limit_receiver(bool per_partition = false);
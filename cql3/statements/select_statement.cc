@@ -47,12 +47,14 @@
 #include "cql3/selection/selection.hh"
 #include "cql3/util.hh"
 #include "cql3/restrictions/single_column_primary_key_restrictions.hh"
+#include "cql3/restrictions/multi_column_restriction.hh"
 #include "cql3/selection/selector_factories.hh"
 #include <seastar/core/shared_ptr.hh>
 #include "query-result-reader.hh"
 #include "query_result_merger.hh"
 #include "service/pager/query_pagers.hh"
 #include "service/storage_proxy.hh"
+#include "service/forward_service.hh"
 #include <seastar/core/execution_stage.hh>
 #include "view_info.hh"
 #include "partition_slice_builder.hh"
@@ -62,6 +64,7 @@
 #include "database.hh"
 #include "test/lib/select_statement_utils.hh"
 #include <boost/algorithm/cxx11/any_of.hpp>
+#include <boost/algorithm/cxx11/all_of.hpp>
 
 bool is_system_keyspace(std::string_view name);
 
@@ -207,6 +210,34 @@ const sstring& select_statement::column_family() const {
     return _schema->cf_name();
 }
 
+std::vector<query::column_restriction>
+select_statement::get_replica_filter(const query_options& options) const {
+    std::vector<query::column_restriction> filter;
+    if (!_restrictions->need_filtering()) {
+        return filter;
+    }
+    // Replicas only drop rows which restrictions_filter would drop on the
+    // coordinator, which still filters the results. Hence only restrictions
+    // the latter evaluates are pushed down. With multi-column clustering
+    // restrictions, it evaluates only these, and they aren't pushed down.
+    if (dynamic_pointer_cast<restrictions::multi_column_restriction>(_restrictions->get_clustering_columns_restrictions())) {
+        return filter;
+    }
+    auto push = [&] (const restrictions::single_column_restrictions::restrictions_map& by_column) {
+        for (auto& [cdef, restriction] : by_column) {
+            expr::to_column_restrictions(restriction->expression, options, filter);
+        }
+    };
+    if (_restrictions->pk_restrictions_need_filtering()) {
+        push(_restrictions->get_single_column_partition_key_restrictions());
+    }
+    if (_restrictions->ck_restrictions_need_filtering()) {
+        push(_restrictions->get_single_column_clustering_key_restrictions());
+    }
+    push(_restrictions->get_non_pk_restriction());
+    return filter;
+}
+
 query::partition_slice
 select_statement::make_partition_slice(const query_options& options) const
 {
@@ -283,7 +314,7 @@ struct select_statement_executor {
 static thread_local inheriting_concrete_execution_stage<
         future<shared_ptr<cql_transport::messages::result_message>>,
         const select_statement*,
-        service::storage_proxy&,
+        query_processor&,
         service::query_state&,
         const query_options&> select_stage{"cql3_select", select_statement_executor::get()};
 
@@ -292,15 +323,15 @@ select_statement::execute(query_processor& qp,
                              service::query_state& state,
                              const query_options& options) const
 {
-    service::storage_proxy& proxy = qp.proxy();
-    return select_stage(this, seastar::ref(proxy), seastar::ref(state), seastar::cref(options));
+    return select_stage(this, seastar::ref(qp), seastar::ref(state), seastar::cref(options));
 }
 
 future<shared_ptr<cql_transport::messages::result_message>>
-select_statement::do_execute(service::storage_proxy& proxy,
+select_statement::do_execute(query_processor& qp,
                           service::query_state& state,
                           const query_options& options) const
 {
+    service::storage_proxy& proxy = qp.proxy();
     tracing::add_table_name(state.get_trace_state(), keyspace(), column_family());
 
     auto cl = options.get_consistency();
@@ -323,6 +354,9 @@ select_statement::do_execute(service::storage_proxy& proxy,
     _stats.select_partition_range_scan_no_bypass_cache += _range_scan_no_bypass_cache;
 
     auto slice = make_partition_slice(options);
+    if (proxy.features().cluster_supports_replica_filtering()) {
+        slice.filter = get_replica_filter(options);
+    }
     auto command = ::make_lw_shared<query::read_command>(
             _schema->id(),
             _schema->version(),
@@ -371,6 +405,10 @@ select_statement::do_execute(service::storage_proxy& proxy,
         return execute(proxy, command, std::move(key_ranges), state, options, now);
     }
 
+    if (can_forward_aggregation(qp, options, key_ranges)) {
+        return execute_forwarded_aggregation(qp, command, std::move(key_ranges), state, options, now);
+    }
+
     command->slice.options.set<query::partition_slice::option::allow_short_read>();
     auto timeout_duration = get_timeout(state.get_client_state(), options);
     auto timeout = db::timeout_clock::now() + timeout_duration;
@@ -487,6 +525,9 @@ lw_shared_ptr<query::read_command>
 indexed_table_select_statement::prepare_command_for_base_query(service::storage_proxy& proxy, const query_options& options,
         service::query_state& state, gc_clock::time_point now, bool use_paging) const {
     auto slice = make_partition_slice(options);
+    if (proxy.features().cluster_supports_replica_filtering()) {
+        slice.filter = get_replica_filter(options);
+    }
     if (use_paging) {
         slice.options.set<query::partition_slice::option::allow_short_read>();
         slice.options.set<query::partition_slice::option::send_partition_key>();
@@ -722,6 +763,44 @@ select_statement::execute(service::storage_proxy& proxy,
     }
 }
 
+bool select_statement::can_forward_aggregation(query_processor& qp, const query_options& options, const dht::partition_range_vector& key_ranges) const {
+    // The ranges are split among the nodes, so they must not be subject to a limit,
+    // and the partial results must not depend on rows held by other nodes.
+    if (!_aggregation_infos || !_selection->is_reducible() || has_group_by() || _restrictions->need_filtering()
+            || _per_partition_limit || get_limit(options) != query::max_rows || !_parameters->orderings().empty()
+            || _parameters->is_distinct()) {
+        return false;
+    }
+    if (_ks_sel != ks_selector::NONSYSTEM || db::is_serial_consistency(options.get_consistency())) {
+        return false;
+    }
+    if (boost::algorithm::all_of(key_ranges, [] (const dht::partition_range& r) { return r.is_singular(); })) {
+        return false;
+    }
+    return qp.db().get_config().enable_parallelized_aggregation() && qp.proxy().features().cluster_supports_parallelized_aggregation();
+}
+
+future<shared_ptr<cql_transport::messages::result_message>>
+select_statement::execute_forwarded_aggregation(query_processor& qp,
+                          lw_shared_ptr<query::read_command> cmd,
+                          dht::partition_range_vector key_ranges,
+                          service::query_state& state,
+                          const query_options& options,
+                          gc_clock::time_point now) const
+{
+    auto timeout = db::timeout_clock::now() + get_timeout(state.get_client_state(), options);
+    query::forward_request req{*_aggregation_infos, *cmd, std::move(key_ranges), options.get_consistency()};
+    return qp.forwarder().dispatch(std::move(req), timeout, state.get_trace_state()).then(
+            [this, now, sf = options.get_cql_serialization_format()] (query::forward_result result) {
+        cql3::selection::result_set_builder builder(*_selection, now, sf);
+        builder.merge_state(result.query_results);
+        auto rs = builder.build();
+        update_stats_rows_read(rs->size());
+        auto msg = ::make_shared<cql_transport::messages::result_message::rows>(result(std::move(rs)));
+        return shared_ptr<cql_transport::messages::result_message>(std::move(msg));
+    });
+}
+
 future<shared_ptr<cql_transport::messages::result_message>>
 indexed_table_select_statement::process_base_query_results(
         foreign_ptr<lw_shared_ptr<query::result>> results,
@@ -799,9 +878,11 @@ primary_key_select_statement::primary_key_select_statement(schema_ptr schema, ui
                                                            ::shared_ptr<term> limit,
                                                            ::shared_ptr<term> per_partition_limit,
                                                            cql_stats &stats,
-                                                           std::unique_ptr<attributes> attrs)
+                                                           std::unique_ptr<attributes> attrs,
+                                                           std::optional<std::vector<query::forward_request::aggregation_info>> aggregation_infos)
     : select_statement{schema, bound_terms, parameters, selection, restrictions, group_by_cell_indices, is_reversed, ordering_comparator, limit, per_partition_limit, stats, std::move(attrs)}
 {
+    _aggregation_infos = std::move(aggregation_infos);
     if (_ks_sel == ks_selector::NONSYSTEM) {
         if (_restrictions->need_filtering() ||
                 _restrictions->get_partition_key_restrictions()->empty() ||
@@ -971,10 +1052,11 @@ lw_shared_ptr<const service::pager::paging_state> indexed_table_select_statement
 }
 
 future<shared_ptr<cql_transport::messages::result_message>>
-indexed_table_select_statement::do_execute(service::storage_proxy& proxy,
+indexed_table_select_statement::do_execute(query_processor& qp,
                              service::query_state& state,
                              const query_options& options) const
 {
+    service::storage_proxy& proxy = qp.proxy();
     tracing::add_table_name(state.get_trace_state(), _view_schema->ks_name(), _view_schema->cf_name());
     tracing::add_table_name(state.get_trace_state(), keyspace(), column_family());
 
@@ -1462,7 +1544,8 @@ std::unique_ptr<prepared_statement> select_statement::prepare(database& db, cql_
                 prepare_limit(db, bound_names, _limit),
                 prepare_limit(db, bound_names, _per_partition_limit),
                 stats,
-                std::move(prepared_attrs));
+                std::move(prepared_attrs),
+                prepare_aggregation_infos(*schema));
     }
 
     auto partition_key_bind_indices = bound_names.get_partition_key_bind_indexes(*schema);
@@ -1470,6 +1553,31 @@ std::unique_ptr<prepared_statement> select_statement::prepare(database& db, cql_
     return std::make_unique<prepared_statement>(std::move(stmt), bound_names, std::move(partition_key_bind_indices));
 }
 
+std::optional<std::vector<query::forward_request::aggregation_info>>
+select_statement::prepare_aggregation_infos(const schema& schema) const {
+    std::vector<query::forward_request::aggregation_info> infos;
+    infos.reserve(_select_clause.size());
+    for (auto& selectable : selection::raw_selector::to_selectables(_select_clause, schema)) {
+        auto fun = dynamic_pointer_cast<selection::selectable::with_function>(selectable);
+        if (!fun) {
+            return std::nullopt;
+        }
+        query::forward_request::aggregation_info info{fun->function_name().name, {}};
+        for (auto& arg : fun->args()) {
+            auto column = dynamic_pointer_cast<column_identifier>(arg);
+            if (!column) {
+                return std::nullopt;
+            }
+            info.column_names.push_back(column->text());
+        }
+        infos.push_back(std::move(info));
+    }
+    if (infos.empty()) {
+        return std::nullopt;
+    }
+    return infos;
+}
+
 ::shared_ptr<restrictions::statement_restrictions>
 select_statement::prepare_restrictions(database& db,
                                        schema_ptr schema,
@@ -99,8 +99,11 @@ class select_statement : public cql_statement {
     bool _range_scan = false;
     bool _range_scan_no_bypass_cache = false;
     std::unique_ptr<cql3::attributes> _attrs;
+    // Set if the selection consists of aggregates of plain columns only, which
+    // the nodes owning the data can compute in parts, see service::forward_service.
+    std::optional<std::vector<query::forward_request::aggregation_info>> _aggregation_infos;
 protected :
-    virtual future<::shared_ptr<cql_transport::messages::result_message>> do_execute(service::storage_proxy& proxy,
+    virtual future<::shared_ptr<cql_transport::messages::result_message>> do_execute(query_processor& qp,
         service::query_state& state, const query_options& options) const;
     friend class select_statement_executor;
 public:
@@ -152,6 +155,8 @@ protected :
     db::timeout_clock::duration get_timeout(const service::client_state& state, const query_options& options) const;
 
 protected:
+    // The restrictions which replicas can evaluate on their own, for filtering queries.
+    std::vector<query::column_restriction> get_replica_filter(const query_options& options) const;
     uint64_t do_get_limit(const query_options& options, ::shared_ptr<term> limit, uint64_t default_limit) const;
     uint64_t get_limit(const query_options& options) const {
         return do_get_limit(options, _limit, query::max_rows);
@@ -160,6 +165,10 @@ protected :
         return do_get_limit(options, _per_partition_limit, query::partition_max_rows);
     }
     bool needs_post_query_ordering() const;
+    bool can_forward_aggregation(query_processor& qp, const query_options& options, const dht::partition_range_vector& key_ranges) const;
+    future<::shared_ptr<cql_transport::messages::result_message>> execute_forwarded_aggregation(query_processor& qp,
+        lw_shared_ptr<query::read_command> cmd, dht::partition_range_vector key_ranges, service::query_state& state,
+        const query_options& options, gc_clock::time_point now) const;
     virtual void update_stats_rows_read(int64_t rows_read) const {
         _stats.rows_read += rows_read;
     }
@@ -178,7 +187,8 @@ class primary_key_select_statement : public select_statement {
                      ::shared_ptr<term> limit,
                      ::shared_ptr<term> per_partition_limit,
                      cql_stats &stats,
-                     std::unique_ptr<cql3::attributes> attrs);
+                     std::unique_ptr<cql3::attributes> attrs,
+                     std::optional<std::vector<query::forward_request::aggregation_info>> aggregation_infos = std::nullopt);
 };
 
 class indexed_table_select_statement : public select_statement {
@@ -219,7 +229,7 @@ class indexed_table_select_statement : public select_statement {
                                    std::unique_ptr<cql3::attributes> attrs);
 
 private:
-    virtual future<::shared_ptr<cql_transport::messages::result_message>> do_execute(service::storage_proxy& proxy,
+    virtual future<::shared_ptr<cql_transport::messages::result_message>> do_execute(query_processor& qp,
             service::query_state& state, const query_options& options) const override;
 
     lw_shared_ptr<const service::pager::paging_state> generate_view_paging_state_from_base_query_results(lw_shared_ptr<const service::pager::paging_state> paging_state,
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/core/metrics.hh>
+#include "cql3/unprepared_statements_cache.hh"
+#include "cql3/statements/select_statement.hh"
+#include "cql3/statements/modification_statement.hh"
+#include "cql3/statements/batch_statement.hh"
+
+namespace cql3 {
+
+unprepared_statements_cache::unprepared_statements_cache(utils::updateable_value<uint32_t> max_entries)
+    : _max_entries(std::move(max_entries)) {
+    namespace sm = seastar::metrics;
+    _metrics.add_group("query_processor", {
+        sm::make_total_operations("unprepared_statements_cache_hits", _stats.hits,
+                sm::description("Number of unprepared statements executed without being parsed, as they were found in the cache.")),
+        sm::make_total_operations("unprepared_statements_cache_misses", _stats.misses,
+                sm::description("Number of unprepared statements which had to be parsed, as they were not found in the cache.")),
+        sm::make_total_operations("unprepared_statements_cache_evictions", _stats.evictions,
+                sm::description("Number of statements evicted to keep the cache of unprepared statements within its size limit.")),
+        sm::make_total_operations("unprepared_statements_cache_invalidations", _stats.invalidations,
+                sm::description("Number of statements dropped from the cache of unprepared statements because of schema changes.")),
+        sm::make_gauge("unprepared_statements_cache_entries", [this] { return _entries.size(); },
+                sm::description("Number of statements in the cache of unprepared statements.")),
+    });
+}
+
+unprepared_statements_cache::~unprepared_statements_cache() {
+    _lru.clear();
+}
+
+void unprepared_statements_cache::erase(map_type::iterator it) {
+    _lru.erase(_lru.iterator_to(it->second));
+    _entries.erase(it);
+}
+
+void unprepared_statements_cache::evict_to(size_t max_entries) {
+    while (_entries.size() > max_entries) {
+        auto& e = _lru.back();
+        _lru.pop_back();
+        _entries.erase(_entries.find(*e._key));
+        ++_stats.evictions;
+    }
+}
+
+const statements::prepared_statement* unprepared_statements_cache::find(std::string_view keyspace, std::string_view query) {
+    // Apply a lowered size limit right away.
+    evict_to(_max_entries());
+    auto it = _entries.find(cache_key{sstring(keyspace), sstring(query)});
+    if (it == _entries.end()) {
+        ++_stats.misses;
+        return nullptr;
+    }
+    auto& e = it->second;
+    _lru.erase(_lru.iterator_to(e));
+    _lru.push_front(e);
+    ++_stats.hits;
+    return e.prepared.get();
+}
+
+bool unprepared_statements_cache::should_cache(std::string_view query, const statements::prepared_statement& prepared) const {
+    if (_max_entries() == 0 || query.size() > max_query_size) {
+        return false;
+    }
+    auto* stmt = prepared.statement.get();
+    return dynamic_cast<const statements::select_statement*>(stmt)
+            || dynamic_cast<const statements::modification_statement*>(stmt)
+            || dynamic_cast<const statements::batch_statement*>(stmt);
+}
+
+const statements::prepared_statement* unprepared_statements_cache::insert(std::string_view keyspace, std::string_view query,
+        std::unique_ptr<statements::prepared_statement> prepared) {
+    auto [it, inserted] = _entries.try_emplace(cache_key{sstring(keyspace), sstring(query)}, std::move(prepared));
+    if (inserted) {
+        it->second._key = &it->first;
+    } else {
+        it->second.prepared = std::move(prepared);
+        _lru.erase(_lru.iterator_to(it->second));
+    }
+    _lru.push_front(it->second);
+    evict_to(std::max(_max_entries(), 1u));
+    return it->second.prepared.get();
+}
+
+}
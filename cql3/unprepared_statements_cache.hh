@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <boost/intrusive/list.hpp>
+#include <seastar/core/metrics_registration.hh>
+#include "cql3/statements/prepared_statement.hh"
+#include "utils/updateable_value.hh"
+#include "utils/hash.hh"
+
+namespace cql3 {
+
+// A per-shard cache of the statements executed without being prepared by
+// the client, keyed by the query string and the keyspace of the session.
+//
+// Executing an unprepared statement used to parse and prepare it every time.
+// Clients sending the same query strings over and over, as many legacy ones
+// do, now only pay for it once, until the statement is evicted.
+//
+// Only DML statements are cached, and only if their query string is not too
+// long: statements embedding large literals would hold a lot of memory, and
+// are unlikely to be repeated. Like prepared statements, cached statements
+// are dropped when the schema they depend on changes, see
+// query_processor::migration_subscriber.
+class unprepared_statements_cache {
+public:
+    struct stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+    };
+
+    // Longer query strings are not cached.
+    static constexpr size_t max_query_size = 4096;
+private:
+    struct cache_key {
+        sstring keyspace;
+        sstring query;
+
+        bool operator==(const cache_key& o) const {
+            return keyspace == o.keyspace && query == o.query;
+        }
+    };
+    struct cache_key_hash {
+        size_t operator()(const cache_key& k) const {
+            return utils::hash_combine(std::hash<std::string_view>()(k.keyspace), std::hash<std::string_view>()(k.query));
+        }
+    };
+
+    struct entry {
+        std::unique_ptr<statements::prepared_statement> prepared;
+        boost::intrusive::list_member_hook<> _lru_link;
+        // Points to the key of the map node holding this entry.
+        const cache_key* _key = nullptr;
+
+        explicit entry(std::unique_ptr<statements::prepared_statement> p) : prepared(std::move(p)) {}
+    };
+
+    using lru_list = boost::intrusive::list<entry,
+            boost::intrusive::member_hook<entry, boost::intrusive::list_member_hook<>, &entry::_lru_link>,
+            boost::intrusive::constant_time_size<false>>;
+    using map_type = std::unordered_map<cache_key, entry, cache_key_hash>;
+
+    utils::updateable_value<uint32_t> _max_entries;
+    map_type _entries;
+    // MRU entry at the front, LRU at the back.
+    lru_list _lru;
+    stats _stats;
+    seastar::metrics::metric_groups _metrics;
+
+    void erase(map_type::iterator it);
+    void evict_to(size_t max_entries);
+public:
+    explicit unprepared_statements_cache(utils::updateable_value<uint32_t> max_entries);
+    ~unprepared_statements_cache();
+
+    unprepared_statements_cache(const unprepared_statements_cache&) = delete;
+    unprepared_statements_cache& operator=(const unprepared_statements_cache&) = delete;
+
+    // Returns the statement cached for `query` executed in `keyspace`, or
+    // nullptr. The statement may be evicted at the next deferring point,
+    // callers have to hold on to the parts they need.
+    const statements::prepared_statement* find(std::string_view keyspace, std::string_view query);
+
+    // Whether the statement prepared for `query` is eligible for caching.
+    bool should_cache(std::string_view query, const statements::prepared_statement& prepared) const;
+
+    // Caches a statement prepared for `query` executed in `keyspace`, returns
+    // the cached statement, with the same lifetime as the result of find().
+    const statements::prepared_statement* insert(std::string_view keyspace, std::string_view query,
+            std::unique_ptr<statements::prepared_statement> prepared);
+
+    // Drops the statements for which `pred(::shared_ptr<cql_statement>)` is true.
+    template <typename Pred>
+    void remove_if(Pred&& pred) {
+        for (auto it = _entries.begin(); it != _entries.end();) {
+            auto next = std::next(it);
+            if (pred(it->second.prepared->statement)) {
+                erase(it);
+                ++_stats.invalidations;
+            }
+            it = next;
+        }
+    }
+
+    size_t size() const noexcept {
+        return _entries.size();
+    }
+    const stats& get_stats() const noexcept {
+        return _stats;
+    }
+};
+
+}
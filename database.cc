@@ -1116,6 +1116,7 @@ keyspace::make_column_family_config(const schema& s, const database& db) const {
     cfg.enable_cache = _config.enable_cache;
     cfg.enable_dangerous_direct_import_of_cassandra_counters = _config.enable_dangerous_direct_import_of_cassandra_counters;
     cfg.compaction_enforce_min_threshold = _config.compaction_enforce_min_threshold;
+    cfg.read_coalescing_window_in_us = _config.read_coalescing_window_in_us;
     cfg.dirty_memory_manager = _config.dirty_memory_manager;
     cfg.streaming_read_concurrency_semaphore = _config.streaming_read_concurrency_semaphore;
     cfg.compaction_concurrency_semaphore = _config.compaction_concurrency_semaphore;
@@ -1393,16 +1394,22 @@ database::query(schema_ptr s, const query::read_command& cmd, query::result_opti
     auto& semaphore = get_reader_concurrency_semaphore();
     auto class_config = query::query_class_config{.semaphore = semaphore, .max_memory_for_unlimited_query = *cmd.max_result_size};
     query::querier_cache_context cache_ctx(_querier_cache, cmd.query_uuid, cmd.is_first_page);
-    return _data_query_stage(&cf,
-            std::move(s),
-            seastar::cref(cmd),
-            class_config,
-            opts,
-            seastar::cref(ranges),
-            std::move(trace_state),
-            seastar::ref(get_result_memory_limiter()),
-            timeout,
-            std::move(cache_ctx)).then_wrapped([this, s = _stats, &semaphore, hit_rate = cf.get_global_cache_hit_rate(), op = cf.read_in_progress()] (auto f) {
+    auto do_query = [this, &cf, &cmd, &ranges, s = std::move(s), class_config, opts, trace_state, timeout,
+            cache_ctx = std::move(cache_ctx)] () mutable {
+        return _data_query_stage(&cf,
+                std::move(s),
+                seastar::cref(cmd),
+                class_config,
+                opts,
+                seastar::cref(ranges),
+                std::move(trace_state),
+                seastar::ref(get_result_memory_limiter()),
+                timeout,
+                std::move(cache_ctx));
+    };
+    auto key = query::read_coalescer::key::make(cmd, ranges, opts);
+    auto f = key ? cf.get_read_coalescer().coalesce(std::move(*key), timeout, std::move(trace_state), std::move(do_query)) : do_query();
+    return std::move(f).then_wrapped([this, s = _stats, &semaphore, hit_rate = cf.get_global_cache_hit_rate(), op = cf.read_in_progress()] (auto f) {
         if (f.failed()) {
             ++semaphore.get_stats().total_failed_reads;
             return make_exception_future<std::tuple<lw_shared_ptr<query::result>, cache_temperature>>(f.get_exception());
@@ -1860,6 +1867,7 @@ database::make_keyspace_config(const keyspace_metadata& ksm) {
     }
     cfg.enable_dangerous_direct_import_of_cassandra_counters = _cfg.enable_dangerous_direct_import_of_cassandra_counters();
     cfg.compaction_enforce_min_threshold = _cfg.compaction_enforce_min_threshold;
+    cfg.read_coalescing_window_in_us = _cfg.read_coalescing_window_in_us;
     cfg.dirty_memory_manager = &_dirty_memory_manager;
     cfg.streaming_read_concurrency_semaphore = &_streaming_concurrency_sem;
     cfg.compaction_concurrency_semaphore = &_compaction_concurrency_sem;
@@ -67,6 +67,7 @@
 #include "reader_concurrency_semaphore.hh"
 #include "db/timeout_clock.hh"
 #include "querier.hh"
+#include "read_coalescer.hh"
 #include "mutation_query.hh"
 #include "cache_temperature.hh"
 #include <unordered_set>
@@ -360,6 +361,7 @@ class table : public enable_lw_shared_from_this<table> {
         bool enable_commitlog = true;
         bool enable_incremental_backups = false;
         utils::updateable_value<bool> compaction_enforce_min_threshold{false};
+        utils::updateable_value<uint32_t> read_coalescing_window_in_us{0};
         bool enable_dangerous_direct_import_of_cassandra_counters = false;
         ::dirty_memory_manager* dirty_memory_manager = &default_dirty_memory_manager;
         reader_concurrency_semaphore* streaming_read_concurrency_semaphore;
@@ -433,6 +435,7 @@ class table : public enable_lw_shared_from_this<table> {
     // protects against candidates being picked more than once.
     seastar::named_semaphore _off_strategy_sem = {1, named_semaphore_exception_factory{"off-strategy compaction"}};
     mutable row_cache _cache; // Cache covers only sstables.
+    query::read_coalescer _read_coalescer;
     std::optional<int64_t> _sstable_generation = {};
 
     db::replay_position _highest_rp;
@@ -699,6 +702,9 @@ class table : public enable_lw_shared_from_this<table> {
 
     mutation_source as_mutation_source() const;
     mutation_source as_mutation_source_excluding(std::vector<sstables::shared_sstable>& sst) const;
+    // Returns where reversed queries cut partitions into windows, see
+    // make_windowed_reversing_reader().
+    partition_window_boundaries_fn reversed_read_window_boundaries() const;
 
     void set_virtual_reader(mutation_source virtual_reader) {
         _virtual_reader = std::move(virtual_reader);
@@ -719,6 +725,10 @@ class table : public enable_lw_shared_from_this<table> {
         return _cache;
     }
 
+    query::read_coalescer& get_read_coalescer() {
+        return _read_coalescer;
+    }
+
     future<std::vector<locked_cell>> lock_counter_cells(const mutation& m, db::timeout_clock::time_point timeout);
 
     logalloc::occupancy_stats occupancy() const;
@@ -1119,6 +1129,7 @@ class keyspace {
         bool enable_cache = true;
         bool enable_incremental_backups = false;
         utils::updateable_value<bool> compaction_enforce_min_threshold{false};
+        utils::updateable_value<uint32_t> read_coalescing_window_in_us{0};
         bool enable_dangerous_direct_import_of_cassandra_counters = false;
         ::dirty_memory_manager* dirty_memory_manager = &default_dirty_memory_manager;
         reader_concurrency_semaphore* streaming_read_concurrency_semaphore;
@@ -527,6 +527,13 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "\tall: All traffic is compressed.\n"
         "\tdc : Traffic between data centers is compressed.\n"
         "\tnone : No compression.")
+    , internode_compression_algorithm(this, "internode_compression_algorithm", value_status::Used, "lz4",
+        "The algorithm preferred for compressing traffic between nodes, when internode_compression enables it. The valid values are:\n"
+        "\n"
+        "\tlz4 : Fast, with a moderate compression ratio.\n"
+        "\tzstd : Better compression ratio, for links where bandwidth is scarce, at the cost of more CPU. Nodes which don't support zstd use lz4.")
+    , internode_compression_zstd_level(this, "internode_compression_zstd_level", value_status::Used, 3,
+        "The zstd compression level of traffic between nodes. Higher levels compress better, but use more CPU.")
     , inter_dc_tcp_nodelay(this, "inter_dc_tcp_nodelay", value_status::Used, false,
         "Enable or disable tcp_nodelay for inter-data center communication. When disabled larger, but fewer, network packets are sent. This reduces overhead from the TCP protocol itself. However, if cross data-center responses are blocked, it will increase latency.")
     , streaming_socket_timeout_in_ms(this, "streaming_socket_timeout_in_ms", value_status::Unused, 0,
@@ -553,6 +560,8 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "Idle threads are stopped after 30 seconds.\n")
     , native_transport_max_frame_size_in_mb(this, "native_transport_max_frame_size_in_mb", value_status::Unused, 256,
         "The maximum size of allowed frame. Frame (requests) larger than this are rejected as invalid.")
+    , native_transport_compression_zstd_level(this, "native_transport_compression_zstd_level", value_status::Used, 3,
+        "The zstd compression level of responses to clients which negotiated zstd compression. Higher levels compress better, but use more CPU.")
     /* RPC (remote procedure call) settings */
     /* Settings for configuring and tuning client connections. */
     , broadcast_rpc_address(this, "broadcast_rpc_address", value_status::Used, {/* unset */},
@@ -582,12 +591,23 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "This boolean controls whether the replicas for read query will be choosen based on cache hit ratio")
     /* Advanced fault detection settings */
     /* Settings to handle poorly performing or failing nodes. */
-    , dynamic_snitch_badness_threshold(this, "dynamic_snitch_badness_threshold", value_status::Unused, 0,
-        "Sets the performance threshold for dynamically routing requests away from a poorly performing node. A value of 0.2 means Cassandra continues to prefer the static snitch values until the node response time is 20% worse than the best performing node. Until the threshold is reached, incoming client requests are statically routed to the closest replica (as determined by the snitch). Having requests consistently routed to a given replica can help keep a working set of data hot when read repair is less than 1.")
-    , dynamic_snitch_reset_interval_in_ms(this, "dynamic_snitch_reset_interval_in_ms", value_status::Unused, 60000,
+    , dynamic_snitch(this, "dynamic_snitch", liveness::LiveUpdate, value_status::Used, true,
+        "Whether to order the replicas of a read by their recent response latencies, in addition to their proximity as determined by endpoint_snitch.")
+    , dynamic_snitch_badness_threshold(this, "dynamic_snitch_badness_threshold", liveness::LiveUpdate, value_status::Used, 0.1,
+        "Sets the performance threshold for dynamically routing requests away from a poorly performing node. A value of 0.2 means Scylla continues to prefer the static snitch values until the node response time is 20% worse than the best performing node. Until the threshold is reached, incoming client requests are statically routed to the closest replica (as determined by the snitch). Having requests consistently routed to a given replica can help keep a working set of data hot when read repair is less than 1.")
+    , dynamic_snitch_reset_interval_in_ms(this, "dynamic_snitch_reset_interval_in_ms", liveness::LiveUpdate, value_status::Used, 60000,
         "Time interval in milliseconds to reset all node scores, which allows a bad node to recover.")
-    , dynamic_snitch_update_interval_in_ms(this, "dynamic_snitch_update_interval_in_ms", value_status::Unused, 100,
+    , dynamic_snitch_update_interval_in_ms(this, "dynamic_snitch_update_interval_in_ms", liveness::LiveUpdate, value_status::Used, 100,
         "The time interval for how often the snitch calculates node scores. Because score calculation is CPU intensive, be careful when reducing this interval.")
+    , speculative_retry_budget(this, "speculative_retry_budget", liveness::LiveUpdate, value_status::Used, 0,
+        "Maximum number of speculative read requests a coordinator sends, as a fraction of the reads eligible for speculative retry. "
+        "Prevents speculative retry from amplifying the load when many replicas are slow at once. 0 (the default) disables the limit.")
+    , read_coalescing_window_in_us(this, "read_coalescing_window_in_us", liveness::LiveUpdate, value_status::Used, 2000,
+        "Time window in microseconds during which a replica lets identical reads of a single partition share the execution of the first one, instead of executing each of them. "
+        "A read never joins one which started before a write to the same partition was applied. Set to 0 to disable.")
+    , enable_parallelized_aggregation(this, "enable_parallelized_aggregation", liveness::LiveUpdate, value_status::Used, true,
+        "Execute aggregating range scans such as SELECT count(*) in parallel on the nodes and shards owning the data, each of them returning a partial result to the coordinator, "
+        "instead of fetching all the rows to the coordinator.")
     , hinted_handoff_enabled(this, "hinted_handoff_enabled", value_status::Used, db::config::hinted_handoff_enabled_type(db::config::hinted_handoff_enabled_type::enabled_for_all_tag()),
         "Enable or disable hinted handoff. To enable per data center, add data center list. For example: hinted_handoff_enabled: DC1,DC2. A hint indicates that the write needs to be replayed to an unavailable node. "
         "Related information: About hinted handoff writes")
@@ -747,6 +767,12 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , enable_dangerous_direct_import_of_cassandra_counters(this, "enable_dangerous_direct_import_of_cassandra_counters", value_status::Used, false, "Only turn this option on if you want to import tables from Cassandra containing counters, and you are SURE that no counters in that table were created in a version earlier than Cassandra 2.1."
         " It is not enough to have ever since upgraded to newer versions of Cassandra. If you EVER used a version earlier than 2.1 in the cluster where these SSTables come from, DO NOT TURN ON THIS OPTION! You will corrupt your data. You have been warned.")
     , enable_shard_aware_drivers(this, "enable_shard_aware_drivers", value_status::Used, true, "Enable native transport drivers to use connection-per-shard for better performance")
+    , route_cql_requests_to_owning_shard(this, "route_cql_requests_to_owning_shard", liveness::LiveUpdate, value_status::Used, true,
+        "Execute prepared statements bound to a single partition on the shard owning the partition, if this node is one of its replicas, "
+        "rather than on the shard of the connection they were received on. Helps clients whose drivers aren't shard-aware.")
+    , unprepared_statements_cache_size(this, "unprepared_statements_cache_size", liveness::LiveUpdate, value_status::Used, 1000,
+        "Maximum number of statements per shard executed without being prepared (SELECT, INSERT, UPDATE, DELETE and BATCH) whose parsed form is kept in memory, "
+        "so that executing them again doesn't parse them again. Set to 0 to disable the cache.")
     , enable_ipv6_dns_lookup(this, "enable_ipv6_dns_lookup", value_status::Used, false, "Use IPv6 address resolution")
     , abort_on_internal_error(this, "abort_on_internal_error", liveness::LiveUpdate, value_status::Used, false, "Abort the server instead of throwing exception when internal invariants are violated")
     , max_partition_key_restrictions_per_query(this, "max_partition_key_restrictions_per_query", liveness::LiveUpdate, value_status::Used, 100,
@@ -775,6 +801,15 @@ db::config::config(std::shared_ptr<db::extensions> exts)
         "Time period in seconds after which unused schema versions will be evicted from the local schema registry cache. Default is 1 second.")
     , max_concurrent_requests_per_shard(this, "max_concurrent_requests_per_shard",liveness::LiveUpdate, value_status::Used, std::numeric_limits<uint32_t>::max(),
         "Maximum number of concurrent requests a single shard can handle before it starts shedding extra load. By default, no requests will be shed.")
+    , paxos_state_cache_size(this, "paxos_state_cache_size", liveness::LiveUpdate, value_status::Used, 10000,
+        "Maximum number of partitions per shard whose Paxos state (promised and accepted ballots, most recent commit) is kept in memory, "
+        "so that lightweight transactions on them don't have to read system.paxos. Set to 0 to disable the cache.")
+    , paxos_state_cache_size_in_mb(this, "paxos_state_cache_size_in_mb", liveness::LiveUpdate, value_status::Used, 16,
+        "Maximum memory per shard, in megabytes, used by the Paxos states kept in memory. The accepted proposals and most recent commits "
+        "of the cached partitions are whole mutations, so the cache is limited by both this and paxos_state_cache_size.")
+    , cas_max_batch_size(this, "cas_max_batch_size", liveness::LiveUpdate, value_status::Used, 16,
+        "Maximum number of concurrent lightweight transactions on the same partition that a coordinator executes in a single Paxos round. "
+        "Their conditions are still evaluated in arrival order; set to 1 to run a separate round for every request.")
     , cdc_dont_rewrite_streams(this, "cdc_dont_rewrite_streams", value_status::Used, false,
             "Disable rewriting streams from cdc_streams_descriptions to cdc_streams_descriptions_v2. Should not be necessary, but the procedure is expensive and prone to failures; this config option is left as a backdoor in case some user requires manual intervention.")
     , alternator_port(this, "alternator_port", value_status::Used, 0, "Alternator API port")
@@ -785,11 +820,18 @@ db::config::config(std::shared_ptr<db::extensions> exts)
     , alternator_streams_time_window_s(this, "alternator_streams_time_window_s", value_status::Used, 10, "CDC query confidence window for alternator streams")
     , alternator_timeout_in_ms(this, "alternator_timeout_in_ms", value_status::Used, 10000,
         "The server-side timeout for completing Alternator API requests.")
+    , alternator_expression_cache_size(this, "alternator_expression_cache_size", value_status::Used, 1000,
+        "The maximum number of parsed Alternator expressions (condition, update and projection expressions) cached by each shard. 0 disables the cache.")
     , abort_on_ebadf(this, "abort_on_ebadf", value_status::Used, true, "Abort the server on incorrect file descriptor access. Throws exception when disabled.")
     , redis_port(this, "redis_port", value_status::Used, 0, "Port on which the REDIS transport listens for clients.")
     , redis_ssl_port(this, "redis_ssl_port", value_status::Used, 0, "Port on which the REDIS TLS native transport listens for clients.")
     , redis_read_consistency_level(this, "redis_read_consistency_level", value_status::Used, "LOCAL_QUORUM", "Consistency level for read operations for redis.")
     , redis_write_consistency_level(this, "redis_write_consistency_level", value_status::Used, "LOCAL_QUORUM", "Consistency level for write operations for redis.")
+    , redis_read_modify_write_consistency(this, "redis_read_modify_write_consistency", value_status::Used, "strict",
+        "Consistency of the redis commands which modify the current value of a key (INCR, APPEND, EXPIRE, ...):\n"
+        "\tstrict: the commands use lightweight transactions, and are atomic.\n"
+        "\trelaxed: the commands read the value, then write it, at the redis read and write consistency levels. "
+        "They are only atomic with respect to the commands on the same key coordinated by the same node.")
     , redis_database_count(this, "redis_database_count", value_status::Used, 16, "Database count for the redis. You can use the default settings (16).")
     , redis_keyspace_replication_strategy_options(this, "redis_keyspace_replication_strategy", value_status::Used, {}, 
         "Set the replication strategy for the redis keyspace. The setting is used by the first node in the boot phase when the keyspace is not exists to create keyspace for redis.\n"
@@ -218,6 +218,8 @@ class config : public utils::config_file {
     named_value<uint32_t> internode_send_buff_size_in_bytes;
     named_value<uint32_t> internode_recv_buff_size_in_bytes;
     named_value<sstring> internode_compression;
+    named_value<sstring> internode_compression_algorithm;
+    named_value<int32_t> internode_compression_zstd_level;
     named_value<bool> inter_dc_tcp_nodelay;
     named_value<uint32_t> streaming_socket_timeout_in_ms;
     named_value<bool> start_native_transport;
@@ -227,6 +229,7 @@ class config : public utils::config_file {
     named_value<uint16_t> native_shard_aware_transport_port_ssl;
     named_value<uint32_t> native_transport_max_threads;
     named_value<uint32_t> native_transport_max_frame_size_in_mb;
+    named_value<int32_t> native_transport_compression_zstd_level;
     named_value<sstring> broadcast_rpc_address;
     named_value<uint16_t> rpc_port;
     named_value<bool> start_rpc;
@@ -237,9 +240,13 @@ class config : public utils::config_file {
     named_value<uint32_t> rpc_send_buff_size_in_bytes;
     named_value<sstring> rpc_server_type;
     named_value<bool> cache_hit_rate_read_balancing;
+    named_value<bool> dynamic_snitch;
     named_value<double> dynamic_snitch_badness_threshold;
     named_value<uint32_t> dynamic_snitch_reset_interval_in_ms;
     named_value<uint32_t> dynamic_snitch_update_interval_in_ms;
+    named_value<double> speculative_retry_budget;
+    named_value<uint32_t> read_coalescing_window_in_us;
+    named_value<bool> enable_parallelized_aggregation;
     named_value<hinted_handoff_enabled_type> hinted_handoff_enabled;
     named_value<uint32_t> hinted_handoff_throttle_in_kb;
     named_value<uint32_t> max_hint_window_in_ms;
@@ -308,6 +315,8 @@ class config : public utils::config_file {
     named_value<bool> enable_sstables_md_format;
     named_value<bool> enable_dangerous_direct_import_of_cassandra_counters;
     named_value<bool> enable_shard_aware_drivers;
+    named_value<bool> route_cql_requests_to_owning_shard;
+    named_value<uint32_t> unprepared_statements_cache_size;
     named_value<bool> enable_ipv6_dns_lookup;
     named_value<bool> abort_on_internal_error;
     named_value<uint32_t> max_partition_key_restrictions_per_query;
@@ -322,6 +331,9 @@ class config : public utils::config_file {
     named_value<unsigned> user_defined_function_contiguous_allocation_limit_bytes;
     named_value<uint32_t> schema_registry_grace_period;
     named_value<uint32_t> max_concurrent_requests_per_shard;
+    named_value<uint32_t> paxos_state_cache_size;
+    named_value<uint32_t> paxos_state_cache_size_in_mb;
+    named_value<uint32_t> cas_max_batch_size;
     named_value<bool> cdc_dont_rewrite_streams;
 
     named_value<uint16_t> alternator_port;
@@ -331,6 +343,7 @@ class config : public utils::config_file {
     named_value<sstring> alternator_write_isolation;
     named_value<uint32_t> alternator_streams_time_window_s;
     named_value<uint32_t> alternator_timeout_in_ms;
+    named_value<uint32_t> alternator_expression_cache_size;
 
     named_value<bool> abort_on_ebadf;
 
@@ -338,6 +351,7 @@ class config : public utils::config_file {
     named_value<uint16_t> redis_ssl_port;
     named_value<sstring> redis_read_consistency_level;
     named_value<sstring> redis_write_consistency_level;
+    named_value<sstring> redis_read_modify_write_consistency;
     named_value<uint16_t> redis_database_count;
     named_value<string_map> redis_keyspace_replication_strategy_options;
 
@@ -55,6 +55,7 @@
 #include "locator/network_topology_strategy.hh"
 #include "utils/fb_utilities.hh"
 #include "heat_load_balance.hh"
+#include "locator/dynamic_snitch.hh"
 
 namespace db {
 
@@ -162,7 +163,8 @@ filter_for_query(consistency_level cl,
                  const std::vector<gms::inet_address>& preferred_endpoints,
                  read_repair_decision read_repair,
                  gms::inet_address* extra,
-                 column_family* cf) {
+                 column_family* cf,
+                 locator::dynamic_snitch* ds) {
     size_t local_count;
 
     if (read_repair == read_repair_decision::GLOBAL) { // take RRD.GLOBAL out of the way
@@ -211,7 +213,14 @@ filter_for_query(consistency_level cl,
 
     const auto remaining_bf = bf - selected_endpoints.size();
 
-    if (cf) {
+    // Steer away from replicas which respond noticeably slower than the others. With
+    // read repair all the replicas of the DC are contacted anyway, so only order matters
+    // then, and it must keep local replicas first.
+    bool reordered = ds && read_repair == read_repair_decision::NONE && ds->sort_by_score(live_endpoints);
+
+    // Load balancing by cache hit rate assumes replicas are in proximity order, and
+    // would keep sending a share of the reads to a slow replica.
+    if (cf && !reordered) {
         auto get_hit_rate = [cf] (gms::inet_address ep) -> float {
             constexpr float max_hit_rate = 0.999;
             auto ht = cf->get_hit_rate(ep);
@@ -259,8 +268,9 @@ std::vector<gms::inet_address> filter_for_query(consistency_level cl,
         keyspace& ks,
         std::vector<gms::inet_address>& live_endpoints,
         const std::vector<gms::inet_address>& preferred_endpoints,
-        column_family* cf) {
-    return filter_for_query(cl, ks, live_endpoints, preferred_endpoints, read_repair_decision::NONE, nullptr, cf);
+        column_family* cf,
+        locator::dynamic_snitch* ds) {
+    return filter_for_query(cl, ks, live_endpoints, preferred_endpoints, read_repair_decision::NONE, nullptr, cf, ds);
 }
 
 bool
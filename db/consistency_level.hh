@@ -52,6 +52,10 @@
 #include <iosfwd>
 #include <vector>
 
+namespace locator {
+class dynamic_snitch;
+}
+
 namespace db {
 
 extern logging::logger cl_logger;
@@ -82,13 +86,15 @@ filter_for_query(consistency_level cl,
                  const std::vector<gms::inet_address>& preferred_endpoints,
                  read_repair_decision read_repair,
                  gms::inet_address* extra,
-                 column_family* cf);
+                 column_family* cf,
+                 locator::dynamic_snitch* ds);
 
 std::vector<gms::inet_address> filter_for_query(consistency_level cl,
         keyspace& ks,
         std::vector<gms::inet_address>& live_endpoints,
         const std::vector<gms::inet_address>& preferred_endpoints,
-        column_family* cf);
+        column_family* cf,
+        locator::dynamic_snitch* ds);
 
 struct dc_node_count {
     size_t live = 0;
@@ -65,6 +65,10 @@ constexpr std::string_view features::DIGEST_FOR_NULL_VALUES = "DIGEST_FOR_NULL_V
 constexpr std::string_view features::CORRECT_IDX_TOKEN_IN_SECONDARY_INDEX = "CORRECT_IDX_TOKEN_IN_SECONDARY_INDEX";
 constexpr std::string_view features::ALTERNATOR_STREAMS = "ALTERNATOR_STREAMS";
 constexpr std::string_view features::RANGE_SCAN_DATA_VARIANT = "RANGE_SCAN_DATA_VARIANT";
+constexpr std::string_view features::MULTI_PARTITION_READ = "MULTI_PARTITION_READ";
+constexpr std::string_view features::PARALLELIZED_AGGREGATION = "PARALLELIZED_AGGREGATION";
+constexpr std::string_view features::REPLICA_FILTERING = "REPLICA_FILTERING";
+constexpr std::string_view features::ALTERNATOR_STREAMS_RESUME = "ALTERNATOR_STREAMS_RESUME";
 
 static logging::logger logger("features");
 
@@ -89,6 +93,10 @@ feature_service::feature_service(feature_config cfg) : _config(cfg)
         , _correct_idx_token_in_secondary_index_feature(*this, features::CORRECT_IDX_TOKEN_IN_SECONDARY_INDEX)
         , _alternator_streams_feature(*this, features::ALTERNATOR_STREAMS)
         , _range_scan_data_variant(*this, features::RANGE_SCAN_DATA_VARIANT)
+        , _multi_partition_read(*this, features::MULTI_PARTITION_READ)
+        , _parallelized_aggregation(*this, features::PARALLELIZED_AGGREGATION)
+        , _replica_filtering(*this, features::REPLICA_FILTERING)
+        , _alternator_streams_resume(*this, features::ALTERNATOR_STREAMS_RESUME)
 {}
 
 feature_config feature_config_from_db_config(db::config& cfg, std::set<sstring> disabled) {
@@ -185,6 +193,10 @@ std::set<std::string_view> feature_service::known_feature_set() {
         gms::features::CORRECT_IDX_TOKEN_IN_SECONDARY_INDEX,
         gms::features::ALTERNATOR_STREAMS,
         gms::features::RANGE_SCAN_DATA_VARIANT,
+        gms::features::MULTI_PARTITION_READ,
+        gms::features::PARALLELIZED_AGGREGATION,
+        gms::features::REPLICA_FILTERING,
+        gms::features::ALTERNATOR_STREAMS_RESUME,
     };
 
     for (const sstring& s : _config._disabled_features) {
@@ -264,6 +276,10 @@ void feature_service::enable(const std::set<std::string_view>& list) {
         std::ref(_correct_idx_token_in_secondary_index_feature),
         std::ref(_alternator_streams_feature),
         std::ref(_range_scan_data_variant),
+        std::ref(_multi_partition_read),
+        std::ref(_parallelized_aggregation),
+        std::ref(_replica_filtering),
+        std::ref(_alternator_streams_resume),
     })
     {
         if (list.contains(f.name())) {
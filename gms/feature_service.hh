@@ -92,6 +92,10 @@ class feature_service final {
     gms::feature _correct_idx_token_in_secondary_index_feature;
     gms::feature _alternator_streams_feature;
     gms::feature _range_scan_data_variant;
+    gms::feature _multi_partition_read;
+    gms::feature _parallelized_aggregation;
+    gms::feature _replica_filtering;
+    gms::feature _alternator_streams_resume;
 
 public:
     bool cluster_supports_user_defined_functions() const {
@@ -162,6 +166,27 @@ class feature_service final {
     bool cluster_supports_range_scan_data_variant() const {
         return bool(_range_scan_data_variant);
     }
+
+    // READ_DATA and READ_DIGEST accept additional partition ranges to read,
+    // after the first one.
+    bool cluster_supports_multi_partition_read() const {
+        return bool(_multi_partition_read);
+    }
+
+    // Nodes can execute parts of an aggregating range scan, see the FORWARD_REQUEST verb.
+    bool cluster_supports_parallelized_aggregation() const {
+        return bool(_parallelized_aggregation);
+    }
+
+    // Replicas evaluate the filtering restrictions of partition_slice::filter.
+    bool cluster_supports_replica_filtering() const {
+        return bool(_replica_filtering);
+    }
+
+    // Alternator Streams shard iterators may carry a resume point.
+    bool cluster_supports_alternator_streams_resume() const {
+        return bool(_alternator_streams_resume);
+    }
 };
 
 } // namespace gms
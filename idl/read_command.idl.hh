@@ -30,6 +30,25 @@ class specific_ranges {
     std::vector<nonwrapping_range<clustering_key_prefix>> ranges();
 };
 
+enum class restriction_op : uint8_t {
+    in,
+    lt,
+    lte,
+    gt,
+    gte,
+};
+
+struct column_restriction {
+    bytes column_name;
+    query::restriction_op op;
+    std::vector<bytes> values;
+};
+
+struct collection_keys_selection {
+    bytes column_name;
+    std::vector<bytes> keys;
+};
+
 class partition_slice {
     std::vector<nonwrapping_range<clustering_key_prefix>> default_row_ranges();
     utils::small_vector<uint32_t, 8> static_columns;
@@ -39,6 +58,8 @@ class partition_slice {
     cql_serialization_format cql_format();
     uint32_t partition_row_limit_low_bits() [[version 1.3]] = std::numeric_limits<uint32_t>::max();
     uint32_t partition_row_limit_high_bits() [[version 4.3]] = 0;
+    std::vector<query::column_restriction> filter [[version 4.6]];
+    std::vector<query::collection_keys_selection> collection_keys [[version 4.6]];
 };
 
 struct max_result_size {
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <seastar/core/metrics.hh>
+#include "locator/dynamic_snitch.hh"
+
+namespace locator {
+
+// Weight of a new sample in the latency moving average.
+static constexpr double latency_alpha = 0.25;
+// Minimal number of samples for a latency percentile to be estimated.
+static constexpr int64_t min_percentile_samples = 100;
+
+dynamic_snitch::dynamic_snitch(config cfg)
+    : _cfg(std::move(cfg))
+    , _update_timer([this] { update_scores(); schedule_update(); })
+    , _last_reset(seastar::lowres_clock::now()) {
+    namespace sm = seastar::metrics;
+    _metrics.add_group("dynamic_snitch", {
+        sm::make_total_operations("reorders", _stats.reorders,
+                sm::description("Number of times replicas were ordered by latency score instead of by proximity.")),
+        sm::make_total_operations("samples", _stats.samples,
+                sm::description("Number of replica response latencies recorded.")),
+        sm::make_gauge("scored_endpoints", [this] { return _scores.size(); },
+                sm::description("Number of replicas with a latency score.")),
+    });
+    schedule_update();
+}
+
+void dynamic_snitch::schedule_update() {
+    _update_timer.arm(std::chrono::milliseconds(std::max<uint32_t>(_cfg.update_interval_in_ms(), 1)));
+}
+
+void dynamic_snitch::update_scores() {
+    auto now = seastar::lowres_clock::now();
+    if (now - _last_reset >= std::chrono::milliseconds(_cfg.reset_interval_in_ms())) {
+        _last_reset = now;
+        for (auto it = _endpoints.begin(); it != _endpoints.end();) {
+            auto& st = it->second;
+            st.latency_us = -1;
+            // Give new samples more weight, but keep enough history to
+            // estimate the latency distribution right away.
+            st.latency_histogram *= 0.5;
+            if (!st.in_flight && !st.latency_histogram.count()) {
+                it = _endpoints.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // A replica with requests piling up is likely to answer the next one
+    // later than its past latency suggests.
+    std::unordered_map<gms::inet_address, double> scores;
+    double max_score = 0;
+    for (auto& [ep, st] : _endpoints) {
+        if (st.latency_us < 0) {
+            continue;
+        }
+        auto score = std::max(st.latency_us, 1.0) * (1 + st.in_flight);
+        scores.emplace(ep, score);
+        max_score = std::max(max_score, score);
+    }
+    for (auto& [ep, score] : scores) {
+        score /= max_score;
+    }
+    _scores = std::move(scores);
+}
+
+void dynamic_snitch::on_request_sent(gms::inet_address ep) {
+    ++_endpoints[ep].in_flight;
+}
+
+dynamic_snitch::endpoint_state& dynamic_snitch::record(gms::inet_address ep, clock_type::duration latency) {
+    auto& st = _endpoints[ep];
+    if (st.in_flight) {
+        --st.in_flight;
+    }
+    auto sample = std::chrono::duration<double, std::micro>(latency).count();
+    st.latency_us = st.latency_us < 0 ? sample : latency_alpha * sample + (1 - latency_alpha) * st.latency_us;
+    ++_stats.samples;
+    return st;
+}
+
+void dynamic_snitch::on_response(gms::inet_address ep, clock_type::duration latency) {
+    auto& st = record(ep, latency);
+    st.latency_histogram.add(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+}
+
+void dynamic_snitch::on_failure(gms::inet_address ep, clock_type::duration penalty) {
+    record(ep, penalty);
+}
+
+double dynamic_snitch::get_score(gms::inet_address ep) const {
+    auto it = _scores.find(ep);
+    return it == _scores.end() ? 0 : it->second;
+}
+
+std::optional<std::chrono::microseconds> dynamic_snitch::get_latency_percentile(gms::inet_address ep, double percentile) const {
+    auto it = _endpoints.find(ep);
+    if (it == _endpoints.end() || it->second.latency_histogram.count() < min_percentile_samples) {
+        return std::nullopt;
+    }
+    return std::chrono::microseconds(it->second.latency_histogram.percentile(percentile));
+}
+
+bool dynamic_snitch::sort_by_score(std::vector<gms::inet_address>& eps) {
+    if (!_cfg.enabled() || eps.size() < 2 || _scores.empty()) {
+        return false;
+    }
+    // Replicas without a score (e.g. in another DC, or since the last reset)
+    // keep their place in the proximity order, only the replicas with a score
+    // are reordered, among the positions they occupy.
+    std::vector<size_t> positions;
+    std::vector<gms::inet_address> sorted;
+    for (size_t i = 0; i < eps.size(); ++i) {
+        if (_scores.contains(eps[i])) {
+            positions.push_back(i);
+            sorted.push_back(eps[i]);
+        }
+    }
+    if (sorted.size() < 2) {
+        return false;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [this] (gms::inet_address a, gms::inet_address b) {
+        return get_score(a) < get_score(b);
+    });
+    // Stick to the proximity order, which keeps the working set of a replica
+    // hot in its cache, unless it places a replica noticeably worse than
+    // the one the score order would have placed at the same position.
+    auto threshold = 1 + std::max(_cfg.badness_threshold(), 0.0);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (get_score(eps[positions[i]]) > get_score(sorted[i]) * threshold) {
+            for (size_t j = 0; j < sorted.size(); ++j) {
+                eps[positions[j]] = sorted[j];
+            }
+            ++_stats.reorders;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace locator
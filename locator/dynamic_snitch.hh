@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <seastar/core/timer.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/metrics_registration.hh>
+#include "gms/inet_address.hh"
+#include "utils/updateable_value.hh"
+#include "utils/estimated_histogram.hh"
+
+namespace locator {
+
+// Orders replicas by how quickly they have been answering reads.
+//
+// The configured snitch orders replicas by proximity only, so reads keep
+// going to a replica which is close but slow (a bad disk, a compaction
+// storm, a noisy neighbour). The dynamic snitch tracks an exponentially
+// weighted moving average of the response latency and the number of
+// requests in flight to each replica, and periodically turns them into a
+// score. When the proximity order is worse than the score order by more
+// than the badness threshold, the score order is used instead.
+//
+// Latencies are periodically forgotten, so that a replica which was slow
+// gets a chance to prove it recovered.
+//
+// A latency histogram is kept for each replica as well, so that the
+// coordinator can tell when a replica is late by its own standards, see
+// get_latency_percentile().
+//
+// Each shard keeps its own view, fed by the reads it coordinates.
+class dynamic_snitch {
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    struct config {
+        utils::updateable_value<bool> enabled;
+        utils::updateable_value<double> badness_threshold;
+        utils::updateable_value<uint32_t> update_interval_in_ms;
+        utils::updateable_value<uint32_t> reset_interval_in_ms;
+    };
+
+    struct stats {
+        uint64_t reorders = 0;
+        uint64_t samples = 0;
+    };
+private:
+    struct endpoint_state {
+        // Moving average of the response latency, in microseconds.
+        // Negative if no response was received since the last reset.
+        double latency_us = -1;
+        uint32_t in_flight = 0;
+        // Response latencies, in microseconds. Decayed on every reset.
+        utils::estimated_histogram latency_histogram;
+    };
+
+    config _cfg;
+    std::unordered_map<gms::inet_address, endpoint_state> _endpoints;
+    // Scores as of the last update, in (0, 1]. The lower the better.
+    // Replicas without a score keep their proximity order, see sort_by_score().
+    std::unordered_map<gms::inet_address, double> _scores;
+    seastar::timer<seastar::lowres_clock> _update_timer;
+    seastar::lowres_clock::time_point _last_reset;
+    stats _stats;
+    seastar::metrics::metric_groups _metrics;
+
+    void update_scores();
+    void schedule_update();
+    endpoint_state& record(gms::inet_address ep, clock_type::duration latency);
+public:
+    explicit dynamic_snitch(config cfg);
+
+    dynamic_snitch(const dynamic_snitch&) = delete;
+    dynamic_snitch& operator=(const dynamic_snitch&) = delete;
+
+    // Must be paired with a call to on_response() or on_failure() for the same endpoint.
+    void on_request_sent(gms::inet_address ep);
+    void on_response(gms::inet_address ep, clock_type::duration latency);
+    // Accounts a failed request as a response received after `penalty`. Doesn't
+    // affect the latency distribution, which describes successful responses.
+    void on_failure(gms::inet_address ep, clock_type::duration penalty);
+
+    double get_score(gms::inet_address ep) const;
+    // Returns the given percentile (in [0, 1]) of the response latencies of `ep`,
+    // or std::nullopt if there are too few samples for it to be meaningful.
+    std::optional<std::chrono::microseconds> get_latency_percentile(gms::inet_address ep, double percentile) const;
+    const std::unordered_map<gms::inet_address, double>& get_scores() const noexcept {
+        return _scores;
+    }
+
+    // Reorders the replicas of `eps` which have a score, expected to be sorted by
+    // proximity, by score if the proximity order is bad enough. Returns true if
+    // the order was changed.
+    bool sort_by_score(std::vector<gms::inet_address>& eps);
+
+    const stats& get_stats() const noexcept {
+        return _stats;
+    }
+};
+
+} // namespace locator
@@ -33,6 +33,7 @@
 #include "db/legacy_schema_migrator.hh"
 #include "service/storage_service.hh"
 #include "service/migration_manager.hh"
+#include "service/forward_service.hh"
 #include "service/load_meter.hh"
 #include "service/view_update_backlog_broker.hh"
 #include "service/qos/service_level_controller.hh"
@@ -87,6 +88,7 @@
 #include "cdc/generation_service.hh"
 #include "alternator/tags_extension.hh"
 #include "alternator/rmw_operation.hh"
+#include "alternator/expressions.hh"
 #include "db/paxos_grace_seconds_extension.hh"
 #include "service/qos/standard_service_level_distributed_data_accessor.hh"
 
@@ -489,6 +491,7 @@ int main(int ac, char** av) {
     sharded<gms::feature_service> feature_service;
     sharded<db::snapshot_ctl> snapshot_ctl;
     sharded<netw::messaging_service> messaging;
+    sharded<service::forward_service> forward_service;
     sharded<cql3::query_processor> qp;
     sharded<semaphore> sst_dir_semaphore;
     sharded<raft_services> raft_srvs;
@@ -810,6 +813,14 @@ int main(int ac, char** av) {
             } else if (compress_what == "dc") {
                 mscfg.compress = netw::messaging_service::compress_what::dc;
             }
+            sstring compress_algorithm = cfg->internode_compression_algorithm();
+            if (compress_algorithm == "zstd") {
+                mscfg.compress_algorithm = netw::messaging_service::compression_algorithm::zstd;
+            } else if (compress_algorithm != "lz4") {
+                startlog.error("Bad configuration: invalid 'internode_compression_algorithm': {}", compress_algorithm);
+                throw bad_configuration_error();
+            }
+            mscfg.zstd_compression_level = cfg->internode_compression_zstd_level();
 
             if (!cfg->inter_dc_tcp_nodelay()) {
                 mscfg.tcp_nodelay = netw::messaging_service::tcp_nodelay_what::local;
@@ -962,10 +973,15 @@ int main(int ac, char** av) {
             auto stop_migration_manager = defer_verbose_shutdown("migration manager", [&mm] {
                 mm.stop().get();
             });
+            supervisor::notify("starting forward service");
+            forward_service.start(std::ref(messaging), std::ref(proxy), std::ref(db), std::ref(mm)).get();
+            auto stop_forward_service = defer_verbose_shutdown("forward service", [&forward_service] {
+                forward_service.stop().get();
+            });
             supervisor::notify("starting query processor");
             cql3::query_processor::memory_config qp_mcfg = {memory::stats().total_memory() / 256, memory::stats().total_memory() / 2560};
             debug::the_query_processor = &qp;
-            qp.start(std::ref(proxy), std::ref(db), std::ref(mm_notifier), std::ref(mm), qp_mcfg, std::ref(cql_config), std::ref(sl_controller)).get();
+            qp.start(std::ref(proxy), std::ref(forward_service), std::ref(db), std::ref(mm_notifier), std::ref(mm), qp_mcfg, std::ref(cql_config), std::ref(sl_controller)).get();
             // #293 - do not stop anything
             // engine().at_exit([&qp] { return qp.stop(); });
             supervisor::notify("initializing batchlog manager");
@@ -1079,6 +1095,11 @@ int main(int ac, char** av) {
             auto stop_proxy_handlers = defer_verbose_shutdown("storage proxy RPC verbs", [&proxy] {
                 proxy.invoke_on_all(&service::storage_proxy::uninit_messaging_service).get();
             });
+            supervisor::notify("initializing forward service RPC verbs");
+            forward_service.invoke_on_all(&service::forward_service::init_messaging_service).get();
+            auto stop_forward_service_handlers = defer_verbose_shutdown("forward service RPC verbs", [&forward_service] {
+                forward_service.invoke_on_all(&service::forward_service::uninit_messaging_service).get();
+            });
             supervisor::notify("initializing Raft services");
             raft_srvs.start(std::ref(messaging), std::ref(gossiper), std::ref(qp)).get();
             raft_srvs.invoke_on_all(&raft_services::init).get();
@@ -1364,6 +1385,7 @@ int main(int ac, char** av) {
             if (cfg->alternator_port() || cfg->alternator_https_port()) {
                 alternator::rmw_operation::set_default_write_isolation(cfg->alternator_write_isolation());
                 alternator::executor::set_default_timeout(std::chrono::milliseconds(cfg->alternator_timeout_in_ms()));
+                alternator::set_expression_cache_size(cfg->alternator_expression_cache_size());
                 static sharded<alternator::executor> alternator_executor;
                 static sharded<alternator::server> alternator_server;
 
@@ -66,6 +66,7 @@
 #include "idl/messaging_service.dist.hh"
 #include "idl/paxos.dist.hh"
 #include "idl/raft.dist.hh"
+#include "idl/forward_request.dist.hh"
 #include "serializer_impl.hh"
 #include "serialization_visitors.hh"
 #include "idl/consistency_level.dist.impl.hh"
@@ -89,9 +90,11 @@
 #include "idl/messaging_service.dist.impl.hh"
 #include "idl/paxos.dist.impl.hh"
 #include "idl/raft.dist.impl.hh"
+#include "idl/forward_request.dist.impl.hh"
 #include <seastar/rpc/lz4_compressor.hh>
 #include <seastar/rpc/lz4_fragmented_compressor.hh>
 #include <seastar/rpc/multi_algo_compressor_factory.hh>
+#include "message/zstd_rpc_compressor.hh"
 #include "idl/view.dist.impl.hh"
 #include "partition_range_compat.hh"
 #include <boost/range/adaptor/filtered.hpp>
@@ -148,10 +151,6 @@ using namespace std::chrono_literals;
 
 static rpc::lz4_fragmented_compressor::factory lz4_fragmented_compressor_factory;
 static rpc::lz4_compressor::factory lz4_compressor_factory;
-static rpc::multi_algo_compressor_factory compressor_factory {
-    &lz4_fragmented_compressor_factory,
-    &lz4_compressor_factory,
-};
 
 class messaging_service::rpc_protocol_wrapper {
     rpc_protocol _impl;
@@ -344,7 +343,7 @@ void messaging_service::do_start_listen() {
     bool listen_to_bc = _cfg.listen_on_broadcast_address && _cfg.ip != utils::fb_utilities::get_broadcast_address();
     rpc::server_options so;
     if (_cfg.compress != compress_what::none) {
-        so.compressor_factory = &compressor_factory;
+        so.compressor_factory = _compressor_factory.get();
     }
     so.load_balancing_algorithm = server_socket::load_balancing_algorithm::port;
 
@@ -431,9 +430,20 @@ messaging_service::messaging_service(config cfg, scheduling_config scfg, std::sh
     , _clients(2 + scfg.statement_tenants.size() * 2)
     , _scheduling_config(scfg)
     , _scheduling_info_for_connection_index(initial_scheduling_info())
+    , _zstd_compressor_factory(std::make_unique<zstd_rpc_compressor::factory>(_cfg.zstd_compression_level))
 {
     _rpc->set_logger(&rpc_logger);
 
+    // The client offers the algorithms in this order, and the server picks
+    // the first one it knows, so nodes which don't know zstd use LZ4.
+    if (_cfg.compress_algorithm == compression_algorithm::zstd) {
+        _compressor_factory = std::make_unique<rpc::multi_algo_compressor_factory>(std::vector<const rpc::compressor::factory*>{
+                _zstd_compressor_factory.get(), &lz4_fragmented_compressor_factory, &lz4_compressor_factory});
+    } else {
+        _compressor_factory = std::make_unique<rpc::multi_algo_compressor_factory>(std::vector<const rpc::compressor::factory*>{
+                &lz4_fragmented_compressor_factory, &lz4_compressor_factory, _zstd_compressor_factory.get()});
+    }
+
     // this initialization should be done before any handler registration
     // this is because register_handler calls to: scheduling_group_for_verb
     // which in turn relies on _connection_index_for_tenant to be initialized.
@@ -586,6 +596,7 @@ static constexpr unsigned do_get_rpc_client_idx(messaging_verb verb) {
     case messaging_verb::RAFT_VOTE_REQUEST:
     case messaging_verb::RAFT_VOTE_REPLY:
     case messaging_verb::RAFT_TIMEOUT_NOW:
+    case messaging_verb::FORWARD_REQUEST:
         return 2;
     case messaging_verb::MUTATION_DONE:
     case messaging_verb::MUTATION_FAILED:
@@ -781,7 +792,7 @@ shared_ptr<messaging_service::rpc_protocol_client_wrapper> messaging_service::ge
     // send keepalive messages each minute if connection is idle, drop connection after 10 failures
     opts.keepalive = std::optional<net::tcp_keepalive_params>({60s, 60s, 10});
     if (must_compress) {
-        opts.compressor_factory = &compressor_factory;
+        opts.compressor_factory = _compressor_factory.get();
     }
     opts.tcp_nodelay = must_tcp_nodelay;
     opts.reuseaddr = true;
@@ -1221,7 +1232,7 @@ future<> messaging_service::send_mutation_failed(msg_addr id, unsigned shard, re
     return send_message_oneway(this, messaging_verb::MUTATION_FAILED, std::move(id), shard, std::move(response_id), num_failed, std::move(backlog));
 }
 
-void messaging_service::register_read_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda)>&& func) {
+void messaging_service::register_read_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda, rpc::optional<dht::partition_range_vector> additional_ranges)>&& func) {
     register_handler(this, netw::messaging_verb::READ_DATA, std::move(func));
 }
 future<> messaging_service::unregister_read_data() {
@@ -1230,6 +1241,13 @@ future<> messaging_service::unregister_read_data() {
 future<rpc::tuple<query::result, rpc::optional<cache_temperature>>> messaging_service::send_read_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da) {
     return send_message_timeout<future<rpc::tuple<query::result, rpc::optional<cache_temperature>>>>(this, messaging_verb::READ_DATA, std::move(id), timeout, cmd, pr, da);
 }
+future<rpc::tuple<query::result, rpc::optional<cache_temperature>>> messaging_service::send_read_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range_vector& prs, query::digest_algorithm da) {
+    if (prs.size() == 1) {
+        return send_read_data(std::move(id), timeout, cmd, prs.front(), da);
+    }
+    return send_message_timeout<future<rpc::tuple<query::result, rpc::optional<cache_temperature>>>>(this, messaging_verb::READ_DATA, std::move(id), timeout, cmd, prs.front(), da,
+            dht::partition_range_vector(std::next(prs.begin()), prs.end()));
+}
 
 void messaging_service::register_get_schema_version(std::function<future<frozen_schema>(unsigned, table_schema_version)>&& func) {
     register_handler(this, netw::messaging_verb::GET_SCHEMA_VERSION, std::move(func));
@@ -1261,7 +1279,7 @@ future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>>> messag
     return send_message_timeout<future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>>>>(this, messaging_verb::READ_MUTATION_DATA, std::move(id), timeout, cmd, pr);
 }
 
-void messaging_service::register_read_digest(std::function<future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda)>&& func) {
+void messaging_service::register_read_digest(std::function<future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda, rpc::optional<dht::partition_range_vector> additional_ranges)>&& func) {
     register_handler(this, netw::messaging_verb::READ_DIGEST, std::move(func));
 }
 future<> messaging_service::unregister_read_digest() {
@@ -1270,6 +1288,26 @@ future<> messaging_service::unregister_read_digest() {
 future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>>> messaging_service::send_read_digest(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da) {
     return send_message_timeout<future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>>>>(this, netw::messaging_verb::READ_DIGEST, std::move(id), timeout, cmd, pr, da);
 }
+future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>>> messaging_service::send_read_digest(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range_vector& prs, query::digest_algorithm da) {
+    if (prs.size() == 1) {
+        return send_read_digest(std::move(id), timeout, cmd, prs.front(), da);
+    }
+    return send_message_timeout<future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>>>>(this, netw::messaging_verb::READ_DIGEST, std::move(id), timeout, cmd, prs.front(), da,
+            dht::partition_range_vector(std::next(prs.begin()), prs.end()));
+}
+
+// Wrapper for FORWARD_REQUEST
+void messaging_service::register_forward_request(std::function<future<query::forward_result> (const rpc::client_info&, rpc::opt_time_point timeout, query::forward_request req,
+        std::optional<tracing::trace_info> trace_info)>&& func) {
+    register_handler(this, netw::messaging_verb::FORWARD_REQUEST, std::move(func));
+}
+future<> messaging_service::unregister_forward_request() {
+    return unregister_handler(netw::messaging_verb::FORWARD_REQUEST);
+}
+future<query::forward_result> messaging_service::send_forward_request(msg_addr id, clock_type::time_point timeout, const query::forward_request& req,
+        std::optional<tracing::trace_info> trace_info) {
+    return send_message_timeout<future<query::forward_result>>(this, netw::messaging_verb::FORWARD_REQUEST, std::move(id), timeout, req, std::move(trace_info));
+}
 
 // Wrapper for TRUNCATE
 void messaging_service::register_truncate(std::function<future<> (sstring, sstring)>&& func) {
@@ -151,7 +151,8 @@ enum class messaging_verb : int32_t {
     RAFT_VOTE_REQUEST = 49,
     RAFT_VOTE_REPLY = 50,
     RAFT_TIMEOUT_NOW = 51,
-    LAST = 52,
+    FORWARD_REQUEST = 52,
+    LAST = 53,
 };
 
 } // namespace netw
@@ -220,6 +221,11 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
         all,
     };
 
+    enum class compression_algorithm {
+        lz4,
+        zstd,
+    };
+
     enum class tcp_nodelay_what {
         local,
         all,
@@ -231,6 +237,10 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
         uint16_t ssl_port = 0;
         encrypt_what encrypt = encrypt_what::none;
         compress_what compress = compress_what::none;
+        // The algorithm offered first when connecting to other nodes. Both
+        // are accepted from them.
+        compression_algorithm compress_algorithm = compression_algorithm::lz4;
+        int zstd_compression_level = 3;
         tcp_nodelay_what tcp_nodelay = tcp_nodelay_what::all;
         bool listen_on_broadcast_address = false;
         size_t rpc_memory_limit = 1'000'000;
@@ -277,6 +287,8 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     scheduling_config _scheduling_config;
     std::vector<scheduling_info_for_connection_index> _scheduling_info_for_connection_index;
     std::vector<tenant_connection_index> _connection_index_for_tenant;
+    std::unique_ptr<rpc::compressor::factory> _zstd_compressor_factory;
+    std::unique_ptr<rpc::compressor::factory> _compressor_factory;
 
     future<> stop_tls_server();
     future<> stop_nontls_server();
@@ -471,9 +483,11 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
 
     // Wrapper for READ_DATA
     // Note: WTH is future<foreign_ptr<lw_shared_ptr<query::result>>
-    void register_read_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> digest)>&& func);
+    void register_read_data(std::function<future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> digest, rpc::optional<dht::partition_range_vector> additional_ranges)>&& func);
     future<> unregister_read_data();
     future<rpc::tuple<query::result, rpc::optional<cache_temperature>>> send_read_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da);
+    // Reads several singular ranges, requires the MULTI_PARTITION_READ feature if there is more than one.
+    future<rpc::tuple<query::result, rpc::optional<cache_temperature>>> send_read_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range_vector& prs, query::digest_algorithm da);
 
     // Wrapper for GET_SCHEMA_VERSION
     void register_get_schema_version(std::function<future<frozen_schema>(unsigned, table_schema_version)>&& func);
@@ -491,9 +505,18 @@ class messaging_service : public seastar::async_sharded_service<messaging_servic
     future<rpc::tuple<reconcilable_result, rpc::optional<cache_temperature>>> send_read_mutation_data(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr);
 
     // Wrapper for READ_DIGEST
-    void register_read_digest(std::function<future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> digest)>&& func);
+    void register_read_digest(std::function<future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> (const rpc::client_info&, rpc::opt_time_point timeout, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> digest, rpc::optional<dht::partition_range_vector> additional_ranges)>&& func);
     future<> unregister_read_digest();
     future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>>> send_read_digest(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range& pr, query::digest_algorithm da);
+    // Reads several singular ranges, requires the MULTI_PARTITION_READ feature if there is more than one.
+    future<rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>>> send_read_digest(msg_addr id, clock_type::time_point timeout, const query::read_command& cmd, const dht::partition_range_vector& prs, query::digest_algorithm da);
+
+    // Wrapper for FORWARD_REQUEST
+    void register_forward_request(std::function<future<query::forward_result> (const rpc::client_info&, rpc::opt_time_point timeout, query::forward_request req,
+            std::optional<tracing::trace_info> trace_info)>&& func);
+    future<> unregister_forward_request();
+    future<query::forward_result> send_forward_request(msg_addr id, clock_type::time_point timeout, const query::forward_request& req,
+            std::optional<tracing::trace_info> trace_info);
 
     // Wrapper for TRUNCATE
     void register_truncate(std::function<future<>(sstring, sstring)>&& func);
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <zstd.h>
+#include <seastar/core/byteorder.hh>
+#include <seastar/util/variant_utils.hh>
+#include "message/zstd_rpc_compressor.hh"
+
+namespace netw {
+
+using namespace seastar;
+
+static constexpr size_t chunk_size = 128 * 1024;
+
+static const sstring zstd_compressor_name = "ZSTD";
+
+template <typename Buf, typename Func>
+static void for_each_fragment(Buf& data, Func&& func) {
+    std::visit(make_visitor(
+        [&] (temporary_buffer<char>& buf) {
+            func(buf.get(), buf.size());
+        },
+        [&] (std::vector<temporary_buffer<char>>& bufs) {
+            for (auto& buf : bufs) {
+                func(buf.get(), buf.size());
+            }
+        }), data.bufs);
+}
+
+static void check_zstd(size_t ret, const char* what) {
+    if (ZSTD_isError(ret)) {
+        throw std::runtime_error(format("{} failed: {}", what, ZSTD_getErrorName(ret)));
+    }
+}
+
+void zstd_rpc_compressor::cctx_deleter::operator()(ZSTD_CCtx_s* cctx) const noexcept {
+    ZSTD_freeCCtx(cctx);
+}
+
+void zstd_rpc_compressor::dctx_deleter::operator()(ZSTD_DCtx_s* dctx) const noexcept {
+    ZSTD_freeDCtx(dctx);
+}
+
+// The compressed message is the size of the message, as a 4-byte
+// little-endian integer, followed by a flushed zstd block.
+rpc::snd_buf zstd_rpc_compressor::compress(size_t head_space, rpc::snd_buf data) {
+    if (!_cctx) {
+        _cctx.reset(ZSTD_createCCtx());
+        if (!_cctx) {
+            throw std::bad_alloc();
+        }
+        check_zstd(ZSTD_CCtx_setParameter(_cctx.get(), ZSTD_c_compressionLevel, _level), "ZSTD_CCtx_setParameter");
+        check_zstd(ZSTD_CCtx_setParameter(_cctx.get(), ZSTD_c_windowLog, window_log), "ZSTD_CCtx_setParameter");
+    }
+
+    std::vector<temporary_buffer<char>> out;
+    size_t out_size = 0;
+    temporary_buffer<char> chunk(std::max(chunk_size, head_space + 4 + ZSTD_CStreamOutSize()));
+    write_le<uint32_t>(chunk.get_write() + head_space, data.size);
+    ZSTD_outBuffer output{chunk.get_write(), chunk.size(), head_space + 4};
+    auto next_chunk = [&] {
+        out_size += output.pos;
+        chunk.trim(output.pos);
+        out.push_back(std::move(chunk));
+        chunk = temporary_buffer<char>(chunk_size);
+        output = ZSTD_outBuffer{chunk.get_write(), chunk.size(), 0};
+    };
+
+    for_each_fragment(data, [&] (const char* p, size_t size) {
+        ZSTD_inBuffer input{p, size, 0};
+        while (input.pos < input.size) {
+            check_zstd(ZSTD_compressStream2(_cctx.get(), &output, &input, ZSTD_e_continue), "ZSTD_compressStream2");
+            if (output.pos == output.size) {
+                next_chunk();
+            }
+        }
+    });
+    // Flush the block, without ending the frame, so that the next messages
+    // can refer to this one.
+    ZSTD_inBuffer no_input{nullptr, 0, 0};
+    for (;;) {
+        auto remaining = ZSTD_compressStream2(_cctx.get(), &output, &no_input, ZSTD_e_flush);
+        check_zstd(remaining, "ZSTD_compressStream2");
+        if (!remaining) {
+            break;
+        }
+        if (output.pos == output.size) {
+            next_chunk();
+        }
+    }
+    out_size += output.pos;
+    chunk.trim(output.pos);
+    out.push_back(std::move(chunk));
+
+    if (out.size() == 1) {
+        return rpc::snd_buf(std::move(out.front()));
+    }
+    rpc::snd_buf ret;
+    ret.size = out_size;
+    ret.bufs = std::move(out);
+    return ret;
+}
+
+rpc::rcv_buf zstd_rpc_compressor::decompress(rpc::rcv_buf data) {
+    if (data.size < 4) {
+        return rpc::rcv_buf();
+    }
+    if (!_dctx) {
+        _dctx.reset(ZSTD_createDCtx());
+        if (!_dctx) {
+            throw std::bad_alloc();
+        }
+    }
+
+    // The size may span fragments.
+    char size_buf[4];
+    size_t size_pos = 0;
+    for_each_fragment(data, [&] (const char* p, size_t size) {
+        auto n = std::min(size, sizeof(size_buf) - size_pos);
+        std::copy_n(p, n, size_buf + size_pos);
+        size_pos += n;
+    });
+    auto uncompressed_size = read_le<uint32_t>(size_buf);
+
+    std::vector<temporary_buffer<char>> out;
+    for (size_t left = uncompressed_size; left;) {
+        auto n = std::min(left, chunk_size);
+        out.emplace_back(n);
+        left -= n;
+    }
+    size_t out_idx = 0;
+    ZSTD_outBuffer output{out.empty() ? nullptr : out[0].get_write(), out.empty() ? 0 : out[0].size(), 0};
+    size_t skip = 4;
+    size_t produced = 0;
+    for_each_fragment(data, [&] (const char* p, size_t size) {
+        auto n = std::min(size, skip);
+        skip -= n;
+        ZSTD_inBuffer input{p + n, size - n, 0};
+        while (input.pos < input.size) {
+            if (output.pos == output.size && out_idx + 1 < out.size()) {
+                produced += output.pos;
+                ++out_idx;
+                output = ZSTD_outBuffer{out[out_idx].get_write(), out[out_idx].size(), 0};
+            }
+            // Block and frame headers are consumed even when the output is full.
+            auto input_pos = input.pos;
+            auto output_pos = output.pos;
+            check_zstd(ZSTD_decompressStream(_dctx.get(), &output, &input), "ZSTD_decompressStream");
+            if (input.pos == input_pos && output.pos == output_pos) {
+                throw std::runtime_error("zstd RPC message larger than advertised");
+            }
+        }
+    });
+    produced += output.pos;
+    if (produced != uncompressed_size) {
+        throw std::runtime_error(format("zstd RPC message size mismatch: expected {}, got {}", uncompressed_size, produced));
+    }
+
+    if (out.size() == 1) {
+        return rpc::rcv_buf(std::move(out.front()));
+    }
+    rpc::rcv_buf ret;
+    ret.size = uncompressed_size;
+    ret.bufs = std::move(out);
+    return ret;
+}
+
+sstring zstd_rpc_compressor::name() const {
+    return zstd_compressor_name;
+}
+
+const sstring& zstd_rpc_compressor::factory::supported() const {
+    return zstd_compressor_name;
+}
+
+std::unique_ptr<rpc::compressor> zstd_rpc_compressor::factory::negotiate(sstring feature, bool is_server) const {
+    if (feature != zstd_compressor_name) {
+        return nullptr;
+    }
+    return std::make_unique<zstd_rpc_compressor>(_level);
+}
+
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <seastar/rpc/rpc_types.hh>
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+namespace netw {
+
+// An RPC compressor using zstd in streaming mode.
+//
+// Unlike the LZ4 compressors, which compress each message on its own, the
+// compression and decompression contexts live as long as the connection, and
+// each message is compressed as a flushed block of a single, never-ending,
+// zstd frame. Messages can therefore refer to data of the previous messages
+// of the connection, which matters for the many small and similar messages
+// exchanged between nodes. This relies on RPC compressing and decompressing
+// the messages of a connection in the order they are sent.
+//
+// The window is kept small, to bound the memory used by each connection.
+class zstd_rpc_compressor : public seastar::rpc::compressor {
+    struct cctx_deleter {
+        void operator()(ZSTD_CCtx_s* cctx) const noexcept;
+    };
+    struct dctx_deleter {
+        void operator()(ZSTD_DCtx_s* dctx) const noexcept;
+    };
+    int _level;
+    // Created on first use, a connection often only sends or receives.
+    std::unique_ptr<ZSTD_CCtx_s, cctx_deleter> _cctx;
+    std::unique_ptr<ZSTD_DCtx_s, dctx_deleter> _dctx;
+public:
+    static constexpr int window_log = 17;
+
+    class factory;
+
+    explicit zstd_rpc_compressor(int level) noexcept : _level(level) {}
+
+    seastar::rpc::snd_buf compress(size_t head_space, seastar::rpc::snd_buf data) override;
+    seastar::rpc::rcv_buf decompress(seastar::rpc::rcv_buf data) override;
+    seastar::sstring name() const override;
+};
+
+class zstd_rpc_compressor::factory : public seastar::rpc::compressor::factory {
+    int _level;
+public:
+    explicit factory(int level) noexcept : _level(level) {}
+
+    const seastar::sstring& supported() const override;
+    std::unique_ptr<seastar::rpc::compressor> negotiate(seastar::sstring feature, bool is_server) const override;
+};
+
+}
@@ -762,6 +762,7 @@ class data_query_result_builder {
     stop_iteration consume(clustering_row&& cr, row_tombstone t, bool is_alive) { return _builder.consume(std::move(cr), t, is_alive); }
     stop_iteration consume(range_tombstone&& rt) { return _builder.consume(std::move(rt)); }
     stop_iteration consume_end_of_partition()  { return _builder.consume_end_of_partition(); }
+    void mark_as_short_read() { _builder.mark_as_short_read(); }
     result_type consume_end_of_stream() {
         _builder.consume_end_of_stream();
         return _res_builder->build();
@@ -23,6 +23,7 @@
 
 #include "compaction_garbage_collector.hh"
 #include "mutation_fragment.hh"
+#include "row_filter.hh"
 
 static inline bool has_ck_selector(const query::clustering_row_ranges& ranges) {
     // Like PK range, an empty row range, should be considered an "exclude all" restriction
@@ -153,6 +154,27 @@ class compact_mutation_state {
     std::optional<static_row> _last_static_row;
 
     std::unique_ptr<mutation_compactor_garbage_collector> _collector;
+
+    // The filtering restrictions of the slice, applied to live rows when
+    // emitting only those. Rows which don't match aren't emitted nor counted.
+    std::optional<query::row_filter> _filter;
+    bool _partition_matches_filter = true;
+    bool _static_row_matches_filter = true;
+    bool _rows_filtered_out = false;
+    // Live rows dropped by the filter in the current page, and how many of
+    // them the page may scan. Once the budget is used up, the next dropped
+    // row is emitted anyway and ends the page as a short read: the result
+    // then ends at the position the scan reached, and the coordinator, which
+    // applies the same restrictions, drops the row. Without this, a selective
+    // filter could make a page scan a whole range. Pages read without
+    // start_new_page(), or which can't be short, have no budget.
+    uint64_t _filtered_out_rows = 0;
+    uint64_t _max_filtered_out_rows = std::numeric_limits<uint64_t>::max();
+    bool _filtered_out_rows_limit_reached = false;
+    // With a filter, the live static row is held back until it is known
+    // whether it is to be returned, i.e. until the first matching clustering
+    // row or the end of the partition.
+    std::optional<std::pair<static_row, tombstone>> _pending_static_row;
 private:
     static constexpr bool only_live() {
         return OnlyLive == emit_only_live_rows::yes;
@@ -185,6 +207,31 @@ class compact_mutation_state {
         }
     }
 
+    template <typename Consumer>
+    void emit_pending_static_row(Consumer& consumer) {
+        if (_pending_static_row) {
+            auto [sr, t] = std::move(*std::exchange(_pending_static_row, {}));
+            partition_is_not_empty(consumer);
+            consumer.consume(std::move(sr), t, true);
+        }
+    }
+
+    // Mirrors the coordinator-side filtering, which returns a partition
+    // without clustering rows only if it had no live rows at all, and only
+    // if its static row satisfies the restrictions not involving clustering
+    // rows.
+    bool pending_static_row_is_returned() const {
+        return _rows_in_current_partition == 0 && !_rows_filtered_out && _partition_matches_filter
+                && _static_row_matches_filter && !_filter->has_clustering_restrictions();
+    }
+
+    // Returns true if the live row dropped by the filter has to be emitted
+    // anyway to end the page, see _max_filtered_out_rows.
+    bool filtered_out_row_ends_page() {
+        _filtered_out_rows_limit_reached = ++_filtered_out_rows > _max_filtered_out_rows;
+        return _filtered_out_rows_limit_reached;
+    }
+
     bool can_purge_tombstone(const tombstone& t) {
         return t.deletion_time < _gc_before && can_gc(t);
     };
@@ -228,6 +275,12 @@ class compact_mutation_state {
         , _last_dk({dht::token(), partition_key::make_empty()})
     {
         static_assert(!sstable_compaction(), "This constructor cannot be used for sstable compaction.");
+        if (only_live() && !slice.filter.empty()) {
+            _filter.emplace(s, slice.filter);
+            if (_filter->empty()) {
+                _filter.reset();
+            }
+        }
     }
 
     compact_mutation_state(const schema& s, gc_clock::time_point compaction_time,
@@ -260,6 +313,12 @@ class compact_mutation_state {
         _current_partition_limit = std::min(_row_limit, _partition_row_limit);
         _max_purgeable = api::missing_timestamp;
         _last_static_row.reset();
+        if (_filter) {
+            _partition_matches_filter = _filter->matches_partition(pk);
+            _static_row_matches_filter = !_filter->has_static_restrictions();
+            _rows_filtered_out = false;
+            _pending_static_row.reset();
+        }
     }
 
     template <typename Consumer, typename GCConsumer>
@@ -297,6 +356,11 @@ class compact_mutation_state {
             }
         }
         _static_row_live = is_live;
+        if (_filter && is_live) {
+            _static_row_matches_filter = _filter->matches_static_row(sr.cells(), _query_time);
+            _pending_static_row.emplace(std::move(sr), current_tombstone);
+            return stop_iteration::no;
+        }
         if (is_live || (!only_live() && !sr.empty())) {
             partition_is_not_empty(consumer);
             return consumer.consume(std::move(sr), current_tombstone, is_live);
@@ -344,9 +408,19 @@ class compact_mutation_state {
         }
 
         if (only_live() && is_live) {
+            if (_filter) {
+                if (!_partition_matches_filter || !_static_row_matches_filter
+                        || !_filter->matches_row(cr.key(), cr.cells(), _query_time)) {
+                    _rows_filtered_out = true;
+                    if (!filtered_out_row_ends_page()) {
+                        return stop_iteration::no;
+                    }
+                }
+                emit_pending_static_row(consumer);
+            }
             partition_is_not_empty(consumer);
             auto stop = consumer.consume(std::move(cr), t, true);
-            if (++_rows_in_current_partition == _current_partition_limit) {
+            if (++_rows_in_current_partition == _current_partition_limit || _filtered_out_rows_limit_reached) {
                 return stop_iteration::yes;
             }
             return stop;
@@ -387,6 +461,18 @@ class compact_mutation_state {
         if (!_empty_partition_in_gc_consumer) {
             gc_consumer.consume_end_of_partition();
         }
+        if (_pending_static_row) {
+            // A static row dropped by the filter counts against the budget
+            // only if it would have been returned without the filter.
+            if (pending_static_row_is_returned()
+                    || (_rows_in_current_partition == 0 && !_rows_filtered_out && _return_static_content_on_partition_with_no_rows
+                        && filtered_out_row_ends_page())) {
+                emit_pending_static_row(consumer);
+            } else {
+                _pending_static_row.reset();
+                _static_row_live = false;
+            }
+        }
         if (!_empty_partition) {
             // #589 - Do not add extra row for statics unless we did a CK range-less query.
             // See comment in query
@@ -399,7 +485,7 @@ class compact_mutation_state {
             _partition_limit -= _rows_in_current_partition > 0;
             auto stop = consumer.consume_end_of_partition();
             if (!sstable_compaction()) {
-                return _row_limit && _partition_limit && stop != stop_iteration::yes
+                return _row_limit && _partition_limit && stop != stop_iteration::yes && !_filtered_out_rows_limit_reached
                        ? stop_iteration::no : stop_iteration::yes;
             }
         }
@@ -413,6 +499,11 @@ class compact_mutation_state {
             _last_dk = *_dk;
             _dk = &_last_dk;
         }
+        if constexpr (requires { consumer.mark_as_short_read(); }) {
+            if (_filtered_out_rows_limit_reached) {
+                consumer.mark_as_short_read();
+            }
+        }
         if constexpr (std::is_same_v<std::result_of_t<decltype(&GCConsumer::consume_end_of_stream)(GCConsumer&)>, void>) {
             gc_consumer.consume_end_of_stream();
             return consumer.consume_end_of_stream();
@@ -445,6 +536,13 @@ class compact_mutation_state {
         _current_partition_limit = std::min(_row_limit, _partition_row_limit);
         _query_time = query_time;
         _gc_before = saturating_subtract(query_time, _schema.gc_grace_seconds());
+        _rows_filtered_out = false;
+        _pending_static_row.reset();
+        _filtered_out_rows = 0;
+        _filtered_out_rows_limit_reached = false;
+        if (_filter && _slice.options.contains(query::partition_slice::option::allow_short_read)) {
+            _max_filtered_out_rows = row_limit;
+        }
 
         if ((next_fragment_kind == mutation_fragment::kind::clustering_row || next_fragment_kind == mutation_fragment::kind::range_tombstone)
                 && _last_static_row) {
@@ -735,6 +735,45 @@ void write_cell(RowWriter& w, const query::partition_slice& slice, data_type typ
         .end_qr_cell();
 }
 
+// Returns the selection of cells of the collection column def, if the slice
+// has one.
+static const query::collection_keys_selection* find_collection_keys(const query::partition_slice& slice, const column_definition& def) {
+    for (auto& sel : slice.collection_keys) {
+        if (sel.column_name == def.name()) {
+            return &sel;
+        }
+    }
+    return nullptr;
+}
+
+// Writes the live cells of the collection selected by sel, or skips the
+// collection if none of them is live.
+template<typename RowWriter>
+void write_selected_cells(RowWriter& w, const query::partition_slice& slice, data_type type, collection_mutation_view v,
+        const query::collection_keys_selection& sel) {
+    auto& ctype = static_cast<const collection_type_impl&>(*type);
+    auto selected = v.with_deserialized(*type, [&] (collection_mutation_view_description mv) {
+        collection_mutation_view_description selected;
+        for (auto& c : mv.cells) {
+            if (!c.second.is_live()) {
+                continue;
+            }
+            auto key_matches = [&] (const bytes& k) {
+                return ctype.name_comparator()->equal(c.first, bytes_view(k));
+            };
+            if (std::any_of(sel.keys.begin(), sel.keys.end(), key_matches)) {
+                selected.cells.push_back(c);
+            }
+        }
+        return selected.cells.empty() ? std::optional<collection_mutation>() : selected.serialize(*type);
+    });
+    if (!selected) {
+        w.add().skip();
+    } else {
+        write_cell(w, slice, std::move(type), *selected);
+    }
+}
+
 template<typename RowWriter>
 void write_counter_cell(RowWriter& w, const query::partition_slice& slice, ::atomic_cell_view c) {
     assert(c.is_live());
@@ -872,8 +911,11 @@ static void get_compacted_row_slice(const schema& s,
                 }
             } else {
                 auto mut = cell->as_collection_mutation();
+                auto* sel = def.type->is_collection() && !slice.collection_keys.empty() ? find_collection_keys(slice, def) : nullptr;
                 if (!mut.is_any_live(*def.type)) {
                     writer.add().skip();
+                } else if (sel) {
+                    write_selected_cells(writer, slice, def.type, std::move(mut), *sel);
                 } else {
                     write_cell(writer, slice, def.type, std::move(mut));
                 }
@@ -33,6 +33,7 @@
 #include "schema_registry.hh"
 #include "mutation_compactor.hh"
 #include "dht/sharder.hh"
+#include "range_tombstone_list.hh"
 
 logging::logger mrlog("mutation_reader");
 
@@ -2317,6 +2318,255 @@ flat_mutation_reader make_compacting_reader(flat_mutation_reader source, gc_cloc
     return make_flat_mutation_reader<compacting_reader>(std::move(source), compaction_time, get_max_purgeable);
 }
 
+namespace {
+
+// Cuts the clustering ranges of a reversed slice into windows at the given
+// boundaries. The windows are returned in the order they have to be read in,
+// that is, in descending order.
+std::vector<query::clustering_range> make_reversed_windows(const schema& s, const query::clustering_row_ranges& ranges,
+        const std::vector<clustering_key_prefix>& boundaries) {
+    position_in_partition::less_compare less(s);
+    std::vector<query::clustering_range> windows;
+    // The ranges of a reversed slice are already in reverse order.
+    for (auto& r : ranges) {
+        auto start = position_in_partition_view::for_range_start(r);
+        // The boundaries are not necessarily distinct.
+        auto upper = position_in_partition_view::for_range_end(r);
+        auto window_end = r.end();
+        bool cut = false;
+        for (auto it = boundaries.rbegin(); it != boundaries.rend(); ++it) {
+            auto pos = position_in_partition_view::before_key(*it);
+            if (!less(start, pos)) {
+                break;
+            }
+            if (!less(pos, upper)) {
+                continue;
+            }
+            windows.emplace_back(query::clustering_range::bound(*it, true), std::move(window_end));
+            window_end = query::clustering_range::bound(*it, false);
+            upper = pos;
+            cut = true;
+        }
+        if (cut) {
+            windows.emplace_back(r.start(), std::move(window_end));
+        } else {
+            windows.push_back(r);
+        }
+    }
+    return windows;
+}
+
+class windowed_reversing_reader final : public flat_mutation_reader::impl {
+    mutation_source _source;
+    const dht::partition_range& _range;
+    const query::partition_slice& _slice;
+    const io_priority_class& _pc;
+    tracing::trace_state_ptr _trace_state;
+    partition_window_boundaries_fn _window_boundaries;
+    const query::max_result_size _max_size;
+    partition_key _key;
+    // Windows yet to be read, the next one is at the back.
+    std::vector<query::clustering_range> _windows;
+    bool _windows_computed = false;
+    bool _partition_started = false;
+    // The fragments of the current window, waiting to be emitted in reverse.
+    range_tombstone_list _range_tombstones;
+    std::vector<mutation_fragment> _fragments;
+    size_t _window_size = 0;
+    bool _below_soft_limit = true;
+private:
+    future<> compute_windows() {
+        auto dk = dht::decorated_key(_range.start()->value().token(), _key);
+        auto boundaries = co_await _window_boundaries(dk, _permit, _trace_state);
+        _windows = make_reversed_windows(*_schema, _slice.row_ranges(*_schema, _key), boundaries);
+        std::reverse(_windows.begin(), _windows.end());
+        _windows_computed = true;
+    }
+
+    void check_window_size() {
+        if (_window_size > _max_size.hard_limit) {
+            throw std::runtime_error(fmt::format(
+                    "Memory usage of reversed read exceeds hard limit of {} (configured via max_memory_for_unlimited_query_hard_limit), while reading partition {}",
+                    _max_size.hard_limit,
+                    _key.with_schema(*_schema)));
+        }
+        if (_window_size > _max_size.soft_limit && _below_soft_limit) {
+            mrlog.warn(
+                    "Memory usage of reversed read exceeds soft limit of {} (configured via max_memory_for_unlimited_query_soft_limit), while reading partition {}",
+                    _max_size.soft_limit,
+                    _key.with_schema(*_schema));
+            _below_soft_limit = false;
+        }
+    }
+
+    void consume_window_fragment(mutation_fragment&& mf, position_in_partition_view window_start, position_in_partition_view window_end,
+            bool first_window) {
+        switch (mf.mutation_fragment_kind()) {
+        case mutation_fragment::kind::partition_start:
+            if (!_partition_started) {
+                push_mutation_fragment(std::move(mf));
+                _partition_started = true;
+            }
+            break;
+        case mutation_fragment::kind::static_row:
+            if (first_window) {
+                push_mutation_fragment(std::move(mf));
+            }
+            break;
+        case mutation_fragment::kind::range_tombstone: {
+            // Range tombstones are trimmed to the window, so that the pieces
+            // emitted for consecutive windows don't overlap.
+            auto rt = std::move(mf).as_range_tombstone();
+            if (!rt.trim_front(*_schema, window_start)) {
+                break;
+            }
+            position_in_partition::less_compare less(*_schema);
+            if (less(window_end, rt.end_position())) {
+                if (!less(rt.position(), window_end)) {
+                    break;
+                }
+                rt = range_tombstone(rt.position(), window_end, rt.tomb);
+            }
+            _range_tombstones.apply(*_schema, std::move(rt));
+            break;
+        }
+        case mutation_fragment::kind::clustering_row:
+            _window_size += mf.memory_usage();
+            _fragments.push_back(std::move(mf));
+            check_window_size();
+            break;
+        case mutation_fragment::kind::partition_end:
+            break;
+        }
+    }
+
+    future<> read_window(db::timeout_clock::time_point timeout) {
+        auto window = std::move(_windows.back());
+        _windows.pop_back();
+        const bool first_window = !_partition_started;
+
+        auto slice = _slice;
+        slice.options.remove<query::partition_slice::option::reversed>();
+        slice.clear_ranges();
+        slice.set_range(*_schema, _key, {window});
+        auto window_start = position_in_partition::for_range_start(window);
+        auto window_end = position_in_partition::for_range_end(window);
+
+        auto rd = _source.make_reader(_schema, _permit, _range, slice, _pc, _trace_state,
+                streamed_mutation::forwarding::no, mutation_reader::forwarding::no);
+        std::exception_ptr ex;
+        try {
+            while (auto mfopt = co_await rd(timeout)) {
+                consume_window_fragment(std::move(*mfopt), window_start, window_end, first_window);
+            }
+        } catch (...) {
+            ex = std::current_exception();
+        }
+        co_await rd.close();
+        if (ex) {
+            std::rethrow_exception(std::move(ex));
+        }
+    }
+
+    // Emits the fragments of the current window in reverse order. Range
+    // tombstones are emitted when their end is reached.
+    void emit_window() {
+        auto emit_range_tombstone = [&] {
+            auto it = std::prev(_range_tombstones.end());
+            push_mutation_fragment(*_schema, _permit, _range_tombstones.pop_as<range_tombstone>(it));
+        };
+        position_in_partition::less_compare cmp(*_schema);
+        while (!_fragments.empty() && !is_buffer_full()) {
+            auto& mf = _fragments.back();
+            if (!_range_tombstones.empty() && !cmp(_range_tombstones.rbegin()->end_position(), mf.position())) {
+                emit_range_tombstone();
+            } else {
+                _window_size -= mf.memory_usage();
+                push_mutation_fragment(std::move(mf));
+                _fragments.pop_back();
+            }
+        }
+        while (!_range_tombstones.empty() && !is_buffer_full()) {
+            emit_range_tombstone();
+        }
+    }
+
+    void drop_window() {
+        _fragments.clear();
+        _range_tombstones.clear();
+        _window_size = 0;
+    }
+public:
+    windowed_reversing_reader(mutation_source source, schema_ptr schema, reader_permit permit, const dht::partition_range& range,
+            const query::partition_slice& slice, const io_priority_class& pc, tracing::trace_state_ptr trace_state,
+            partition_window_boundaries_fn window_boundaries, query::max_result_size max_size)
+        : impl(std::move(schema), std::move(permit))
+        , _source(std::move(source))
+        , _range(range)
+        , _slice(slice)
+        , _pc(pc)
+        , _trace_state(std::move(trace_state))
+        , _window_boundaries(std::move(window_boundaries))
+        , _max_size(max_size)
+        , _key(*_range.start()->value().key())
+        , _range_tombstones(*_schema) {
+    }
+
+    virtual future<> fill_buffer(db::timeout_clock::time_point timeout) override {
+        if (!_windows_computed) {
+            co_await compute_windows();
+        }
+        while (!is_buffer_full() && !is_end_of_stream()) {
+            if (!_fragments.empty() || !_range_tombstones.empty()) {
+                emit_window();
+            } else if (!_windows.empty()) {
+                co_await read_window(timeout);
+            } else {
+                if (_partition_started) {
+                    push_mutation_fragment(*_schema, _permit, partition_end{});
+                }
+                _end_of_stream = true;
+            }
+        }
+    }
+    virtual future<> next_partition() override {
+        clear_buffer_to_next_partition();
+        if (is_buffer_empty() && _partition_started) {
+            // There is only one partition to read.
+            drop_window();
+            _windows.clear();
+            _windows_computed = true;
+            _end_of_stream = true;
+        }
+        return make_ready_future<>();
+    }
+    virtual future<> fast_forward_to(const dht::partition_range&, db::timeout_clock::time_point) override {
+        return make_exception_future<>(make_backtraced_exception_ptr<std::bad_function_call>());
+    }
+    virtual future<> fast_forward_to(position_range, db::timeout_clock::time_point) override {
+        return make_exception_future<>(make_backtraced_exception_ptr<std::bad_function_call>());
+    }
+    virtual future<> close() noexcept override {
+        // The reader of a window is closed as soon as the window is read.
+        return make_ready_future<>();
+    }
+};
+
+} // anonymous namespace
+
+flat_mutation_reader make_windowed_reversing_reader(mutation_source source,
+        schema_ptr schema,
+        reader_permit permit,
+        const dht::partition_range& range,
+        const query::partition_slice& slice,
+        const io_priority_class& pc,
+        tracing::trace_state_ptr trace_state,
+        partition_window_boundaries_fn window_boundaries,
+        query::max_result_size max_size) {
+    return make_flat_mutation_reader<windowed_reversing_reader>(std::move(source), std::move(schema), std::move(permit), range, slice, pc,
+            std::move(trace_state), std::move(window_boundaries), max_size);
+}
+
 position_reader_queue::~position_reader_queue() {}
 
 // Merges output of readers opened for a single partition query into a non-decreasing stream of mutation fragments.
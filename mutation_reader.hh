@@ -27,6 +27,7 @@
 #include <seastar/core/future.hh>
 #include <seastar/core/future-util.hh>
 #include <seastar/core/do_with.hh>
+#include <seastar/util/noncopyable_function.hh>
 #include "tracing/trace_state.hh"
 #include "flat_mutation_reader.hh"
 #include "reader_concurrency_semaphore.hh"
@@ -613,6 +614,40 @@ std::pair<flat_mutation_reader, queue_reader_handle> make_queue_reader(schema_pt
 flat_mutation_reader make_compacting_reader(flat_mutation_reader source, gc_clock::time_point compaction_time,
         std::function<api::timestamp_type(const dht::decorated_key&)> get_max_purgeable);
 
+/// Returns clustering positions at which the given partition can be cut into
+/// windows of roughly bounded size, in ascending order.
+///
+/// The positions are only hints, any set of positions yields correct results,
+/// including an empty one.
+using partition_window_boundaries_fn = noncopyable_function<future<std::vector<clustering_key_prefix>>(
+        const dht::decorated_key&, reader_permit, tracing::trace_state_ptr)>;
+
+/// Creates a reader which reads a single partition in reverse clustering order.
+///
+/// Unlike make_reversing_reader(), which has to buffer the entire partition
+/// before it can emit its first fragment, the partition is read backwards in
+/// windows delimited by the positions returned by `window_boundaries`. Each
+/// window is read with a forward reader created from `source` and reversed on
+/// its own, so the memory needed is proportional to the size of a window,
+/// rather than to that of the partition. The output is the same as that of
+/// make_reversing_reader(), except that range tombstones spanning several
+/// windows are emitted as one fragment per window.
+///
+/// \param range a singular range of a partition with a known key.
+/// \param slice a reversed slice, its clustering ranges in reverse order.
+/// \param max_size limits the memory used for reversing a single window.
+///
+/// Inter-partition and intra-partition forwarding are not supported.
+flat_mutation_reader make_windowed_reversing_reader(mutation_source source,
+        schema_ptr schema,
+        reader_permit permit,
+        const dht::partition_range& range,
+        const query::partition_slice& slice,
+        const io_priority_class& pc,
+        tracing::trace_state_ptr trace_state,
+        partition_window_boundaries_fn window_boundaries,
+        query::max_result_size max_size);
+
 // A mutation reader together with an upper bound on the set of positions of fragments
 // that the reader will return. The upper bound does not need to be exact.
 struct reader_and_upper_bound {
@@ -241,8 +241,9 @@ static void insert_querier(
     // FIXME: see #3159
     // In reverse mode flat_mutation_reader drops any remaining rows of the
     // current partition when the page ends so it cannot be reused across
-    // pages.
-    if (q.is_reversed()) {
+    // pages. Readers reversing the partition window by window keep their
+    // position, so they can.
+    if (q.is_reversed() && !q.is_reader_reversed()) {
         return;
     }
 
@@ -63,15 +63,23 @@ class clustering_position_tracker {
     stop_iteration consume_end_of_partition() {
         return _consumer.consume_end_of_partition();
     }
+    void mark_as_short_read() requires requires (Consumer& c) { c.mark_as_short_read(); } {
+        _consumer.mark_as_short_read();
+    }
     auto consume_end_of_stream() {
         return _consumer.consume_end_of_stream();
     }
 };
 
+using reader_is_reversed = bool_class<class reader_is_reversed_tag>;
+
 /// Consume a page worth of data from the reader.
 ///
 /// Uses `compaction_state` for compacting the fragments and `consumer` for
 /// building the results.
+/// If the slice is reversed, the fragments of the reader are reversed with
+/// make_reversing_reader(), unless `reversed` says the reader already emits
+/// them in reverse order.
 /// Returns a future containing a tuple with the last consumed clustering key,
 /// or std::nullopt if the last row wasn't a clustering row, and whatever the
 /// consumer's `consume_end_of_stream()` method returns.
@@ -85,7 +93,8 @@ auto consume_page(flat_mutation_reader& reader,
         uint32_t partition_limit,
         gc_clock::time_point query_time,
         db::timeout_clock::time_point timeout,
-        query::max_result_size max_size) {
+        query::max_result_size max_size,
+        reader_is_reversed reversed = reader_is_reversed::no) {
     return reader.peek(timeout).then([=, &reader, consumer = std::move(consumer), &slice] (
                 mutation_fragment* next_fragment) mutable {
         const auto next_fragment_kind = next_fragment ? next_fragment->mutation_fragment_kind() : mutation_fragment::kind::partition_end;
@@ -96,8 +105,8 @@ auto consume_page(flat_mutation_reader& reader,
                 compaction_state,
                 clustering_position_tracker(std::move(consumer), last_ckey));
 
-        auto consume = [&reader, &slice, reader_consumer = std::move(reader_consumer), timeout, max_size] () mutable {
-            if (slice.options.contains(query::partition_slice::option::reversed)) {
+        auto consume = [&reader, &slice, reader_consumer = std::move(reader_consumer), timeout, max_size, reversed] () mutable {
+            if (slice.options.contains(query::partition_slice::option::reversed) && !reversed) {
                 return with_closeable(make_reversing_reader(reader, max_size),
                         [reader_consumer = std::move(reader_consumer), timeout] (flat_mutation_reader& reversing_reader) mutable {
                     return reversing_reader.consume(std::move(reader_consumer), timeout);
@@ -126,9 +135,27 @@ class querier_base {
     reader_permit _permit;
     std::unique_ptr<const dht::partition_range> _range;
     std::unique_ptr<const query::partition_slice> _slice;
+    // Whether _reader emits the fragments of the partition in reverse order
+    // by itself, see make_reader().
+    reader_is_reversed _reader_is_reversed = reader_is_reversed::no;
     std::variant<flat_mutation_reader, reader_concurrency_semaphore::inactive_read_handle> _reader;
     dht::partition_ranges_view _query_ranges;
 
+private:
+    // Reversed single-partition reads are served by a reader reading the
+    // partition backwards window by window, when the windows are known.
+    // Others read forward, and have to be reversed by consume_page().
+    flat_mutation_reader make_reader(const mutation_source& ms, const io_priority_class& pc, tracing::trace_state_ptr trace_ptr,
+            partition_window_boundaries_fn window_boundaries, query::max_result_size max_size) {
+        if (window_boundaries && is_reversed() && _range->is_singular() && _range->start()->value().has_key()) {
+            _reader_is_reversed = reader_is_reversed::yes;
+            return make_windowed_reversing_reader(ms, _schema, _permit, *_range, *_slice, pc, std::move(trace_ptr),
+                    std::move(window_boundaries), max_size);
+        }
+        return ms.make_reader(_schema, _permit, *_range, *_slice, pc, std::move(trace_ptr), streamed_mutation::forwarding::no,
+                mutation_reader::forwarding::no);
+    }
+
 public:
     querier_base(reader_permit permit, std::unique_ptr<const dht::partition_range> range,
             std::unique_ptr<const query::partition_slice> slice, flat_mutation_reader reader, dht::partition_ranges_view query_ranges)
@@ -150,6 +177,17 @@ class querier_base {
         , _query_ranges(*_range)
     { }
 
+    querier_base(schema_ptr schema, reader_permit permit, dht::partition_range range,
+            query::partition_slice slice, const mutation_source& ms, const io_priority_class& pc, tracing::trace_state_ptr trace_ptr,
+            partition_window_boundaries_fn window_boundaries, query::max_result_size max_size)
+        : _schema(std::move(schema))
+        , _permit(std::move(permit))
+        , _range(std::make_unique<const dht::partition_range>(std::move(range)))
+        , _slice(std::make_unique<const query::partition_slice>(std::move(slice)))
+        , _reader(make_reader(ms, pc, std::move(trace_ptr), std::move(window_boundaries), max_size))
+        , _query_ranges(*_range)
+    { }
+
     querier_base(querier_base&&) = default;
     querier_base& operator=(querier_base&&) = default;
 
@@ -167,6 +205,10 @@ class querier_base {
         return _slice->options.contains(query::partition_slice::option::reversed);
     }
 
+    reader_is_reversed is_reader_reversed() const {
+        return _reader_is_reversed;
+    }
+
     virtual position_view current_position() const = 0;
 
     dht::partition_ranges_view ranges() const {
@@ -218,6 +260,22 @@ class querier : public querier_base {
         , _compaction_state(make_lw_shared<compact_for_query_state<OnlyLive>>(*schema, gc_clock::time_point{}, *_slice, 0, 0)) {
     }
 
+    /// Reversed reads of single partitions are served by reading the
+    /// partition backwards in the windows delimited by `window_boundaries`,
+    /// see make_windowed_reversing_reader().
+    querier(const mutation_source& ms,
+            schema_ptr schema,
+            reader_permit permit,
+            dht::partition_range range,
+            query::partition_slice slice,
+            const io_priority_class& pc,
+            tracing::trace_state_ptr trace_ptr,
+            partition_window_boundaries_fn window_boundaries,
+            query::max_result_size max_size)
+        : querier_base(schema, permit, std::move(range), std::move(slice), ms, pc, std::move(trace_ptr), std::move(window_boundaries), max_size)
+        , _compaction_state(make_lw_shared<compact_for_query_state<OnlyLive>>(*schema, gc_clock::time_point{}, *_slice, 0, 0)) {
+    }
+
     bool are_limits_reached() const {
         return  _compaction_state->are_limits_reached();
     }
@@ -231,7 +289,7 @@ class querier : public querier_base {
             db::timeout_clock::time_point timeout,
             query::max_result_size max_size) {
         return ::query::consume_page(std::get<flat_mutation_reader>(_reader), _compaction_state, *_slice, std::move(consumer), row_limit,
-                partition_limit, query_time, timeout, max_size).then([this] (auto&& results) {
+                partition_limit, query_time, timeout, max_size, _reader_is_reversed).then([this] (auto&& results) {
             _last_ckey = std::get<std::optional<clustering_key>>(std::move(results));
             constexpr auto size = std::tuple_size<std::decay_t<decltype(results)>>::value;
             static_assert(size <= 2);
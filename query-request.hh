@@ -31,6 +31,7 @@
 #include "tracing/tracing.hh"
 #include "utils/small_vector.hh"
 #include "query_class_config.hh"
+#include "db/consistency_level_type.hh"
 
 class position_in_partition_view;
 
@@ -121,6 +122,36 @@ constexpr auto max_rows = std::numeric_limits<uint64_t>::max();
 constexpr auto partition_max_rows = std::numeric_limits<uint64_t>::max();
 constexpr auto max_rows_if_set = std::numeric_limits<uint32_t>::max();
 
+enum class restriction_op : uint8_t {
+    in,
+    lt,
+    lte,
+    gt,
+    gte,
+};
+
+// A restriction of a single primary key or atomic column, which the rows of a
+// filtering (ALLOW FILTERING) query have to satisfy. Evaluated by replicas,
+// see query::row_filter, so that they don't send rows which the coordinator
+// would filter out anyway.
+// An equality is an `in` restriction with a single value. A restriction
+// without values (e.g. a comparison with null) matches no row.
+struct column_restriction {
+    bytes column_name;
+    restriction_op op;
+    std::vector<bytes> values;
+};
+
+// Selects the cells of a non-frozen collection column to return, by their
+// keys (the keys of a map, the elements of a set), serialized with the key
+// type of the collection. Replicas leave the other cells of the column out of
+// query results, so that the coordinator doesn't receive whole collections
+// only to use a few of their cells. An empty set of keys selects no cells.
+struct collection_keys_selection {
+    bytes column_name;
+    std::vector<bytes> keys;
+};
+
 // Specifies subset of rows, columns and cell attributes to be returned in a query.
 // Can be accessed across cores.
 // Schema-dependent.
@@ -172,12 +203,23 @@ class partition_slice {
     uint32_t _partition_row_limit_low_bits;
     uint32_t _partition_row_limit_high_bits;
 public:
+    // Restrictions of a filtering query, all of which a row must satisfy to be
+    // returned. Replicas may ignore them, the coordinator filters the rows anyway.
+    std::vector<column_restriction> filter;
+    // Cells of collection columns to return, at most one selection per column.
+    // Replicas may ignore them, the coordinator has to pick the cells it needs
+    // from the returned collections anyway. Digests are computed from whole
+    // cells, so they don't depend on the selections.
+    std::vector<collection_keys_selection> collection_keys;
+
     partition_slice(clustering_row_ranges row_ranges, column_id_vector static_columns,
         column_id_vector regular_columns, option_set options,
         std::unique_ptr<specific_ranges> specific_ranges,
         cql_serialization_format,
         uint32_t partition_row_limit_low_bits,
-        uint32_t partition_row_limit_high_bits);
+        uint32_t partition_row_limit_high_bits,
+        std::vector<column_restriction> filter = {},
+        std::vector<collection_keys_selection> collection_keys = {});
     partition_slice(clustering_row_ranges row_ranges, column_id_vector static_columns,
         column_id_vector regular_columns, option_set options,
         std::unique_ptr<specific_ranges> specific_ranges = nullptr,
@@ -328,4 +370,27 @@ class read_command {
     friend std::ostream& operator<<(std::ostream& out, const read_command& r);
 };
 
+// An aggregating range scan, executed in parts by the nodes owning the data,
+// see service::forward_service.
+struct forward_request {
+    // An aggregate function of columns, e.g. sum(v), or count(*) if there are no columns.
+    struct aggregation_info {
+        // Name of the native aggregate function.
+        sstring function_name;
+        std::vector<sstring> column_names;
+    };
+
+    std::vector<aggregation_info> aggregation_infos;
+    query::read_command cmd;
+    dht::partition_range_vector pr;
+    db::consistency_level cl;
+
+    friend std::ostream& operator<<(std::ostream& out, const forward_request& r);
+};
+
+// Intermediate states of the aggregates of a forward_request, in the same order.
+struct forward_result {
+    std::vector<bytes_opt> query_results;
+};
+
 }
@@ -151,6 +151,7 @@ concept ResultVisitor = requires(Visitor visitor, const partition_key& pkey,
 class result_view {
     ser::query_result_view _v;
     friend class result_merger;
+    friend std::vector<foreign_ptr<lw_shared_ptr<query::result>>> split_result(const schema&, const query::result&, const dht::partition_range_vector&);
 public:
     result_view(const bytes_ostream& v) : _v(ser::query_result_view{ser::as_input_stream(v)}) {}
     result_view(ser::query_result_view v) : _v(v) {}
@@ -173,9 +174,12 @@ class result_view {
         for (auto&& p : _v.partitions()) {
             auto rows = p.rows();
             auto row_count = rows.size();
+            // The partition key must outlive the whole partition: visitors
+            // may keep a reference to it until accept_partition_end().
+            std::optional<partition_key> key;
             if (slice.options.contains<partition_slice::option::send_partition_key>()) {
-                auto key = *p.key();
-                visitor.accept_new_partition(key, row_count);
+                key = *p.key();
+                visitor.accept_new_partition(*key, row_count);
             } else {
                 visitor.accept_new_partition(row_count);
             }
@@ -238,5 +238,9 @@ class query_result_builder {
     stop_iteration consume(clustering_row&& cr, row_tombstone t, bool);
     stop_iteration consume(range_tombstone&& rt);
     stop_iteration consume_end_of_partition();
+    // Ends the result before the limits are reached, see compact_mutation_state.
+    void mark_as_short_read() {
+        _rb.mark_as_short_read();
+    }
     void consume_end_of_stream();
 };
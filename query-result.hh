@@ -429,6 +429,11 @@ class result {
         return _last_modified;
     }
 
+    void set_digest(result_digest digest, api::timestamp_type last_modified) {
+        _digest = std::move(digest);
+        _last_modified = last_modified;
+    }
+
     short_read is_short_read() const {
         return _short_read;
     }
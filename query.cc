@@ -55,6 +55,12 @@ std::ostream& operator<<(std::ostream& out, const partition_slice& ps) {
     out << ", options=" << format("{:x}", ps.options.mask()); // FIXME: pretty print options
     out << ", cql_format=" << ps.cql_format();
     out << ", partition_row_limit=" << ps._partition_row_limit_low_bits;
+    if (!ps.filter.empty()) {
+        out << ", filter=" << ps.filter.size() << " restrictions";
+    }
+    if (!ps.collection_keys.empty()) {
+        out << ", collection_keys=" << ps.collection_keys.size() << " columns";
+    }
     return out << "}";
 }
 
@@ -68,6 +74,14 @@ std::ostream& operator<<(std::ostream& out, const read_command& r) {
         << ", partition_limit=" << r.partition_limit << "}";
 }
 
+std::ostream& operator<<(std::ostream& out, const forward_request& r) {
+    out << "forward_request{aggregations=[";
+    for (auto& info : r.aggregation_infos) {
+        out << info.function_name << "(" << join(", ", info.column_names) << ")" << (&info != &r.aggregation_infos.back() ? ", " : "");
+    }
+    return out << "], cmd=" << r.cmd << ", pr={" << join(", ", r.pr) << "}, cl=" << r.cl << "}";
+}
+
 std::ostream& operator<<(std::ostream& out, const specific_ranges& s) {
     return out << "{" << s._pk << " : " << join(", ", s._ranges) << "}";
 }
@@ -117,7 +131,9 @@ partition_slice::partition_slice(clustering_row_ranges row_ranges,
     std::unique_ptr<specific_ranges> specific_ranges,
     cql_serialization_format cql_format,
     uint32_t partition_row_limit_low_bits,
-    uint32_t partition_row_limit_high_bits)
+    uint32_t partition_row_limit_high_bits,
+    std::vector<column_restriction> filter,
+    std::vector<collection_keys_selection> collection_keys)
     : _row_ranges(std::move(row_ranges))
     , static_columns(std::move(static_columns))
     , regular_columns(std::move(regular_columns))
@@ -126,6 +142,8 @@ partition_slice::partition_slice(clustering_row_ranges row_ranges,
     , _cql_format(std::move(cql_format))
     , _partition_row_limit_low_bits(partition_row_limit_low_bits)
     , _partition_row_limit_high_bits(partition_row_limit_high_bits)
+    , filter(std::move(filter))
+    , collection_keys(std::move(collection_keys))
 {}
 
 partition_slice::partition_slice(clustering_row_ranges row_ranges,
@@ -168,6 +186,8 @@ partition_slice::partition_slice(const partition_slice& s)
     , _specific_ranges(s._specific_ranges ? std::make_unique<specific_ranges>(*s._specific_ranges) : nullptr)
     , _cql_format(s._cql_format)
     , _partition_row_limit_low_bits(s._partition_row_limit_low_bits)
+    , filter(s.filter)
+    , collection_keys(s.collection_keys)
 {}
 
 partition_slice::~partition_slice()
@@ -271,6 +291,50 @@ static void write_partial_partition(ser::writer_of_qr_partition<bytes_ostream>&&
     std::move(rows_wr).end_rows().end_qr_partition();
 }
 
+std::vector<foreign_ptr<lw_shared_ptr<query::result>>> split_result(const schema& s, const query::result& r, const dht::partition_range_vector& ranges) {
+    std::vector<foreign_ptr<lw_shared_ptr<query::result>>> results;
+    results.reserve(ranges.size());
+    auto eq = partition_key::equality(s);
+    auto make_result = [] (std::optional<ser::qr_partition_view> pv, short_read sr) {
+        bytes_ostream w;
+        if (!pv) {
+            ser::writer_of_query_result<bytes_ostream>(w).skip_partitions().end_query_result();
+            return make_foreign(make_lw_shared<query::result>(std::move(w), sr, 0, 0));
+        }
+        auto partitions = ser::writer_of_query_result<bytes_ostream>(w).start_partitions();
+        partitions.add(*pv);
+        std::move(partitions).end_partitions().end_query_result();
+        // If rows.empty(), then there's a static row, or there wouldn't be a partition
+        const uint64_t rows = pv->rows().size() ? : 1;
+        return make_foreign(make_lw_shared<query::result>(std::move(w), sr, rows, 1));
+    };
+
+    result_view::do_with(r, [&] (result_view rv) {
+        auto partitions = rv._v.partitions();
+        size_t remaining = partitions.size();
+        for (auto&& pv : partitions) {
+            auto key = pv.key();
+            if (!key) {
+                throw std::runtime_error("cannot split a query result without partition keys");
+            }
+            while (results.size() < ranges.size() && !eq(*ranges[results.size()].start()->value().key(), *key)) {
+                results.push_back(make_result(std::nullopt, short_read::no));
+            }
+            if (results.size() == ranges.size()) {
+                throw std::runtime_error(format("partition {} of the query result is not in the queried ranges", *key));
+            }
+            results.push_back(make_result(pv, short_read(--remaining == 0 && r.is_short_read())));
+        }
+    });
+    if (r.is_short_read() && results.empty()) {
+        results.push_back(make_result(std::nullopt, short_read::yes));
+    }
+    while (results.size() < ranges.size()) {
+        results.push_back(make_result(std::nullopt, short_read::no));
+    }
+    return results;
+}
+
 foreign_ptr<lw_shared_ptr<query::result>> result_merger::get() {
     if (_partial.size() == 1) {
         return std::move(_partial[0]);
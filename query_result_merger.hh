@@ -55,4 +55,12 @@ class result_merger {
     foreign_ptr<lw_shared_ptr<query::result>> get();
 };
 
+// Splits the result of a read of several singular partition ranges into one
+// result per range. The result must include the partition keys, and its
+// partitions must be in the order of the ranges.
+//
+// If the result is short, the result of the range of its last partition is
+// short too, and the ranges following it have empty results.
+std::vector<foreign_ptr<lw_shared_ptr<query::result>>> split_result(const schema& s, const query::result& r, const dht::partition_range_vector& ranges);
+
 }
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "read_coalescer.hh"
+#include "utils/hash.hh"
+#include "utils/exceptions.hh"
+#include "serializer.hh"
+#include "idl/uuid.dist.hh"
+#include "idl/keys.dist.hh"
+#include "idl/range.dist.hh"
+#include "idl/tracing.dist.hh"
+#include "idl/read_command.dist.hh"
+#include "serializer_impl.hh"
+#include "idl/uuid.dist.impl.hh"
+#include "idl/keys.dist.impl.hh"
+#include "idl/range.dist.impl.hh"
+#include "idl/tracing.dist.impl.hh"
+#include "idl/read_command.dist.impl.hh"
+
+namespace query {
+
+read_coalescer::key::key(const read_command& cmd, const partition_key& pk, result_options opts)
+    : _schema_version(cmd.schema_version)
+    , _key(pk)
+    // The slice is compared in its serialized form, which is simpler than
+    // comparing its clustering ranges, as it doesn't need the schema.
+    , _slice(ser::serialize_to_buffer<bytes>(cmd.slice))
+    , _query_time(cmd.timestamp)
+    , _row_limit(cmd.get_row_limit())
+    , _partition_limit(cmd.partition_limit)
+    , _opts(opts)
+    , _max_result_size(*cmd.max_result_size) {
+    _hash = utils::hash_combine(std::hash<utils::UUID>()(_schema_version), std::hash<managed_bytes_view>()(_key.representation()));
+    _hash = utils::hash_combine(_hash, std::hash<bytes_view>()(_slice));
+}
+
+std::optional<read_coalescer::key> read_coalescer::key::make(const read_command& cmd, const dht::partition_range_vector& ranges, result_options opts) {
+    // Paged reads may resume a querier saved by the previous page, which
+    // can't be shared.
+    if (cmd.query_uuid != utils::UUID() || !cmd.max_result_size) {
+        return std::nullopt;
+    }
+    if (ranges.size() != 1 || !ranges.front().is_singular() || !ranges.front().start()->value().has_key()) {
+        return std::nullopt;
+    }
+    return key(cmd, *ranges.front().start()->value().key(), opts);
+}
+
+bool read_coalescer::key::operator==(const key& o) const {
+    return _hash == o._hash
+        && _schema_version == o._schema_version
+        && _query_time == o._query_time
+        && _row_limit == o._row_limit
+        && _partition_limit == o._partition_limit
+        && _opts.request == o._opts.request
+        && _opts.digest_algo == o._opts.digest_algo
+        && _max_result_size.soft_limit == o._max_result_size.soft_limit
+        && _max_result_size.hard_limit == o._max_result_size.hard_limit
+        && _key.representation() == o._key.representation()
+        && _slice == o._slice;
+}
+
+read_coalescer::read_coalescer(utils::updateable_value<uint32_t> window_in_us)
+    : _window_in_us(std::move(window_in_us)) {
+}
+
+size_t read_coalescer::bucket_of(partition_key_view pk) noexcept {
+    return std::hash<managed_bytes_view>()(pk.representation()) % write_epoch_buckets;
+}
+
+future<read_coalescer::result_type>
+read_coalescer::coalesce(key k, db::timeout_clock::time_point timeout, tracing::trace_state_ptr trace_state,
+        noncopyable_function<future<result_type>()> read) {
+    auto window = std::chrono::microseconds(_window_in_us());
+    if (window.count() == 0) {
+        return read();
+    }
+    auto now = clock_type::now();
+    auto write_epoch = _write_epochs[bucket_of(k.partition())];
+    auto it = _inflight.find(k);
+    if (it != _inflight.end()) {
+        auto& r = *it->second;
+        if (now - r.started <= window && r.write_epoch == write_epoch && r.generation == _generation) {
+            ++_stats.coalesced_reads;
+            tracing::trace(trace_state, "Joining an identical read in progress");
+            return r.result.get_future(timeout).handle_exception([timeout, trace_state = std::move(trace_state), read = std::move(read)] (std::exception_ptr ep) mutable {
+                // The shared read may have timed out before this one.
+                if (!is_timeout_exception(ep) || db::timeout_clock::now() >= timeout) {
+                    return make_exception_future<result_type>(std::move(ep));
+                }
+                tracing::trace(trace_state, "Joined read timed out, executing the read");
+                return futurize_invoke(std::move(read));
+            });
+        }
+        // Later reads will join the one about to be started instead. The
+        // replaced read still completes for those already waiting on it.
+        _inflight.erase(it);
+    }
+
+    auto r = make_lw_shared<inflight_read>(inflight_read{
+        .result = shared_future<result_type>(futurize_invoke(std::move(read)).then([] (result_type res) {
+            // The result may now be read by multiple shards at once, make
+            // sure none of them needs to lazily compute the counts.
+            res->ensure_counts();
+            return res;
+        })),
+        .started = now,
+        .write_epoch = write_epoch,
+        .generation = _generation,
+    });
+    auto f = r->result.get_future();
+    _inflight.emplace(k, r);
+    return f.finally([this, k = std::move(k), r = std::move(r)] {
+        // The entry may have been replaced by a newer read already.
+        auto it = _inflight.find(k);
+        if (it != _inflight.end() && it->second == r) {
+            _inflight.erase(it);
+        }
+    });
+}
+
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <unordered_map>
+#include <seastar/core/shared_future.hh>
+#include <seastar/util/noncopyable_function.hh>
+#include "query-request.hh"
+#include "query-result.hh"
+#include "keys.hh"
+#include "bytes.hh"
+#include "db/timeout_clock.hh"
+#include "utils/updateable_value.hh"
+#include "tracing/trace_state.hh"
+
+namespace query {
+
+// Lets identical concurrent data queries of a single partition share one execution.
+//
+// A hot partition typically receives many identical reads at once, each of which
+// would go through admission, create its own reader and walk the cache on its own.
+// Instead, a read for which an identical read is already in progress waits for the
+// latter's result.
+//
+// Joining a read which started before a write to the partition was applied could
+// miss the write, breaking the guarantee that a read started after a write completed
+// observes it. Writes are therefore reported to the coalescer, and reads in progress
+// at the time of a write to their partition can't be joined anymore. To keep the
+// bookkeeping cheap, partitions are tracked in buckets, so a write may prevent
+// coalescing of reads of other partitions too, never the other way around.
+//
+// Reads can also be joined only for a short time after they started, so that
+// the result never lags behind by more than the configured window.
+//
+// The shared read runs with the timeout and the admission of the read which
+// started it. A joining read only waits for the result, until its own timeout.
+// If the shared read times out before that, the joining read is executed on
+// its own, as if it hadn't joined.
+class read_coalescer {
+public:
+    using result_type = lw_shared_ptr<query::result>;
+    using clock_type = std::chrono::steady_clock;
+
+    struct stats {
+        uint64_t coalesced_reads = 0;
+    };
+
+    // Identifies reads which return the same result, given the same data.
+    class key {
+        table_schema_version _schema_version;
+        partition_key _key;
+        bytes _slice;
+        // Decides which cells have expired, so reads at different times may
+        // return different results.
+        gc_clock::time_point _query_time;
+        uint64_t _row_limit;
+        uint32_t _partition_limit;
+        result_options _opts;
+        max_result_size _max_result_size;
+        size_t _hash;
+
+        key(const read_command& cmd, const partition_key& pk, result_options opts);
+    public:
+        // Returns std::nullopt if the read is not eligible for coalescing.
+        static std::optional<key> make(const read_command& cmd, const dht::partition_range_vector& ranges, result_options opts);
+
+        const partition_key& partition() const noexcept {
+            return _key;
+        }
+        size_t hash() const noexcept {
+            return _hash;
+        }
+        bool operator==(const key& o) const;
+    };
+private:
+    struct key_hash {
+        size_t operator()(const key& k) const noexcept {
+            return k.hash();
+        }
+    };
+
+    struct inflight_read {
+        shared_future<result_type> result;
+        clock_type::time_point started;
+        uint64_t write_epoch;
+        uint64_t generation;
+    };
+
+    static constexpr size_t write_epoch_buckets = 1024;
+
+    utils::updateable_value<uint32_t> _window_in_us;
+    std::unordered_map<key, lw_shared_ptr<inflight_read>, key_hash> _inflight;
+    // Bumped on every write to a partition of the bucket.
+    std::array<uint64_t, write_epoch_buckets> _write_epochs{};
+    // Bumped whenever data of unknown partitions changes.
+    uint64_t _generation = 0;
+    stats _stats;
+
+    static size_t bucket_of(partition_key_view pk) noexcept;
+public:
+    explicit read_coalescer(utils::updateable_value<uint32_t> window_in_us);
+
+    // Executes `read`, unless an identical read which can be joined is in progress.
+    future<result_type> coalesce(key k, db::timeout_clock::time_point timeout, tracing::trace_state_ptr trace_state,
+            noncopyable_function<future<result_type>()> read);
+
+    void on_write(partition_key_view pk) noexcept {
+        ++_write_epochs[bucket_of(pk)];
+    }
+    // To be called when data changes other than by writing single partitions,
+    // e.g. when sstables are added or the table is truncated.
+    void invalidate() noexcept {
+        ++_generation;
+    }
+
+    const stats& get_stats() const noexcept {
+        return _stats;
+    }
+};
+
+}
@@ -41,6 +41,14 @@ future<redis_message> command_factory::create_execute(service::storage_proxy& pr
         { "set", commands::set },
         { "setex", commands::setex },
         { "del", commands::del },
+        { "mget", commands::mget },
+        { "mset", commands::mset },
+        { "incr", commands::incr },
+        { "incrby", commands::incrby },
+        { "decr", commands::decr },
+        { "decrby", commands::decrby },
+        { "append", commands::append },
+        { "expire", commands::expire },
         { "echo", commands::echo },
         { "lolwut", commands::lolwut },
         { "hget", commands::hget },
@@ -20,6 +20,7 @@
  */
 
 #include "redis/commands.hh"
+#include <charconv>
 #include "seastar/core/shared_ptr.hh"
 #include "redis/request.hh"
 #include "redis/reply.hh"
@@ -197,6 +198,139 @@ future<redis_message> del(service::storage_proxy& proxy, request& req, redis::re
     });
 }
 
+future<redis_message> mget(service::storage_proxy& proxy, request& req, redis::redis_options& options, service_permit permit) {
+    if (req.arguments_size() < 1) {
+        throw wrong_number_of_arguments_exception(req._command);
+    }
+    return redis::read_multiple_strings(proxy, options, req._args, permit).then([&req] (auto result) {
+        std::vector<std::optional<bytes>> values;
+        values.reserve(req._args.size());
+        for (auto& key : req._args) {
+            auto it = result->find(key);
+            values.push_back(it != result->end() ? std::make_optional(it->second) : std::nullopt);
+        }
+        return redis_message::make_optional_strings_list_result(values);
+    });
+}
+
+future<redis_message> mset(service::storage_proxy& proxy, request& req, redis::redis_options& options, service_permit permit) {
+    if (req.arguments_size() == 0 || req.arguments_size() % 2 != 0) {
+        throw wrong_number_of_arguments_exception(req._command);
+    }
+    std::vector<std::pair<bytes, bytes>> keys_and_data;
+    keys_and_data.reserve(req.arguments_size() / 2);
+    for (size_t i = 0; i < req.arguments_size(); i += 2) {
+        keys_and_data.emplace_back(std::move(req._args[i]), std::move(req._args[i + 1]));
+    }
+    return redis::write_multiple_strings(proxy, options, std::move(keys_and_data), permit).then([] {
+        return redis_message::ok();
+    });
+}
+
+// Parses a signed 64-bit integer, rejecting anything else, like Redis does
+// for the arguments and the values of INCR and friends.
+static int64_t parse_integer(bytes_view v) {
+    auto begin = reinterpret_cast<const char*>(v.data());
+    auto end = begin + v.size();
+    int64_t n;
+    auto [ptr, ec] = std::from_chars(begin, end, n);
+    if (v.empty() || ec != std::errc() || ptr != end) {
+        throw not_an_integer_exception();
+    }
+    return n;
+}
+
+// The TTL to rewrite a value with, for it to keep its expiration.
+static long remaining_ttl(const strings_result& current) {
+    if (!current.has_ttl()) {
+        return 0;
+    }
+    // A value about to expire must not be rewritten without a TTL.
+    return std::max<long>(current.ttl().count(), 1);
+}
+
+static future<redis_message> increment(service::storage_proxy& proxy, request& req, redis::redis_options& options, service_permit permit, int64_t delta) {
+    auto updater = [delta] (const strings_result& current) {
+        int64_t value = current.has_result() ? parse_integer(current.result()) : 0;
+        if (__builtin_add_overflow(value, delta, &value)) {
+            throw integer_overflow_exception();
+        }
+        return std::make_optional(strings_update{to_bytes(std::to_string(value)), remaining_ttl(current)});
+    };
+    return redis::update_strings(proxy, options, std::move(req._args[0]), std::move(updater), permit).then([] (std::optional<strings_update> update) {
+        return redis_message::integer(parse_integer(*update->value));
+    });
+}
+
+future<redis_message> incr(service::storage_proxy& proxy, request& req, redis::redis_options& options, service_permit permit) {
+    if (req.arguments_size() != 1) {
+        throw wrong_arguments_exception(1, req.arguments_size(), req._command);
+    }
+    return increment(proxy, req, options, permit, 1);
+}
+
+future<redis_message> incrby(service::storage_proxy& proxy, request& req, redis::redis_options& options, service_permit permit) {
+    if (req.arguments_size() != 2) {
+        throw wrong_arguments_exception(2, req.arguments_size(), req._command);
+    }
+    return increment(proxy, req, options, permit, parse_integer(req._args[1]));
+}
+
+future<redis_message> decr(service::storage_proxy& proxy, request& req, redis::redis_options& options, service_permit permit) {
+    if (req.arguments_size() != 1) {
+        throw wrong_arguments_exception(1, req.arguments_size(), req._command);
+    }
+    return increment(proxy, req, options, permit, -1);
+}
+
+future<redis_message> decrby(service::storage_proxy& proxy, request& req, redis::redis_options& options, service_permit permit) {
+    if (req.arguments_size() != 2) {
+        throw wrong_arguments_exception(2, req.arguments_size(), req._command);
+    }
+    auto decrement = parse_integer(req._args[1]);
+    if (decrement == std::numeric_limits<int64_t>::min()) {
+        throw integer_overflow_exception();
+    }
+    return increment(proxy, req, options, permit, -decrement);
+}
+
+future<redis_message> append(service::storage_proxy& proxy, request& req, redis::redis_options& options, service_permit permit) {
+    if (req.arguments_size() != 2) {
+        throw wrong_arguments_exception(2, req.arguments_size(), req._command);
+    }
+    auto updater = [suffix = std::move(req._args[1])] (const strings_result& current) {
+        auto value = current.has_result() ? current.result() + suffix : suffix;
+        return std::make_optional(strings_update{std::move(value), remaining_ttl(current)});
+    };
+    return redis::update_strings(proxy, options, std::move(req._args[0]), std::move(updater), permit).then([] (std::optional<strings_update> update) {
+        return redis_message::number(update->value->size());
+    });
+}
+
+future<redis_message> expire(service::storage_proxy& proxy, request& req, redis::redis_options& options, service_permit permit) {
+    if (req.arguments_size() != 2) {
+        throw wrong_arguments_exception(2, req.arguments_size(), req._command);
+    }
+    auto seconds = parse_integer(req._args[1]);
+    if (seconds > max_ttl.count()) {
+        throw invalid_arguments_exception(req._command);
+    }
+    // Only STRINGs are supported. A key which doesn't exist is left alone,
+    // a key with a negative or zero TTL is deleted.
+    auto updater = [seconds] (const strings_result& current) -> std::optional<strings_update> {
+        if (!current.has_result()) {
+            return std::nullopt;
+        }
+        if (seconds <= 0) {
+            return strings_update{std::nullopt, 0};
+        }
+        return strings_update{current.result(), seconds};
+    };
+    return redis::update_strings(proxy, options, std::move(req._args[0]), std::move(updater), permit).then([] (std::optional<strings_update> update) {
+        return update ? redis_message::one() : redis_message::zero();
+    });
+}
+
 future<redis_message> select(service::storage_proxy&, request& req, redis::redis_options& options, service_permit) {
     if (req.arguments_size() != 1) {
         throw wrong_arguments_exception(1, req.arguments_size(), req._command);
@@ -61,3 +61,13 @@ class invalid_db_index_exception : public redis_exception {
 public:
     invalid_db_index_exception() : redis_exception("DB index is out of range") {}
 };
+
+class not_an_integer_exception : public redis_exception {
+public:
+    not_an_integer_exception() : redis_exception("value is not an integer or out of range") {}
+};
+
+class integer_overflow_exception : public redis_exception {
+public:
+    integer_overflow_exception() : redis_exception("increment or decrement would overflow") {}
+};
@@ -22,12 +22,19 @@
 #include "redis/mutation_utils.hh"
 #include "types.hh"
 #include "service/storage_proxy.hh"
+#include "service/client_state.hh"
 #include "schema.hh"
 #include "database.hh"
 #include <seastar/core/print.hh>
+#include <seastar/core/semaphore.hh>
+#include <unordered_map>
 #include "redis/keyspace_utils.hh"
 #include "redis/options.hh"
+#include "redis/query_utils.hh"
 #include "mutation.hh"
+#include "partition_slice_builder.hh"
+#include "query-result.hh"
+#include "timeout_config.hh"
 #include "service_permit.hh"
 
 using namespace seastar;
@@ -37,18 +44,19 @@ namespace redis {
 atomic_cell make_cell(const schema_ptr schema,
         const abstract_type& type,
         bytes_view value,
-        long cttl = 0)
+        long cttl = 0,
+        api::timestamp_type ts = api::new_timestamp())
 {
 
     if (cttl > 0) {
         auto ttl = std::chrono::seconds(cttl);
-        return atomic_cell::make_live(type, api::new_timestamp(), value, gc_clock::now() + ttl, ttl, atomic_cell::collection_member::no);
+        return atomic_cell::make_live(type, ts, value, gc_clock::now() + ttl, ttl, atomic_cell::collection_member::no);
     }   
     auto ttl = schema->default_time_to_live();
     if (ttl.count() > 0) {
-        return atomic_cell::make_live(type, api::new_timestamp(), value, gc_clock::now() + ttl, ttl, atomic_cell::collection_member::no);
+        return atomic_cell::make_live(type, ts, value, gc_clock::now() + ttl, ttl, atomic_cell::collection_member::no);
     }   
-    return atomic_cell::make_live(type, api::new_timestamp(), value, atomic_cell::collection_member::no);
+    return atomic_cell::make_live(type, ts, value, atomic_cell::collection_member::no);
 }  
 
 
@@ -86,11 +94,161 @@ future<> write_strings(service::storage_proxy& proxy, redis::redis_options& opti
 }
 
 
-mutation make_tombstone(service::storage_proxy& proxy, const redis_options& options, const sstring& cf_name, const bytes& key) {
+future<> write_multiple_strings(service::storage_proxy& proxy, redis::redis_options& options, std::vector<std::pair<bytes, bytes>>&& keys_and_data, service_permit permit) {
+    db::timeout_clock::time_point timeout = db::timeout_clock::now() + options.get_write_timeout();
+    // Mutations of the same key would get the same timestamp, the last
+    // value has to win explicitly.
+    std::unordered_map<bytes, bytes> last_values;
+    for (auto& [key, data] : keys_and_data) {
+        last_values.insert_or_assign(std::move(key), std::move(data));
+    }
+    std::vector<mutation> mutations;
+    mutations.reserve(last_values.size());
+    for (auto& [key, data] : last_values) {
+        mutations.push_back(make_mutation(proxy, options, bytes(key), std::move(data), 0));
+    }
+    auto write_consistency_level = options.get_write_consistency_level();
+    return proxy.mutate(std::move(mutations), write_consistency_level, timeout, nullptr, permit);
+}
+
+
+mutation make_update_mutation(const schema_ptr& schema, const partition_key& pkey, const strings_update& update, api::timestamp_type ts) {
+    auto m = mutation(schema, pkey);
+    if (update.value) {
+        const column_definition& column = *schema->get_column_definition(redis::DATA_COLUMN_NAME);
+        auto cell = make_cell(schema, *(column.type.get()), *update.value, update.ttl, ts);
+        m.set_clustered_cell(clustering_key::make_empty(), column, std::move(cell));
+    } else {
+        m.partition().apply(tombstone { ts, gc_clock::now() });
+    }
+    return m;
+}
+
+// What update_strings() needs from the redis_options of the connection, copied
+// to be used on the shard owning the key.
+struct update_strings_params {
+    sstring ks_name;
+    rmw_consistency consistency;
+    db::consistency_level read_consistency_level;
+    db::consistency_level write_consistency_level;
+    timeout_config timeouts;
+};
+
+class strings_cas_request : public service::cas_request {
+    schema_ptr _schema;
+    partition_key _pkey;
+    strings_updater _updater;
+    std::optional<strings_update> _update;
+public:
+    strings_cas_request(schema_ptr schema, partition_key pkey, strings_updater updater)
+        : _schema(std::move(schema))
+        , _pkey(std::move(pkey))
+        , _updater(std::move(updater))
+    {
+    }
+    virtual std::optional<mutation> apply(foreign_ptr<lw_shared_ptr<query::result>> qr, const query::partition_slice& slice, api::timestamp_type ts) override {
+        // Called again if the transaction is retried, the last update is the one written.
+        _update = _updater(*make_strings_result(*qr, _schema, slice));
+        if (!_update) {
+            return std::nullopt;
+        }
+        return make_update_mutation(_schema, _pkey, *_update, ts);
+    }
+    std::optional<strings_update>& update() { return _update; }
+};
+
+// Serializes the relaxed updates of the keys owned by this shard. Like the
+// locks of paxos_state, the locks are per token, and dropped when unused.
+class key_lock_map {
+    using semaphore = basic_semaphore<semaphore_default_exception_factory, db::timeout_clock>;
+    std::unordered_map<dht::token, semaphore> _locks;
+public:
+    template<typename Func>
+    futurize_t<std::result_of_t<Func()>> with_locked_key(const dht::token& key, db::timeout_clock::time_point timeout, Func func) {
+        auto& sem = _locks.try_emplace(key, 1).first->second;
+        return with_semaphore(sem, 1, timeout - db::timeout_clock::now(), std::move(func)).finally([key, this] {
+            auto it = _locks.find(key);
+            if (it != _locks.end() && it->second.current() == 1) {
+                _locks.erase(it);
+            }
+        });
+    }
+};
+
+static thread_local key_lock_map relaxed_update_locks;
+
+// The permit of a request stays on the shard which received it, so updates
+// of keys owned by another shard run there with a permit holding a unit of
+// this semaphore of the owning shard, which bounds how many of them it runs
+// at once.
+static constexpr size_t max_forwarded_updates = 1000;
+static thread_local semaphore forwarded_updates_semaphore{max_forwarded_updates};
+
+// Must be called on the shard owning the key, see storage_proxy::cas_shard().
+static future<std::optional<strings_update>> do_update_strings(service::storage_proxy& proxy, update_strings_params params, bytes key, strings_updater updater, service_permit permit) {
+    auto schema = get_schema(proxy, params.ks_name, redis::STRINGs);
+    auto pkey = partition_key::from_single_value(*schema, key);
+    auto ps = partition_slice_builder(*schema).build();
+    const auto max_result_size = proxy.get_max_result_size(ps);
+    auto cmd = make_lw_shared<query::read_command>(schema->id(), schema->version(), ps, 1, gc_clock::now(), std::nullopt, 1, utils::UUID(), query::is_first_page::no, max_result_size, 0);
+    auto dk = dht::decorate_key(*schema, pkey);
+    auto token = dk.token();
+    auto partition_range = dht::partition_range::make_singular(std::move(dk));
+    auto now = db::timeout_clock::now();
+    auto read_timeout = now + params.timeouts.read_timeout;
+    auto write_timeout = now + params.timeouts.write_timeout;
+
+    if (params.consistency == rmw_consistency::strict) {
+        auto request = seastar::make_shared<strings_cas_request>(schema, std::move(pkey), std::move(updater));
+        return proxy.cas(schema, request, cmd, {std::move(partition_range)}, {read_timeout, std::move(permit), service::client_state::for_internal_calls()},
+                db::consistency_level::LOCAL_SERIAL, params.write_consistency_level, write_timeout, now + params.timeouts.cas_timeout).then([request] (bool) {
+            return std::move(request->update());
+        });
+    }
+
+    return relaxed_update_locks.with_locked_key(token, write_timeout, [&proxy, schema, pkey = std::move(pkey), cmd, partition_range = std::move(partition_range),
+            updater = std::move(updater), permit = std::move(permit), cl = params.read_consistency_level, write_cl = params.write_consistency_level,
+            read_timeout, write_timeout] () mutable {
+        return proxy.query(schema, cmd, {std::move(partition_range)}, cl, {read_timeout, permit, service::client_state::for_internal_calls()}).then(
+                [&proxy, schema, pkey = std::move(pkey), cmd, updater = std::move(updater), permit, write_cl, write_timeout] (service::storage_proxy::coordinator_query_result qr) mutable {
+            auto update = updater(*make_strings_result(*qr.query_result, schema, cmd->slice));
+            if (!update) {
+                return make_ready_future<std::optional<strings_update>>();
+            }
+            auto m = make_update_mutation(schema, pkey, *update, api::new_timestamp());
+            return proxy.mutate(std::vector<mutation> {std::move(m)}, write_cl, write_timeout, nullptr, permit).then([update = std::move(update)] () mutable {
+                return std::move(update);
+            });
+        });
+    });
+}
+
+future<std::optional<strings_update>> update_strings(service::storage_proxy& proxy, redis::redis_options& options, bytes&& key, strings_updater updater, service_permit permit) {
+    update_strings_params params{options.get_keyspace_name(), options.get_rmw_consistency(),
+            options.get_read_consistency_level(), options.get_write_consistency_level(), options.get_timeout_config()};
+    auto schema = get_schema(proxy, params.ks_name, redis::STRINGs);
+    auto token = dht::get_token(*schema, partition_key::from_single_value(*schema, key));
+    // Both kinds of updates run on the shard owning the key: lightweight
+    // transactions have to, and the relaxed updates of the key coordinated
+    // by this node are serialized there.
+    auto shard = service::storage_proxy::cas_shard(*schema, token);
+    if (shard == this_shard_id()) {
+        return do_update_strings(proxy, std::move(params), std::move(key), std::move(updater), std::move(permit));
+    }
+    return proxy.container().invoke_on(shard, [params = std::move(params), key = std::move(key), updater = std::move(updater)] (service::storage_proxy& proxy) mutable {
+        auto timeout = std::chrono::duration_cast<semaphore::duration>(params.timeouts.write_timeout);
+        return get_units(forwarded_updates_semaphore, 1, timeout).then(
+                [&proxy, params = std::move(params), key = std::move(key), updater = std::move(updater)] (semaphore_units<> units) mutable {
+            return do_update_strings(proxy, std::move(params), std::move(key), std::move(updater), make_service_permit(std::move(units)));
+        });
+    }).finally([permit = std::move(permit)] {});
+}
+
+mutation make_tombstone(service::storage_proxy& proxy, const redis_options& options, const sstring& cf_name, const bytes& key, api::timestamp_type ts, gc_clock::time_point clk) {
     auto schema = get_schema(proxy, options.get_keyspace_name(), cf_name);
     auto pkey = partition_key::from_single_value(*schema, key);
     auto m = mutation(schema, std::move(pkey));
-    m.partition().apply(tombstone { api::new_timestamp(), gc_clock::now() }); 
+    m.partition().apply(tombstone { ts, clk });
     return m;
 }
 
@@ -98,13 +256,18 @@ future<> delete_objects(service::storage_proxy& proxy, redis::redis_options& opt
     db::timeout_clock::time_point timeout = db::timeout_clock::now() + options.get_write_timeout();
     auto write_consistency_level = options.get_write_consistency_level();
     std::vector<sstring> tables { redis::STRINGs, redis::LISTs, redis::HASHes, redis::SETs, redis::ZSETs }; 
-    auto remove = [&proxy, timeout, write_consistency_level, permit, &options, keys = std::move(keys)] (const sstring& cf_name) {
-        return parallel_for_each(keys.begin(), keys.end(), [&proxy, timeout, write_consistency_level, &options, permit, cf_name] (const bytes& key) {
-            auto m = make_tombstone(proxy, options, cf_name, key);
-            return proxy.mutate(std::vector<mutation> {std::move(m)}, write_consistency_level, timeout, nullptr, permit);
-        });
-    };  
-    return parallel_for_each(tables.begin(), tables.end(), remove);
+    // All the tombstones are written with a single mutate() call, rather
+    // than one per key and table.
+    auto ts = api::new_timestamp();
+    auto clk = gc_clock::now();
+    std::vector<mutation> mutations;
+    mutations.reserve(tables.size() * keys.size());
+    for (auto& cf_name : tables) {
+        for (auto& key : keys) {
+            mutations.push_back(make_tombstone(proxy, options, cf_name, key, ts, clk));
+        }
+    }
+    return proxy.mutate(std::move(mutations), write_consistency_level, timeout, nullptr, permit);
 }
 
 future<> delete_fields(service::storage_proxy& proxy, redis::redis_options& options, bytes&& key, std::vector<bytes>&& fields, service_permit permit) {
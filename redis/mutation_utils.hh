@@ -20,6 +20,7 @@
  */
 
 #pragma once
+#include <functional>
 #include "types.hh"
 
 class service_permit;
@@ -32,9 +33,29 @@ class mutation;
 namespace redis {
 
 class redis_options;
+struct strings_result;
+
+// The new value of a STRING, computed by a strings_updater.
+struct strings_update {
+    // The key is deleted if there is no value.
+    std::optional<bytes> value;
+    long ttl = 0;
+};
+
+// Computes the update of a STRING from its current value, or returns nothing
+// to leave it as it is. May be called several times, on another shard than
+// the one calling update_strings(), and may throw to fail the update.
+using strings_updater = std::function<std::optional<strings_update>(const strings_result&)>;
 
 future<> write_hashes(service::storage_proxy& proxy, redis::redis_options& options, bytes&& key, bytes&& field, bytes&& data, long ttl, service_permit permit);
 future<> write_strings(service::storage_proxy& proxy, redis::redis_options& options, bytes&& key, bytes&& data, long ttl, service_permit permit);
+// Writes the values of several keys at once. If a key appears several times, its last value is written.
+future<> write_multiple_strings(service::storage_proxy& proxy, redis::redis_options& options, std::vector<std::pair<bytes, bytes>>&& keys_and_data, service_permit permit);
+// Atomically updates the value of a STRING with `updater`, returns the update
+// written, if any. Depending on redis_options::get_rmw_consistency(), this is
+// either a lightweight transaction, or a read followed by a write which is only
+// atomic with respect to the other updates of the key coordinated by this node.
+future<std::optional<strings_update>> update_strings(service::storage_proxy& proxy, redis::redis_options& options, bytes&& key, strings_updater updater, service_permit permit);
 future<> delete_objects(service::storage_proxy& proxy, redis::redis_options& options, std::vector<bytes>&& keys, service_permit permit);
 future<> delete_fields(service::storage_proxy& proxy, redis::redis_options& options, bytes&& key, std::vector<bytes>&& fields, service_permit permit);
 
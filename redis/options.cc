@@ -32,6 +32,15 @@ using namespace seastar;
 
 namespace redis {
 
+rmw_consistency make_rmw_consistency(const sstring& consistency) {
+    if (consistency == "strict") {
+        return rmw_consistency::strict;
+    } else if (consistency == "relaxed") {
+        return rmw_consistency::relaxed;
+    }
+    throw std::invalid_argument(format("Invalid redis_read_modify_write_consistency '{}', expected 'strict' or 'relaxed'", consistency));
+}
+
 schema_ptr get_schema(service::storage_proxy& proxy, const sstring& ks_name, const sstring& cf_name) {
     auto& db = proxy.get_db().local();
     auto schema = db.find_schema(ks_name, cf_name);
@@ -36,16 +36,27 @@ class storage_proxy;
 
 namespace redis {
 
+// The consistency of the read-modify-write commands (INCR, APPEND, ...),
+// see the redis_read_modify_write_consistency option.
+enum class rmw_consistency {
+    strict,
+    relaxed,
+};
+
+rmw_consistency make_rmw_consistency(const sstring&);
+
 class redis_options {
     sstring _ks_name;
     const db::consistency_level _read_consistency;
     const db::consistency_level _write_consistency;
+    const rmw_consistency _rmw_consistency;
     const timeout_config& _timeout_config;
     service::client_state _client_state;
     size_t _total_redis_db_count;
 public:
     explicit redis_options(const db::consistency_level rcl,
         const db::consistency_level wcl,
+        const rmw_consistency rmwc,
         const timeout_config& tc,
         auth::service& auth,
         const socket_address addr,
@@ -53,6 +64,7 @@ class redis_options {
         :_ks_name("REDIS_0")
         ,_read_consistency(rcl)
         ,_write_consistency(wcl)
+        ,_rmw_consistency(rmwc)
         ,_timeout_config(tc)
         ,_client_state(service::client_state::external_tag{}, auth, tc, addr)
         ,_total_redis_db_count(total_redis_db_count)
@@ -61,6 +73,7 @@ class redis_options {
     explicit redis_options(const sstring& ks_name,
         const db::consistency_level rcl,
         const db::consistency_level wcl,
+        const rmw_consistency rmwc,
         const timeout_config& tc,
         auth::service& auth,
         const socket_address addr,
@@ -68,6 +81,7 @@ class redis_options {
         :_ks_name(ks_name)
         ,_read_consistency(rcl)
         ,_write_consistency(wcl)
+        ,_rmw_consistency(rmwc)
         ,_timeout_config(tc)
         ,_client_state(service::client_state::external_tag{}, auth, tc, addr)
         ,_total_redis_db_count(total_redis_db_count)
@@ -76,6 +90,7 @@ class redis_options {
 
     const db::consistency_level get_read_consistency_level() const { return _read_consistency; }
     const db::consistency_level get_write_consistency_level() const { return _write_consistency; }
+    rmw_consistency get_rmw_consistency() const { return _rmw_consistency; }
 
     const timeout_config& get_timeout_config() const { return _timeout_config; }
     const db::timeout_clock::duration get_read_timeout() const { return _timeout_config.read_timeout; }
@@ -74,6 +74,14 @@ class strings_result_builder {
 };
 
 
+lw_shared_ptr<strings_result> make_strings_result(const query::result& qr, schema_ptr schema, const query::partition_slice& ps) {
+    return query::result_view::do_with(qr, [&] (query::result_view v) {
+        auto pd = make_lw_shared<strings_result>();
+        v.consume(ps, strings_result_builder(pd, schema, ps));
+        return pd;
+    });
+}
+
 future<lw_shared_ptr<strings_result>> read_strings(service::storage_proxy& proxy, const redis_options& options, const bytes& key, service_permit permit) {
     auto schema = get_schema(proxy, options.get_keyspace_name(), redis::STRINGs);
     auto ps = partition_slice_builder(*schema).build();
@@ -89,10 +97,75 @@ future<lw_shared_ptr<strings_result>> query_strings(service::storage_proxy& prox
     partition_ranges.emplace_back(std::move(partition_range));
     auto read_consistency_level = options.get_read_consistency_level();
     db::timeout_clock::time_point timeout = db::timeout_clock::now() + options.get_read_timeout();
+    return proxy.query(schema, make_lw_shared<query::read_command>(std::move(cmd)), std::move(partition_ranges), read_consistency_level, {timeout, permit, service::client_state::for_internal_calls()}).then([ps, schema] (auto qr) {
+        return make_strings_result(*qr.query_result, schema, ps);
+    });
+}
+
+
+class multiple_strings_result_builder {
+    lw_shared_ptr<std::map<bytes, bytes>> _data;
+    const query::partition_slice& _partition_slice;
+    const schema_ptr _schema;
+    bytes _key;
+public:
+    multiple_strings_result_builder(lw_shared_ptr<std::map<bytes, bytes>> data, const schema_ptr schema, const query::partition_slice& ps)
+        : _data(data)
+        , _partition_slice(ps)
+        , _schema(schema)
+    {
+    }
+    void accept_new_partition(const partition_key& key, uint32_t row_count) {
+        _key = key.explode().front();
+    }
+    void accept_new_partition(uint32_t row_count) {}
+    void accept_new_row(const clustering_key& key, const query::result_row_view& static_row, const query::result_row_view& row)
+    {
+        auto row_iterator = row.iterator();
+        for (auto&& id : _partition_slice.regular_columns) {
+            auto cell = row_iterator.next_atomic_cell();
+            if (cell) {
+                cell->value().with_linearized([this, &col = _schema->regular_column_at(id)] (bytes_view cell_view) {
+                    _data->insert_or_assign(_key, col.type->deserialize_value(cell_view).serialize_nonnull());
+                });
+            }
+        }
+    }
+    void accept_new_row(const query::result_row_view& static_row, const query::result_row_view& row) {}
+    void accept_partition_end(const query::result_row_view& static_row) {}
+};
+
+future<lw_shared_ptr<std::map<bytes, bytes>>> read_multiple_strings(service::storage_proxy& proxy, const redis_options& options, const std::vector<bytes>& keys, service_permit permit) {
+    auto schema = get_schema(proxy, options.get_keyspace_name(), redis::STRINGs);
+    auto ps = partition_slice_builder(*schema)
+        .with_option<query::partition_slice::option::send_partition_key>()
+        .build();
+    // The keys are read in ring order, without duplicates. storage_proxy
+    // reads the partitions sharing their replicas with a single request to
+    // each of them, which needs the partition keys in the result.
+    std::vector<dht::decorated_key> dkeys;
+    dkeys.reserve(keys.size());
+    for (auto& key : keys) {
+        dkeys.push_back(dht::decorate_key(*schema, partition_key::from_single_value(*schema, key)));
+    }
+    std::sort(dkeys.begin(), dkeys.end(), dht::decorated_key::less_comparator(schema));
+    dkeys.erase(std::unique(dkeys.begin(), dkeys.end(), [&schema] (const dht::decorated_key& a, const dht::decorated_key& b) {
+        return a.equal(*schema, b);
+    }), dkeys.end());
+    dht::partition_range_vector partition_ranges;
+    partition_ranges.reserve(dkeys.size());
+    for (auto& dk : dkeys) {
+        partition_ranges.emplace_back(dht::partition_range::make_singular(std::move(dk)));
+    }
+    const auto max_result_size = proxy.get_max_result_size(ps);
+    const auto limit = static_cast<uint32_t>(partition_ranges.size());
+    query::read_command cmd(schema->id(), schema->version(), ps, limit, gc_clock::now(), std::nullopt, limit, utils::UUID(), query::is_first_page::no, max_result_size, 0);
+    auto read_consistency_level = options.get_read_consistency_level();
+    db::timeout_clock::time_point timeout = db::timeout_clock::now() + options.get_read_timeout();
     return proxy.query(schema, make_lw_shared<query::read_command>(std::move(cmd)), std::move(partition_ranges), read_consistency_level, {timeout, permit, service::client_state::for_internal_calls()}).then([ps, schema] (auto qr) {
         return query::result_view::do_with(*qr.query_result, [&] (query::result_view v) {
-            auto pd = make_lw_shared<strings_result>();
-            v.consume(ps, strings_result_builder(pd, schema, ps));
+            auto pd = make_lw_shared<std::map<bytes, bytes>>();
+            v.consume(ps, multiple_strings_result_builder(pd, schema, ps));
             return pd;
         });
     });
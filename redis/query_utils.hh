@@ -32,6 +32,10 @@ class storage_proxy;
 class client_state;
 }
 
+namespace query {
+class result;
+}
+
 class service_permit;
 
 namespace redis {
@@ -43,13 +47,18 @@ struct strings_result {
     bool _has_result;
     ttl_opt _ttl;
     bytes& result() { return _result; }
+    const bytes& result() const { return _result; }
     bool has_result() const { return _has_result; }
-    gc_clock::duration ttl() { return _ttl.value(); }
-    bool has_ttl() { return _ttl.has_value(); }
+    gc_clock::duration ttl() const { return _ttl.value(); }
+    bool has_ttl() const { return _ttl.has_value(); }
 };
 
+// Builds the strings_result of a query for a single key of the STRINGs table.
+seastar::lw_shared_ptr<strings_result> make_strings_result(const query::result&, schema_ptr, const query::partition_slice&);
 seastar::future<seastar::lw_shared_ptr<strings_result>> read_strings(service::storage_proxy&, const redis_options&, const bytes&, service_permit);
 seastar::future<seastar::lw_shared_ptr<strings_result>> query_strings(service::storage_proxy&, const redis_options&, const bytes&, service_permit, schema_ptr, query::partition_slice);
+// Reads the values of several keys with a single query, returns those of the keys which exist.
+seastar::future<seastar::lw_shared_ptr<std::map<bytes, bytes>>> read_multiple_strings(service::storage_proxy&, const redis_options&, const std::vector<bytes>&, service_permit);
 
 seastar::future<seastar::lw_shared_ptr<std::map<bytes, bytes>>> read_hashes(service::storage_proxy&, const redis_options&, const bytes&, service_permit);
 seastar::future<seastar::lw_shared_ptr<std::map<bytes, bytes>>> read_hashes(service::storage_proxy&, const redis_options&, const bytes&, const bytes&, service_permit);
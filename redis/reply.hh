@@ -71,6 +71,12 @@ class redis_message final {
         m->append(sprint(":%zu\r\n", n));
         return make_ready_future<redis_message>(m);
     }
+    // A signed integer, which number() can't represent.
+    static seastar::future<redis_message> integer(int64_t n) {
+        auto m = make_lw_shared<scattered_message<char>> ();
+        m->append(sprint(":%d\r\n", n));
+        return make_ready_future<redis_message>(m);
+    }
     static seastar::future<redis_message> make_list_result(std::map<bytes, bytes>& list_result) {
         auto m = make_lw_shared<scattered_message<char>> ();
         m->append(sprint("*%u\r\n", list_result.size() * 2));
@@ -80,6 +86,19 @@ class redis_message final {
         }
         return make_ready_future<redis_message>(m);
     }
+    // An array of bulk strings, with nil for the missing values.
+    static seastar::future<redis_message> make_optional_strings_list_result(std::vector<std::optional<bytes>>& values) {
+        auto m = make_lw_shared<scattered_message<char>> ();
+        m->append(sprint("*%u\r\n", values.size()));
+        for (auto& v : values) {
+            if (v) {
+                write_bytes(m, *v);
+            } else {
+                m->append_static("$-1\r\n");
+            }
+        }
+        return make_ready_future<redis_message>(m);
+    }
     static seastar::future<redis_message> make_strings_result(bytes result) {
         auto m = make_lw_shared<scattered_message<char>> ();
         write_bytes(m, result);
@@ -84,7 +84,7 @@ redis_server::connection::connection(redis_server& server, socket_address server
     : generic_server::connection(server, std::move(fd))
     , _server(server)
     , _server_addr(server_addr)
-    , _options(server._config._read_consistency_level, server._config._write_consistency_level, server._config._timeout_config, server._auth_service, addr, server._total_redis_db_count)
+    , _options(server._config._read_consistency_level, server._config._write_consistency_level, server._config._rmw_consistency, server._config._timeout_config, server._auth_service, addr, server._total_redis_db_count)
 {
 }
 
@@ -93,28 +93,51 @@ redis_server::connection::~connection() {
 
 thread_local redis_server::connection::execution_stage_type redis_server::connection::_process_request_stage {"redis_transport", &connection::process_request_one};
 
+// The commands of a connection are executed one after the other, in the
+// order of the requests, as Redis does: a command sees the effects of the
+// commands sent before it. Only reading the next requests and writing the
+// replies of the previous ones overlap with the execution of a command.
 future<redis_server::result> redis_server::connection::process_request_internal() {
-    return _process_request_stage(this, _parser.get_request(), seastar::ref(_options), empty_service_permit());
+    promise<> executed;
+    auto previous = std::exchange(_previous_request_executed, executed.get_future());
+    return previous.then([this, request = std::move(_parser.get_request())] () mutable {
+        return _process_request_stage(this, std::move(request), seastar::ref(_options), empty_service_permit());
+    }).then_wrapped([executed = std::move(executed)] (future<result> f) mutable {
+        executed.set_value();
+        return f;
+    });
 }
 
-void redis_server::connection::write_reply(const redis_exception& e)
-{
-    _ready_to_respond = _ready_to_respond.then([this, exception_message = e.what_message()] () mutable {
-        return redis_message::exception(exception_message).then([this] (auto&& result) {
-            auto m = result.message();
-            return _write_buf.write(std::move(*m)).then([this] {
-                return _write_buf.flush();
-            });
-        });
+// Replies to the requests which failed with an error, rather than failing the connection.
+static future<redis_server::result> error_reply(std::exception_ptr ep) {
+    sstring message;
+    try {
+        std::rethrow_exception(std::move(ep));
+    } catch (redis_exception& e) {
+        message = e.what_message();
+    } catch (std::exception& e) {
+        message = e.what();
+    } catch (...) {
+        message = "Unknown exception";
+    }
+    return redis::redis_message::exception(message).then([] (redis::redis_message m) {
+        return redis_server::result(std::move(m));
     });
 }
 
-void redis_server::connection::write_reply(redis_server::result result)
+// Replies are written in the order of the requests, whatever the order in
+// which they complete. Each reply is flushed as soon as it is written, like
+// CQL responses: the output stream batches the flushes, so the replies of
+// pipelined requests completing together are still sent together, while a
+// reply never waits for the requests received after it.
+void redis_server::connection::write_reply(future<redis_server::result> reply)
 {
-    _ready_to_respond = _ready_to_respond.then([this, result = std::move(result)] () mutable {
-        auto m = result.make_message();
-        return _write_buf.write(std::move(*m)).then([this] {
-            return _write_buf.flush();
+    _ready_to_respond = _ready_to_respond.then([this, reply = std::move(reply)] () mutable {
+        return reply.then([this] (redis_server::result result) {
+            auto m = result.make_message();
+            return _write_buf.write(std::move(*m)).then([this] {
+                return _write_buf.flush();
+            });
         });
     });
 }
@@ -125,29 +148,30 @@ future<> redis_server::connection::process_request() {
         if (_parser.eof()) {
             return make_ready_future<>();
         }
-        ++_server._stats._requests_serving;
-        _pending_requests_gate.enter();
-        utils::latency_counter lc;
-        lc.start();
-        auto leave = defer([this] { _pending_requests_gate.leave(); });
-        return process_request_internal().then([this, leave = std::move(leave), lc = std::move(lc)] (auto&& result) mutable {
-            --_server._stats._requests_serving;
-            try {
-                if (_parser.failed()) {
-                    logging.error("request parse failed");
-                    const auto e = redis_exception("unknown command ''");
-                    write_reply(std::move(e));
-                }else{
-                    write_reply(std::move(result));
-                }
+        // Requests are pipelined: the next requests are read while this one
+        // is waiting for its turn or executed, up to max_pipelined_requests
+        // at once.
+        return get_units(_pipelined_requests, 1).then([this] (semaphore_units<> units) {
+            ++_server._stats._requests_serving;
+            _pending_requests_gate.enter();
+            utils::latency_counter lc;
+            lc.start();
+            auto leave = defer([this] { _pending_requests_gate.leave(); });
+            if (_parser.failed()) {
+                logging.error("request parse failed");
+            }
+            auto reply = _parser.failed()
+                    ? make_exception_future<result>(redis_exception("unknown command ''"))
+                    : process_request_internal();
+            write_reply(reply.handle_exception(error_reply).then([this, leave = std::move(leave), lc = std::move(lc)] (result r) mutable {
+                --_server._stats._requests_serving;
                 ++_server._stats._requests_served;
                 _server._stats._requests.mark(lc.stop().latency());
                 if (lc.is_start()) {
                     _server._stats._estimated_requests_latency.add(lc.latency(), _server._stats._requests.hist.count);
                 }
-            } catch (...) {
-                logging.error("request processing failed: {}", std::current_exception());
-            }
+                return r;
+            }).finally([units = std::move(units)] {}));
         });
     });
 }
@@ -156,14 +180,8 @@ void redis_server::connection::handle_error(future<>&& f) {
     try {
         f.get();
     }
-    catch (redis_exception& e) {
-        write_reply(e);
-    }
-    catch (std::exception& e) {
-        write_reply(redis_exception { e.what() });
-    }
     catch (...) {
-        write_reply(redis_exception { "Unknown exception" });
+        write_reply(error_reply(std::current_exception()));
     }
 }
 
@@ -63,6 +63,7 @@ struct redis_server_config {
     size_t _max_request_size;
     db::consistency_level _read_consistency_level;
     db::consistency_level _write_consistency_level;
+    redis::rmw_consistency _rmw_consistency;
     size_t _total_redis_db_count;
 };
 
@@ -95,6 +96,11 @@ class redis_server : public generic_server::server {
         socket_address _server_addr;
         redis_protocol_parser _parser;
         redis::redis_options _options;
+        // Bounds the number of pipelined requests read and not replied to yet.
+        semaphore _pipelined_requests{max_pipelined_requests};
+        // Resolved once the last request read is executed, see
+        // process_request_internal().
+        future<> _previous_request_executed = make_ready_future<>();
 
         using execution_stage_type = inheriting_concrete_execution_stage<
                 future<redis_server::result>,
@@ -105,12 +111,13 @@ class redis_server : public generic_server::server {
         >;
         static thread_local execution_stage_type _process_request_stage;
     public:
+        static constexpr size_t max_pipelined_requests = 128;
+
         connection(redis_server& server, socket_address server_addr, connected_socket&& fd, socket_address addr);
         virtual ~connection();
         future<> process_request() override;
         void handle_error(future<>&& f) override;
-        void write_reply(const redis_exception&);
-        void write_reply(redis_server::result result);
+        void write_reply(future<redis_server::result> reply);
     private:
         const ::timeout_config& timeout_config() { return _server.timeout_config(); }
         future<result> process_request_one(redis::request&& request, redis::redis_options&, service_permit permit);
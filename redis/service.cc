@@ -56,6 +56,7 @@ future<> redis_service::listen(seastar::sharded<auth::service>& auth_service, db
     redis_cfg._timeout_config = make_timeout_config(cfg);
     redis_cfg._read_consistency_level = make_consistency_level(cfg.redis_read_consistency_level());
     redis_cfg._write_consistency_level = make_consistency_level(cfg.redis_write_consistency_level());
+    redis_cfg._rmw_consistency = redis::make_rmw_consistency(cfg.redis_read_modify_write_consistency());
     redis_cfg._max_request_size = memory::stats().total_memory() / 10;
     redis_cfg._total_redis_db_count = cfg.redis_database_count();
     return gms::inet_address::lookup(addr, family, preferred).then([this, server, addr, &cfg, keepalive, ceo = std::move(ceo), redis_cfg, &auth_service] (seastar::net::inet_address ip) {
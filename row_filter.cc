@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "row_filter.hh"
+#include "schema.hh"
+#include "mutation_partition.hh"
+#include "utils/fragment_range.hh"
+
+namespace query {
+
+// Size of the values of types serialized as big-endian two's complement
+// integers, and compared as such, 0 for other types.
+static size_t integer_size(const abstract_type& type) {
+    switch (type.get_kind()) {
+    case abstract_type::kind::byte:
+        return 1;
+    case abstract_type::kind::short_kind:
+        return 2;
+    case abstract_type::kind::int32:
+        return 4;
+    case abstract_type::kind::long_kind:
+    case abstract_type::kind::time:
+    case abstract_type::kind::timestamp:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+static int64_t read_integer(managed_bytes_view v, size_t size) {
+    switch (size) {
+    case 1: return read_simple_exactly<int8_t>(v);
+    case 2: return read_simple_exactly<int16_t>(v);
+    case 4: return read_simple_exactly<int32_t>(v);
+    default: return read_simple_exactly<int64_t>(v);
+    }
+}
+
+row_filter::restriction::restriction(const column_definition& cdef, restriction_op op, std::vector<bytes> values)
+    : _type(cdef.type->without_reversed())
+    , _op(op)
+    , _values(std::move(values))
+    , _integer_size(integer_size(_type))
+    , column(&cdef) {
+    if (_op == restriction_op::in) {
+        auto less = _type.as_less_comparator();
+        std::sort(_values.begin(), _values.end(), less);
+        _values.erase(std::unique(_values.begin(), _values.end(), [&] (const bytes& a, const bytes& b) {
+            return _type.equal(a, b);
+        }), _values.end());
+    }
+    // Empty values are valid for integer types and sort first, they have to
+    // go through the generic comparison.
+    if (std::any_of(_values.begin(), _values.end(), [&] (const bytes& v) { return v.size() != _integer_size; })) {
+        _integer_size = 0;
+    }
+    if (_integer_size) {
+        _integer_values.reserve(_values.size());
+        for (auto& v : _values) {
+            _integer_values.push_back(read_integer(managed_bytes_view(bytes_view(v)), _integer_size));
+        }
+    }
+}
+
+bool row_filter::restriction::integer_is_satisfied_by(int64_t value) const {
+    switch (_op) {
+    case restriction_op::in:
+        return std::binary_search(_integer_values.begin(), _integer_values.end(), value);
+    case restriction_op::lt:
+        return !_integer_values.empty() && value < _integer_values.front();
+    case restriction_op::lte:
+        return !_integer_values.empty() && value <= _integer_values.front();
+    case restriction_op::gt:
+        return !_integer_values.empty() && value > _integer_values.front();
+    case restriction_op::gte:
+        return !_integer_values.empty() && value >= _integer_values.front();
+    }
+    // Unknown operation, sent by a newer coordinator.
+    return true;
+}
+
+bool row_filter::restriction::is_satisfied_by(managed_bytes_view value) const {
+    if (_integer_size && value.size() == _integer_size) {
+        return integer_is_satisfied_by(read_integer(value, _integer_size));
+    }
+    auto cmp = [&] (const bytes& v) {
+        return _type.compare(value, managed_bytes_view(bytes_view(v)));
+    };
+    switch (_op) {
+    case restriction_op::in: {
+        auto it = std::lower_bound(_values.begin(), _values.end(), value, [&] (const bytes& v, managed_bytes_view x) {
+            return _type.compare(managed_bytes_view(bytes_view(v)), x) < 0;
+        });
+        return it != _values.end() && cmp(*it) == 0;
+    }
+    case restriction_op::lt:
+        return !_values.empty() && cmp(_values.front()) < 0;
+    case restriction_op::lte:
+        return !_values.empty() && cmp(_values.front()) <= 0;
+    case restriction_op::gt:
+        return !_values.empty() && cmp(_values.front()) > 0;
+    case restriction_op::gte:
+        return !_values.empty() && cmp(_values.front()) >= 0;
+    }
+    return true;
+}
+
+row_filter::row_filter(const schema& s, const std::vector<column_restriction>& restrictions)
+    : _schema(s) {
+    for (auto& r : restrictions) {
+        auto* cdef = s.get_column_definition(r.column_name);
+        if (!cdef || !cdef->is_atomic() || cdef->is_counter()) {
+            continue;
+        }
+        auto& target = [&] () -> std::vector<restriction>& {
+            switch (cdef->kind) {
+            case column_kind::partition_key: return _partition_key_restrictions;
+            case column_kind::clustering_key: return _clustering_key_restrictions;
+            case column_kind::static_column: return _static_restrictions;
+            case column_kind::regular_column: return _regular_restrictions;
+            }
+            abort();
+        }();
+        target.emplace_back(*cdef, r.op, r.values);
+    }
+}
+
+bool row_filter::matches_partition(const partition_key& pk) const {
+    return std::all_of(_partition_key_restrictions.begin(), _partition_key_restrictions.end(), [&] (const restriction& r) {
+        return r.is_satisfied_by(pk.get_component(_schema, r.column->component_index()));
+    });
+}
+
+template <typename Restrictions>
+static bool cells_match(const Restrictions& restrictions, const row& cells, gc_clock::time_point now) {
+    return std::all_of(restrictions.begin(), restrictions.end(), [&] (const auto& r) {
+        auto* cell = cells.find_cell(r.column->id);
+        if (!cell) {
+            return false;
+        }
+        auto c = cell->as_atomic_cell(*r.column);
+        return !c.is_dead(now) && r.is_satisfied_by(c.value());
+    });
+}
+
+bool row_filter::matches_static_row(const row& cells, gc_clock::time_point now) const {
+    return cells_match(_static_restrictions, cells, now);
+}
+
+bool row_filter::matches_row(const clustering_key_prefix& ck, const row& cells, gc_clock::time_point now) const {
+    auto ck_matches = std::all_of(_clustering_key_restrictions.begin(), _clustering_key_restrictions.end(), [&] (const restriction& r) {
+        auto idx = r.column->component_index();
+        return idx < ck.size(_schema) && r.is_satisfied_by(ck.get_component(_schema, idx));
+    });
+    return ck_matches && cells_match(_regular_restrictions, cells, now);
+}
+
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include "query-request.hh"
+#include "schema_fwd.hh"
+#include "keys.hh"
+#include "gc_clock.hh"
+
+class row;
+
+namespace query {
+
+// Evaluates the filtering restrictions of a partition_slice (see
+// partition_slice::filter) against the rows of a partition.
+//
+// Restrictions of columns which the schema doesn't know about, or which aren't
+// atomic, are ignored: replicas only filter out rows the coordinator would
+// drop anyway, so ignoring a restriction never affects the result.
+// Like in CQL, a missing or dead cell never satisfies a restriction.
+class row_filter {
+    // A restriction prepared for evaluation against many values.
+    //
+    // The values of `in` restrictions are sorted, so that lookups are
+    // logarithmic. Columns of signed integer types (including timestamps)
+    // have their restriction values decoded upfront, and are compared as
+    // plain integers rather than through abstract_type::compare().
+    class restriction {
+        const abstract_type& _type;
+        restriction_op _op;
+        std::vector<bytes> _values;
+        // Size of the serialized values if they are compared as integers, 0 otherwise.
+        size_t _integer_size = 0;
+        std::vector<int64_t> _integer_values;
+    public:
+        const column_definition* column;
+
+        restriction(const column_definition& cdef, restriction_op op, std::vector<bytes> values);
+
+        bool is_satisfied_by(managed_bytes_view value) const;
+    private:
+        bool integer_is_satisfied_by(int64_t value) const;
+    };
+    const schema& _schema;
+    std::vector<restriction> _partition_key_restrictions;
+    std::vector<restriction> _clustering_key_restrictions;
+    std::vector<restriction> _static_restrictions;
+    std::vector<restriction> _regular_restrictions;
+public:
+    row_filter(const schema& s, const std::vector<column_restriction>& restrictions);
+
+    bool empty() const {
+        return _partition_key_restrictions.empty() && _clustering_key_restrictions.empty()
+                && _static_restrictions.empty() && _regular_restrictions.empty();
+    }
+    bool has_static_restrictions() const {
+        return !_static_restrictions.empty();
+    }
+    bool has_clustering_restrictions() const {
+        return !_clustering_key_restrictions.empty();
+    }
+
+    bool matches_partition(const partition_key& pk) const;
+    bool matches_static_row(const row& cells, gc_clock::time_point now) const;
+    // Doesn't check the partition key and the static row, see above.
+    bool matches_row(const clustering_key_prefix& ck, const row& cells, gc_clock::time_point now) const;
+};
+
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/metrics.hh>
+#include "service/forward_service.hh"
+#include "service/storage_proxy.hh"
+#include "service/migration_manager.hh"
+#include "service/query_state.hh"
+#include "service/pager/query_pagers.hh"
+#include "cql3/query_options.hh"
+#include "cql3/selection/selection.hh"
+#include "cql3/selection/raw_selector.hh"
+#include "cql3/statements/select_statement.hh"
+#include "message/messaging_service.hh"
+#include "schema_registry.hh"
+#include "database.hh"
+#include "log.hh"
+#include "utils/fb_utilities.hh"
+
+namespace service {
+
+static logging::logger flogger("forward_service");
+
+// Rebuilds the selection of the query from its aggregates. The columns it
+// reads are the same, in the same order, as those of the selection the
+// coordinator built for the read command.
+static shared_ptr<cql3::selection::selection> make_selection(database& db, schema_ptr s, const query::forward_request& req) {
+    std::vector<shared_ptr<cql3::selection::raw_selector>> raw_selectors;
+    raw_selectors.reserve(req.aggregation_infos.size());
+    for (auto& info : req.aggregation_infos) {
+        std::vector<shared_ptr<cql3::selection::selectable::raw>> args;
+        args.reserve(info.column_names.size());
+        for (auto& column : info.column_names) {
+            args.push_back(make_shared<cql3::column_identifier::raw>(column, true));
+        }
+        auto fun = make_shared<cql3::selection::selectable::with_function::raw>(
+                cql3::functions::function_name::native_function(info.function_name), std::move(args));
+        raw_selectors.push_back(make_shared<cql3::selection::raw_selector>(std::move(fun), nullptr));
+    }
+    return cql3::selection::selection::from_selectors(db, std::move(s), raw_selectors);
+}
+
+static query::forward_result merge_results(const cql3::selection::selection& selection, gc_clock::time_point now,
+        std::vector<query::forward_result>& results) {
+    cql3::selection::result_set_builder builder(selection, now, cql_serialization_format::internal());
+    for (auto& r : results) {
+        builder.merge_state(r.query_results);
+    }
+    return query::forward_result{builder.build_state()};
+}
+
+static const dht::token& end_token(const dht::partition_range& r) {
+    static const dht::token max_token = dht::maximum_token();
+    return r.end() ? r.end()->value().token() : max_token;
+}
+
+forward_service::forward_service(netw::messaging_service& ms, storage_proxy& p, distributed<database>& db, migration_manager& mm)
+    : _messaging(ms)
+    , _proxy(p)
+    , _db(db)
+    , _mm(mm) {
+    setup_metrics();
+}
+
+void forward_service::setup_metrics() {
+    namespace sm = seastar::metrics;
+    _metrics.add_group("forward_service", {
+        sm::make_total_operations("requests_dispatched_to_other_nodes", _stats.requests_dispatched_to_other_nodes,
+                sm::description("Number of parts of aggregating queries sent to other nodes for execution.")),
+        sm::make_total_operations("requests_dispatched_to_own_shards", _stats.requests_dispatched_to_own_shards,
+                sm::description("Number of parts of aggregating queries dispatched to the shards of this node.")),
+        sm::make_total_operations("requests_executed", _stats.requests_executed,
+                sm::description("Number of parts of aggregating queries executed by this shard.")),
+    });
+}
+
+future<> forward_service::stop() {
+    return make_ready_future<>();
+}
+
+void forward_service::init_messaging_service() {
+    _messaging.register_forward_request([this] (const rpc::client_info& cinfo, rpc::opt_time_point t, query::forward_request req,
+            std::optional<tracing::trace_info> trace_info) -> future<query::forward_result> {
+        auto src_addr = netw::messaging_service::get_source(cinfo);
+        tracing::trace_state_ptr tr_state;
+        if (trace_info) {
+            tr_state = tracing::tracing::get_local_tracing_instance().create_session(*trace_info);
+            tracing::begin(tr_state);
+            tracing::trace(tr_state, "forward_request: message received from /{}", src_addr.addr);
+        }
+        auto timeout = t ? *t : db::no_timeout;
+        auto s = co_await _mm.get_schema_for_read(req.cmd.schema_version, std::move(src_addr), _messaging);
+        co_return co_await dispatch_to_shards(std::move(s), std::move(req), timeout, std::move(tr_state));
+    });
+}
+
+future<> forward_service::uninit_messaging_service() {
+    return _messaging.unregister_forward_request();
+}
+
+future<query::forward_result> forward_service::dispatch(query::forward_request req, db::timeout_clock::time_point timeout,
+        tracing::trace_state_ptr tr_state) {
+    auto s = _db.local().find_schema(req.cmd.cf_id);
+    auto& ks = _db.local().find_keyspace(s->ks_name());
+
+    // Group the vnodes by their closest live replica.
+    std::map<gms::inet_address, dht::partition_range_vector> ranges_by_endpoint;
+    query_ranges_to_vnodes_generator ranges_to_vnodes(_proxy.get_token_metadata_ptr(), s, std::move(req.pr));
+    while (!ranges_to_vnodes.empty()) {
+        for (auto& range : ranges_to_vnodes(1024)) {
+            auto endpoints = _proxy.get_live_sorted_endpoints(ks, end_token(range));
+            // Without live replicas, let the local node fail the read
+            // with the appropriate error.
+            auto ep = endpoints.empty() ? utils::fb_utilities::get_broadcast_address() : endpoints.front();
+            ranges_by_endpoint[ep].push_back(std::move(range));
+        }
+    }
+
+    flogger.debug("Dispatching forward_request for {}.{} to {} endpoints", s->ks_name(), s->cf_name(), ranges_by_endpoint.size());
+    tracing::trace(tr_state, "Dispatching forward_request to {} endpoints", ranges_by_endpoint.size());
+    std::vector<query::forward_result> results(ranges_by_endpoint.size());
+    size_t i = 0;
+    co_await parallel_for_each(ranges_by_endpoint, [&] (auto& ep_and_ranges) {
+        auto& result = results[i++];
+        query::forward_request part{req.aggregation_infos, req.cmd, std::move(ep_and_ranges.second), req.cl};
+        auto ep = ep_and_ranges.first;
+        if (ep == utils::fb_utilities::get_broadcast_address()) {
+            return dispatch_to_shards(s, std::move(part), timeout, tr_state).then([&result] (query::forward_result r) {
+                result = std::move(r);
+            });
+        }
+        ++_stats.requests_dispatched_to_other_nodes;
+        tracing::trace(tr_state, "Sending forward_request to /{}", ep);
+        return do_with(std::move(part), [this, &result, ep, timeout, &tr_state] (const query::forward_request& part) {
+            return _messaging.send_forward_request(netw::messaging_service::msg_addr{ep, 0}, timeout, part,
+                    tracing::make_trace_info(tr_state)).then([&result] (query::forward_result r) {
+                result = std::move(r);
+            });
+        });
+    });
+
+    auto selection = make_selection(_db.local(), s, req);
+    co_return merge_results(*selection, req.cmd.timestamp, results);
+}
+
+future<query::forward_result> forward_service::dispatch_to_shards(schema_ptr s, query::forward_request req, db::timeout_clock::time_point timeout,
+        tracing::trace_state_ptr tr_state) {
+    std::map<unsigned, dht::partition_range_vector> ranges_by_shard;
+    for (auto& range : req.pr) {
+        for (auto& [shard, ranges] : dht::split_range_to_shards(range, *s)) {
+            auto& v = ranges_by_shard[shard];
+            std::move(ranges.begin(), ranges.end(), std::back_inserter(v));
+        }
+    }
+
+    std::vector<query::forward_result> results(ranges_by_shard.size());
+    size_t i = 0;
+    co_await parallel_for_each(ranges_by_shard, [&] (auto& shard_and_ranges) {
+        auto& result = results[i++];
+        ++_stats.requests_dispatched_to_own_shards;
+        query::forward_request part{req.aggregation_infos, req.cmd, std::move(shard_and_ranges.second), req.cl};
+        return container().invoke_on(shard_and_ranges.first, [gs = global_schema_ptr(s), part = std::move(part), timeout,
+                gt = tracing::global_trace_state_ptr(tr_state)] (forward_service& fs) mutable {
+            return fs.execute_on_this_shard(gs, std::move(part), timeout, gt.get());
+        }).then([&result] (query::forward_result r) {
+            result = std::move(r);
+        });
+    });
+
+    auto selection = make_selection(_db.local(), s, req);
+    co_return merge_results(*selection, req.cmd.timestamp, results);
+}
+
+future<query::forward_result> forward_service::execute_on_this_shard(schema_ptr s, query::forward_request req, db::timeout_clock::time_point timeout,
+        tracing::trace_state_ptr tr_state) {
+    ++_stats.requests_executed;
+    tracing::trace(tr_state, "Executing forward_request on shard {}", this_shard_id());
+    auto selection = make_selection(_db.local(), s, req);
+    auto now = req.cmd.timestamp;
+    auto cmd = make_lw_shared<query::read_command>(std::move(req.cmd));
+    cmd->slice.options.set<query::partition_slice::option::allow_short_read>();
+
+    service::query_state qs(service::client_state::for_internal_calls(), std::move(tr_state), empty_service_permit());
+    cql3::query_options opts(req.cl, std::vector<cql3::raw_value>{});
+    auto pager = service::pager::query_pagers::pager(s, selection, qs, opts, std::move(cmd), std::move(req.pr));
+
+    cql3::selection::result_set_builder builder(*selection, now, cql_serialization_format::internal());
+    while (!pager->is_exhausted()) {
+        co_await pager->fetch_page(builder, cql3::statements::select_statement::DEFAULT_COUNT_PAGE_SIZE, now, timeout);
+    }
+    co_return query::forward_result{builder.build_state()};
+}
+
+} // namespace service
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <seastar/core/sharded.hh>
+#include <seastar/core/metrics_registration.hh>
+#include "query-request.hh"
+#include "schema_fwd.hh"
+#include "db/timeout_clock.hh"
+#include "tracing/trace_state.hh"
+
+class database;
+
+namespace netw {
+class messaging_service;
+}
+
+namespace service {
+
+class storage_proxy;
+class migration_manager;
+
+// Executes aggregating range scans, such as SELECT count(*) FROM t, in
+// parallel on the nodes owning the data.
+//
+// The coordinator splits the ranges of the query into vnodes, groups them by
+// their closest live replica, and sends each replica its part of the ranges
+// in a FORWARD_REQUEST. Every node then splits its part by shard, and each
+// shard reads its ranges with the consistency level of the query, feeding the
+// rows to the aggregates. Only the intermediate states of the aggregates are
+// returned and merged on the way back, instead of the rows themselves.
+class forward_service : public seastar::peering_sharded_service<forward_service> {
+public:
+    struct stats {
+        uint64_t requests_dispatched_to_other_nodes = 0;
+        uint64_t requests_dispatched_to_own_shards = 0;
+        uint64_t requests_executed = 0;
+    };
+private:
+    netw::messaging_service& _messaging;
+    storage_proxy& _proxy;
+    distributed<database>& _db;
+    migration_manager& _mm;
+    stats _stats;
+    seastar::metrics::metric_groups _metrics;
+public:
+    forward_service(netw::messaging_service& ms, storage_proxy& p, distributed<database>& db, migration_manager& mm);
+
+    future<> stop();
+
+    void init_messaging_service();
+    future<> uninit_messaging_service();
+
+    const stats& get_stats() const {
+        return _stats;
+    }
+
+    // Executes `req` on the nodes owning the data, returns the merged states
+    // of its aggregates.
+    future<query::forward_result> dispatch(query::forward_request req, db::timeout_clock::time_point timeout, tracing::trace_state_ptr tr_state);
+private:
+    // Executes `req` on the shards of this node owning its ranges.
+    future<query::forward_result> dispatch_to_shards(schema_ptr s, query::forward_request req, db::timeout_clock::time_point timeout,
+            tracing::trace_state_ptr tr_state);
+    future<query::forward_result> execute_on_this_shard(schema_ptr s, query::forward_request req, db::timeout_clock::time_point timeout,
+            tracing::trace_state_ptr tr_state);
+    void setup_metrics();
+};
+
+} // namespace service
@@ -67,6 +67,7 @@ class paging_state final {
     uint32_t _rows_fetched_for_last_partition_low_bits;
     uint32_t _remaining_high_bits;
     uint32_t _rows_fetched_for_last_partition_high_bits;
+    uint32_t _range_concurrency;
 
 public:
     paging_state(partition_key pk,
@@ -77,7 +78,8 @@ class paging_state final {
             std::optional<db::read_repair_decision> query_read_repair_decision,
             uint32_t rows_fetched_for_last_partition,
             uint32_t remaining_ext,
-            uint32_t rows_fetched_for_last_partition_high_bits);
+            uint32_t rows_fetched_for_last_partition_high_bits,
+            uint32_t range_concurrency = 1);
 
     paging_state(partition_key pk,
             std::optional<clustering_key> ck,
@@ -85,7 +87,8 @@ class paging_state final {
             utils::UUID reader_recall_uuid,
             replicas_per_token_range last_replicas,
             std::optional<db::read_repair_decision> query_read_repair_decision,
-            uint64_t rows_fetched_for_last_partition);
+            uint64_t rows_fetched_for_last_partition,
+            uint32_t range_concurrency = 1);
 
     void set_partition_key(partition_key pk) {
         _partition_key = std::move(pk);
@@ -184,6 +187,20 @@ class paging_state final {
         return _query_read_repair_decision;
     }
 
+    /**
+     * The number of vnode ranges to query concurrently on the next page.
+     *
+     * Range scans query an increasing number of vnode ranges concurrently
+     * until the page is filled. The next page starts with the concurrency
+     * estimated from the density of the rows read by the last one, instead of
+     * ramping up from a single range again.
+     * Meaningless for single-partition queries. In a mixed cluster older
+     * coordinators will ignore this value.
+     */
+    uint32_t get_range_concurrency() const {
+        return _range_concurrency;
+    }
+
     static lw_shared_ptr<paging_state> deserialize(bytes_opt bytes);
     bytes_opt serialize() const;
 };
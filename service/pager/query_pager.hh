@@ -97,6 +97,7 @@ class query_pager {
     paging_state::replicas_per_token_range _last_replicas;
     std::optional<db::read_repair_decision> _query_read_repair_decision;
     uint64_t _rows_fetched_for_last_partition = 0;
+    uint32_t _range_concurrency = 1;
     stats _stats;
 public:
     query_pager(schema_ptr s, shared_ptr<const cql3::selection::selection> selection,
@@ -101,6 +101,7 @@ static bool has_clustering_keys(const schema& s, const query::read_command& cmd)
             _cmd->is_first_page = query::is_first_page::no;
             _last_replicas = state->get_last_replicas();
             _query_read_repair_decision = state->get_query_read_repair_decision();
+            _range_concurrency = state->get_range_concurrency();
             _rows_fetched_for_last_partition = state->get_rows_fetched_for_last_partition();
         } else {
             _cmd->query_uuid = utils::make_random_uuid();
@@ -200,13 +201,15 @@ static bool has_clustering_keys(const schema& s, const query::read_command& cmd)
                 std::move(command),
                 std::move(ranges),
                 _options.get_consistency(),
-                {timeout, _state.get_permit(), _state.get_client_state(), _state.get_trace_state(), std::move(_last_replicas), _query_read_repair_decision});
+                {timeout, _state.get_permit(), _state.get_client_state(), _state.get_trace_state(), std::move(_last_replicas), _query_read_repair_decision,
+                 _range_concurrency});
     }
 
     future<> query_pager::fetch_page(cql3::selection::result_set_builder& builder, uint32_t page_size, gc_clock::time_point now, db::timeout_clock::time_point timeout) {
         return do_fetch_page(page_size, now, timeout).then([this, &builder, page_size, now] (service::storage_proxy::coordinator_query_result qr) {
             _last_replicas = std::move(qr.last_replicas);
             _query_read_repair_decision = qr.read_repair_decision;
+            _range_concurrency = qr.range_concurrency;
             return builder.with_thread_if_needed([this, &builder, page_size, now, qr = std::move(qr)] {
                 handle_result(cql3::selection::result_set_builder::visitor(builder, *_schema, *_selection),
                               std::move(qr.query_result), page_size, now);
@@ -230,6 +233,7 @@ future<cql3::result_generator> query_pager::fetch_page_generator(uint32_t page_s
     return do_fetch_page(page_size, now, timeout).then([this, page_size, now, &stats] (service::storage_proxy::coordinator_query_result qr) {
         _last_replicas = std::move(qr.last_replicas);
         _query_read_repair_decision = qr.read_repair_decision;
+        _range_concurrency = qr.range_concurrency;
         handle_result(noop_visitor(), qr.query_result, page_size, now);
         return cql3::result_generator(_schema, std::move(qr.query_result), _cmd, _selection, stats);
     });
@@ -253,6 +257,7 @@ class filtering_query_pager : public query_pager {
         return do_fetch_page(page_size, now, timeout).then([this, &builder, page_size, now] (service::storage_proxy::coordinator_query_result qr) {
             _last_replicas = std::move(qr.last_replicas);
             _query_read_repair_decision = qr.read_repair_decision;
+            _range_concurrency = qr.range_concurrency;
             qr.query_result->ensure_counts();
             _stats.rows_read_total += *qr.query_result->row_count();
             handle_result(cql3::selection::result_set_builder::visitor(builder, *_schema, *_selection,
@@ -377,7 +382,8 @@ class query_pager::query_result_visitor : public Base {
     }
 
     lw_shared_ptr<const paging_state> query_pager::state() const {
-        return make_lw_shared<paging_state>(_last_pkey.value_or(partition_key::make_empty()), _last_ckey, _exhausted ? 0 : _max, _cmd->query_uuid, _last_replicas, _query_read_repair_decision, _rows_fetched_for_last_partition);
+        return make_lw_shared<paging_state>(_last_pkey.value_or(partition_key::make_empty()), _last_ckey, _exhausted ? 0 : _max, _cmd->query_uuid, _last_replicas, _query_read_repair_decision, _rows_fetched_for_last_partition,
+                _range_concurrency);
     }
 
 }
@@ -24,6 +24,7 @@
 #include "service/storage_proxy.hh"
 #include "service/paxos/proposal.hh"
 #include "service/paxos/paxos_state.hh"
+#include "service/paxos/paxos_state_cache.hh"
 #include "db/system_keyspace.hh"
 #include "schema_registry.hh"
 #include "database.hh"
@@ -39,7 +40,6 @@ namespace service::paxos {
 
 logging::logger paxos_state::logger("paxos");
 thread_local paxos_state::key_lock_map paxos_state::_paxos_table_lock;
-thread_local paxos_state::key_lock_map paxos_state::_coordinator_lock;
 
 paxos_state::key_lock_map::semaphore& paxos_state::key_lock_map::get_semaphore_for_key(const dht::token& key) {
     return _locks.try_emplace(key, 1).first->second;
@@ -52,10 +52,52 @@ void paxos_state::key_lock_map::release_semaphore_for_key(const dht::token& key)
     }
 }
 
-future<paxos_state::guard> paxos_state::get_cas_lock(const dht::token& key, clock_type::time_point timeout) {
-    guard m(_coordinator_lock, key, timeout);
-    co_await m.lock();
-    co_return m;
+future<paxos_state> paxos_state::load(schema_ptr schema, const partition_key& key, gc_clock::time_point now,
+        clock_type::time_point timeout) {
+    auto& cache = get_local_storage_proxy().get_paxos_state_cache();
+    if (auto state = cache.get(*schema, key, now)) {
+        return make_ready_future<paxos_state>(std::move(*state));
+    }
+    auto version = cache.version(*schema, key);
+    return db::system_keyspace::load_paxos_state(key, schema, now, timeout).then([schema, key, version] (paxos_state state) {
+        get_local_storage_proxy().get_paxos_state_cache().populate(*schema, key, state, version);
+        return state;
+    });
+}
+
+// Keeps the paxos_state_cache of the shard owning the key in sync with the
+// outcome of a write to system.paxos. `on_success` is invoked on that shard.
+static future<> write_through(future<> write, schema_ptr schema, partition_key key,
+        std::function<void(paxos_state_cache&, const schema&, const partition_key&)> on_success) {
+    return write.then_wrapped([schema = std::move(schema), key = std::move(key), on_success = std::move(on_success)] (future<> f) mutable {
+        auto failed = f.failed();
+        auto update = [&schema, &key, &on_success, failed] (paxos_state_cache& cache) {
+            if (failed) {
+                // We don't know whether the write made it to the table or not.
+                cache.invalidate(*schema, key);
+            } else {
+                on_success(cache, *schema, key);
+            }
+        };
+        auto shard = dht::shard_of(*schema, dht::get_token(*schema, key));
+        if (shard == this_shard_id()) {
+            update(get_local_storage_proxy().get_paxos_state_cache());
+            return f;
+        }
+        // Learn can be executed on any shard.
+        return get_local_storage_proxy().container().invoke_on(shard, [gs = global_schema_ptr(schema), key, on_success, failed] (storage_proxy& sp) {
+            auto& cache = sp.get_paxos_state_cache();
+            schema_ptr s = gs;
+            if (failed) {
+                cache.invalidate(*s, key);
+            } else {
+                on_success(cache, *s, key);
+            }
+        }).then_wrapped([f = std::move(f)] (future<> cache_f) mutable {
+            cache_f.ignore_ready_future();
+            return std::move(f);
+        });
+    });
 }
 
 future<prepare_response> paxos_state::prepare(tracing::trace_state_ptr tr_state, schema_ptr schema,
@@ -73,7 +115,7 @@ future<prepare_response> paxos_state::prepare(tracing::trace_state_ptr tr_state,
             // tombstone that hides any re-submit). See CASSANDRA-12043 for details.
             auto now_in_sec = utils::UUID_gen::unix_timestamp_in_sec(ballot);
 
-            auto f = db::system_keyspace::load_paxos_state(key, schema, gc_clock::time_point(now_in_sec), timeout);
+            auto f = load(schema, key, gc_clock::time_point(now_in_sec), timeout);
             return f.then([&cmd, token = std::move(token), &key, ballot, tr_state, schema, only_digest, da, timeout] (paxos_state state) {
                 // If received ballot is newer that the one we already accepted it has to be accepted as well,
                 // but we will return the previously accepted proposal so that the new coordinator will use it instead of
@@ -84,7 +126,10 @@ future<prepare_response> paxos_state::prepare(tracing::trace_state_ptr tr_state,
                     if (utils::get_local_injector().enter("paxos_error_before_save_promise")) {
                         return make_exception_future<prepare_response>(utils::injected_error("injected_error_before_save_promise"));
                     }
-                    auto f1 = futurize_invoke(db::system_keyspace::save_paxos_promise, *schema, std::ref(key), ballot, timeout);
+                    auto f1 = write_through(futurize_invoke(db::system_keyspace::save_paxos_promise, *schema, std::ref(key), ballot, timeout),
+                            schema, key, [ballot] (paxos_state_cache& cache, const schema& s, const partition_key& key) {
+                        cache.on_promise(s, key, ballot);
+                    });
                     auto f2 = futurize_invoke([&] {
                         return do_with(dht::partition_range_vector({dht::partition_range::make_singular({token, key})}),
                                 [tr_state, schema, &cmd, only_digest, da, timeout] (const dht::partition_range_vector& prv) {
@@ -142,7 +187,7 @@ future<bool> paxos_state::accept(tracing::trace_state_ptr tr_state, schema_ptr s
         lc.start();
         return with_locked_key(token, timeout, [&proposal, schema, tr_state, timeout] () mutable {
             auto now_in_sec = utils::UUID_gen::unix_timestamp_in_sec(proposal.ballot);
-            auto f = db::system_keyspace::load_paxos_state(proposal.update.key(), schema, gc_clock::time_point(now_in_sec), timeout);
+            auto f = load(schema, proposal.update.key(), gc_clock::time_point(now_in_sec), timeout);
             return f.then([&proposal, tr_state, schema, timeout] (paxos_state state) {
                 // Accept the proposal if we promised to accept it or the proposal is newer than the one we promised.
                 // Otherwise the proposal was cutoff by another Paxos proposer and has to be rejected.
@@ -154,7 +199,10 @@ future<bool> paxos_state::accept(tracing::trace_state_ptr tr_state, schema_ptr s
                         return make_exception_future<bool>(utils::injected_error("injected_error_before_save_proposal"));
                     }
 
-                    return db::system_keyspace::save_paxos_proposal(*schema, proposal, timeout).then([] {
+                    auto f = db::system_keyspace::save_paxos_proposal(*schema, proposal, timeout);
+                    return write_through(std::move(f), schema, proposal.update.key(), [&proposal] (paxos_state_cache& cache, const schema& s, const partition_key&) {
+                        cache.on_proposal(s, proposal);
+                    }).then([] {
                         if (utils::get_local_injector().enter("paxos_error_after_save_proposal")) {
                             return make_exception_future<bool>(utils::injected_error("injected_error_after_save_proposal"));
                         }
@@ -230,7 +278,10 @@ future<> paxos_state::learn(schema_ptr schema, proposal decision, clock_type::ti
             // We don't need to lock the partition key if there is no gap between loading paxos
             // state and saving it, and here we're just blindly updating.
             return utils::get_local_injector().inject("paxos_timeout_after_save_decision", timeout, [&decision, schema, timeout] {
-                return db::system_keyspace::save_paxos_decision(*schema, decision, timeout);
+                auto f = db::system_keyspace::save_paxos_decision(*schema, decision, timeout);
+                return write_through(std::move(f), schema, decision.update.key(), [&decision] (paxos_state_cache& cache, const schema& s, const partition_key&) {
+                    cache.on_decision(s, decision);
+                });
             });
         });
     }).finally([schema, lc] () mutable {
@@ -244,7 +295,10 @@ future<> paxos_state::prune(schema_ptr schema, const partition_key& key, utils::
         tracing::trace_state_ptr tr_state) {
     logger.debug("Delete paxos state for ballot {}", ballot);
     tracing::trace(tr_state, "Delete paxos state for ballot {}", ballot);
-    return db::system_keyspace::delete_paxos_decision(*schema, key, ballot, timeout);
+    auto f = db::system_keyspace::delete_paxos_decision(*schema, key, ballot, timeout);
+    return write_through(std::move(f), schema, key, [ballot] (paxos_state_cache& cache, const schema& s, const partition_key& key) {
+        cache.on_prune(s, key, ballot);
+    });
 }
 
 } // end of namespace "service::paxos"
@@ -52,10 +52,10 @@ namespace service::paxos {
 
 using clock_type = db::timeout_clock;
 
+class paxos_state_cache;
+
 // The state of a CAS update of a given primary key as persisted in the paxos table.
 class paxos_state {
-public:
-    class guard;
 private:
 
     class key_lock_map {
@@ -79,19 +79,11 @@ class paxos_state {
                 release_semaphore_for_key(key);
             });
         }
-
-        friend class guard;
     };
 
     // Locks are local to the shard which owns the corresponding token range.
     // Protects concurrent reads and writes of the same row in system.paxos table.
     static thread_local key_lock_map _paxos_table_lock;
-    // Taken by the coordinator code to allow only one instance of PAXOS to run for each key.
-    // This prevents contantion between multiple clients trying to modify the
-    // same key throug the same coordinator and stealing the ballot from
-    // eachother.
-    static thread_local key_lock_map _coordinator_lock;
-
 
     // protects acess to system.paxos
     template<typename Func>
@@ -104,32 +96,13 @@ class paxos_state {
     std::optional<proposal> _accepted_proposal;
     std::optional<proposal> _most_recent_commit;
 
-public:
-
-    class guard {
-        key_lock_map& _map;
-        dht::token _key;
-        clock_type::time_point _timeout;
-        bool _locked = false;
-    public:
-        future<> lock() {
-            auto f = _map.get_semaphore_for_key(_key).wait(_timeout, 1);
-            _locked = true;
-            return f;
-        }
-        guard(key_lock_map& map, const dht::token& key, clock_type::time_point timeout) : _map(map), _key(key), _timeout(timeout) {};
-        guard(guard&& o) noexcept : _map(o._map), _key(std::move(o._key)), _timeout(o._timeout), _locked(o._locked) {
-            o._locked = false;
-        }
-        ~guard() {
-            if (_locked) {
-                _map.get_semaphore_for_key(_key).signal(1);
-                _map.release_semaphore_for_key(_key);
-            }
-        }
-    };
+    // Loads the state of the key from the shard's paxos_state_cache, falling
+    // back to system.paxos on a miss. Must be called on the shard owning the key.
+    static future<paxos_state> load(schema_ptr schema, const partition_key& key, gc_clock::time_point now,
+            clock_type::time_point timeout);
 
-    static future<guard> get_cas_lock(const dht::token& key, clock_type::time_point timeout);
+    friend class paxos_state_cache;
+public:
 
     static logging::logger logger;
 
@@ -139,6 +112,17 @@ class paxos_state {
         : _promised_ballot(std::move(promised))
         , _accepted_proposal(std::move(accepted))
         , _most_recent_commit(std::move(commit)) {}
+
+    const utils::UUID& promised_ballot() const {
+        return _promised_ballot;
+    }
+    const std::optional<proposal>& accepted_proposal() const {
+        return _accepted_proposal;
+    }
+    const std::optional<proposal>& most_recent_commit() const {
+        return _most_recent_commit;
+    }
+
     // Replica RPC endpoint for Paxos "prepare" phase.
     static future<prepare_response> prepare(tracing::trace_state_ptr tr_state, schema_ptr schema,
             const query::read_command& cmd, const partition_key& key, utils::UUID ballot,
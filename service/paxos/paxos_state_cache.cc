@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/core/metrics.hh>
+#include "service/paxos/paxos_state_cache.hh"
+#include "mutation.hh"
+#include "schema.hh"
+
+namespace service::paxos {
+
+// The write timestamp of every system.paxos cell is derived from the ballot.
+static api::timestamp_type ballot_timestamp(const utils::UUID& ballot) {
+    return utils::UUID_gen::micros_timestamp(ballot);
+}
+
+static const utils::UUID no_ballot = utils::UUID_gen::min_time_UUID();
+
+paxos_state_cache::entry::entry(const paxos_state& state)
+    : _promised_ballot(state._promised_ballot)
+    , _accepted_proposal(state._accepted_proposal)
+    , _most_recent_commit(state._most_recent_commit) {
+    // Saving a decision always deletes the accepted proposal with the
+    // decision's timestamp, so we know at least about that deletion.
+    if (_most_recent_commit) {
+        _accepted_tombstone = ballot_timestamp(_most_recent_commit->ballot);
+    }
+}
+
+paxos_state paxos_state_cache::entry::state() const {
+    return paxos_state(_promised_ballot, _accepted_proposal, _most_recent_commit);
+}
+
+size_t paxos_state_cache::entry::external_memory_usage() const {
+    size_t usage = 0;
+    if (_accepted_proposal) {
+        usage += _accepted_proposal->update.representation().size();
+    }
+    if (_most_recent_commit) {
+        usage += _most_recent_commit->update.representation().size();
+    }
+    return usage;
+}
+
+bool paxos_state_cache::entry::expired(gc_clock::time_point now, gc_clock::duration ttl) const {
+    // The TTL of a cell starts when it is written, which is never before its
+    // ballot was created, so expiring based on the ballot time is conservative.
+    auto is_expired = [now, ttl] (const utils::UUID& ballot) {
+        return gc_clock::time_point(utils::UUID_gen::unix_timestamp_in_sec(ballot)) + ttl <= now;
+    };
+    return (_promised_ballot != no_ballot && is_expired(_promised_ballot))
+        || (_accepted_proposal && is_expired(_accepted_proposal->ballot))
+        || (_most_recent_commit && is_expired(_most_recent_commit->ballot));
+}
+
+bool paxos_state_cache::entry::apply_promise(utils::UUID ballot) {
+    auto ts = ballot_timestamp(ballot);
+    auto current_ts = _promised_ballot != no_ballot ? ballot_timestamp(_promised_ballot) : api::missing_timestamp;
+    if (ts > current_ts) {
+        _promised_ballot = ballot;
+    } else if (ts == current_ts && ballot != _promised_ballot) {
+        return false;
+    }
+    return true;
+}
+
+bool paxos_state_cache::entry::apply_proposal(const proposal& p) {
+    if (!apply_promise(p.ballot)) {
+        return false;
+    }
+    auto ts = ballot_timestamp(p.ballot);
+    // A deletion wins over a write with the same timestamp.
+    if (ts <= _accepted_tombstone) {
+        return true;
+    }
+    if (!_accepted_proposal || ts > ballot_timestamp(_accepted_proposal->ballot)) {
+        _accepted_proposal.emplace(p);
+    } else if (ts == ballot_timestamp(_accepted_proposal->ballot) && p.ballot != _accepted_proposal->ballot) {
+        return false;
+    }
+    return true;
+}
+
+bool paxos_state_cache::entry::apply_decision(const proposal& decision, const schema& s) {
+    auto ts = ballot_timestamp(decision.ballot);
+    _accepted_tombstone = std::max(_accepted_tombstone, ts);
+    if (_accepted_proposal && ballot_timestamp(_accepted_proposal->ballot) <= _accepted_tombstone) {
+        _accepted_proposal.reset();
+    }
+    if (!_most_recent_commit || ts > ballot_timestamp(_most_recent_commit->ballot)) {
+        if (ts <= _commit_tombstone) {
+            // The decision was already pruned, only most_recent_commit_at survives.
+            _most_recent_commit.emplace(decision.ballot, freeze(mutation(s.shared_from_this(), decision.update.key())));
+        } else {
+            _most_recent_commit.emplace(decision);
+        }
+    } else if (ts == ballot_timestamp(_most_recent_commit->ballot) && decision.ballot != _most_recent_commit->ballot) {
+        return false;
+    }
+    return true;
+}
+
+bool paxos_state_cache::entry::apply_prune(utils::UUID ballot, const schema& s) {
+    auto ts = ballot_timestamp(ballot);
+    _commit_tombstone = std::max(_commit_tombstone, ts);
+    if (_most_recent_commit && ballot_timestamp(_most_recent_commit->ballot) <= _commit_tombstone) {
+        auto key = _most_recent_commit->update.key();
+        _most_recent_commit->update = freeze(mutation(s.shared_from_this(), key));
+    }
+    return true;
+}
+
+paxos_state_cache::paxos_state_cache(utils::updateable_value<uint32_t> max_entries, utils::updateable_value<uint32_t> max_memory_in_mb)
+    : _max_entries(std::move(max_entries))
+    , _max_memory_in_mb(std::move(max_memory_in_mb)) {
+    namespace sm = seastar::metrics;
+    _metrics.add_group("paxos_state_cache", {
+        sm::make_total_operations("hits", _stats.hits,
+                sm::description("Number of Paxos state lookups served from the cache.")),
+        sm::make_total_operations("misses", _stats.misses,
+                sm::description("Number of Paxos state lookups which had to read system.paxos.")),
+        sm::make_total_operations("evictions", _stats.evictions,
+                sm::description("Number of entries evicted to keep the cache within its size limit.")),
+        sm::make_total_operations("invalidations", _stats.invalidations,
+                sm::description("Number of entries dropped because their content could no longer be trusted.")),
+        sm::make_gauge("entries", [this] { return _entries.size(); },
+                sm::description("Number of partitions with a cached Paxos state.")),
+        sm::make_gauge("bytes", [this] { return _memory_usage; },
+                sm::description("Memory used by the cached Paxos states.")),
+    });
+}
+
+paxos_state_cache::~paxos_state_cache() {
+    _lru.clear();
+}
+
+// An estimate, counting the map node as the key and the entry.
+size_t paxos_state_cache::memory_usage(const map_type::value_type& e) {
+    return sizeof(e) + e.first.key.external_memory_usage() + e.second.external_memory_usage();
+}
+
+void paxos_state_cache::erase(map_type::iterator it) {
+    _memory_usage -= memory_usage(*it);
+    _lru.erase(_lru.iterator_to(it->second));
+    _entries.erase(it);
+}
+
+void paxos_state_cache::evict_to(size_t max_entries, size_t max_memory) {
+    while (!_lru.empty() && (_entries.size() > max_entries || _memory_usage > max_memory)) {
+        erase(_entries.find(*_lru.back()._key));
+        ++_stats.evictions;
+    }
+}
+
+std::optional<paxos_state> paxos_state_cache::get(const schema& s, const partition_key& key, gc_clock::time_point now) {
+    // Apply lowered size limits right away.
+    evict();
+    auto it = _entries.find(cache_key{s.id(), key});
+    if (it == _entries.end()) {
+        ++_stats.misses;
+        return std::nullopt;
+    }
+    auto& e = it->second;
+    if (e.expired(now, s.paxos_grace_seconds())) {
+        erase(it);
+        ++_stats.misses;
+        return std::nullopt;
+    }
+    _lru.erase(_lru.iterator_to(e));
+    _lru.push_front(e);
+    ++_stats.hits;
+    return e.state();
+}
+
+void paxos_state_cache::populate(const schema& s, const partition_key& key, const paxos_state& state, uint64_t version) {
+    auto max_entries = _max_entries();
+    if (version != version_of(s.id(), key) || max_entries == 0) {
+        return;
+    }
+    auto [it, inserted] = _entries.try_emplace(cache_key{s.id(), key}, state);
+    if (!inserted) {
+        return;
+    }
+    auto usage = memory_usage(*it);
+    auto memory_budget = max_memory();
+    if (usage > memory_budget) {
+        // Don't evict the whole cache for a single entry.
+        _entries.erase(it);
+        return;
+    }
+    it->second._key = &it->first;
+    _lru.push_front(it->second);
+    _memory_usage += usage;
+    evict_to(max_entries, memory_budget);
+}
+
+template <typename Func>
+void paxos_state_cache::update(const schema& s, const partition_key& key, Func&& func) {
+    ++version_of(s.id(), key);
+    auto it = _entries.find(cache_key{s.id(), key});
+    if (it == _entries.end()) {
+        return;
+    }
+    auto old_usage = memory_usage(*it);
+    auto valid = func(it->second);
+    _memory_usage = _memory_usage - old_usage + memory_usage(*it);
+    if (!valid) {
+        erase(it);
+        ++_stats.invalidations;
+        return;
+    }
+    // The entry may have grown past the memory budget.
+    evict();
+}
+
+void paxos_state_cache::on_promise(const schema& s, const partition_key& key, utils::UUID ballot) {
+    update(s, key, [&] (entry& e) {
+        return e.apply_promise(ballot);
+    });
+}
+
+void paxos_state_cache::on_proposal(const schema& s, const proposal& p) {
+    update(s, p.update.key(), [&] (entry& e) {
+        return e.apply_proposal(p);
+    });
+}
+
+void paxos_state_cache::on_decision(const schema& s, const proposal& decision) {
+    update(s, decision.update.key(), [&] (entry& e) {
+        return e.apply_decision(decision, s);
+    });
+}
+
+void paxos_state_cache::on_prune(const schema& s, const partition_key& key, utils::UUID ballot) {
+    update(s, key, [&] (entry& e) {
+        return e.apply_prune(ballot, s);
+    });
+}
+
+void paxos_state_cache::invalidate(const schema& s, const partition_key& key) {
+    update(s, key, [] (entry&) {
+        return false;
+    });
+}
+
+void paxos_state_cache::invalidate_tables(noncopyable_function<bool (const utils::UUID& table_id)> dropped) {
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        auto next = std::next(it);
+        if (dropped(it->first.table_id)) {
+            erase(it);
+            ++_stats.invalidations;
+        }
+        it = next;
+    }
+}
+
+} // end of namespace "service::paxos"
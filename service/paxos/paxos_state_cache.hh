@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <unordered_map>
+#include <boost/intrusive/list.hpp>
+#include <seastar/core/metrics_registration.hh>
+#include <seastar/util/noncopyable_function.hh>
+#include "service/paxos/paxos_state.hh"
+#include "utils/updateable_value.hh"
+#include "utils/hash.hh"
+#include "timestamp.hh"
+#include "gc_clock.hh"
+
+namespace service::paxos {
+
+// A per-shard, write-through cache of the rows of system.paxos.
+//
+// Every Paxos round on a replica starts by loading the paxos state of the
+// key from system.paxos, which makes the prepare and accept phases of hot
+// partitions read-bound. The cache keeps the most recently used states in
+// memory, so they can be answered without going to the storage engine.
+// The table stays the source of truth: entries are only updated after the
+// corresponding write to system.paxos succeeded, and are dropped when it
+// failed, so a miss always falls back to reading the table.
+//
+// Updates are merged the same way the storage engine merges the cells of
+// a row: each column is last-write-wins on the ballot timestamp, which is
+// the write timestamp used by db::system_keyspace::save_paxos_*(). This
+// makes the result independent of the order in which learn, prune and
+// accept reach the replica. Whenever the outcome can't be determined
+// (two different ballots with the same timestamp) the entry is dropped.
+//
+// The cache is bounded both by a number of entries and by the memory they
+// use, as the accepted proposals and most recent commits it holds are whole
+// mutations. Entries of dropped tables are dropped with them.
+//
+// All accesses for a given key must happen on the shard owning the key's
+// token, which is also where prepare and accept are executed.
+class paxos_state_cache {
+public:
+    struct stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+    };
+private:
+    struct cache_key {
+        utils::UUID table_id;
+        partition_key key;
+
+        bool operator==(const cache_key& o) const {
+            return table_id == o.table_id && key.representation() == o.key.representation();
+        }
+    };
+    static size_t hash(const utils::UUID& table_id, const partition_key& key) {
+        return utils::hash_combine(std::hash<utils::UUID>()(table_id), std::hash<managed_bytes_view>()(key.representation()));
+    }
+    struct cache_key_hash {
+        size_t operator()(const cache_key& k) const {
+            return hash(k.table_id, k.key);
+        }
+    };
+
+    class entry {
+        utils::UUID _promised_ballot = utils::UUID_gen::min_time_UUID();
+        std::optional<proposal> _accepted_proposal;
+        std::optional<proposal> _most_recent_commit;
+        // Deletion timestamps of the proposal and most_recent_commit columns
+        // observed through this cache. Needed to know whether a late write is
+        // shadowed by a newer deletion.
+        api::timestamp_type _accepted_tombstone = api::missing_timestamp;
+        api::timestamp_type _commit_tombstone = api::missing_timestamp;
+    public:
+        boost::intrusive::list_member_hook<> _lru_link;
+        // Points to the key of the map node holding this entry.
+        const cache_key* _key = nullptr;
+
+        explicit entry(const paxos_state& state);
+        paxos_state state() const;
+        // Memory used by the proposals held by the entry, outside of it.
+        size_t external_memory_usage() const;
+        // Returns true if any of the persisted cells has outlived its TTL.
+        bool expired(gc_clock::time_point now, gc_clock::duration ttl) const;
+
+        // The functions below return false if the merge result is ambiguous
+        // and the entry has to be dropped.
+        [[nodiscard]] bool apply_promise(utils::UUID ballot);
+        [[nodiscard]] bool apply_proposal(const proposal& p);
+        [[nodiscard]] bool apply_decision(const proposal& decision, const schema& s);
+        [[nodiscard]] bool apply_prune(utils::UUID ballot, const schema& s);
+    };
+
+    using lru_list = boost::intrusive::list<entry,
+            boost::intrusive::member_hook<entry, boost::intrusive::list_member_hook<>, &entry::_lru_link>,
+            boost::intrusive::constant_time_size<false>>;
+    using map_type = std::unordered_map<cache_key, entry, cache_key_hash>;
+
+    // Number of version counters. Keys are spread among them by hash, so
+    // that an update only makes the reads of the keys sharing its counter
+    // stale, rather than all the reads in flight.
+    static constexpr size_t version_buckets = 1024;
+
+    utils::updateable_value<uint32_t> _max_entries;
+    utils::updateable_value<uint32_t> _max_memory_in_mb;
+    map_type _entries;
+    // MRU entry at the front, LRU at the back.
+    lru_list _lru;
+    // Memory used by the entries, as computed by memory_usage().
+    size_t _memory_usage = 0;
+    // Bumped on every update of a key of the bucket. Used to detect that a
+    // state read from the table may have been overwritten while the read
+    // was in flight.
+    std::array<uint64_t, version_buckets> _versions{};
+    stats _stats;
+    seastar::metrics::metric_groups _metrics;
+
+    static size_t memory_usage(const map_type::value_type& e);
+    size_t max_memory() const {
+        return size_t(_max_memory_in_mb()) << 20;
+    }
+    uint64_t& version_of(const utils::UUID& table_id, const partition_key& key) {
+        return _versions[hash(table_id, key) % version_buckets];
+    }
+    template <typename Func>
+    void update(const schema& s, const partition_key& key, Func&& func);
+    void erase(map_type::iterator it);
+    void evict_to(size_t max_entries, size_t max_memory);
+    void evict() {
+        evict_to(_max_entries(), max_memory());
+    }
+public:
+    paxos_state_cache(utils::updateable_value<uint32_t> max_entries, utils::updateable_value<uint32_t> max_memory_in_mb);
+    ~paxos_state_cache();
+
+    paxos_state_cache(const paxos_state_cache&) = delete;
+    paxos_state_cache& operator=(const paxos_state_cache&) = delete;
+
+    // Returns the cached state of the key, if there is a valid one.
+    std::optional<paxos_state> get(const schema& s, const partition_key& key, gc_clock::time_point now);
+
+    // Must be sampled before reading the state of the key from system.paxos
+    // and passed to populate() once the read completes.
+    uint64_t version(const schema& s, const partition_key& key) {
+        return version_of(s.id(), key);
+    }
+    // Inserts a state read from system.paxos. Ignored if the key may have
+    // been updated since `version` was sampled, as the state may be stale by
+    // now, or if the state alone doesn't fit in the memory budget.
+    void populate(const schema& s, const partition_key& key, const paxos_state& state, uint64_t version);
+
+    // Write-through updates, to be called after the corresponding
+    // db::system_keyspace::save_paxos_*() call succeeded.
+    void on_promise(const schema& s, const partition_key& key, utils::UUID ballot);
+    void on_proposal(const schema& s, const proposal& p);
+    void on_decision(const schema& s, const proposal& decision);
+    void on_prune(const schema& s, const partition_key& key, utils::UUID ballot);
+
+    // Drops the entry of the key. To be called when a write to system.paxos
+    // failed and its outcome is unknown.
+    void invalidate(const schema& s, const partition_key& key);
+    // Drops the entries of the tables for which `dropped` returns true.
+    void invalidate_tables(noncopyable_function<bool (const utils::UUID& table_id)> dropped);
+
+    size_t size() const noexcept {
+        return _entries.size();
+    }
+    size_t memory_usage() const noexcept {
+        return _memory_usage;
+    }
+    const stats& get_stats() const noexcept {
+        return _stats;
+    }
+};
+
+} // end of namespace "service::paxos"
@@ -48,6 +48,7 @@
 #include "frozen_mutation.hh"
 #include "supervisor.hh"
 #include "query_result_merger.hh"
+#include "digester.hh"
 #include <seastar/core/do_with.hh>
 #include "message/messaging_service.hh"
 #include "gms/failure_detector.hh"
@@ -77,6 +78,7 @@
 #include <boost/range/algorithm/min_element.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 #include <boost/intrusive/list.hpp>
+#include <boost/range/irange.hpp>
 #include "utils/latency.hh"
 #include "schema.hh"
 #include "schema_registry.hh"
@@ -95,6 +97,8 @@
 #include "service/paxos/prepare_summary.hh"
 #include "service/migration_manager.hh"
 #include "service/paxos/proposal.hh"
+#include "service/paxos/paxos_state_cache.hh"
+#include "locator/dynamic_snitch.hh"
 #include "locator/token_metadata.hh"
 #include "seastar/core/coroutine.hh"
 
@@ -789,12 +793,13 @@ static future<std::optional<paxos_response_handler::ballot_and_data>> sleep_and_
  * nodes have seen the most recent commit. Otherwise, return null.
  */
 future<paxos_response_handler::ballot_and_data>
-paxos_response_handler::begin_and_repair_paxos(client_state& cs, unsigned& contentions, bool is_write) {
+paxos_response_handler::begin_and_repair_paxos(client_state& cs, unsigned& contentions, bool is_write,
+        api::timestamp_type min_timestamp_micros) {
     if (!_proxy->features().cluster_supports_lwt()) {
         throw std::runtime_error("The cluster does not support Paxos. Upgrade all the nodes to the version with LWT support.");
     }
 
-    return do_with(api::timestamp_type(0), shared_from_this(), [this, &cs, &contentions, is_write]
+    return do_with(api::timestamp_type(min_timestamp_micros), shared_from_this(), [this, &cs, &contentions, is_write]
             (api::timestamp_type& min_timestamp_micros_to_use, shared_ptr<paxos_response_handler>& prh) {
         return repeat_until_value([this, &contentions, &cs, &min_timestamp_micros_to_use, is_write] {
             if (storage_proxy::clock_type::now() > _cas_timeout) {
@@ -1600,6 +1605,26 @@ void storage_proxy_stats::stats::register_stats() {
                        sm::description("number of speculative data read requests that were sent"),
                        {storage_proxy_stats::current_scheduling_group_label()}),
 
+        sm::make_total_operations("speculative_reads_succeeded", speculative_reads_succeeded,
+                       sm::description("number of speculative read requests whose response was used to complete the read"),
+                       {storage_proxy_stats::current_scheduling_group_label()}),
+
+        sm::make_total_operations("speculative_reads_wasted", speculative_reads_wasted,
+                       sm::description("number of speculative read requests sent in vain, as the read completed without them"),
+                       {storage_proxy_stats::current_scheduling_group_label()}),
+
+        sm::make_total_operations("speculative_reads_throttled", speculative_reads_throttled,
+                       sm::description("number of speculative read requests not sent because the speculative retry budget was exhausted"),
+                       {storage_proxy_stats::current_scheduling_group_label()}),
+
+        sm::make_total_operations("multi_partition_reads", multi_partition_reads,
+                       sm::description("number of reads of several partitions owned by the same replicas which were sent as a single request to each replica"),
+                       {storage_proxy_stats::current_scheduling_group_label()}),
+
+        sm::make_total_operations("multi_partition_read_fallbacks", multi_partition_read_fallbacks,
+                       sm::description("number of multi-partition reads which had to be retried partition by partition because the replicas disagreed"),
+                       {storage_proxy_stats::current_scheduling_group_label()}),
+
         sm::make_histogram("cas_read_latency", sm::description("Transactional read latency histogram"),
                 {storage_proxy_stats::current_scheduling_group_label()},
                 [this]{ return to_metrics_histogram(estimated_cas_read);}),
@@ -1645,6 +1670,10 @@ void storage_proxy_stats::stats::register_stats() {
                        sm::description("CAS read rounds issued only if previous value is missing on some replica"),
                        {storage_proxy_stats::current_scheduling_group_label()}),
 
+        sm::make_total_operations("cas_batched_requests", cas_batched_requests,
+                       sm::description("CAS requests completed in a Paxos round shared with other requests on the same partition"),
+                       {storage_proxy_stats::current_scheduling_group_label()}),
+
         sm::make_histogram("cas_read_contention", sm::description("how many contended reads were encountered"),
                        {storage_proxy_stats::current_scheduling_group_label()},
                        [this]{ return cas_read_contention.get_histogram(1, 8);}),
@@ -1782,6 +1811,27 @@ inline std::ostream& operator<<(std::ostream& os, const hint_wrapper& h) {
 
 using namespace std::literals::chrono_literals;
 
+class storage_proxy::paxos_state_cache_invalidator : public migration_listener::empty_listener {
+    storage_proxy& _proxy;
+public:
+    explicit paxos_state_cache_invalidator(storage_proxy& proxy) : _proxy(proxy) { }
+
+    // Notified once the table is gone from the database.
+    void on_drop_column_family(const sstring& ks_name, const sstring& cf_name) override {
+        invalidate_dropped_tables();
+    }
+    void on_drop_keyspace(const sstring& ks_name) override {
+        invalidate_dropped_tables();
+    }
+private:
+    void invalidate_dropped_tables() {
+        auto& db = _proxy._db.local();
+        _proxy.get_paxos_state_cache().invalidate_tables([&db] (const utils::UUID& table_id) {
+            return !db.column_family_exists(table_id);
+        });
+    }
+};
+
 storage_proxy::~storage_proxy() {}
 storage_proxy::storage_proxy(distributed<database>& db, storage_proxy::config cfg, db::view::node_update_backlog& max_view_update_backlog,
         scheduling_group_key stats_key, gms::feature_service& feat, const locator::shared_token_metadata& stm, netw::messaging_service& ms)
@@ -1802,6 +1852,15 @@ storage_proxy::storage_proxy(distributed<database>& db, storage_proxy::config cf
     , _background_write_throttle_threahsold(cfg.available_memory / 10)
     , _mutate_stage{"storage_proxy_mutate", &storage_proxy::do_mutate}
     , _max_view_update_backlog(max_view_update_backlog)
+    , _paxos_state_cache(std::make_unique<paxos::paxos_state_cache>(_db.local().get_config().paxos_state_cache_size,
+            _db.local().get_config().paxos_state_cache_size_in_mb))
+    , _paxos_state_cache_invalidator(std::make_unique<paxos_state_cache_invalidator>(*this))
+    , _dynamic_snitch(std::make_unique<locator::dynamic_snitch>(locator::dynamic_snitch::config{
+            .enabled = _db.local().get_config().dynamic_snitch,
+            .badness_threshold = _db.local().get_config().dynamic_snitch_badness_threshold,
+            .update_interval_in_ms = _db.local().get_config().dynamic_snitch_update_interval_in_ms,
+            .reset_interval_in_ms = _db.local().get_config().dynamic_snitch_reset_interval_in_ms,
+        }))
     , _view_update_handlers_list(std::make_unique<view_update_handlers_list>()) {
     namespace sm = seastar::metrics;
     _metrics.add_group(storage_proxy_stats::COORDINATOR_STATS_CATEGORY, {
@@ -1812,6 +1871,7 @@ storage_proxy::storage_proxy(distributed<database>& db, storage_proxy::config cf
     slogger.trace("hinted DCs: {}", cfg.hinted_handoff_enabled.to_configuration_string());
     _hints_manager.register_metrics("hints_manager");
     _hints_for_views_manager.register_metrics("hints_for_views_manager");
+    _db.local().get_notifier().register_listener(_paxos_state_cache_invalidator.get());
 }
 
 storage_proxy::unique_response_handler::unique_response_handler(storage_proxy& p_, response_id_type id_) : id(id_), p(p_) {}
@@ -3409,7 +3469,7 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     bool _foreground = true;
     service_permit _permit; // holds admission permit until operation completes
 
-private:
+protected:
     void on_read_resolved() noexcept {
         // We could have !_foreground if this is called on behalf of background reconciliation.
         _proxy->get_stats().foreground_reads -= int(_foreground);
@@ -3437,6 +3497,24 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     }
 
 protected:
+    // Reports the response time of the request sent by `func` to the dynamic snitch.
+    // A failed request is accounted as if it timed out.
+    template <typename Func>
+    futurize_t<std::invoke_result_t<Func>> with_latency_tracking(gms::inet_address ep, clock_type::time_point timeout, Func&& func) {
+        _proxy->get_dynamic_snitch().on_request_sent(ep);
+        auto start = locator::dynamic_snitch::clock_type::now();
+        auto sent_at = clock_type::now();
+        return futurize_invoke(std::forward<Func>(func)).then_wrapped([this, ep, start, sent_at, timeout] (auto f) {
+            auto latency = locator::dynamic_snitch::clock_type::now() - start;
+            if (f.failed()) {
+                _proxy->get_dynamic_snitch().on_failure(ep,
+                        std::max(latency, std::chrono::duration_cast<locator::dynamic_snitch::clock_type::duration>(timeout - sent_at)));
+            } else {
+                _proxy->get_dynamic_snitch().on_response(ep, latency);
+            }
+            return f;
+        });
+    }
     future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>> make_mutation_data_request(lw_shared_ptr<query::read_command> cmd, gms::inet_address ep, clock_type::time_point timeout) {
         ++_proxy->get_stats().mutation_data_read_attempts.get_ep_stat(ep);
         if (fbu::is_me(ep)) {
@@ -3451,7 +3529,7 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
             });
         }
     }
-    future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> make_data_request(gms::inet_address ep, clock_type::time_point timeout, bool want_digest) {
+    virtual future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> make_data_request(gms::inet_address ep, clock_type::time_point timeout, bool want_digest) {
         ++_proxy->get_stats().data_read_attempts.get_ep_stat(ep);
         auto opts = want_digest
                   ? query::result_options{query::result_request::result_and_digest, digest_algorithm(*_proxy)}
@@ -3468,7 +3546,7 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
             });
         }
     }
-    future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> make_digest_request(gms::inet_address ep, clock_type::time_point timeout) {
+    virtual future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> make_digest_request(gms::inet_address ep, clock_type::time_point timeout) {
         ++_proxy->get_stats().digest_read_attempts.get_ep_stat(ep);
         if (fbu::is_me(ep)) {
             tracing::trace(_trace_state, "read_digest: querying locally");
@@ -3487,7 +3565,7 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     }
     future<> make_mutation_data_requests(lw_shared_ptr<query::read_command> cmd, data_resolver_ptr resolver, targets_iterator begin, targets_iterator end, clock_type::time_point timeout) {
         return parallel_for_each(begin, end, [this, &cmd, resolver = std::move(resolver), timeout] (gms::inet_address ep) {
-            return make_mutation_data_request(cmd, ep, timeout).then_wrapped([this, resolver, ep] (future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>> f) {
+            return with_latency_tracking(ep, timeout, [&] { return make_mutation_data_request(cmd, ep, timeout); }).then_wrapped([this, resolver, ep] (future<rpc::tuple<foreign_ptr<lw_shared_ptr<reconcilable_result>>, cache_temperature>> f) {
                 try {
                     auto v = f.get0();
                     _cf->set_hit_rate(ep, std::get<1>(v));
@@ -3502,7 +3580,7 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     }
     future<> make_data_requests(digest_resolver_ptr resolver, targets_iterator begin, targets_iterator end, clock_type::time_point timeout, bool want_digest) {
         return parallel_for_each(begin, end, [this, resolver = std::move(resolver), timeout, want_digest] (gms::inet_address ep) {
-            return make_data_request(ep, timeout, want_digest).then_wrapped([this, resolver, ep] (future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> f) {
+            return with_latency_tracking(ep, timeout, [&] { return make_data_request(ep, timeout, want_digest); }).then_wrapped([this, resolver, ep] (future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> f) {
                 try {
                     auto v = f.get0();
                     _cf->set_hit_rate(ep, std::get<1>(v));
@@ -3518,7 +3596,7 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
     }
     future<> make_digest_requests(digest_resolver_ptr resolver, targets_iterator begin, targets_iterator end, clock_type::time_point timeout) {
         return parallel_for_each(begin, end, [this, resolver = std::move(resolver), timeout] (gms::inet_address ep) {
-            return make_digest_request(ep, timeout).then_wrapped([this, resolver, ep] (future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> f) {
+            return with_latency_tracking(ep, timeout, [&] { return make_digest_request(ep, timeout); }).then_wrapped([this, resolver, ep] (future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> f) {
                 try {
                     auto v = f.get0();
                     _cf->set_hit_rate(ep, std::get<2>(v));
@@ -3639,7 +3717,7 @@ class abstract_read_executor : public enable_shared_from_this<abstract_read_exec
             }
         });
     }
-    void reconcile(db::consistency_level cl, storage_proxy::clock_type::time_point timeout) {
+    virtual void reconcile(db::consistency_level cl, storage_proxy::clock_type::time_point timeout) {
         reconcile(cl, timeout, _cmd);
     }
 
@@ -3743,11 +3821,41 @@ class always_speculating_read_executor : public abstract_read_executor {
 // this executor sends request to an additional replica after some time below timeout
 class speculating_read_executor : public abstract_read_executor {
     timer<storage_proxy::clock_type> _speculate_timer;
+    bool _speculated = false;
+
+    // For a percentile-based policy, speculate once any of the replicas the read waits for
+    // is late by its own standards. Falls back to the latency of the table as seen by
+    // this coordinator until there are enough samples for every replica.
+    std::chrono::microseconds speculation_delay() const {
+        auto& sr = _schema->speculative_retry();
+        if (sr.get_type() != speculative_retry::type::PERCENTILE) {
+            return std::chrono::milliseconds(unsigned(sr.get_value()));
+        }
+        auto max_delay = std::chrono::microseconds(std::chrono::milliseconds(_proxy->get_db().local().get_config().read_request_timeout_in_ms() / 2));
+        std::chrono::microseconds delay(0);
+        const auto& ds = _proxy->get_dynamic_snitch();
+        // the last target is the "extra" one, see make_requests()
+        for (auto it = _targets.begin(); it != _targets.end() - 1; ++it) {
+            auto replica_delay = ds.get_latency_percentile(*it, sr.get_value());
+            if (!replica_delay) {
+                return std::min<std::chrono::microseconds>(_cf->get_coordinator_read_latency_percentile(sr.get_value()), max_delay);
+            }
+            delay = std::max(delay, *replica_delay);
+        }
+        return std::min(delay, max_delay);
+    }
 public:
     using abstract_read_executor::abstract_read_executor;
     virtual future<> make_requests(digest_resolver_ptr resolver, storage_proxy::clock_type::time_point timeout) {
+        _proxy->add_speculation_budget();
         _speculate_timer.set_callback([this, resolver, timeout] {
             if (!resolver->is_completed()) { // at the time the callback runs request may be completed already
+                if (!_proxy->consume_speculation_budget()) {
+                    _proxy->get_stats().speculative_reads_throttled++;
+                    tracing::trace(_trace_state, "Not sending a speculative read, speculative retry budget exhausted");
+                    return;
+                }
+                _speculated = true;
                 resolver->add_wait_targets(1); // we send one more request so wait for it too
                 // FIXME: consider disabling for CL=*ONE
                 auto send_request = [&] (bool has_data) {
@@ -3763,11 +3871,7 @@ class speculating_read_executor : public abstract_read_executor {
                 (void)send_request(resolver->has_data()).finally([exec = shared_from_this()]{});
             }
         });
-        auto& sr = _schema->speculative_retry();
-        auto t = (sr.get_type() == speculative_retry::type::PERCENTILE) ?
-            std::min(_cf->get_coordinator_read_latency_percentile(sr.get_value()), std::chrono::milliseconds(_proxy->get_db().local().get_config().read_request_timeout_in_ms()/2)) :
-            std::chrono::milliseconds(unsigned(sr.get_value()));
-        _speculate_timer.arm(t);
+        _speculate_timer.arm(std::chrono::duration_cast<storage_proxy::clock_type::duration>(speculation_delay()));
 
         // if CL + RR result in covering all replicas, getReadExecutor forces AlwaysSpeculating.  So we know
         // that the last replica in our list is "extra."
@@ -3789,12 +3893,133 @@ class speculating_read_executor : public abstract_read_executor {
     }
     virtual void got_cl() override {
         _speculate_timer.cancel();
+        if (_speculated) {
+            // The speculative read paid off if the extra replica was among those the read completed with.
+            if (boost::range::find(_used_targets, _targets.back()) != _used_targets.end()) {
+                _proxy->get_stats().speculative_reads_succeeded++;
+            } else {
+                _proxy->get_stats().speculative_reads_wasted++;
+            }
+        }
     }
     virtual void adjust_targets_for_reconciliation() override {
         _targets = used_targets();
     }
 };
 
+// Reads several partitions owned by the same replicas with a single data or
+// digest request to each of them, instead of one per partition. Executor is
+// the executor get_read_executor() picks for the replicas, so that the reads
+// speculate as reads of a single partition would.
+//
+// The replicas return the partitions in the order of the ranges, which is
+// not the ring order data_read_resolver expects, so when they disagree the
+// partitions are read (and reconciled if needed) one by one instead.
+template <typename Executor>
+class multi_partition_read_executor : public Executor {
+    using clock_type = storage_proxy::clock_type;
+    dht::partition_range_vector _partition_ranges;
+public:
+    template <typename... Args>
+    multi_partition_read_executor(dht::partition_range_vector prs, Args&&... args)
+        : Executor(std::forward<Args>(args)...)
+        , _partition_ranges(std::move(prs)) {
+        this->_proxy->get_stats().multi_partition_reads++;
+    }
+protected:
+    virtual future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> make_data_request(gms::inet_address ep, clock_type::time_point timeout, bool want_digest) override {
+        auto& proxy = *this->_proxy;
+        auto& trace_state = this->_trace_state;
+        ++proxy.get_stats().data_read_attempts.get_ep_stat(ep);
+        auto opts = want_digest
+                  ? query::result_options{query::result_request::result_and_digest, digest_algorithm(proxy)}
+                  : query::result_options{query::result_request::only_result, query::digest_algorithm::none};
+        if (fbu::is_me(ep)) {
+            tracing::trace(trace_state, "read_data: querying {} partitions locally", _partition_ranges.size());
+            return proxy.query_result_local(this->_schema, this->_cmd, _partition_ranges, opts, trace_state, timeout);
+        } else {
+            tracing::trace(trace_state, "read_data: sending a message for {} partitions to /{}", _partition_ranges.size(), ep);
+            return proxy._messaging.send_read_data(netw::messaging_service::msg_addr{ep, 0}, timeout, *this->_cmd, _partition_ranges, opts.digest_algo).then([this, ep](rpc::tuple<query::result, rpc::optional<cache_temperature>> result_hit_rate) {
+                auto&& [result, hit_rate] = result_hit_rate;
+                tracing::trace(this->_trace_state, "read_data: got response from /{}", ep);
+                return make_ready_future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>>(rpc::tuple(make_foreign(::make_lw_shared<query::result>(std::move(result))), hit_rate.value_or(cache_temperature::invalid())));
+            });
+        }
+    }
+    virtual future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> make_digest_request(gms::inet_address ep, clock_type::time_point timeout) override {
+        auto& proxy = *this->_proxy;
+        auto& trace_state = this->_trace_state;
+        ++proxy.get_stats().digest_read_attempts.get_ep_stat(ep);
+        if (fbu::is_me(ep)) {
+            tracing::trace(trace_state, "read_digest: querying {} partitions locally", _partition_ranges.size());
+            return proxy.query_result_local_digest(this->_schema, this->_cmd, _partition_ranges, trace_state,
+                        timeout, digest_algorithm(proxy));
+        } else {
+            tracing::trace(trace_state, "read_digest: sending a message for {} partitions to /{}", _partition_ranges.size(), ep);
+            return proxy._messaging.send_read_digest(netw::messaging_service::msg_addr{ep, 0}, timeout, *this->_cmd,
+                        _partition_ranges, digest_algorithm(proxy)).then([this, ep] (
+                    rpc::tuple<query::result_digest, rpc::optional<api::timestamp_type>, rpc::optional<cache_temperature>> digest_timestamp_hit_rate) {
+                auto&& [d, t, hit_rate] = digest_timestamp_hit_rate;
+                tracing::trace(this->_trace_state, "read_digest: got response from /{}", ep);
+                return make_ready_future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>>(rpc::tuple(d, t ? t.value() : api::missing_timestamp, hit_rate.value_or(cache_temperature::invalid())));
+            });
+        }
+    }
+    virtual void reconcile(db::consistency_level cl, storage_proxy::clock_type::time_point timeout) override {
+        auto& proxy = *this->_proxy;
+        proxy.get_stats().multi_partition_read_fallbacks++;
+        tracing::trace(this->_trace_state, "Digest mismatch, reading {} partitions one by one", _partition_ranges.size());
+        std::vector<::shared_ptr<abstract_read_executor>> execs;
+        execs.reserve(_partition_ranges.size());
+        bool is_read_non_local = false;
+        for (auto& pr : _partition_ranges) {
+            execs.push_back(proxy.get_read_executor(this->_cmd, this->_schema, pr, cl, db::read_repair_decision::NONE,
+                    this->_trace_state, {}, is_read_non_local, this->_permit));
+        }
+        query::result_merger merger(this->_cmd->get_row_limit(), this->_cmd->partition_limit);
+        merger.reserve(execs.size());
+        auto f = ::map_reduce(execs.begin(), execs.end(), [timeout] (::shared_ptr<abstract_read_executor>& rex) {
+            return rex->execute(timeout);
+        }, std::move(merger));
+        // Waited on indirectly.
+        (void)f.then_wrapped([this, exec = this->shared_from_this(), execs = std::move(execs)] (future<foreign_ptr<lw_shared_ptr<query::result>>> f) {
+            if (f.failed()) {
+                this->_result_promise.set_exception(f.get_exception());
+            } else {
+                this->_result_promise.set_value(f.get0());
+            }
+            this->on_read_resolved();
+        });
+    }
+};
+
+// Makes an Executor reading a single partition, or a multi_partition_read_executor<Executor>
+// reading all of `grouped_ranges` if it isn't null.
+template <typename Executor, typename... Args>
+static ::shared_ptr<abstract_read_executor> make_read_executor(dht::partition_range_vector* grouped_ranges, Args&&... args) {
+    if (grouped_ranges) {
+        return ::make_shared<multi_partition_read_executor<Executor>>(std::move(*grouped_ranges), std::forward<Args>(args)...);
+    }
+    return ::make_shared<Executor>(std::forward<Args>(args)...);
+}
+
+void storage_proxy::add_speculation_budget() {
+    // Allow short bursts, e.g. when a replica stalls for a moment.
+    constexpr double max_speculation_budget = 100;
+    _speculation_budget = std::min(_speculation_budget + _db.local().get_config().speculative_retry_budget(), max_speculation_budget);
+}
+
+bool storage_proxy::consume_speculation_budget() {
+    if (_db.local().get_config().speculative_retry_budget() <= 0) {
+        return true;
+    }
+    if (_speculation_budget < 1) {
+        return false;
+    }
+    _speculation_budget -= 1;
+    return true;
+}
+
 db::read_repair_decision storage_proxy::new_read_repair_decision(const schema& s) {
     double chance = _read_repair_chance(_urandom);
     if (s.read_repair_chance() > chance) {
@@ -3816,7 +4041,8 @@ ::shared_ptr<abstract_read_executor> storage_proxy::get_read_executor(lw_shared_
         tracing::trace_state_ptr trace_state,
         const std::vector<gms::inet_address>& preferred_endpoints,
         bool& is_read_non_local,
-        service_permit permit) {
+        service_permit permit,
+        dht::partition_range_vector* grouped_ranges) {
     const dht::token& token = pr.start()->value().token();
     keyspace& ks = _db.local().find_keyspace(schema->ks_name());
     speculative_retry::type retry_type = schema->speculative_retry().get_type();
@@ -3832,7 +4058,7 @@ ::shared_ptr<abstract_read_executor> storage_proxy::get_read_executor(lw_shared_
     auto cf = _db.local().find_column_family(schema).shared_from_this();
     std::vector<gms::inet_address> target_replicas = db::filter_for_query(cl, ks, all_replicas, preferred_endpoints, repair_decision,
             retry_type == speculative_retry::type::NONE ? nullptr : &extra_replica,
-            _db.local().get_config().cache_hit_rate_read_balancing() ? &*cf : nullptr);
+            _db.local().get_config().cache_hit_rate_read_balancing() ? &*cf : nullptr, _dynamic_snitch.get());
 
     slogger.trace("creating read executor for token {} with all: {} targets: {} rp decision: {}", token, all_replicas, target_replicas, repair_decision);
     tracing::trace(trace_state, "Creating read executor for token {} with all: {} targets: {} repair decision: {}", token, all_replicas, target_replicas, repair_decision);
@@ -3855,21 +4081,21 @@ ::shared_ptr<abstract_read_executor> storage_proxy::get_read_executor(lw_shared_
     // Speculative retry is disabled *OR* there are simply no extra replicas to speculate.
     if (retry_type == speculative_retry::type::NONE || block_for == all_replicas.size()
             || (repair_decision == db::read_repair_decision::DC_LOCAL && is_datacenter_local(cl) && block_for == target_replicas.size())) {
-        return ::make_shared<never_speculating_read_executor>(schema, cf, p, cmd, std::move(pr), cl, std::move(target_replicas), std::move(trace_state), std::move(permit));
+        return make_read_executor<never_speculating_read_executor>(grouped_ranges, schema, cf, p, cmd, std::move(pr), cl, std::move(target_replicas), std::move(trace_state), std::move(permit));
     }
 
     if (target_replicas.size() == all_replicas.size()) {
         // CL.ALL, RRD.GLOBAL or RRD.DC_LOCAL and a single-DC.
         // We are going to contact every node anyway, so ask for 2 full data requests instead of 1, for redundancy
         // (same amount of requests in total, but we turn 1 digest request into a full blown data request).
-        return ::make_shared<always_speculating_read_executor>(schema, cf, p, cmd, std::move(pr), cl, block_for, std::move(target_replicas), std::move(trace_state), std::move(permit));
+        return make_read_executor<always_speculating_read_executor>(grouped_ranges, schema, cf, p, cmd, std::move(pr), cl, block_for, std::move(target_replicas), std::move(trace_state), std::move(permit));
     }
 
     // RRD.NONE or RRD.DC_LOCAL w/ multiple DCs.
     if (target_replicas.size() == block_for) { // If RRD.DC_LOCAL extra replica may already be present
         if (is_datacenter_local(cl) && !db::is_local(extra_replica)) {
             slogger.trace("read executor no extra target to speculate");
-            return ::make_shared<never_speculating_read_executor>(schema, cf, p, cmd, std::move(pr), cl, std::move(target_replicas), std::move(trace_state), std::move(permit));
+            return make_read_executor<never_speculating_read_executor>(grouped_ranges, schema, cf, p, cmd, std::move(pr), cl, std::move(target_replicas), std::move(trace_state), std::move(permit));
         } else {
             target_replicas.push_back(extra_replica);
             slogger.trace("creating read executor with extra target {}", extra_replica);
@@ -3877,9 +4103,9 @@ ::shared_ptr<abstract_read_executor> storage_proxy::get_read_executor(lw_shared_
     }
 
     if (retry_type == speculative_retry::type::ALWAYS) {
-        return ::make_shared<always_speculating_read_executor>(schema, cf, p, cmd, std::move(pr), cl, block_for, std::move(target_replicas), std::move(trace_state), std::move(permit));
+        return make_read_executor<always_speculating_read_executor>(grouped_ranges, schema, cf, p, cmd, std::move(pr), cl, block_for, std::move(target_replicas), std::move(trace_state), std::move(permit));
     } else {// PERCENTILE or CUSTOM.
-        return ::make_shared<speculating_read_executor>(schema, cf, p, cmd, std::move(pr), cl, block_for, std::move(target_replicas), std::move(trace_state), std::move(permit));
+        return make_read_executor<speculating_read_executor>(grouped_ranges, schema, cf, p, cmd, std::move(pr), cl, block_for, std::move(target_replicas), std::move(trace_state), std::move(permit));
     }
 }
 
@@ -3919,6 +4145,74 @@ storage_proxy::query_result_local(schema_ptr s, lw_shared_ptr<query::read_comman
     }
 }
 
+future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>>
+storage_proxy::query_result_local_digest(schema_ptr s, lw_shared_ptr<query::read_command> cmd, dht::partition_range_vector prs, tracing::trace_state_ptr trace_state, storage_proxy::clock_type::time_point timeout, query::digest_algorithm da) {
+    return query_result_local(std::move(s), std::move(cmd), std::move(prs), query::result_options::only_digest(da), std::move(trace_state), timeout).then([] (rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature> result_and_hit_rate) {
+        auto&& [result, hit_rate] = result_and_hit_rate;
+        return make_ready_future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>>(rpc::tuple(*result->digest(), result->last_modified(), hit_rate));
+    });
+}
+
+future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>>
+storage_proxy::query_result_local(schema_ptr s, lw_shared_ptr<query::read_command> cmd, dht::partition_range_vector prs, query::result_options opts,
+                                  tracing::trace_state_ptr trace_state, storage_proxy::clock_type::time_point timeout) {
+    if (prs.size() == 1) {
+        co_return co_await query_result_local(std::move(s), std::move(cmd), prs.front(), opts, std::move(trace_state), timeout);
+    }
+    // Each partition is queried separately, so that the digest of the result
+    // doesn't depend on how the partitions are distributed among the shards of
+    // the replica, which differs from one replica to another. The partitions
+    // are read one after the other, each with what is left of the limits, so
+    // that no more than the command asks for is read, and every result read
+    // is merged as a whole. Their digests then cover exactly the merged
+    // result. The row counts are needed for the limits, so a digest request
+    // reads the results too.
+    tracing::trace(trace_state, "Start querying {} partitions", prs.size());
+    auto range_opts = opts;
+    if (opts.request == query::result_request::only_digest) {
+        range_opts.request = query::result_request::result_and_digest;
+    }
+    auto range_cmd = make_lw_shared<query::read_command>(*cmd);
+    auto row_limit = cmd->get_row_limit();
+    auto partition_limit = cmd->partition_limit;
+    auto hit_rate = cache_temperature::invalid();
+    std::optional<query::digester> digester;
+    if (opts.request != query::result_request::only_result) {
+        digester.emplace(opts.digest_algo);
+    }
+    auto last_modified = api::missing_timestamp;
+    query::result_merger merger(cmd->get_row_limit(), cmd->partition_limit);
+    merger.reserve(prs.size());
+    size_t results = 0;
+    for (auto& pr : prs) {
+        range_cmd->set_row_limit(row_limit);
+        range_cmd->partition_limit = partition_limit;
+        auto [r, ht] = co_await query_result_local(s, range_cmd, pr, range_opts, trace_state, timeout);
+        if (results++ == 0) {
+            hit_rate = ht;
+        }
+        if (digester) {
+            auto& d = r->digest()->get();
+            digester->feed_hash(bytes_view(reinterpret_cast<const int8_t*>(d.data()), d.size()));
+            last_modified = std::max(last_modified, r->last_modified());
+        }
+        row_limit -= std::min(row_limit, *r->row_count());
+        partition_limit -= std::min(partition_limit, *r->partition_count());
+        auto is_short_read = r->is_short_read();
+        merger(std::move(r));
+        if (is_short_read || !row_limit || !partition_limit) {
+            break;
+        }
+    }
+    auto result = merger.get();
+    // A single result already carries its own digest.
+    if (digester && results > 1) {
+        result->set_digest(query::result_digest(digester->finalize_array()), last_modified);
+    }
+    tracing::trace(trace_state, "Querying is done");
+    co_return rpc::tuple(std::move(result), hit_rate);
+}
+
 void storage_proxy::handle_read_error(std::exception_ptr eptr, bool range) {
     try {
         std::rethrow_exception(eptr);
@@ -3939,26 +4233,51 @@ storage_proxy::query_singular(lw_shared_ptr<query::read_command> cmd,
         dht::partition_range_vector&& partition_ranges,
         db::consistency_level cl,
         storage_proxy::coordinator_query_options query_options) {
-    std::vector<std::pair<::shared_ptr<abstract_read_executor>, dht::token_range>> exec;
+    // An executor and the positions, in partition_ranges, of the partitions it reads.
+    struct partitions_read {
+        ::shared_ptr<abstract_read_executor> executor;
+        std::vector<size_t> positions;
+        // The ranges of the partitions, if the executor reads several of them.
+        dht::partition_range_vector ranges;
+    };
+    std::vector<partitions_read> exec;
     exec.reserve(partition_ranges.size());
+    auto token_ranges = make_lw_shared<std::vector<dht::token_range>>();
+    token_ranges->reserve(partition_ranges.size());
 
     schema_ptr schema = local_schema_registry().get(cmd->schema_version);
 
     db::read_repair_decision repair_decision = query_options.read_repair_decision
         ? *query_options.read_repair_decision : new_read_repair_decision(*schema);
 
+    // Partitions owned by the same replicas are read with a single request to
+    // each of them. The result is split back into partitions by their keys, so
+    // they have to be a part of it.
+    const bool group_by_replicas = partition_ranges.size() > 1
+            && repair_decision == db::read_repair_decision::NONE
+            && cmd->slice.options.contains<query::partition_slice::option::send_partition_key>()
+            && _features.cluster_supports_multi_partition_read();
+    std::map<std::vector<gms::inet_address>, std::vector<size_t>> partitions_by_replicas;
+
     // Update reads_coordinator_outside_replica_set once per request,
     // not once per partition.
     bool is_read_non_local = false;
 
     const auto tmptr = get_token_metadata_ptr();
-    for (auto&& pr: partition_ranges) {
+    for (size_t i = 0; i < partition_ranges.size(); ++i) {
+        auto& pr = partition_ranges[i];
         if (!pr.is_singular()) {
             throw std::runtime_error("mixed singular and non singular range are not supported");
         }
 
-        auto token_range = dht::token_range::make_singular(pr.start()->value().token());
-        auto it = query_options.preferred_replicas.find(token_range);
+        const auto& token = pr.start()->value().token();
+        token_ranges->push_back(dht::token_range::make_singular(token));
+        auto it = query_options.preferred_replicas.find(token_ranges->back());
+        if (group_by_replicas && it == query_options.preferred_replicas.end()) {
+            keyspace& ks = _db.local().find_keyspace(schema->ks_name());
+            partitions_by_replicas[get_live_sorted_endpoints(ks, token)].push_back(i);
+            continue;
+        }
         const auto replicas = it == query_options.preferred_replicas.end()
             ? std::vector<gms::inet_address>{} : replica_ids_to_endpoints(*tmptr, it->second);
 
@@ -3966,49 +4285,109 @@ storage_proxy::query_singular(lw_shared_ptr<query::read_command> cmd,
                                                query_options.trace_state, replicas, is_read_non_local,
                                                query_options.permit);
 
-        exec.emplace_back(read_executor, std::move(token_range));
+        exec.push_back(partitions_read{std::move(read_executor), {i}});
+    }
+    for (auto& [all_replicas, positions] : partitions_by_replicas) {
+        if (positions.size() == 1) {
+            auto read_executor = get_read_executor(cmd, schema, std::move(partition_ranges[positions.front()]), cl, repair_decision,
+                                                   query_options.trace_state, {}, is_read_non_local, query_options.permit);
+            exec.push_back(partitions_read{std::move(read_executor), std::move(positions)});
+            continue;
+        }
+
+        dht::partition_range_vector ranges;
+        ranges.reserve(positions.size());
+        for (auto i : positions) {
+            ranges.push_back(std::move(partition_ranges[i]));
+        }
+        auto first_range = ranges.front();
+        slogger.trace("creating read executor for {} partitions", ranges.size());
+        tracing::trace(query_options.trace_state, "Creating read executor for {} partitions", ranges.size());
+        // Keep a copy of the ranges to split the result back into partitions.
+        auto grouped_ranges = ranges;
+        auto read_executor = get_read_executor(cmd, schema, std::move(first_range), cl, repair_decision,
+                query_options.trace_state, {}, is_read_non_local, query_options.permit, &grouped_ranges);
+        exec.push_back(partitions_read{std::move(read_executor), std::move(positions), std::move(ranges)});
     }
     if (is_read_non_local) {
         get_stats().reads_coordinator_outside_replica_set++;
     }
 
-    query::result_merger merger(cmd->get_row_limit(), cmd->partition_limit);
-    merger.reserve(exec.size());
-
     auto used_replicas = make_lw_shared<replicas_per_token_range>();
+    // Results of the partitions, in the order of partition_ranges.
+    auto results = make_lw_shared<std::vector<foreign_ptr<lw_shared_ptr<query::result>>>>(partition_ranges.size());
 
-    auto f = ::map_reduce(exec.begin(), exec.end(), [p = shared_from_this(), timeout = query_options.timeout(*this), used_replicas, tmptr] (
-                std::pair<::shared_ptr<abstract_read_executor>, dht::token_range>& executor_and_token_range) {
-        auto& rex = std::get<0>(executor_and_token_range);
-        auto& token_range = std::get<1>(executor_and_token_range);
+    auto f = parallel_for_each(exec, [p = shared_from_this(), timeout = query_options.timeout(*this), used_replicas, results, token_ranges, tmptr, schema] (
+                partitions_read& read) {
+        auto& rex = read.executor;
         utils::latency_counter lc;
         lc.start();
-        return rex->execute(timeout).then_wrapped([p = std::move(p), lc, rex, used_replicas, token_range = std::move(token_range), tmptr] (
+        return rex->execute(timeout).then_wrapped([p = std::move(p), lc, rex, &read, used_replicas, results, token_ranges, tmptr, schema] (
                     future<foreign_ptr<lw_shared_ptr<query::result>>> f) mutable {
             if (!f.failed()) {
-                used_replicas->emplace(std::move(token_range), endpoints_to_replica_ids(*tmptr, rex->used_targets()));
+                auto replica_ids = endpoints_to_replica_ids(*tmptr, rex->used_targets());
+                for (auto i : read.positions) {
+                    used_replicas->emplace((*token_ranges)[i], replica_ids);
+                }
             }
             if (lc.is_start()) {
                 rex->get_cf()->add_coordinator_read_latency(lc.stop().latency());
             }
-            return std::move(f);
+            auto result = f.get0();
+            if (read.positions.size() == 1) {
+                (*results)[read.positions.front()] = std::move(result);
+                return;
+            }
+            auto partition_results = query::split_result(*schema, *result, read.ranges);
+            for (size_t i = 0; i < partition_results.size(); ++i) {
+                (*results)[read.positions[i]] = std::move(partition_results[i]);
+            }
         });
-    }, std::move(merger));
+    });
 
     return f.then_wrapped([exec = std::move(exec),
             p = shared_from_this(),
             used_replicas,
-            repair_decision] (future<foreign_ptr<lw_shared_ptr<query::result>>> f) {
+            results,
+            row_limit = cmd->get_row_limit(),
+            partition_limit = cmd->partition_limit,
+            repair_decision] (future<> f) {
         if (f.failed()) {
             auto eptr = f.get_exception();
             // hold onto exec until read is complete
             p->handle_read_error(eptr, false);
             return make_exception_future<storage_proxy::coordinator_query_result>(eptr);
         }
-        return make_ready_future<coordinator_query_result>(coordinator_query_result(std::move(f.get0()), std::move(*used_replicas), repair_decision));
+        query::result_merger merger(row_limit, partition_limit);
+        merger.reserve(results->size());
+        for (auto& r : *results) {
+            merger(std::move(r));
+        }
+        return make_ready_future<coordinator_query_result>(coordinator_query_result(merger.get(), std::move(*used_replicas), repair_decision));
     });
 }
 
+// Starting every page from a single range and doubling the concurrency until
+// the page is full costs several round trips per page on sparse tables, while
+// overshooting makes the replicas read past the end of the page and drop the
+// readers they saved in their querier cache for the next one. The estimate is
+// capped at twice the concurrency this page ended with, which is what the next
+// round of this page would have used, and at max_initial_range_concurrency.
+//
+// A page cut short by the size limit would be cut again by it, however dense
+// the rows: the next one only needs as many ranges as this one read.
+uint32_t estimate_next_concurrency_factor(uint64_t page_rows, uint64_t rows_fetched, bool short_read, size_t ranges_queried, int concurrency_factor) {
+    const uint64_t max_concurrency_factor = std::min(uint64_t(concurrency_factor) * 2, uint64_t(max_initial_range_concurrency));
+    if (!rows_fetched || !ranges_queried) {
+        return max_concurrency_factor;
+    }
+    if (short_read) {
+        page_rows = rows_fetched;
+    }
+    const double estimate = std::ceil(double(page_rows) * ranges_queried / rows_fetched);
+    return std::max(uint64_t(1), uint64_t(std::min(estimate, double(max_concurrency_factor))));
+}
+
 future<query_partition_key_range_concurrent_result>
 storage_proxy::query_partition_key_range_concurrent(storage_proxy::clock_type::time_point timeout,
         std::vector<foreign_ptr<lw_shared_ptr<query::result>>>&& results,
@@ -4020,7 +4399,8 @@ storage_proxy::query_partition_key_range_concurrent(storage_proxy::clock_type::t
         uint64_t remaining_row_count,
         uint32_t remaining_partition_count,
         replicas_per_token_range preferred_replicas,
-        service_permit permit) {
+        service_permit permit,
+        size_t ranges_queried) {
     schema_ptr schema = local_schema_registry().get(cmd->schema_version);
     keyspace& ks = _db.local().find_keyspace(schema->ks_name());
     std::vector<::shared_ptr<abstract_read_executor>> exec;
@@ -4048,12 +4428,13 @@ storage_proxy::query_partition_key_range_concurrent(storage_proxy::clock_type::t
     // eventualy zero out resulting in an infinite recursion. This line makes sure that concurrency factor is never
     // get stuck on 0 and never increased too much if the number of results remains small.
     concurrency_factor = std::max(size_t(1), ranges.size());
+    ranges_queried += ranges.size();
 
     while (i != ranges.end()) {
         dht::partition_range& range = *i;
         std::vector<gms::inet_address> live_endpoints = get_live_sorted_endpoints(ks, end_token(range));
         std::vector<gms::inet_address> merged_preferred_replicas = preferred_replicas_for_range(*i);
-        std::vector<gms::inet_address> filtered_endpoints = filter_for_query(cl, ks, live_endpoints, merged_preferred_replicas, pcf);
+        std::vector<gms::inet_address> filtered_endpoints = filter_for_query(cl, ks, live_endpoints, merged_preferred_replicas, pcf, _dynamic_snitch.get());
         std::vector<dht::token_range> merged_ranges{to_token_range(range)};
         ++i;
 
@@ -4065,7 +4446,7 @@ storage_proxy::query_partition_key_range_concurrent(storage_proxy::clock_type::t
             const auto current_range_preferred_replicas = preferred_replicas_for_range(*i);
             dht::partition_range& next_range = *i;
             std::vector<gms::inet_address> next_endpoints = get_live_sorted_endpoints(ks, end_token(next_range));
-            std::vector<gms::inet_address> next_filtered_endpoints = filter_for_query(cl, ks, next_endpoints, current_range_preferred_replicas, pcf);
+            std::vector<gms::inet_address> next_filtered_endpoints = filter_for_query(cl, ks, next_endpoints, current_range_preferred_replicas, pcf, _dynamic_snitch.get());
 
             // Origin has this to say here:
             // *  If the current range right is the min token, we should stop merging because CFS.getRangeSlice
@@ -4086,7 +4467,7 @@ storage_proxy::query_partition_key_range_concurrent(storage_proxy::clock_type::t
                 break;
             }
 
-            std::vector<gms::inet_address> filtered_merged = filter_for_query(cl, ks, merged, current_merged_preferred_replicas, pcf);
+            std::vector<gms::inet_address> filtered_merged = filter_for_query(cl, ks, merged, current_merged_preferred_replicas, pcf, _dynamic_snitch.get());
 
             // Estimate whether merging will be a win or not
             if (!locator::i_endpoint_snitch::get_local_snitch_ptr()->is_worth_merging_for_range_query(filtered_merged, filtered_endpoints, next_filtered_endpoints)) {
@@ -4154,7 +4535,8 @@ storage_proxy::query_partition_key_range_concurrent(storage_proxy::clock_type::t
             trace_state = std::move(trace_state),
             preferred_replicas = std::move(preferred_replicas),
             ranges_per_exec = std::move(ranges_per_exec),
-            permit = std::move(permit)] (foreign_ptr<lw_shared_ptr<query::result>>&& result) mutable {
+            permit = std::move(permit),
+            ranges_queried] (foreign_ptr<lw_shared_ptr<query::result>>&& result) mutable {
         result->ensure_counts();
         remaining_row_count -= result->row_count().value();
         remaining_partition_count -= result->partition_count().value();
@@ -4172,12 +4554,22 @@ storage_proxy::query_partition_key_range_concurrent(storage_proxy::clock_type::t
                     used_replicas.emplace(std::move(r), replica_ids);
                 }
             }
-            return make_ready_future<query_partition_key_range_concurrent_result>(query_partition_key_range_concurrent_result{std::move(results), std::move(used_replicas)});
+            uint64_t rows_fetched = 0;
+            bool short_read = false;
+            for (auto& r : results) {
+                rows_fetched += r->row_count().value();
+                short_read = short_read || r->is_short_read();
+            }
+            auto next_concurrency_factor = estimate_next_concurrency_factor(rows_fetched + remaining_row_count, rows_fetched,
+                    short_read, ranges_queried, concurrency_factor);
+            return make_ready_future<query_partition_key_range_concurrent_result>(query_partition_key_range_concurrent_result{
+                    std::move(results), std::move(used_replicas), next_concurrency_factor});
         } else {
             cmd->set_row_limit(remaining_row_count);
             cmd->partition_limit = remaining_partition_count;
             return p->query_partition_key_range_concurrent(timeout, std::move(results), cmd, cl, std::move(ranges_to_vnodes),
-                    concurrency_factor * 2, std::move(trace_state), remaining_row_count, remaining_partition_count, std::move(preferred_replicas), std::move(permit));
+                    concurrency_factor * 2, std::move(trace_state), remaining_row_count, remaining_partition_count, std::move(preferred_replicas), std::move(permit),
+                    ranges_queried);
         }
     }).handle_exception([p] (std::exception_ptr eptr) {
         p->handle_read_error(eptr, true);
@@ -4197,13 +4589,16 @@ storage_proxy::query_partition_key_range(lw_shared_ptr<query::read_command> cmd,
     // expensive in clusters with vnodes)
     query_ranges_to_vnodes_generator ranges_to_vnodes(get_token_metadata_ptr(), schema, std::move(partition_ranges), ks.get_replication_strategy().get_type() == locator::replication_strategy_type::local);
 
-    int result_rows_per_range = 0;
-    int concurrency_factor = 1;
+    // Pages of a range scan resume with the concurrency estimated from the
+    // density of the rows read by the previous page, see
+    // estimate_next_concurrency_factor(). The value comes from the paging
+    // state sent by the client, so it is clamped to what a previous page could
+    // have produced.
+    int concurrency_factor = std::clamp<uint32_t>(query_options.range_concurrency, 1, max_initial_range_concurrency);
 
     std::vector<foreign_ptr<lw_shared_ptr<query::result>>> results;
 
-    slogger.debug("Estimated result rows per range: {}; requested rows: {}, concurrent range requests: {}",
-            result_rows_per_range, cmd->get_row_limit(), concurrency_factor);
+    slogger.debug("Requested rows: {}, concurrent range requests: {}", cmd->get_row_limit(), concurrency_factor);
 
     // The call to `query_partition_key_range_concurrent()` below
     // updates `cmd` directly when processing the results. Under
@@ -4240,7 +4635,8 @@ storage_proxy::query_partition_key_range(lw_shared_ptr<query::read_command> cmd,
             merger(std::move(r));
         }
 
-        return make_ready_future<coordinator_query_result>(coordinator_query_result(merger.get(), std::move(used_replicas)));
+        return make_ready_future<coordinator_query_result>(coordinator_query_result(merger.get(), std::move(used_replicas),
+                db::read_repair_decision::NONE, result.next_concurrency_factor));
     });
 }
 
@@ -4371,6 +4767,38 @@ static lw_shared_ptr<query::read_command> read_nothing_read_command(schema_ptr s
             query::max_result_size(query::result_memory_limiter::unlimited_result_size));
 }
 
+// A CAS request waiting to be executed in a Paxos round, possibly shared with
+// other requests on the same partition, see storage_proxy::run_cas_batch().
+struct storage_proxy::cas_batch_entry {
+    shared_ptr<cas_request> request;
+    lw_shared_ptr<query::read_command> cmd;
+    dht::partition_range_vector partition_ranges;
+    coordinator_query_options query_options;
+    shared_ptr<paxos_response_handler> handler;
+    bool write;
+    unsigned contentions = 0;
+    // Resolved with whether the condition was met once the round completes.
+    promise<bool> done;
+    // Whether the request waits in a cas_queue, rather than being executed.
+    bool queued = false;
+    // Set when the request timed out while queued, its promise is resolved.
+    bool expired = false;
+    // Fails the request if it is still queued at its timeout.
+    timer<clock_type> expiry;
+
+    // Requests can share a Paxos round only if they agree on everything
+    // the round is parametrized with. The round runs with the timeouts of
+    // its first request, so a request which times out earlier can't join it.
+    bool can_share_round_with(const cas_batch_entry& o) const;
+};
+
+// The CAS requests waiting for a Paxos round on a given token.
+struct storage_proxy::cas_queue {
+    std::deque<lw_shared_ptr<cas_batch_entry>> pending;
+    // Whether run_cas_queue() is executing rounds for the queue.
+    bool running = false;
+};
+
 static read_timeout_exception write_timeout_to_read(schema_ptr s, mutation_write_timeout_exception& ex) {
     return read_timeout_exception(s->ks_name(), s->cf_name(), ex.consistency, ex.received, ex.block_for, false);
 }
@@ -4418,6 +4846,12 @@ static mutation_write_failure_exception read_failure_to_write(schema_ptr s, read
  * values) between the prepare and accept phases. This gives us a slightly longer window for another
  * coordinator to come along and trump our own promise with a newer one but is otherwise safe.
  *
+ * Only one Paxos round per partition runs at a time on a coordinator. Requests arriving for a partition
+ * while a round is in progress are queued, and the next round is executed on behalf of up to
+ * cas_max_batch_size of them: their conditions are evaluated one after another and the updates of those
+ * which apply are proposed as a single value. Each request gets its own result, the same it would have
+ * got if the requests were executed in sequence. See run_cas_batch().
+ *
  * NOTE: `cmd` argument can be nullptr, in which case it's guaranteed that this function would not perform
  * any reads of commited values (in case user of the function is not interested in them).
  *
@@ -4457,12 +4891,23 @@ future<bool> storage_proxy::cas(schema_ptr schema, shared_ptr<cas_request> reque
         throw;
     }
 
-    db::consistency_level cl = cl_for_paxos == db::consistency_level::LOCAL_SERIAL ?
-        db::consistency_level::LOCAL_QUORUM : db::consistency_level::QUORUM;
-
-    unsigned contentions;
+    auto entry = make_lw_shared<cas_batch_entry>(cas_batch_entry{
+        .request = std::move(request),
+        .cmd = std::move(cmd),
+        .partition_ranges = std::move(partition_ranges),
+        .query_options = std::move(query_options),
+        .handler = handler,
+        .write = write,
+    });
+    entry->expiry.set_callback([e = entry.get()] {
+        if (e->queued) {
+            // Timed out waiting for its turn, as it would have done waiting for the row lock.
+            // The entry is dropped from the queue when the next batch is formed.
+            e->expired = true;
+            e->done.set_exception(seastar::semaphore_timed_out());
+        }
+    });
 
-    dht::token token = partition_ranges[0].start()->value().as_decorated_key().token();
     utils::latency_counter lc;
     lc.start();
 
@@ -4476,57 +4921,273 @@ future<bool> storage_proxy::cas(schema_ptr schema, shared_ptr<cas_request> reque
                 write ? get_stats().estimated_cas_write.add(lc.latency()) :
                         get_stats().estimated_cas_read.add(lc.latency());
             }
-            if (contentions > 0) {
-                write ? get_stats().cas_write_contention.add(contentions) : get_stats().cas_read_contention.add(contentions);
+            if (entry->contentions > 0) {
+                write ? get_stats().cas_write_contention.add(entry->contentions) : get_stats().cas_read_contention.add(entry->contentions);
             }
         });
 
-        paxos::paxos_state::guard l = co_await paxos::paxos_state::get_cas_lock(token, write_timeout);
+        auto f = entry->done.get_future();
+        auto& queue = _cas_queues[handler->key_token()];
+        if (!queue) {
+            queue = make_lw_shared<cas_queue>();
+        }
+        if (!queue->running) {
+            // The first request to arrive runs the Paxos rounds on behalf of
+            // all requests queued for the same token until the queue drains.
+            // Throws if the proxy is stopping, before the request is queued.
+            _cas_queues_gate.enter();
+            queue->running = true;
+            // run_cas_queue() doesn't fail, its requests are resolved with the errors.
+            (void)run_cas_queue(handler->key_token(), queue).finally([this] {
+                _cas_queues_gate.leave();
+            });
+        }
+        entry->queued = true;
+        entry->expiry.arm(handler->timeout());
+        queue->pending.push_back(entry);
+        condition_met = co_await std::move(f);
+        entry->expiry.cancel();
+    } catch (read_failure_exception& ex) {
+        write ? throw read_failure_to_write(schema, ex) : throw;
+    } catch (read_timeout_exception& ex) {
+        if (write) {
+            get_stats().cas_write_timeouts.mark();
+            throw read_timeout_to_write(schema, ex);
+        } else {
+            get_stats().cas_read_timeouts.mark();
+            throw;
+        }
+    } catch (mutation_write_failure_exception& ex) {
+        write ? throw : throw write_failure_to_read(schema, ex);
+    } catch (mutation_write_timeout_exception& ex) {
+        if (write) {
+            get_stats().cas_write_timeouts.mark();
+            throw;
+        } else {
+            get_stats().cas_read_timeouts.mark();
+            throw write_timeout_to_read(schema, ex);
+        }
+    } catch (exceptions::unavailable_exception& ex) {
+        write ? get_stats().cas_write_unavailables.mark() :  get_stats().cas_read_unavailables.mark();
+        throw;
+    } catch (seastar::semaphore_timed_out& ex) {
+        paxos::paxos_state::logger.trace("CAS[{}]: timeout while waiting for row lock {}", handler->id());
+        if (write) {
+            get_stats().cas_write_timeouts.mark();
+            throw mutation_write_timeout_exception(schema->ks_name(), schema->cf_name(), cl_for_paxos, 0,  handler->block_for(), db::write_type::CAS);
+        } else {
+            get_stats().cas_read_timeouts.mark();
+            throw read_timeout_exception(schema->ks_name(), schema->cf_name(), cl_for_paxos, 0,  handler->block_for(), 0);
+        }
+    }
+
+    co_return condition_met;
+}
+
+// Returns true if the result of reading `slice` may depend on any of the changes in `m`.
+// Conservative: it is enough for a change and the slice to touch the same row.
+static bool cas_read_depends_on(const schema& s, const mutation& m, const query::partition_slice& slice) {
+    const mutation_partition& p = m.partition();
+    if (p.partition_tombstone() || !p.row_tombstones().empty()) {
+        return true;
+    }
+    if (!p.static_row().empty() && (slice.static_columns.size() || slice.options.contains<query::partition_slice::option::always_return_static_content>())) {
+        return true;
+    }
+    auto cmp = clustering_key_prefix::prefix_equal_tri_compare(s);
+    const auto& ranges = slice.row_ranges(s, m.key());
+    for (const rows_entry& e : p.clustered_rows()) {
+        for (const query::clustering_range& r : ranges) {
+            if (r.contains(e.key(), cmp)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Returns true if `a` and `b` modify the same row. As all mutations of a batched
+// CAS round share the ballot timestamp, the outcome of merging them would not
+// follow the order of the requests.
+static bool cas_writes_overlap(const schema& s, const mutation& a, const mutation& b) {
+    const mutation_partition& pa = a.partition();
+    const mutation_partition& pb = b.partition();
+    if (pa.partition_tombstone() || pb.partition_tombstone() || !pa.row_tombstones().empty() || !pb.row_tombstones().empty()) {
+        return true;
+    }
+    if (!pa.static_row().empty() && !pb.static_row().empty()) {
+        return true;
+    }
+    for (const rows_entry& e : pb.clustered_rows()) {
+        if (pa.find_row(s, e.key())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool storage_proxy::cas_batch_entry::can_share_round_with(const cas_batch_entry& o) const {
+    const auto& s = *handler->schema();
+    return write == o.write
+        && s.version() == o.handler->schema()->version()
+        && handler->cl_for_paxos() == o.handler->cl_for_paxos()
+        && handler->cl_for_learn() == o.handler->cl_for_learn()
+        && handler->key().equal(s, o.handler->key())
+        // The round fails the requests which took part in it at the timeouts
+        // of its first request. A request with later timeouts then gets the
+        // timeout before its own deadline, as it does when the outcome of its
+        // own round is unknown, but one with earlier timeouts would wait past
+        // them: it ends the batch and leads the next round instead.
+        && o.handler->timeout() >= handler->timeout()
+        && o.handler->cas_timeout() >= handler->cas_timeout();
+}
+
+future<> storage_proxy::run_cas_queue(dht::token token, lw_shared_ptr<cas_queue> queue) {
+    auto p = shared_from_this();
+    while (!queue->pending.empty()) {
+        std::vector<lw_shared_ptr<cas_batch_entry>> batch;
+        const auto max_batch_size = std::max<uint32_t>(_db.local().get_config().cas_max_batch_size(), 1);
+        const auto now = clock_type::now();
+        while (!queue->pending.empty() && batch.size() < max_batch_size) {
+            auto& e = queue->pending.front();
+            if (e->expired) {
+                queue->pending.pop_front();
+                continue;
+            }
+            if (e->handler->timeout() < now) {
+                e->expiry.cancel();
+                e->done.set_exception(seastar::semaphore_timed_out());
+                queue->pending.pop_front();
+                continue;
+            }
+            if (!batch.empty() && !batch.front()->can_share_round_with(*e)) {
+                break;
+            }
+            e->queued = false;
+            batch.push_back(std::move(e));
+            queue->pending.pop_front();
+        }
+        if (batch.empty()) {
+            continue;
+        }
+        auto deferred = co_await run_cas_batch(std::move(batch));
+        // Requests which could not be completed in this round go first in the next one.
+        for (auto it = deferred.rbegin(); it != deferred.rend(); ++it) {
+            (*it)->queued = true;
+            queue->pending.push_front(std::move(*it));
+        }
+    }
+    _cas_queues.erase(token);
+}
+
+// Runs a single Paxos round on behalf of all the requests in the batch, which all
+// work on the same partition. Conditions are evaluated in the order of the requests and
+// their updates merged into a single proposal. A request whose result could depend on
+// the update of an earlier request of the batch, or which modifies the same rows, ends
+// the batch: it and the requests following it are returned to be executed in the next round.
+// If the round fails, only its leader and the requests whose conditions were evaluated
+// fail, the others are returned as well. The round is governed by the handler and the
+// timeouts of its leader, which are the earliest of the batch, see can_share_round_with().
+future<std::vector<lw_shared_ptr<storage_proxy::cas_batch_entry>>>
+storage_proxy::run_cas_batch(std::vector<lw_shared_ptr<cas_batch_entry>> batch) {
+    auto& leader = *batch.front();
+    auto handler = leader.handler;
+    auto schema = handler->schema();
+    std::vector<lw_shared_ptr<cas_batch_entry>> deferred;
+    // The requests whose conditions were evaluated in the current attempt.
+    std::vector<bool> conditions_met;
+    // The request whose condition is being evaluated.
+    std::optional<size_t> applying;
+
+    db::consistency_level cl = handler->cl_for_paxos() == db::consistency_level::LOCAL_SERIAL ?
+        db::consistency_level::LOCAL_QUORUM : db::consistency_level::QUORUM;
+
+    try {
+        // The ballot must not be older than the last timestamp handed out to any of the
+        // batched clients, or their operations may appear out-of-order (#7801).
+        api::timestamp_type min_timestamp_micros = 0;
+        for (size_t i = 1; i < batch.size(); ++i) {
+            min_timestamp_micros = std::max(min_timestamp_micros, batch[i]->query_options.cstate.get_timestamp_for_paxos(0));
+        }
 
         while (true) {
-            // Finish the previous PAXOS round, if any, and, as a side effect, compute
-            // a ballot (round identifier) which is a) unique b) has good chances of being
-            // recent enough.
-            auto [ballot, qr] = co_await handler->begin_and_repair_paxos(query_options.cstate, contentions, write);
-            // Read the current values and check they validate the conditions.
+            auto [ballot, qr] = co_await handler->begin_and_repair_paxos(leader.query_options.cstate, leader.contentions, leader.write,
+                    min_timestamp_micros);
+            auto ballot_micros = utils::UUID_gen::micros_timestamp(ballot);
+            for (size_t i = 1; i < batch.size(); ++i) {
+                batch[i]->query_options.cstate.get_timestamp_for_paxos(ballot_micros);
+            }
+
+            // Read the current values for all the requests.
+            std::vector<foreign_ptr<lw_shared_ptr<query::result>>> results(batch.size());
             if (qr) {
                 paxos::paxos_state::logger.debug("CAS[{}]: Using prefetched values for CAS precondition",
                         handler->id());
                 tracing::trace(handler->tr_state, "Using prefetched values for CAS precondition");
-            } else {
+                results[0] = std::move(qr);
+            }
+            co_await parallel_for_each(boost::irange<size_t>(0, batch.size()), [&] (size_t i) -> future<> {
+                if (results[i]) {
+                    return make_ready_future<>();
+                }
+                auto& e = *batch[i];
                 paxos::paxos_state::logger.debug("CAS[{}]: Reading existing values for CAS precondition",
-                        handler->id());
-                tracing::trace(handler->tr_state, "Reading existing values for CAS precondition");
+                        e.handler->id());
+                tracing::trace(e.handler->tr_state, "Reading existing values for CAS precondition");
                 ++get_stats().cas_failed_read_round_optimization;
 
-                auto pr = partition_ranges; // cannot move original because it can be reused during retry
-                auto cqr = co_await query(schema, cmd, std::move(pr), cl, query_options);
-                qr = std::move(cqr.query_result);
-            }
+                auto pr = e.partition_ranges; // cannot move original because it can be reused during retry
+                return query(schema, e.cmd, std::move(pr), cl, e.query_options).then([&results, i] (coordinator_query_result cqr) {
+                    results[i] = std::move(cqr.query_result);
+                });
+            });
 
-            auto mutation = request->apply(std::move(qr), cmd->slice, utils::UUID_gen::micros_timestamp(ballot));
-            condition_met = true;
-            if (!mutation) {
-                if (write) {
-                    paxos::paxos_state::logger.debug("CAS[{}] precondition does not match current values", handler->id());
-                    tracing::trace(handler->tr_state, "CAS precondition does not match current values");
+            // Evaluate the conditions in order, as if the requests were executed one after another.
+            std::optional<mutation> batch_mutation;
+            conditions_met.clear();
+            conditions_met.reserve(batch.size());
+            for (size_t i = 0; i < batch.size(); ++i) {
+                auto& e = *batch[i];
+                if (batch_mutation && cas_read_depends_on(*schema, *batch_mutation, e.cmd->slice)) {
+                    break;
+                }
+                applying = i;
+                auto m = e.request->apply(std::move(results[i]), e.cmd->slice, ballot_micros);
+                applying.reset();
+                if (m) {
+                    if (batch_mutation && cas_writes_overlap(*schema, *batch_mutation, *m)) {
+                        break;
+                    }
+                    paxos::paxos_state::logger.debug("CAS[{}] precondition is met; proposing client-requested updates for {}",
+                            e.handler->id(), ballot);
+                    tracing::trace(e.handler->tr_state, "CAS precondition is met; proposing client-requested updates for {}", ballot);
+                    if (batch_mutation) {
+                        batch_mutation->apply(std::move(*m));
+                    } else {
+                        batch_mutation = std::move(m);
+                    }
+                    conditions_met.push_back(true);
+                } else if (e.write) {
+                    paxos::paxos_state::logger.debug("CAS[{}] precondition does not match current values", e.handler->id());
+                    tracing::trace(e.handler->tr_state, "CAS precondition does not match current values");
                     ++get_stats().cas_write_condition_not_met;
-                    condition_met = false;
+                    conditions_met.push_back(false);
+                } else {
+                    conditions_met.push_back(true);
                 }
+            }
+
+            if (!batch_mutation) {
                 // If a condition is not met we still need to complete paxos round to achieve
                 // linearizability otherwise next write attempt may read differnt value as described
                 // in https://github.com/scylladb/scylla/issues/6299
                 // Let's use empty mutation as a value and proceed
-                mutation.emplace(handler->schema(), handler->key());
+                batch_mutation.emplace(handler->schema(), handler->key());
                 // since the value we are writing is dummy we may use minimal consistency level for learn
                 handler->set_cl_for_learn(db::consistency_level::ANY);
-            } else {
-                paxos::paxos_state::logger.debug("CAS[{}] precondition is met; proposing client-requested updates for {}",
-                        handler->id(), ballot);
-                tracing::trace(handler->tr_state, "CAS precondition is met; proposing client-requested updates for {}", ballot);
             }
 
-            auto proposal = make_lw_shared<paxos::proposal>(ballot, freeze(*mutation));
+            auto proposal = make_lw_shared<paxos::proposal>(ballot, freeze(*batch_mutation));
 
             bool is_accepted = co_await handler->accept_proposal(proposal);
             if (is_accepted) {
@@ -4539,56 +5200,48 @@ future<bool> storage_proxy::cas(schema_ptr schema, shared_ptr<cas_request> reque
                     // if learning stage encountered unavailablity error lets re-map it to a write error
                     // since unavailable error means that operation has never ever started which is not
                     // the case here
-                    schema_ptr schema = handler->schema();
                     throw mutation_write_timeout_exception(schema->ks_name(), schema->cf_name(),
                                           e.consistency, e.alive, e.required, db::write_type::CAS);
                 }
                 paxos::paxos_state::logger.debug("CAS[{}] successful", handler->id());
                 tracing::trace(handler->tr_state, "CAS successful");
+                if (batch.size() > 1) {
+                    get_stats().cas_batched_requests += conditions_met.size();
+                }
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    if (i < conditions_met.size()) {
+                        batch[i]->contentions = leader.contentions;
+                        batch[i]->done.set_value(conditions_met[i]);
+                    } else {
+                        deferred.push_back(std::move(batch[i]));
+                    }
+                }
                 break;
             } else {
                 paxos::paxos_state::logger.debug("CAS[{}] PAXOS proposal not accepted (pre-empted by a higher ballot)",
                         handler->id());
                 tracing::trace(handler->tr_state, "PAXOS proposal not accepted (pre-empted by a higher ballot)");
-                ++contentions;
+                ++leader.contentions;
                 co_await sleep_approx_50ms();
             }
         }
-    } catch (read_failure_exception& ex) {
-        write ? throw read_failure_to_write(schema, ex) : throw;
-    } catch (read_timeout_exception& ex) {
-        if (write) {
-            get_stats().cas_write_timeouts.mark();
-            throw read_timeout_to_write(schema, ex);
-        } else {
-            get_stats().cas_read_timeouts.mark();
-            throw;
-        }
-    } catch (mutation_write_failure_exception& ex) {
-        write ? throw : throw write_failure_to_read(schema, ex);
-    } catch (mutation_write_timeout_exception& ex) {
-        if (write) {
-            get_stats().cas_write_timeouts.mark();
-            throw;
-        } else {
-            get_stats().cas_read_timeouts.mark();
-            throw write_timeout_to_read(schema, ex);
-        }
-    } catch (exceptions::unavailable_exception& ex) {
-        write ? get_stats().cas_write_unavailables.mark() :  get_stats().cas_read_unavailables.mark();
-        throw;
-    } catch (seastar::semaphore_timed_out& ex) {
-        paxos::paxos_state::logger.trace("CAS[{}]: timeout while waiting for row lock {}", handler->id());
-        if (write) {
-            get_stats().cas_write_timeouts.mark();
-            throw mutation_write_timeout_exception(schema->ks_name(), schema->cf_name(), cl_for_paxos, 0,  handler->block_for(), db::write_type::CAS);
-        } else {
-            get_stats().cas_read_timeouts.mark();
-            throw read_timeout_exception(schema->ks_name(), schema->cf_name(), cl_for_paxos, 0,  handler->block_for(), 0);
+    } catch (...) {
+        // The outcome of the requests which took part in the round is unknown. Those
+        // which didn't are retried in a round of their own, which fails them
+        // only if it fails for them as well.
+        auto ex = std::current_exception();
+        deferred.clear();
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (i == 0 || i < conditions_met.size() || applying == i) {
+                batch[i]->contentions = leader.contentions;
+                batch[i]->done.set_exception(ex);
+            } else {
+                deferred.push_back(std::move(batch[i]));
+            }
         }
     }
 
-    co_return condition_met;
+    co_return deferred;
 }
 
 std::vector<gms::inet_address> storage_proxy::get_live_endpoints(keyspace& ks, const dht::token& token) const {
@@ -4601,7 +5254,8 @@ std::vector<gms::inet_address> storage_proxy::get_live_endpoints(keyspace& ks, c
 
 void storage_proxy::sort_endpoints_by_proximity(std::vector<gms::inet_address>& eps) {
     locator::i_endpoint_snitch::get_local_snitch_ptr()->sort_by_proximity(utils::fb_utilities::get_broadcast_address(), eps);
-    // FIXME: before dynamic snitch is implement put local address (if present) at the beginning
+    // Put local address (if present) at the beginning. If it turns out to be slow,
+    // the dynamic snitch moves it back, see db::filter_for_query().
     auto it = boost::range::find(eps, utils::fb_utilities::get_broadcast_address());
     if (it != eps.end() && it != eps.begin()) {
         std::iter_swap(it, eps.begin());
@@ -4942,7 +5596,8 @@ void storage_proxy::init_messaging_service(shared_ptr<migration_manager> mm) {
             return netw::messaging_service::no_wait();
         });
     });
-    ms.register_read_data([mm] (const rpc::client_info& cinfo, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda) {
+    ms.register_read_data([mm] (const rpc::client_info& cinfo, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda,
+            rpc::optional<dht::partition_range_vector> additional_ranges) {
         tracing::trace_state_ptr trace_state_ptr;
         auto src_addr = netw::messaging_service::get_source(cinfo);
         if (cmd.trace_info) {
@@ -4956,10 +5611,11 @@ void storage_proxy::init_messaging_service(shared_ptr<migration_manager> mm) {
             auto& cfg = sp->local_db().get_config();
             cmd.max_result_size.emplace(cfg.max_memory_for_unlimited_query_soft_limit(), cfg.max_memory_for_unlimited_query_hard_limit());
         }
-        return do_with(std::move(pr), std::move(sp), std::move(trace_state_ptr), [&cinfo, cmd = make_lw_shared<query::read_command>(std::move(cmd)), src_addr = std::move(src_addr), da, t, mm] (::compat::wrapping_partition_range& pr, shared_ptr<storage_proxy>& p, tracing::trace_state_ptr& trace_state_ptr) mutable {
+        return do_with(std::move(pr), std::move(sp), std::move(trace_state_ptr), [&cinfo, cmd = make_lw_shared<query::read_command>(std::move(cmd)), src_addr = std::move(src_addr), da, t, mm,
+                additional_ranges = additional_ranges.value_or(dht::partition_range_vector())] (::compat::wrapping_partition_range& pr, shared_ptr<storage_proxy>& p, tracing::trace_state_ptr& trace_state_ptr) mutable {
             p->get_stats().replica_data_reads++;
             auto src_ip = src_addr.addr;
-            return mm->get_schema_for_read(cmd->schema_version, std::move(src_addr), p->_messaging).then([cmd, da, &pr, &p, &trace_state_ptr, t] (schema_ptr s) {
+            return mm->get_schema_for_read(cmd->schema_version, std::move(src_addr), p->_messaging).then([cmd, da, &pr, &p, &trace_state_ptr, t, additional_ranges = std::move(additional_ranges)] (schema_ptr s) mutable {
                 auto pr2 = ::compat::unwrap(std::move(pr), *s);
                 if (pr2.second) {
                     // this function assumes singular queries but doesn't validate
@@ -4969,6 +5625,10 @@ void storage_proxy::init_messaging_service(shared_ptr<migration_manager> mm) {
                 opts.digest_algo = da;
                 opts.request = da == query::digest_algorithm::none ? query::result_request::only_result : query::result_request::result_and_digest;
                 auto timeout = t ? *t : db::no_timeout;
+                if (!additional_ranges.empty()) {
+                    additional_ranges.insert(additional_ranges.begin(), std::move(pr2.first));
+                    return p->query_result_local(std::move(s), cmd, std::move(additional_ranges), opts, trace_state_ptr, timeout);
+                }
                 return p->query_result_local(std::move(s), cmd, std::move(pr2.first), opts, trace_state_ptr, timeout);
             }).finally([&trace_state_ptr, src_ip] () mutable {
                 tracing::trace(trace_state_ptr, "read_data handling is done, sending a response to /{}", src_ip);
@@ -5006,7 +5666,8 @@ void storage_proxy::init_messaging_service(shared_ptr<migration_manager> mm) {
             });
         });
     });
-    ms.register_read_digest([mm] (const rpc::client_info& cinfo, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda) {
+    ms.register_read_digest([mm] (const rpc::client_info& cinfo, rpc::opt_time_point t, query::read_command cmd, ::compat::wrapping_partition_range pr, rpc::optional<query::digest_algorithm> oda,
+            rpc::optional<dht::partition_range_vector> additional_ranges) {
         tracing::trace_state_ptr trace_state_ptr;
         auto src_addr = netw::messaging_service::get_source(cinfo);
         if (cmd.trace_info) {
@@ -5018,16 +5679,21 @@ void storage_proxy::init_messaging_service(shared_ptr<migration_manager> mm) {
         if (!cmd.max_result_size) {
             cmd.max_result_size.emplace(cinfo.retrieve_auxiliary<uint64_t>("max_result_size"));
         }
-        return do_with(std::move(pr), get_local_shared_storage_proxy(), std::move(trace_state_ptr), [&cinfo, cmd = make_lw_shared<query::read_command>(std::move(cmd)), src_addr = std::move(src_addr), da, t, mm] (::compat::wrapping_partition_range& pr, shared_ptr<storage_proxy>& p, tracing::trace_state_ptr& trace_state_ptr) mutable {
+        return do_with(std::move(pr), get_local_shared_storage_proxy(), std::move(trace_state_ptr), [&cinfo, cmd = make_lw_shared<query::read_command>(std::move(cmd)), src_addr = std::move(src_addr), da, t, mm,
+                additional_ranges = additional_ranges.value_or(dht::partition_range_vector())] (::compat::wrapping_partition_range& pr, shared_ptr<storage_proxy>& p, tracing::trace_state_ptr& trace_state_ptr) mutable {
             p->get_stats().replica_digest_reads++;
             auto src_ip = src_addr.addr;
-            return mm->get_schema_for_read(cmd->schema_version, std::move(src_addr), p->_messaging).then([cmd, &pr, &p, &trace_state_ptr, t, da] (schema_ptr s) {
+            return mm->get_schema_for_read(cmd->schema_version, std::move(src_addr), p->_messaging).then([cmd, &pr, &p, &trace_state_ptr, t, da, additional_ranges = std::move(additional_ranges)] (schema_ptr s) mutable {
                 auto pr2 = ::compat::unwrap(std::move(pr), *s);
                 if (pr2.second) {
                     // this function assumes singular queries but doesn't validate
                     throw std::runtime_error("READ_DIGEST called with wrapping range");
                 }
                 auto timeout = t ? *t : db::no_timeout;
+                if (!additional_ranges.empty()) {
+                    additional_ranges.insert(additional_ranges.begin(), std::move(pr2.first));
+                    return p->query_result_local_digest(std::move(s), cmd, std::move(additional_ranges), trace_state_ptr, timeout, da);
+                }
                 return p->query_result_local_digest(std::move(s), cmd, std::move(pr2.first), trace_state_ptr, timeout, da);
             }).finally([&trace_state_ptr, src_ip] () mutable {
                 tracing::trace(trace_state_ptr, "read_digest handling is done, sending a response to /{}", src_ip);
@@ -5299,7 +5965,9 @@ future<> storage_proxy::drain_on_shutdown() {
 
 future<>
 storage_proxy::stop() {
-    return make_ready_future<>();
+    return _db.local().get_notifier().unregister_listener(_paxos_state_cache_invalidator.get()).then([this] {
+        return _cas_queues_gate.close();
+    });
 }
 
 locator::token_metadata_ptr storage_proxy::get_token_metadata_ptr() const noexcept {
@@ -47,6 +47,7 @@
 #include "query-result-set.hh"
 #include <seastar/core/distributed.hh>
 #include <seastar/core/execution_stage.hh>
+#include <seastar/core/gate.hh>
 #include <seastar/core/scheduling_specific.hh>
 #include "db/consistency_level_type.hh"
 #include "db/read_repair_decision.hh"
@@ -88,11 +89,16 @@ namespace cdc {
     class cdc_service;    
 }
 
+namespace locator {
+    class dynamic_snitch;
+}
+
 namespace service {
 
 namespace paxos {
     class prepare_summary;
     class proposal;
+    class paxos_state_cache;
 }
 
 class abstract_write_response_handler;
@@ -107,6 +113,9 @@ using replicas_per_token_range = std::unordered_map<dht::token_range, std::vecto
 struct query_partition_key_range_concurrent_result {
     std::vector<foreign_ptr<lw_shared_ptr<query::result>>> result;
     replicas_per_token_range replicas;
+    // Number of vnode ranges the next page of the scan should start by
+    // querying concurrently, see storage_proxy::query_partition_key_range().
+    uint32_t next_concurrency_factor = 1;
 };
 
 struct view_update_backlog_timestamped {
@@ -137,6 +146,19 @@ class query_ranges_to_vnodes_generator {
     bool empty() const;
 };
 
+// The highest number of vnode ranges a page of a range scan starts with
+// querying concurrently. It bounds the estimate carried to the next page in
+// the paging state, which is sent back by the client and so is not trusted.
+constexpr uint32_t max_initial_range_concurrency = 64;
+
+// Estimates how many vnode ranges the next page of a range scan should query
+// concurrently to be filled in a single round, assuming the rows are spread
+// over the next ranges as they were over the `ranges_queried` ranges which
+// yielded `rows_fetched` rows to this page. `concurrency_factor` is the
+// concurrency of the last round of this page, `short_read` tells whether the
+// page was cut short by the result size limit.
+uint32_t estimate_next_concurrency_factor(uint64_t page_rows, uint64_t rows_fetched, bool short_read, size_t ranges_queried, int concurrency_factor);
+
 // An instance of this class is passed as an argument to storage_proxy::cas().
 // The apply() method, which must be defined by the implementation. It can
 // either return a mutation that will be used as a value for paxos 'propose'
@@ -155,13 +177,17 @@ struct storage_proxy_coordinator_query_result {
     foreign_ptr<lw_shared_ptr<query::result>> query_result;
     replicas_per_token_range last_replicas;
     db::read_repair_decision read_repair_decision;
+    // Range scans only: the concurrency the next page should be read with.
+    uint32_t range_concurrency = 1;
 
     storage_proxy_coordinator_query_result(foreign_ptr<lw_shared_ptr<query::result>> query_result,
             replicas_per_token_range last_replicas = {},
-            db::read_repair_decision read_repair_decision = db::read_repair_decision::NONE)
+            db::read_repair_decision read_repair_decision = db::read_repair_decision::NONE,
+            uint32_t range_concurrency = 1)
         : query_result(std::move(query_result))
         , last_replicas(std::move(last_replicas))
-        , read_repair_decision(std::move(read_repair_decision)) {
+        , read_repair_decision(std::move(read_repair_decision))
+        , range_concurrency(range_concurrency) {
     }
 };
 
@@ -218,19 +244,23 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
         tracing::trace_state_ptr trace_state = nullptr;
         replicas_per_token_range preferred_replicas;
         std::optional<db::read_repair_decision> read_repair_decision;
+        // Number of vnode ranges a range scan starts by querying concurrently.
+        uint32_t range_concurrency = 1;
 
         coordinator_query_options(clock_type::time_point timeout,
                 service_permit permit_,
                 client_state& client_state_,
                 tracing::trace_state_ptr trace_state = nullptr,
                 replicas_per_token_range preferred_replicas = { },
-                std::optional<db::read_repair_decision> read_repair_decision = { })
+                std::optional<db::read_repair_decision> read_repair_decision = { },
+                uint32_t range_concurrency = 1)
             : _timeout(timeout)
             , permit(std::move(permit_))
             , cstate(client_state_)
             , trace_state(std::move(trace_state))
             , preferred_replicas(std::move(preferred_replicas))
-            , read_repair_decision(read_repair_decision) {
+            , read_repair_decision(read_repair_decision)
+            , range_concurrency(range_concurrency) {
         }
 
         clock_type::time_point timeout(storage_proxy& sp) const {
@@ -284,6 +314,10 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
     // for read repair chance calculation
     std::default_random_engine _urandom;
     std::uniform_real_distribution<> _read_repair_chance = std::uniform_real_distribution<>(0,1);
+    // Number of speculative reads which may be sent right now. Grows by
+    // speculative_retry_budget with every read eligible for speculation,
+    // unless the budget is disabled.
+    double _speculation_budget = 0;
     seastar::metrics::metric_groups _metrics;
     uint64_t _background_write_throttle_threahsold;
     inheriting_concrete_execution_stage<
@@ -298,6 +332,24 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
             lw_shared_ptr<cdc::operation_result_tracker>> _mutate_stage;
     db::view::node_update_backlog& _max_view_update_backlog;
     std::unordered_map<gms::inet_address, view_update_backlog_timestamped> _view_update_backlogs;
+    // Caches the system.paxos state of the partitions owned by this shard.
+    std::unique_ptr<paxos::paxos_state_cache> _paxos_state_cache;
+    // Drops the cached Paxos states of dropped tables.
+    class paxos_state_cache_invalidator;
+    std::unique_ptr<paxos_state_cache_invalidator> _paxos_state_cache_invalidator;
+    // Tracks replica response latencies to steer reads away from slow replicas.
+    std::unique_ptr<locator::dynamic_snitch> _dynamic_snitch;
+
+    struct cas_batch_entry;
+    struct cas_queue;
+    // Concurrent CAS requests on the same partition are queued here and
+    // executed in shared Paxos rounds, see cas().
+    std::unordered_map<dht::token, lw_shared_ptr<cas_queue>> _cas_queues;
+    // Tracks the run_cas_queue() calls executing in the background.
+    seastar::gate _cas_queues_gate;
+
+    future<> run_cas_queue(dht::token token, lw_shared_ptr<cas_queue> queue);
+    future<std::vector<lw_shared_ptr<cas_batch_entry>>> run_cas_batch(std::vector<lw_shared_ptr<cas_batch_entry>> batch);
 
     //NOTICE(sarna): This opaque pointer is here just to avoid moving write handler class definitions from .cc to .hh. It's slow path.
     class view_update_handlers_list;
@@ -355,8 +407,9 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
     db::hints::manager& hints_manager_for(db::write_type type);
     std::vector<gms::inet_address> get_live_endpoints(keyspace& ks, const dht::token& token) const;
     static void sort_endpoints_by_proximity(std::vector<gms::inet_address>& eps);
-    std::vector<gms::inet_address> get_live_sorted_endpoints(keyspace& ks, const dht::token& token) const;
     db::read_repair_decision new_read_repair_decision(const schema& s);
+    void add_speculation_budget();
+    bool consume_speculation_budget();
     ::shared_ptr<abstract_read_executor> get_read_executor(lw_shared_ptr<query::read_command> cmd,
             schema_ptr schema,
             dht::partition_range pr,
@@ -365,7 +418,8 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
             tracing::trace_state_ptr trace_state,
             const std::vector<gms::inet_address>& preferred_endpoints,
             bool& is_bounced_read,
-            service_permit permit);
+            service_permit permit,
+            dht::partition_range_vector* grouped_ranges = nullptr);
     future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> query_result_local(schema_ptr, lw_shared_ptr<query::read_command> cmd, const dht::partition_range& pr,
                                                                            query::result_options opts,
                                                                            tracing::trace_state_ptr trace_state,
@@ -374,6 +428,15 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
                                                                                                    tracing::trace_state_ptr trace_state,
                                                                                                    clock_type::time_point timeout,
                                                                                                    query::digest_algorithm da);
+    // Reads several singular ranges, returning the partitions in the order of the ranges.
+    future<rpc::tuple<foreign_ptr<lw_shared_ptr<query::result>>, cache_temperature>> query_result_local(schema_ptr, lw_shared_ptr<query::read_command> cmd, dht::partition_range_vector prs,
+                                                                           query::result_options opts,
+                                                                           tracing::trace_state_ptr trace_state,
+                                                                           clock_type::time_point timeout);
+    future<rpc::tuple<query::result_digest, api::timestamp_type, cache_temperature>> query_result_local_digest(schema_ptr, lw_shared_ptr<query::read_command> cmd, dht::partition_range_vector prs,
+                                                                                                   tracing::trace_state_ptr trace_state,
+                                                                                                   clock_type::time_point timeout,
+                                                                                                   query::digest_algorithm da);
     future<coordinator_query_result> query_partition_key_range(lw_shared_ptr<query::read_command> cmd,
             dht::partition_range_vector partition_ranges,
             db::consistency_level cl,
@@ -389,7 +452,8 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
             uint64_t remaining_row_count,
             uint32_t remaining_partition_count,
             replicas_per_token_range preferred_replicas,
-            service_permit permit);
+            service_permit permit,
+            size_t ranges_queried = 0);
 
     future<coordinator_query_result> do_query(schema_ptr,
         lw_shared_ptr<query::read_command> cmd,
@@ -476,6 +540,17 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
         return *_view_update_handlers_list;
     }
 
+    paxos::paxos_state_cache& get_paxos_state_cache() noexcept {
+        return *_paxos_state_cache;
+    }
+
+    locator::dynamic_snitch& get_dynamic_snitch() noexcept {
+        return *_dynamic_snitch;
+    }
+
+    // Returns the live replicas of `token`, the closest first.
+    std::vector<gms::inet_address> get_live_sorted_endpoints(keyspace& ks, const dht::token& token) const;
+
     response_id_type get_next_response_id() {
         auto next = _next_response_id++;
         if (next == 0) { // 0 is reserved for unique_response_handler
@@ -654,6 +729,8 @@ class storage_proxy : public seastar::async_sharded_service<storage_proxy>, publ
     friend class abstract_read_executor;
     friend class abstract_write_response_handler;
     friend class speculating_read_executor;
+    template <typename Executor>
+    friend class multi_partition_read_executor;
     friend class view_update_backlog_broker;
     friend class view_update_write_response_handler;
     friend class paxos_response_handler;
@@ -751,7 +828,8 @@ class paxos_response_handler : public enable_shared_from_this<paxos_response_han
     };
 
     // Steps of the Paxos protocol
-    future<ballot_and_data> begin_and_repair_paxos(client_state& cs, unsigned& contentions, bool is_write);
+    future<ballot_and_data> begin_and_repair_paxos(client_state& cs, unsigned& contentions, bool is_write,
+            api::timestamp_type min_timestamp_micros = 0);
     future<paxos::prepare_summary> prepare_ballot(utils::UUID ballot);
     future<bool> accept_proposal(lw_shared_ptr<paxos::proposal> proposal, bool timeout_if_partially_accepted = true);
     future<> learn_decision(lw_shared_ptr<paxos::proposal> proposal, bool allow_hints = false);
@@ -768,6 +846,21 @@ class paxos_response_handler : public enable_shared_from_this<paxos_response_han
     const partition_key& key() const {
         return _key.key();
     }
+    dht::token key_token() const {
+        return _key.token();
+    }
+    storage_proxy::clock_type::time_point timeout() const {
+        return _timeout;
+    }
+    storage_proxy::clock_type::time_point cas_timeout() const {
+        return _cas_timeout;
+    }
+    db::consistency_level cl_for_paxos() const {
+        return _cl_for_paxos;
+    }
+    db::consistency_level cl_for_learn() const {
+        return _cl_for_learn;
+    }
     void set_cl_for_learn(db::consistency_level cl) {
         _cl_for_learn = cl;
     }
@@ -117,6 +117,7 @@ struct write_stats {
     uint64_t cas_write_condition_not_met = 0;
     uint64_t cas_write_timeout_due_to_uncertainty = 0;
     uint64_t cas_failed_read_round_optimization = 0;
+    uint64_t cas_batched_requests = 0;
     uint16_t cas_now_pruning = 0;
     uint64_t cas_prune = 0;
     uint64_t cas_coordinator_dropped_prune = 0;
@@ -181,6 +182,11 @@ struct stats : public write_stats {
     uint64_t read_retries = 0; // read is retried with new limit
     uint64_t speculative_digest_reads = 0;
     uint64_t speculative_data_reads = 0;
+    uint64_t speculative_reads_succeeded = 0; // the speculative response was used to reach CL
+    uint64_t speculative_reads_wasted = 0; // CL was reached without the speculative response
+    uint64_t speculative_reads_throttled = 0; // not sent due to speculative_retry_budget
+    uint64_t multi_partition_reads = 0; // reads of several partitions sharing replicas, sent as one request
+    uint64_t multi_partition_read_fallbacks = 0; // replicas disagreed, partitions were read one by one
 
     uint64_t cas_read_unfinished_commit = 0;
     uint64_t cas_foreground = 0;
@@ -782,6 +782,13 @@ class index_reader {
         return partition_data_ready(_lower_bound);
     }
 
+    // Returns the clustered index cursor for the current partition, or nullptr
+    // if it has no clustered index.
+    // Can be called only when partition_data_ready().
+    clustered_index_cursor* current_clustered_cursor() {
+        return current_clustered_cursor(_lower_bound);
+    }
+
     // Forwards the cursor to the given position in the current partition.
     //
     // Note that the index within partition, unlike the partition index, doesn't cover all keys.
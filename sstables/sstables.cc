@@ -2645,6 +2645,36 @@ future<bool> sstable::has_partition_key(const utils::hashed_key& hk, const dht::
     });
 }
 
+future<std::vector<clustering_key_prefix>> sstable::get_promoted_index_block_starts(const dht::decorated_key& dk, reader_permit permit,
+        const io_priority_class& pc, tracing::trace_state_ptr trace_state) {
+    std::vector<clustering_key_prefix> starts;
+    if (!filter_has_key(*_schema, dk.key())) {
+        co_return starts;
+    }
+    auto index = std::make_unique<sstables::index_reader>(shared_from_this(), std::move(permit), pc, std::move(trace_state));
+    std::exception_ptr ex;
+    try {
+        if (co_await index->advance_lower_and_check_if_present(dk)) {
+            if (auto* cursor = index->current_clustered_cursor()) {
+                while (auto entry = co_await cursor->next_entry()) {
+                    // Only the mx format stores the block bounds as positions.
+                    auto* pos = std::get_if<position_in_partition_view>(&entry->start);
+                    if (pos && pos->has_clustering_key() && !pos->key().is_empty()) {
+                        starts.push_back(pos->key());
+                    }
+                }
+            }
+        }
+    } catch (...) {
+        ex = std::current_exception();
+    }
+    co_await index->close();
+    if (ex) {
+        std::rethrow_exception(std::move(ex));
+    }
+    co_return starts;
+}
+
 utils::hashed_key sstable::make_hashed_key(const schema& s, const partition_key& key) {
     return utils::make_hashed_key(static_cast<bytes_view>(key::from_partition_key(s, key)));
 }
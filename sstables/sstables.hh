@@ -686,6 +686,16 @@ class sstable : public enable_lw_shared_from_this<sstable> {
      */
     future<bool> has_partition_key(const utils::hashed_key& hk, const dht::decorated_key& dk);
 
+    /*!
+     * \brief returns the clustering keys at which the blocks of the promoted
+     * index of the given partition start, in ascending order.
+     *
+     * The result is empty if the sstable doesn't contain the partition, or if
+     * the partition has no promoted index, e.g. because it is small.
+     */
+    future<std::vector<clustering_key_prefix>> get_promoted_index_block_starts(const dht::decorated_key& dk, reader_permit permit,
+            const io_priority_class& pc, tracing::trace_state_ptr trace_state);
+
     bool filter_has_key(utils::hashed_key key) const {
         return _components->filter->is_present(key);
     }
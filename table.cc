@@ -416,6 +416,7 @@ table::add_sstable_and_update_cache(sstables::shared_sstable sst, sstables::offs
     return get_row_cache().invalidate(row_cache::external_updater([this, sst, offstrategy] () noexcept {
         // FIXME: this is not really noexcept, but we need to provide strong exception guarantees.
         // atomically load all opened sstables into column family.
+        _read_coalescer.invalidate();
         if (!offstrategy) {
             add_sstable(sst);
             trigger_compaction();
@@ -703,6 +704,8 @@ void table::set_metrics() {
                 ms::make_gauge("total_disk_space", ms::description("Total disk space used"), _stats.total_disk_space_used)(cf)(ks),
                 ms::make_gauge("live_sstable", ms::description("Live sstable count"), _stats.live_sstable_count)(cf)(ks),
                 ms::make_gauge("pending_compaction", ms::description("Estimated number of compactions pending for this column family"), _stats.pending_compactions)(cf)(ks),
+                ms::make_counter("coalesced_reads", [this] { return _read_coalescer.get_stats().coalesced_reads; },
+                        ms::description("Number of reads which shared the result of an identical concurrent read instead of executing"))(cf)(ks),
                 ms::make_gauge("pending_sstable_deletions",
                         ms::description("Number of tasks waiting to delete sstables from a table"),
                         [this] { return _sstable_deletion_sem.waiters(); })(cf)(ks)
@@ -1178,6 +1181,7 @@ table::table(schema_ptr schema, config config, db::commitlog* cl, compaction_man
     , _maintenance_sstables(make_maintenance_sstable_set())
     , _sstables(make_compound_sstable_set())
     , _cache(_schema, sstables_as_snapshot_source(), row_cache_tracker, is_continuous::yes)
+    , _read_coalescer(_config.read_coalescing_window_in_us)
     , _commitlog(cl)
     , _durable_writes(true)
     , _compaction_manager(compaction_manager)
@@ -1478,6 +1482,7 @@ future<> table::clear() {
     }
     _memtables->clear();
     _memtables->add_memtable();
+    _read_coalescer.invalidate();
     return _cache.invalidate(row_cache::external_updater([] { /* There is no underlying mutation source */ }));
 }
 
@@ -1522,6 +1527,7 @@ future<db::replay_position> table::discard_sstables(db_clock::time_point truncat
             cf._main_sstables = std::move(pruned);
             cf._maintenance_sstables = std::move(maintenance_pruned);
             cf.refresh_compound_sstable_set();
+            cf._read_coalescer.invalidate();
         }
     };
     auto p = make_lw_shared<pruner>(*this);
@@ -1838,11 +1844,13 @@ void table::do_apply(db::rp_handle&& h, Args&&... args) {
 
 void
 table::apply(const mutation& m, db::rp_handle&& h) {
+    _read_coalescer.on_write(m.key());
     do_apply(std::move(h), m);
 }
 
 void
 table::apply(const frozen_mutation& m, const schema_ptr& m_schema, db::rp_handle&& h) {
+    _read_coalescer.on_write(m.key());
     do_apply(std::move(h), m, m_schema);
 }
 
@@ -1947,7 +1955,8 @@ table::query(schema_ptr s,
         auto q = querier_opt
                 ? std::move(*querier_opt)
                 : query::data_querier(as_mutation_source(), s, class_config.semaphore.make_permit(s.get(), "data-query"), range, qs.cmd.slice,
-                        service::get_local_sstable_query_read_priority(), trace_state);
+                        service::get_local_sstable_query_read_priority(), trace_state, reversed_read_window_boundaries(),
+                        class_config.max_memory_for_unlimited_query);
 
         std::exception_ptr ex;
       try {
@@ -1986,7 +1995,8 @@ table::mutation_query(schema_ptr s,
     auto q = querier_opt
             ? std::move(*querier_opt)
             : query::mutation_querier(as_mutation_source(), s, class_config.semaphore.make_permit(s.get(), "mutation-query"), range, cmd.slice,
-                    service::get_local_sstable_query_read_priority(), trace_state);
+                    service::get_local_sstable_query_read_priority(), trace_state, reversed_read_window_boundaries(),
+                    class_config.max_memory_for_unlimited_query);
 
     std::exception_ptr ex;
   try {
@@ -2242,6 +2252,25 @@ table::stream_view_replica_updates(const schema_ptr& s, mutation&& m, db::timeou
             query::partition_slice::option_set::of<query::partition_slice::option::bypass_cache>());
 }
 
+partition_window_boundaries_fn
+table::reversed_read_window_boundaries() const {
+    return [this] (const dht::decorated_key& dk, reader_permit permit, tracing::trace_state_ptr trace_state) {
+        // The promoted index of the largest sstable containing the partition
+        // is the best indication available of how its rows are spread.
+        sstables::shared_sstable largest;
+        for (auto& sst : select_sstables(dht::partition_range::make_singular(dk))) {
+            if ((!largest || sst->data_size() > largest->data_size()) && sst->filter_has_key(*_schema, dk.key())) {
+                largest = sst;
+            }
+        }
+        if (!largest) {
+            return make_ready_future<std::vector<clustering_key_prefix>>();
+        }
+        return largest->get_promoted_index_block_starts(dk, std::move(permit), service::get_local_sstable_query_read_priority(),
+                std::move(trace_state)).finally([largest] { });
+    };
+}
+
 mutation_source
 table::as_mutation_source_excluding(std::vector<sstables::shared_sstable>& ssts) const {
     return mutation_source([this, &ssts] (schema_ptr s,
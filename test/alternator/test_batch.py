@@ -306,6 +306,91 @@ def test_batch_get_item_projection_expression(test_table):
         expected_items = [{k: item[k] for k in wanted if k in item} for item in items]
         assert multiset(got_items) == multiset(expected_items)
 
+# Test reading many items of a hash-only table, spread over many partitions
+# (and so over all the nodes and shards), together with missing items.
+def test_batch_get_item_hash_many(test_table_s):
+    items = [{'p': random_string(), 'val': random_string()} for i in range(90)]
+    with test_table_s.batch_writer() as batch:
+        for item in items:
+            batch.put_item(item)
+    keys = [{'p': x['p']} for x in items] + [{'p': random_string()} for i in range(10)]
+    random.shuffle(keys)
+    reply = test_table_s.meta.client.batch_get_item(RequestItems = {test_table_s.name: {'Keys': keys, 'ConsistentRead': True}})
+    got_items = reply['Responses'][test_table_s.name]
+    assert multiset(got_items) == multiset(items)
+
+# Test reading several items of the same partition, some of them missing,
+# requested in no particular order, together with items of other partitions.
+def test_batch_get_item_same_partition(test_table):
+    p = random_string()
+    items = [{'p': p, 'c': str(i), 'val': random_string()} for i in range(10)]
+    other_items = [{'p': random_string(), 'c': str(i), 'val': random_string()} for i in range(3)]
+    with test_table.batch_writer() as batch:
+        for item in items + other_items:
+            batch.put_item(item)
+    wanted = [items[7], items[2], items[5], items[0]]
+    keys = [{'p': x['p'], 'c': x['c']} for x in wanted + other_items] + [{'p': p, 'c': 'missing'}]
+    reply = test_table.meta.client.batch_get_item(RequestItems = {test_table.name: {'Keys': keys, 'ConsistentRead': True}})
+    got_items = reply['Responses'][test_table.name]
+    assert multiset(got_items) == multiset(wanted + other_items)
+
+# Test reading items of several tables, of different key schemas, in one
+# BatchGetItem.
+def test_batch_get_item_multiple_tables(test_table_s, test_table):
+    p = random_string()
+    items = [{'p': p, 'c': str(i), 'val': random_string()} for i in range(5)]
+    items_s = [{'p': random_string(), 'val': random_string()} for i in range(5)]
+    with test_table.batch_writer() as batch:
+        for item in items:
+            batch.put_item(item)
+    with test_table_s.batch_writer() as batch:
+        for item in items_s:
+            batch.put_item(item)
+    reply = test_table.meta.client.batch_get_item(RequestItems = {
+        test_table.name: {'Keys': [{'p': x['p'], 'c': x['c']} for x in items], 'ConsistentRead': True},
+        test_table_s.name: {'Keys': [{'p': x['p']} for x in items_s], 'ProjectionExpression': 'p', 'ConsistentRead': True},
+    })
+    assert multiset(reply['Responses'][test_table.name]) == multiset(items)
+    assert multiset(reply['Responses'][test_table_s.name]) == multiset([{'p': x['p']} for x in items_s])
+
+# As in BatchWriteItem, a BatchGetItem may not ask for the same key twice.
+# DynamoDB says "Provided list of item keys contains duplicates".
+def test_batch_get_item_duplicate(test_table_s, test_table):
+    p = random_string()
+    c = random_string()
+    test_table_s.put_item(Item={'p': p})
+    test_table.put_item(Item={'p': p, 'c': c})
+    with pytest.raises(ClientError, match='ValidationException.*duplicates'):
+        test_table_s.meta.client.batch_get_item(RequestItems = {test_table_s.name: {'Keys': [{'p': p}, {'p': p}]}})
+    with pytest.raises(ClientError, match='ValidationException.*duplicates'):
+        test_table.meta.client.batch_get_item(RequestItems = {test_table.name: {'Keys': [{'p': p, 'c': c}, {'p': p, 'c': c}]}})
+    # The same key in different tables, or different sort keys of the same
+    # partition, aren't duplicates.
+    reply = test_table.meta.client.batch_get_item(RequestItems = {
+        test_table.name: {'Keys': [{'p': p, 'c': c}, {'p': p, 'c': random_string()}], 'ConsistentRead': True},
+        test_table_s.name: {'Keys': [{'p': p}], 'ConsistentRead': True},
+    })
+    assert reply['Responses'][test_table.name] == [{'p': p, 'c': c}]
+    assert reply['Responses'][test_table_s.name] == [{'p': p}]
+
+# Test a BatchWriteItem writing and deleting several items of the same
+# partition, together with items of other partitions.
+def test_batch_write_same_partition(test_table):
+    p = random_string()
+    test_table.put_item(Item={'p': p, 'c': 'deleted', 'a': 'x'})
+    test_table.put_item(Item={'p': p, 'c': 'replaced', 'a': 'x', 'b': 'y'})
+    other_p = random_string()
+    test_table.meta.client.batch_write_item(RequestItems = {
+        test_table.name: [{'PutRequest': {'Item': {'p': p, 'c': str(i), 'a': str(i)}}} for i in range(10)] + [
+            {'DeleteRequest': {'Key': {'p': p, 'c': 'deleted'}}},
+            {'PutRequest': {'Item': {'p': p, 'c': 'replaced', 'a': 'z'}}},
+            {'PutRequest': {'Item': {'p': other_p, 'c': 'c', 'a': 'other'}}},
+        ]
+    })
+    expected = [{'p': p, 'c': str(i), 'a': str(i)} for i in range(10)] + [{'p': p, 'c': 'replaced', 'a': 'z'}]
+    assert multiset(full_query(test_table, KeyConditionExpression='p=:p', ExpressionAttributeValues={':p': p})) == multiset(expected)
+    assert full_query(test_table, KeyConditionExpression='p=:p', ExpressionAttributeValues={':p': other_p}) == [{'p': other_p, 'c': 'c', 'a': 'other'}]
+
 # Test that we return the required UnprocessedKeys/UnprocessedItems parameters
 def test_batch_unprocessed(test_table_s):
     p = random_string()
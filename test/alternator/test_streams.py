@@ -1154,6 +1154,80 @@ def test_streams_starting_sequence_number(test_table_ss_keys_only, dynamodbstrea
         time.sleep(0.5)
     pytest.fail("timed out")
 
+# Reads the whole content of a shard, starting at its TRIM_HORIZON, with
+# GetRecords calls returning at most `limit` records each. Returns the
+# records of partition `p`, and stops at the first call returning nothing.
+def drain_shard(dynamodbstreams, arn, shard_id, limit, p):
+    iter = dynamodbstreams.get_shard_iterator(StreamArn=arn,
+        ShardId=shard_id, ShardIteratorType='TRIM_HORIZON')['ShardIterator']
+    records = []
+    while True:
+        response = dynamodbstreams.get_records(ShardIterator=iter, Limit=limit)
+        if not response.get('Records'):
+            return records
+        assert len(response['Records']) <= limit
+        records.extend(r for r in response['Records'] if r['dynamodb']['Keys']['p'] == {'S': p})
+        iter = response['NextShardIterator']
+
+# Does `updatefunc` to many items of the same partition, so that their
+# records are all in the same shard, and reads them back in small chunks,
+# each GetRecords call continuing where the previous one left off. Checks
+# that no record is lost or read twice across the iterators returned by
+# consecutive calls, whatever the Limit.
+def do_test_drain_with_limit(test_table_ss_stream, dynamodbstreams, updatefunc):
+    table, arn = test_table_ss_stream
+    p = random_string()
+    expected_keys = updatefunc(table, p)
+    # Wait until all the records left the confidence window, then drain the
+    # shard holding them.
+    timeout = time.time() + 30
+    while time.time() < timeout:
+        for shard_id in list_shards(dynamodbstreams, arn):
+            records = drain_shard(dynamodbstreams, arn, shard_id, 1000, p)
+            if not records:
+                continue
+            if len(records) < len(expected_keys):
+                break
+            assert [r['dynamodb']['Keys']['c']['S'] for r in records] == expected_keys
+            for limit in [1, 2, 3, 7]:
+                limited = drain_shard(dynamodbstreams, arn, shard_id, limit, p)
+                assert [r['dynamodb']['SequenceNumber'] for r in limited] == [r['dynamodb']['SequenceNumber'] for r in records]
+                assert [r['dynamodb']['Keys'] for r in limited] == [r['dynamodb']['Keys'] for r in records]
+            return
+        time.sleep(0.5)
+    pytest.fail("timed out")
+
+def do_updates_drain(table, p):
+    keys = []
+    for i in range(20):
+        c = str(i)
+        table.update_item(Key={'p': p, 'c': c},
+            UpdateExpression='SET x = :val1', ExpressionAttributeValues={':val1': i})
+        keys.append(c)
+    return keys
+
+# With KEYS_ONLY, every record is a single log row, so chunks of records are
+# also chunks of rows, and each GetRecords call resumes the read of the
+# previous one.
+def test_streams_drain_with_limit_keys_only(test_table_ss_keys_only, dynamodbstreams):
+    do_test_drain_with_limit(test_table_ss_keys_only, dynamodbstreams, do_updates_drain)
+
+def do_updates_drain_images(table, p):
+    keys = []
+    for i in range(10):
+        c = str(i)
+        # Creating an item has no preimage, updating it has one, so records
+        # are made of varying numbers of rows, and some calls read more rows
+        # than their Limit of records can return.
+        table.put_item(Item={'p': p, 'c': c, 'x': i})
+        table.update_item(Key={'p': p, 'c': c},
+            UpdateExpression='SET x = :val1', ExpressionAttributeValues={':val1': i + 1})
+        keys += [c, c]
+    return keys
+
+def test_streams_drain_with_limit_new_and_old_images(test_table_ss_new_and_old_images, dynamodbstreams):
+    do_test_drain_with_limit(test_table_ss_new_and_old_images, dynamodbstreams, do_updates_drain_images)
+
 # Above we tested some specific operations in small tests aimed to reproduce
 # a specific bug, in the following tests we do a all the different operations,
 # PutItem, DeleteItem, BatchWriteItem and UpdateItem, and check the resulting
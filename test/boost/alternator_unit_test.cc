@@ -24,6 +24,7 @@
 
 #include <seastar/util/defer.hh>
 #include "alternator/base64.hh"
+#include "alternator/expressions.hh"
 
 static bytes_view to_bytes_view(const std::string& s) {
     return bytes_view(reinterpret_cast<const signed char*>(s.c_str()), s.size());
@@ -55,6 +56,20 @@ BOOST_AUTO_TEST_CASE(test_base64_decoded_len) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_base64_decode_into_buffer) {
+    for (auto& [str, encoded] : strings) {
+        BOOST_REQUIRE_EQUAL(str.size(), base64_decoded_size(encoded));
+        bytes buf(bytes::initialized_later(), 1 + str.size());
+        buf[0] = 'x';
+        base64_decode(encoded, buf.begin() + 1);
+        BOOST_REQUIRE_EQUAL(buf[0], 'x');
+        BOOST_REQUIRE_EQUAL(to_bytes_view(str), bytes_view(buf).substr(1));
+    }
+    // Decoding stops at the first unexpected character.
+    BOOST_REQUIRE_EQUAL(base64_decoded_size("YWJj!ZGVm"), 3);
+    BOOST_REQUIRE_EQUAL(base64_decode("YWJj!ZGVm"), base64_decode("YWJj"));
+}
+
 BOOST_AUTO_TEST_CASE(test_base64_begins_with) {
     for (auto& [str, encoded] : strings) {
         for (size_t i = 0; i < str.size(); ++i) {
@@ -98,3 +113,97 @@ BOOST_AUTO_TEST_CASE(test_allocator_fail_gracefully) {
     BOOST_REQUIRE_THROW(stack.Push<char>(too_large_alloc_size), rjson::error);
 #endif
 }
+
+BOOST_AUTO_TEST_CASE(test_chunked_writer) {
+    // Enough items for the text to span several chunks.
+    rjson::value items = rjson::empty_array();
+    for (int i = 0; i < 1000; ++i) {
+        rjson::value item = rjson::empty_object();
+        rjson::set(item, "p", rjson::from_string("item " + std::to_string(i)));
+        rjson::set(item, "n", rjson::value(i));
+        rjson::push_back(items, std::move(item));
+    }
+    rjson::value expected = rjson::empty_object();
+    rjson::set(expected, "Items", rjson::copy(items));
+    rjson::set(expected, "Count", rjson::value(items.Size()));
+
+    rjson::chunked_writer writer;
+    writer.start_object();
+    writer.key("Items");
+    writer.start_array();
+    for (auto& item : items.GetArray()) {
+        writer.write(item);
+    }
+    writer.end_array();
+    writer.key("Count");
+    writer.write(rjson::value(items.Size()));
+    writer.end_object();
+    auto size = writer.size();
+    auto content = std::move(writer).finish();
+    BOOST_REQUIRE_GT(content.size(), 1);
+    size_t content_size = 0;
+    for (auto& chunk : content) {
+        BOOST_REQUIRE(!chunk.empty());
+        content_size += chunk.size();
+    }
+    BOOST_REQUIRE_EQUAL(content_size, size);
+    BOOST_REQUIRE_EQUAL(content_size, rjson::print(expected).size());
+    BOOST_REQUIRE_EQUAL(rjson::parse(std::move(content)), expected);
+}
+
+BOOST_AUTO_TEST_CASE(test_chunked_writer_incomplete) {
+    rjson::chunked_writer writer;
+    writer.start_object();
+    writer.key("Items");
+    BOOST_REQUIRE_THROW(std::move(writer).finish(), rjson::error);
+}
+
+BOOST_AUTO_TEST_CASE(test_expression_cache) {
+    alternator::set_expression_cache_size(2);
+    auto& stats = alternator::get_expression_cache_stats();
+    auto misses = stats.misses;
+    auto hits = stats.hits;
+
+    auto paths = alternator::parse_projection_expression("a, b.c");
+    BOOST_REQUIRE_EQUAL(paths.size(), 2);
+    BOOST_REQUIRE_EQUAL(stats.misses, misses + 1);
+    // Callers get copies of the cached parse trees, which they may modify.
+    paths.clear();
+    paths = alternator::parse_projection_expression("a, b.c");
+    BOOST_REQUIRE_EQUAL(paths.size(), 2);
+    BOOST_REQUIRE_EQUAL(paths[1].root(), "b");
+    BOOST_REQUIRE_EQUAL(stats.hits, hits + 1);
+
+    // The same text is cached separately for each kind of expression.
+    BOOST_REQUIRE_THROW(alternator::parse_update_expression("a, b.c"), alternator::expressions_syntax_error);
+    BOOST_REQUIRE_EQUAL(stats.misses, misses + 2);
+    BOOST_REQUIRE_EQUAL(alternator::get_expression_cache_entries(), 1);
+
+    // The least recently used expression is evicted.
+    auto evictions = stats.evictions;
+    alternator::parse_condition_expression("attribute_exists(a)");
+    alternator::parse_projection_expression("a, b.c");
+    alternator::parse_update_expression("SET a = :v");
+    BOOST_REQUIRE_EQUAL(stats.evictions, evictions + 1);
+    BOOST_REQUIRE_EQUAL(alternator::get_expression_cache_entries(), 2);
+    hits = stats.hits;
+    alternator::parse_projection_expression("a, b.c");
+    BOOST_REQUIRE_EQUAL(stats.hits, hits + 1);
+    alternator::parse_condition_expression("attribute_exists(a)");
+    BOOST_REQUIRE_EQUAL(stats.hits, hits + 1);
+
+    // Long expressions are parsed but not cached.
+    std::string long_expression = "a";
+    while (long_expression.size() <= 4096) {
+        long_expression += ", a";
+    }
+    evictions = stats.evictions;
+    misses = stats.misses;
+    BOOST_REQUIRE_EQUAL(alternator::parse_projection_expression(long_expression).size(), (long_expression.size() + 2) / 3);
+    BOOST_REQUIRE_EQUAL(alternator::parse_projection_expression(long_expression).size(), (long_expression.size() + 2) / 3);
+    BOOST_REQUIRE_EQUAL(stats.misses, misses);
+    BOOST_REQUIRE_EQUAL(stats.evictions, evictions);
+    BOOST_REQUIRE_EQUAL(alternator::get_expression_cache_entries(), 2);
+
+    alternator::set_expression_cache_size(1000);
+}
@@ -51,6 +51,11 @@
 #include "utils/rjson.hh"
 #include "schema_builder.hh"
 #include "service/migration_manager.hh"
+#include "service/forward_service.hh"
+#include "service/storage_proxy.hh"
+#include "cql3/query_processor.hh"
+#include "service/pager/paging_state.hh"
+#include "read_coalescer.hh"
 #include <regex>
 #include "gms/feature.hh"
 #include "db/query_context.hh"
@@ -2351,6 +2356,35 @@ APPLY BATCH;)"
     });
 }
 
+SEASTAR_TEST_CASE(test_batch_single_partition) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table cf (p int, c int, r int, l list<int>, PRIMARY KEY (p, c));").get();
+        e.execute_cql("insert into cf (p, c, l) values (1, 0, [0]);").get();
+        // Statements of the same partition, interleaved with statements of
+        // another one and with one which requires a read, must still be
+        // applied in order.
+        e.execute_cql(R"(BEGIN BATCH
+insert into cf (p, c, r) values (1, 1, 10);
+update cf set l = l + [1] where p = 1 and c = 0;
+update cf set r = 20 where p = 2 and c = 2;
+update cf set l = l + [2] where p = 1 and c = 0;
+update cf set r = 11 where p = 1 and c = 1;
+update cf set l[0] = 5 where p = 1 and c = 0;
+delete r from cf where p = 2 and c = 2;
+APPLY BATCH;)").get();
+        auto msg = e.execute_cql("select p, c, r from cf where p in (1, 2) and c = 1;").get0();
+        assert_that(msg).is_rows().with_rows({
+            {int32_type->decompose(1), int32_type->decompose(1), int32_type->decompose(11)},
+        });
+        auto my_list_type = list_type_impl::get_instance(int32_type, true);
+        e.require_column_has_value("cf", {1}, {0}, "l",
+                make_list_value(my_list_type, list_type_impl::native_type({5, 1, 2}))).get();
+        // The deletion has the same timestamp as the update, and wins.
+        msg = e.execute_cql("select r from cf where p = 2 and c = 2;").get0();
+        assert_that(msg).is_rows().with_size(0);
+    });
+}
+
 SEASTAR_TEST_CASE(test_in_restriction) {
     return do_with_cql_env_thread([] (cql_test_env& e) {
         e.execute_cql("create table tir (p1 int, c1 int, r1 int, PRIMARY KEY (p1, c1));").get();
@@ -4960,3 +4994,288 @@ SEASTAR_TEST_CASE(test_user_based_sla_queries) {
         });
     });
 }
+
+// Concurrent conditional updates of one partition are batched into shared
+// Paxos rounds. Check that they still behave as if executed one after the other.
+SEASTAR_TEST_CASE(test_concurrent_lwt_on_one_partition) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table t (p int, c int, v int, primary key (p, c));").get();
+
+        auto applied = [] (shared_ptr<cql_transport::messages::result_message> msg) {
+            auto rows = dynamic_pointer_cast<cql_transport::messages::result_message::rows>(msg);
+            BOOST_REQUIRE(rows);
+            const auto& rs = rows->rs().result_set().rows();
+            BOOST_REQUIRE_EQUAL(rs.size(), 1);
+            return value_cast<bool>(boolean_type->deserialize(*rs.front()[0]));
+        };
+        auto batched_requests = [] {
+            return service::get_storage_proxy().map_reduce0([] (const service::storage_proxy& sp) {
+                return map_reduce_scheduling_group_specific<service::storage_proxy_stats::stats>(
+                        [] (service::storage_proxy_stats::stats& stats) { return stats.cas_batched_requests; },
+                        std::plus<uint64_t>(), uint64_t(0), sp.get_stats_key());
+            }, uint64_t(0), std::plus<uint64_t>()).get0();
+        };
+        const auto batched_before = batched_requests();
+
+        // Inserts of distinct rows don't conflict, all of them apply.
+        auto results = map_reduce(boost::irange(0, 50), [&] (int c) {
+            return e.execute_cql(format("insert into t (p, c, v) values (1, {}, {}) if not exists;", c, c)).then(applied);
+        }, 0, [] (int count, bool a) { return count + a; }).get0();
+        BOOST_REQUIRE_EQUAL(results, 50);
+        assert_that(e.execute_cql("select count(*) from t where p = 1;").get0())
+            .is_rows().with_rows({{long_type->decompose(int64_t(50))}});
+        // Some of them shared a Paxos round.
+        BOOST_REQUIRE_GT(batched_requests(), batched_before);
+
+        // Inserts of the same row conflict, exactly one of them applies.
+        results = map_reduce(boost::irange(0, 50), [&] (int v) {
+            return e.execute_cql(format("insert into t (p, c, v) values (2, 0, {}) if not exists;", v)).then(applied);
+        }, 0, [] (int count, bool a) { return count + a; }).get0();
+        BOOST_REQUIRE_EQUAL(results, 1);
+
+        // Each increment reads the value written by the previous one.
+        e.execute_cql("insert into t (p, c, v) values (3, 0, 0);").get();
+        for (int round = 0; round < 5; ++round) {
+            results = map_reduce(boost::irange(0, 10), [&] (int) {
+                return e.execute_cql(format("update t set v = {} where p = 3 and c = 0 if v = {};", round + 1, round)).then(applied);
+            }, 0, [] (int count, bool a) { return count + a; }).get0();
+            BOOST_REQUIRE_EQUAL(results, 1);
+        }
+        assert_that(e.execute_cql("select v from t where p = 3 and c = 0;").get0())
+            .is_rows().with_rows({{int32_type->decompose(5)}});
+    });
+}
+
+// Identical concurrent reads of a partition may share one execution on the
+// replica. Check that they all get the full result, and that a read never
+// misses a write which completed before it started.
+SEASTAR_TEST_CASE(test_coalesced_reads) {
+    auto db_config = make_shared<db::config>();
+    db_config->read_coalescing_window_in_us.set(1000000);
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table t (p int, c int, v int, primary key (p, c));").get();
+        e.execute_cql("insert into t (p, c, v) values (1, 0, 0);").get();
+        e.execute_cql("insert into t (p, c, v) values (1, 1, 1);").get();
+
+        auto reads = parallel_for_each(boost::irange(0, 20), [&] (int) {
+            return e.execute_cql("select c, v from t where p = 1;").then([] (shared_ptr<cql_transport::messages::result_message> msg) {
+                assert_that(msg).is_rows().with_rows({
+                    {int32_type->decompose(0), int32_type->decompose(0)},
+                    {int32_type->decompose(1), int32_type->decompose(1)},
+                });
+            });
+        });
+        reads.get();
+
+        for (int v = 2; v < 10; ++v) {
+            e.execute_cql(format("update t set v = {} where p = 1 and c = 1;", v)).get();
+            assert_that(e.execute_cql("select v from t where p = 1 and c = 1;").get0())
+                .is_rows().with_rows({{int32_type->decompose(v)}});
+        }
+    }, cql_test_config(db_config));
+}
+
+// A read joining another one waits for its result with its own timeout. If
+// the shared read times out first, the joining read is executed on its own.
+SEASTAR_THREAD_TEST_CASE(test_read_coalescer_timeouts) {
+    auto s = schema_builder("ks", "t")
+        .with_column("p", int32_type, column_kind::partition_key)
+        .with_column("v", int32_type)
+        .build();
+    query::read_coalescer coalescer(utils::updateable_value<uint32_t>(1000000));
+    auto pk = partition_key::from_single_value(*s, int32_type->decompose(1));
+    auto ranges = dht::partition_range_vector{dht::partition_range::make_singular(dht::decorate_key(*s, pk))};
+    auto opts = query::result_options::only_result();
+    auto now = gc_clock::now();
+    auto make_key = [&] (gc_clock::time_point query_time) {
+        auto cmd = query::read_command(s->id(), s->version(), s->full_slice(), query::max_result_size(1 << 20),
+                query::row_limit::max, query::partition_limit::max, query_time);
+        return *query::read_coalescer::key::make(cmd, ranges, opts);
+    };
+    auto timeout = db::timeout_clock::now() + std::chrono::seconds(10);
+    unsigned own_reads = 0;
+    auto own_read = [&own_reads] {
+        ++own_reads;
+        return make_ready_future<query::read_coalescer::result_type>(make_lw_shared<query::result>());
+    };
+
+    promise<query::read_coalescer::result_type> shared_result;
+    auto leader = coalescer.coalesce(make_key(now), timeout, nullptr, [&] { return shared_result.get_future(); });
+    auto joiner = coalescer.coalesce(make_key(now), timeout, nullptr, own_read);
+    BOOST_REQUIRE_EQUAL(coalescer.get_stats().coalesced_reads, 1u);
+    BOOST_REQUIRE_EQUAL(own_reads, 0u);
+
+    // Reads at another query time may see other cells as expired.
+    coalescer.coalesce(make_key(now + std::chrono::seconds(1)), timeout, nullptr, own_read).get();
+    BOOST_REQUIRE_EQUAL(coalescer.get_stats().coalesced_reads, 1u);
+    BOOST_REQUIRE_EQUAL(own_reads, 1u);
+
+    shared_result.set_exception(timed_out_error());
+    BOOST_REQUIRE_THROW(leader.get(), timed_out_error);
+    BOOST_REQUIRE(joiner.get0());
+    BOOST_REQUIRE_EQUAL(own_reads, 2u);
+
+    // Other errors of the shared read are those of the joining reads too.
+    promise<query::read_coalescer::result_type> failed_result;
+    leader = coalescer.coalesce(make_key(now), timeout, nullptr, [&] { return failed_result.get_future(); });
+    joiner = coalescer.coalesce(make_key(now), timeout, nullptr, own_read);
+    failed_result.set_exception(std::runtime_error("read failed"));
+    BOOST_REQUIRE_THROW(leader.get(), std::runtime_error);
+    BOOST_REQUIRE_THROW(joiner.get(), std::runtime_error);
+    BOOST_REQUIRE_EQUAL(own_reads, 2u);
+}
+
+// Partitions of an IN query which share their replicas are read with a single
+// request to each replica. Check that the result is the same as reading them
+// one by one, with and without paging.
+SEASTAR_TEST_CASE(test_in_query_reads_partitions_sharing_replicas) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table t (p int, c int, v int, primary key (p, c));").get();
+        std::vector<std::vector<bytes_opt>> expected;
+        std::vector<sstring> keys;
+        for (int p = 0; p < 20; ++p) {
+            keys.push_back(format("{}", p));
+            for (int c = 0; c < 3; ++c) {
+                e.execute_cql(format("insert into t (p, c, v) values ({}, {}, {});", p, c, p * c)).get();
+                expected.push_back({int32_type->decompose(p), int32_type->decompose(c), int32_type->decompose(p * c)});
+            }
+        }
+        // A key with no data.
+        keys.push_back("100");
+        const auto query = format("select p, c, v from t where p in ({});", boost::algorithm::join(keys, ", "));
+
+        assert_that(e.execute_cql(query).get0()).is_rows().with_rows_ignore_order(expected);
+
+        for (int32_t page_size : {1000, 7}) {
+            std::vector<std::vector<bytes_opt>> rows;
+            lw_shared_ptr<service::pager::paging_state> paging_state;
+            do {
+                auto qo = std::make_unique<cql3::query_options>(db::consistency_level::ONE, std::vector<cql3::raw_value>{},
+                        cql3::query_options::specific_options{page_size, paging_state, {}, api::new_timestamp()});
+                auto msg = e.execute_cql(query, std::move(qo)).get0();
+                auto res = dynamic_pointer_cast<cql_transport::messages::result_message::rows>(msg);
+                BOOST_REQUIRE(res);
+                for (auto& row : res->rs().result_set().rows()) {
+                    rows.push_back(row);
+                }
+                auto state = res->rs().get_metadata().paging_state();
+                paging_state = state ? make_lw_shared<service::pager::paging_state>(*state) : nullptr;
+            } while (paging_state);
+            BOOST_REQUIRE_EQUAL(rows.size(), expected.size());
+            std::sort(rows.begin(), rows.end());
+            auto sorted_expected = expected;
+            std::sort(sorted_expected.begin(), sorted_expected.end());
+            BOOST_REQUIRE(rows == sorted_expected);
+        }
+    });
+}
+
+// Aggregations of range scans are executed in parts by the shards owning the
+// data, which return partial states of the aggregates to the coordinator.
+// Check that the merged results are correct, and the same as when all rows
+// are aggregated by the coordinator.
+SEASTAR_TEST_CASE(test_parallelized_aggregation) {
+    auto db_config = make_shared<db::config>();
+    return do_with_cql_env_thread([db_config] (cql_test_env& e) {
+        e.execute_cql("create table t (p int, c int, v int, primary key (p, c));").get();
+        for (int p = 0; p < 50; ++p) {
+            for (int c = 0; c < 3; ++c) {
+                e.execute_cql(format("insert into t (p, c, v) values ({}, {}, {});", p, c, p * c)).get();
+            }
+            // A row without a value for v.
+            e.execute_cql(format("insert into t (p, c) values ({}, 3);", p)).get();
+        }
+
+        const auto query = "select count(*), count(v), sum(v), min(v), max(v), avg(v) from t;";
+        const auto expected = std::vector<bytes_opt>{
+            long_type->decompose(int64_t(200)),
+            long_type->decompose(int64_t(150)),
+            int32_type->decompose(3675),
+            int32_type->decompose(0),
+            int32_type->decompose(98),
+            int32_type->decompose(24),
+        };
+        assert_that(e.execute_cql(query).get0()).is_rows().with_rows({expected});
+
+        // Aggregates over an empty range.
+        assert_that(e.execute_cql("select count(*), sum(v), min(v) from t where token(p) > 9223372036854775807;").get0())
+            .is_rows().with_rows({{long_type->decompose(int64_t(0)), int32_type->decompose(0), std::nullopt}});
+
+        // Queries restricted to single partitions are not forwarded.
+        const std::vector<std::pair<sstring, bool>> queries = {
+            {query, true},
+            {"select count(*) from t where token(p) > 0;", true},
+            {"select max(c), min(p) from t;", true},
+            {"select count(v) from t where p in (1, 2);", false},
+        };
+        auto requests_executed = [&e] {
+            return e.qp().map_reduce0([] (cql3::query_processor& qp) {
+                return qp.forwarder().get_stats().requests_executed;
+            }, uint64_t(0), std::plus<uint64_t>()).get0();
+        };
+        std::vector<shared_ptr<cql_transport::messages::result_message>> results;
+        for (auto& [q, forwarded] : queries) {
+            auto executed_before = requests_executed();
+            results.push_back(e.execute_cql(q).get0());
+            BOOST_REQUIRE_EQUAL(requests_executed() > executed_before, forwarded);
+        }
+        db_config->enable_parallelized_aggregation.set(false);
+        auto executed_before = requests_executed();
+        for (size_t i = 0; i < queries.size(); ++i) {
+            auto rows = dynamic_pointer_cast<cql_transport::messages::result_message::rows>(e.execute_cql(queries[i].first).get0());
+            BOOST_REQUIRE(rows);
+            auto& expected_rows = rows->rs().result_set().rows();
+            assert_that(results[i]).is_rows().with_rows({expected_rows.begin(), expected_rows.end()});
+        }
+        BOOST_REQUIRE_EQUAL(requests_executed(), executed_before);
+    }, cql_test_config(db_config));
+}
+
+// Trivial selections are written to the response straight from
+// query::result, with the key components passed as views of the keys
+// deserialized while visiting it. Check that partition key columns stay
+// valid for all rows of a partition, including the row of a partition which
+// only has a static row, which is produced at the end of the partition.
+SEASTAR_TEST_CASE(test_select_key_columns_of_many_partitions_and_rows) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("CREATE TABLE t (p1 text, p2 int, c1 text, c2 int, s int static, v int, PRIMARY KEY ((p1, p2), c1, c2))").get();
+        // Long enough not to be stored inline in bytes.
+        auto p1 = [] (int p) { return format("partition key component number {:04d}", p); };
+        auto c1 = [] (int c) { return format("clustering key component number {:04d}", c); };
+        std::vector<std::vector<bytes_opt>> expected_rows;
+        std::vector<std::vector<bytes_opt>> expected_keys;
+        for (int p = 0; p < 10; ++p) {
+            for (int c = 0; c < 5; ++c) {
+                e.execute_cql(format("INSERT INTO t (p1, p2, c1, c2, s, v) VALUES ('{}', {}, '{}', {}, {}, {})", p1(p), p, c1(c), c, p, p * 10 + c)).get();
+                expected_rows.push_back({utf8_type->decompose(p1(p)), int32_type->decompose(p), utf8_type->decompose(c1(c)),
+                        int32_type->decompose(c), int32_type->decompose(p), int32_type->decompose(p * 10 + c)});
+                expected_keys.push_back({int32_type->decompose(p * 10 + c), utf8_type->decompose(p1(p)), int32_type->decompose(p)});
+            }
+        }
+        // Partitions with no clustering rows.
+        for (int p = 10; p < 15; ++p) {
+            e.execute_cql(format("INSERT INTO t (p1, p2, s) VALUES ('{}', {}, {})", p1(p), p, p)).get();
+            expected_rows.push_back({utf8_type->decompose(p1(p)), int32_type->decompose(p), std::nullopt,
+                    std::nullopt, int32_type->decompose(p), std::nullopt});
+            expected_keys.push_back({std::nullopt, utf8_type->decompose(p1(p)), int32_type->decompose(p)});
+        }
+
+        auto msg = e.execute_cql("SELECT p1, p2, c1, c2, s, v FROM t").get0();
+        assert_that(msg).is_rows().with_rows_ignore_order(expected_rows);
+
+        // Key columns after, and in another order than, regular columns.
+        msg = e.execute_cql("SELECT v, p1, p2 FROM t").get0();
+        assert_that(msg).is_rows().with_rows_ignore_order(expected_keys);
+
+        auto id = e.prepare("SELECT p2, p1, c1 FROM t WHERE p1 = ? AND p2 = ?").get0();
+        for (int p = 0; p < 10; ++p) {
+            std::vector<std::vector<bytes_opt>> expected;
+            for (int c = 0; c < 5; ++c) {
+                expected.push_back({int32_type->decompose(p), utf8_type->decompose(p1(p)), utf8_type->decompose(c1(c))});
+            }
+            msg = e.execute_prepared(id, {cql3::raw_value::make_value(utf8_type->decompose(p1(p))),
+                    cql3::raw_value::make_value(int32_type->decompose(p))}).get0();
+            assert_that(msg).is_rows().with_rows(expected);
+        }
+    });
+}
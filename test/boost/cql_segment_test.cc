@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE cql_segment
+
+#include <boost/test/unit_test.hpp>
+#include "transport/cql_segment.hh"
+#include "exceptions/exceptions.hh"
+
+using namespace cql_transport;
+
+namespace {
+
+bytes make_payload(size_t size, bool compressible) {
+    bytes b(bytes::initialized_later(), size);
+    uint32_t x = 12345;
+    for (size_t i = 0; i < size; ++i) {
+        x = x * 1103515245 + 12345;
+        b[i] = compressible ? int8_t(i % 7) : int8_t(x >> 16);
+    }
+    return b;
+}
+
+// Decodes a single segment, as the server reads it.
+std::pair<segment_codec::header, bytes> decode(const segment_codec& codec, const temporary_buffer<char>& segment) {
+    auto h = codec.parse_header(segment.share(0, codec.header_size()));
+    auto payload = codec.decode_payload(h, segment.share(codec.header_size(), segment.size() - codec.header_size()));
+    return {h, bytes(reinterpret_cast<const int8_t*>(payload.get()), payload.size())};
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_crc24) {
+    // Values of Cassandra's org.apache.cassandra.net.Crc.crc24(), computed as
+    // described above test_cassandra_segment_format.
+    BOOST_REQUIRE_EQUAL(segment_codec::crc24(0, 0), 0x875060u);
+    BOOST_REQUIRE_EQUAL(segment_codec::crc24(0x123456, 3), 0xf5230fu);
+    // The checksum only depends on the low `len` bytes.
+    BOOST_REQUIRE_EQUAL(segment_codec::crc24(0x123456, 3), segment_codec::crc24(0xff123456, 3));
+    BOOST_REQUIRE_NE(segment_codec::crc24(0x123456, 3), segment_codec::crc24(0x123457, 3));
+    BOOST_REQUIRE_LT(segment_codec::crc24(0x123456789a, 5), 1u << 24);
+}
+
+// The expected segments below were computed independently of segment_codec,
+// by a standalone transcription of Cassandra's FrameEncoderCrc.writeHeader(),
+// FrameEncoderLZ4.writeHeader() and Crc.crc24()/Crc.crc32(). The trailer is
+// also the plain CRC32 of the payload prefixed with Crc's initial bytes.
+BOOST_AUTO_TEST_CASE(test_cassandra_segment_format) {
+    auto make_bytes = [] (std::initializer_list<uint8_t> l) {
+        return bytes(reinterpret_cast<const int8_t*>(l.begin()), l.size());
+    };
+    auto encode = [] (const segment_codec& codec, bytes_view payload, bool self_contained) {
+        auto segment = codec.encode(payload, self_contained);
+        return bytes(reinterpret_cast<const int8_t*>(segment.get()), segment.size());
+    };
+    const auto hello = make_bytes({'h', 'e', 'l', 'l', 'o'});
+    segment_codec codec(false);
+
+    BOOST_REQUIRE_EQUAL(encode(codec, bytes(), true),
+            make_bytes({0x00, 0x00, 0x02, 0x6a, 0x36, 0xc4, 0xd3, 0x7e, 0x77, 0x44}));
+    BOOST_REQUIRE_EQUAL(encode(codec, hello, true),
+            make_bytes({0x05, 0x00, 0x02, 0x19, 0x99, 0x9a, 0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x74, 0x80, 0x0e, 0xb6}));
+    BOOST_REQUIRE_EQUAL(encode(codec, hello, false),
+            make_bytes({0x05, 0x00, 0x00, 0x04, 0x48, 0x23, 0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x74, 0x80, 0x0e, 0xb6}));
+
+    // Header of a self-contained LZ4 segment of 10 compressed bytes, 100
+    // uncompressed.
+    segment_codec lz4_codec(true);
+    const uint8_t lz4_header[] = {0x0a, 0x00, 0xc8, 0x00, 0x04, 0xb2, 0xfc, 0xf3};
+    auto h = lz4_codec.parse_header(temporary_buffer<char>(reinterpret_cast<const char*>(lz4_header), sizeof(lz4_header)));
+    BOOST_REQUIRE_EQUAL(h.payload_size, 10u);
+    BOOST_REQUIRE_EQUAL(h.uncompressed_size, 100u);
+    BOOST_REQUIRE(h.self_contained);
+}
+
+BOOST_AUTO_TEST_CASE(test_round_trip) {
+    for (bool compress : {false, true}) {
+        segment_codec codec(compress);
+        for (size_t size : {size_t(0), size_t(1), size_t(9), size_t(1000), segment_codec::max_payload_size}) {
+            for (bool compressible : {false, true}) {
+                for (bool self_contained : {false, true}) {
+                    auto payload = make_payload(size, compressible);
+                    auto segment = codec.encode(payload, self_contained);
+                    auto [h, decoded] = decode(codec, segment);
+                    BOOST_REQUIRE_EQUAL(h.self_contained, self_contained);
+                    BOOST_REQUIRE_EQUAL(h.payload_size, segment.size() - codec.header_size() - segment_codec::trailer_size);
+                    BOOST_REQUIRE(decoded == payload);
+                    if (compress && compressible && size > 100) {
+                        BOOST_REQUIRE_EQUAL(h.uncompressed_size, size);
+                        BOOST_REQUIRE_LT(h.payload_size, size);
+                    } else if (!compress || !compressible) {
+                        BOOST_REQUIRE_EQUAL(h.uncompressed_size, 0u);
+                        BOOST_REQUIRE_EQUAL(h.payload_size, size);
+                    }
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_corruption_is_detected) {
+    for (bool compress : {false, true}) {
+        segment_codec codec(compress);
+        auto payload = make_payload(1000, true);
+        auto segment = codec.encode(payload, true);
+
+        auto corrupt_header = segment.clone();
+        corrupt_header.get_write()[1] ^= 0x10;
+        BOOST_REQUIRE_THROW(decode(codec, corrupt_header), exceptions::protocol_exception);
+
+        auto corrupt_payload = segment.clone();
+        corrupt_payload.get_write()[codec.header_size() + 10] ^= 0x10;
+        BOOST_REQUIRE_THROW(decode(codec, corrupt_payload), exceptions::protocol_exception);
+
+        auto truncated = segment.share(0, segment.size() - 1);
+        BOOST_REQUIRE_THROW(decode(codec, truncated), exceptions::protocol_exception);
+    }
+}
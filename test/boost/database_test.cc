@@ -43,6 +43,7 @@
 #include "test/lib/tmpdir.hh"
 #include "db/data_listeners.hh"
 #include "multishard_mutation_query.hh"
+#include "types/map.hh"
 
 using namespace std::chrono_literals;
 
@@ -146,6 +147,179 @@ SEASTAR_TEST_CASE(test_querying_with_limits) {
     });
 }
 
+SEASTAR_TEST_CASE(test_querying_with_filter) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table ks.cf (p int, c int, s int static, v int, primary key (p, c));").get();
+        for (int c = 1; c <= 4; ++c) {
+            e.execute_cql(format("insert into ks.cf (p, c, s, v) values (1, {}, 10, {});", c, c)).get();
+        }
+        e.execute_cql("insert into ks.cf (p, c, s, v) values (2, 1, 20, 5);").get();
+        e.execute_cql("insert into ks.cf (p, s) values (3, 30);").get();
+
+        auto& db = e.local_db();
+        auto s = db.find_schema("ks", "cf");
+        auto do_query = [&] (std::vector<query::column_restriction> filter, uint64_t row_limit = query::max_rows) {
+            auto slice = partition_slice_builder(*s).build();
+            slice.filter = std::move(filter);
+            auto cmd = query::read_command(s->id(), s->version(), std::move(slice), query::max_result_size(std::numeric_limits<size_t>::max()),
+                    query::row_limit(row_limit));
+            auto result = std::get<0>(db.query(s, cmd, query::result_options::only_result(), {query::full_partition_range}, nullptr, db::no_timeout).get0());
+            return query::result_set::from_raw_result(s, cmd.slice, *result);
+        };
+        auto restriction = [] (sstring column, query::restriction_op op, std::vector<int32_t> values) {
+            query::column_restriction r{to_bytes(column), op, {}};
+            for (auto v : values) {
+                r.values.push_back(int32_type->decompose(v));
+            }
+            return r;
+        };
+
+        // Rows not matching aren't counted against the limits.
+        assert_that(do_query({restriction("v", query::restriction_op::gte, {3})})).has_size(3)
+            .has(a_row().with_column("p", 1).with_column("c", 3).with_column("s", 10))
+            .has(a_row().with_column("p", 1).with_column("c", 4).with_column("s", 10))
+            .has(a_row().with_column("p", 2).with_column("c", 1).with_column("s", 20));
+        assert_that(do_query({restriction("v", query::restriction_op::gte, {3})}, 2)).has_size(2);
+        assert_that(do_query({restriction("v", query::restriction_op::in, {2, 4}), restriction("s", query::restriction_op::in, {10})})).has_size(2)
+            .has(a_row().with_column("p", 1).with_column("c", 2))
+            .has(a_row().with_column("p", 1).with_column("c", 4));
+
+        // A partition without rows is returned only if its static row matches.
+        assert_that(do_query({restriction("s", query::restriction_op::gt, {20})}))
+            .has_only(a_row().with_column("p", 3).with_column("s", 30));
+        assert_that(do_query({restriction("s", query::restriction_op::lt, {20})})).has_size(4);
+
+        // A restriction on a clustering column excludes partitions without rows.
+        assert_that(do_query({restriction("c", query::restriction_op::in, {2})}))
+            .has_only(a_row().with_column("p", 1).with_column("c", 2).with_column("v", 2));
+
+        // Comparisons with null never match.
+        assert_that(do_query({restriction("v", query::restriction_op::lt, {})})).is_empty();
+    });
+}
+
+// Rows dropped by the filter count against a budget of one page worth of
+// rows. Once it is used up, the page ends short on the next dropped row,
+// which is returned so that the next page starts after it.
+SEASTAR_TEST_CASE(test_querying_with_filter_ends_page_short) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table ks.cf (p int, c int, v int, primary key (p, c));").get();
+        for (int c = 0; c < 10; ++c) {
+            e.execute_cql(format("insert into ks.cf (p, c, v) values (1, {}, {});", c, c)).get();
+        }
+
+        auto& db = e.local_db();
+        auto s = db.find_schema("ks", "cf");
+        auto pr = dht::partition_range::make_singular(dht::decorate_key(*s, partition_key::from_single_value(*s, int32_type->decompose(1))));
+        auto do_query = [&] (bool allow_short_read, int32_t first_row) {
+            auto slice = partition_slice_builder(*s)
+                .with_range(query::clustering_range::make_starting_with(clustering_key::from_single_value(*s, int32_type->decompose(first_row))))
+                .build();
+            if (allow_short_read) {
+                slice.options.set<query::partition_slice::option::allow_short_read>();
+            }
+            slice.filter = {query::column_restriction{to_bytes("v"), query::restriction_op::gte, {int32_type->decompose(8)}}};
+            auto cmd = query::read_command(s->id(), s->version(), std::move(slice), query::max_result_size(std::numeric_limits<size_t>::max()),
+                    query::row_limit(3));
+            auto result = std::get<0>(db.query(s, cmd, query::result_options::only_result(), {pr}, nullptr, db::no_timeout).get0());
+            return std::pair(query::result_set::from_raw_result(s, cmd.slice, *result), bool(result->is_short_read()));
+        };
+
+        // Rows 0 to 2 use up the budget, row 3 ends the page.
+        auto [rs, short_read] = do_query(true, 0);
+        BOOST_REQUIRE(short_read);
+        assert_that(rs).has_only(a_row().with_column("c", 3).with_column("v", 3));
+        std::tie(rs, short_read) = do_query(true, 4);
+        BOOST_REQUIRE(short_read);
+        assert_that(rs).has_only(a_row().with_column("c", 7).with_column("v", 7));
+        std::tie(rs, short_read) = do_query(true, 8);
+        BOOST_REQUIRE(!short_read);
+        assert_that(rs).has_size(2)
+            .has(a_row().with_column("c", 8))
+            .has(a_row().with_column("c", 9));
+
+        // Queries which can't be short have no budget.
+        std::tie(rs, short_read) = do_query(false, 0);
+        BOOST_REQUIRE(!short_read);
+        assert_that(rs).has_size(2);
+    });
+}
+
+SEASTAR_TEST_CASE(test_querying_with_filter_on_various_types) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table ks.cf (p int, c bigint, t timestamp, txt text, v int, primary key (p, c)) "
+                "with clustering order by (c desc);").get();
+        for (int c = -2; c <= 2; ++c) {
+            e.execute_cql(format("insert into ks.cf (p, c, t, txt, v) values (1, {}, {}, '{}', {});", c, c, char('c' + c), c * 10)).get();
+        }
+        // Empty values are valid for integer types, and sort before all others.
+        e.execute_cql("insert into ks.cf (p, c, t, txt, v) values (1, 3, 3, 'f', blobAsInt(0x));").get();
+
+        auto& db = e.local_db();
+        auto s = db.find_schema("ks", "cf");
+        auto do_query = [&] (query::column_restriction r) {
+            auto slice = partition_slice_builder(*s).build();
+            slice.filter = {std::move(r)};
+            auto cmd = query::read_command(s->id(), s->version(), std::move(slice), query::max_result_size(std::numeric_limits<size_t>::max()));
+            auto result = std::get<0>(db.query(s, cmd, query::result_options::only_result(), {query::full_partition_range}, nullptr, db::no_timeout).get0());
+            return query::result_set::from_raw_result(s, cmd.slice, *result);
+        };
+        auto bigint = [] (int64_t v) { return long_type->decompose(v); };
+
+        assert_that(do_query({to_bytes("c"), query::restriction_op::in, {bigint(2), bigint(-2), bigint(2)}})).has_size(2)
+            .has(a_row().with_column("c", int64_t(2)))
+            .has(a_row().with_column("c", int64_t(-2)));
+        assert_that(do_query({to_bytes("c"), query::restriction_op::gt, {bigint(-1)}})).has_size(4);
+        assert_that(do_query({to_bytes("t"), query::restriction_op::lte, {bigint(0)}})).has_size(3);
+        assert_that(do_query({to_bytes("v"), query::restriction_op::lt, {int32_type->decompose(0)}})).has_size(3)
+            .has(a_row().with_column("c", int64_t(3)));
+        assert_that(do_query({to_bytes("v"), query::restriction_op::in, {bytes(), int32_type->decompose(10)}})).has_size(2)
+            .has(a_row().with_column("c", int64_t(1)))
+            .has(a_row().with_column("c", int64_t(3)));
+        assert_that(do_query({to_bytes("txt"), query::restriction_op::gte, {utf8_type->decompose(sstring("d"))}})).has_size(3);
+    });
+}
+
+SEASTAR_TEST_CASE(test_querying_with_collection_keys) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        e.execute_cql("create table ks.cf (p int primary key, m map<text, int>, v int);").get();
+        e.execute_cql("insert into ks.cf (p, m, v) values (1, {'a': 1, 'b': 2, 'c': 3}, 10);").get();
+        e.execute_cql("insert into ks.cf (p, m, v) values (2, {'x': 1}, 20);").get();
+        e.execute_cql("delete m['c'] from ks.cf where p = 1;").get();
+
+        auto& db = e.local_db();
+        auto s = db.find_schema("ks", "cf");
+        auto m_type = map_type_impl::get_instance(utf8_type, int32_type, true);
+        auto do_query = [&] (std::vector<sstring> keys) {
+            auto slice = partition_slice_builder(*s).build();
+            query::collection_keys_selection sel{to_bytes("m"), {}};
+            for (auto& k : keys) {
+                sel.keys.push_back(utf8_type->decompose(k));
+            }
+            slice.collection_keys.push_back(std::move(sel));
+            auto cmd = query::read_command(s->id(), s->version(), std::move(slice), query::max_result_size(std::numeric_limits<size_t>::max()));
+            auto result = std::get<0>(db.query(s, cmd, query::result_options::only_result(), {query::full_partition_range}, nullptr, db::no_timeout).get0());
+            return query::result_set::from_raw_result(s, cmd.slice, *result);
+        };
+
+        auto rs = do_query({"a", "c", "z"});
+        assert_that(rs).has_size(2)
+            .has(a_row().with_column("p", 1).with_column("v", 10)
+                    .with_column("m", make_map_value(m_type, map_type_impl::native_type{{sstring("a"), 1}})))
+            .has(a_row().with_column("p", 2).with_column("v", 20));
+        // Rows without any of the selected cells are still returned.
+        for (auto& row : rs.rows()) {
+            if (row.get_nonnull<int32_t>("p") == 2) {
+                BOOST_REQUIRE(!row.get_data_value("m"));
+            }
+        }
+
+        assert_that(do_query({"b", "x"})).has_size(2)
+            .has(a_row().with_column("p", 1).with_column("m", make_map_value(m_type, map_type_impl::native_type{{sstring("b"), 2}})))
+            .has(a_row().with_column("p", 2).with_column("m", make_map_value(m_type, map_type_impl::native_type{{sstring("x"), 1}})));
+    });
+}
+
 SEASTAR_THREAD_TEST_CASE(test_database_with_data_in_sstables_is_a_mutation_source) {
     do_with_cql_env_thread([] (cql_test_env& e) {
         run_mutation_source_tests([&] (schema_ptr s, const std::vector<mutation>& partitions) -> mutation_source {
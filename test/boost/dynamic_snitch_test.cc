@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/testing/thread_test_case.hh>
+#include <seastar/core/sleep.hh>
+
+#include "locator/dynamic_snitch.hh"
+
+using namespace std::chrono_literals;
+
+static const gms::inet_address ep1("127.0.0.1");
+static const gms::inet_address ep2("127.0.0.2");
+static const gms::inet_address ep3("127.0.0.3");
+
+static locator::dynamic_snitch::config make_config(bool enabled = true, double badness_threshold = 0.1, uint32_t reset_interval_in_ms = 600000) {
+    return locator::dynamic_snitch::config{
+        .enabled = utils::updateable_value<bool>(enabled),
+        .badness_threshold = utils::updateable_value<double>(badness_threshold),
+        .update_interval_in_ms = utils::updateable_value<uint32_t>(10),
+        .reset_interval_in_ms = utils::updateable_value<uint32_t>(reset_interval_in_ms),
+    };
+}
+
+static void record(locator::dynamic_snitch& ds, gms::inet_address ep, locator::dynamic_snitch::clock_type::duration latency) {
+    ds.on_request_sent(ep);
+    ds.on_response(ep, latency);
+}
+
+// Scores are computed periodically, give the snitch time to do it.
+static void wait_for_update() {
+    seastar::sleep(100ms).get();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_dynamic_snitch_keeps_proximity_order_without_samples) {
+    locator::dynamic_snitch ds(make_config());
+    wait_for_update();
+
+    std::vector<gms::inet_address> eps{ep1, ep2, ep3};
+    BOOST_REQUIRE(!ds.sort_by_score(eps));
+    BOOST_REQUIRE(eps == std::vector<gms::inet_address>({ep1, ep2, ep3}));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_dynamic_snitch_moves_slow_replica_back) {
+    locator::dynamic_snitch ds(make_config());
+    record(ds, ep1, 10ms);
+    record(ds, ep2, 1ms);
+    record(ds, ep3, 2ms);
+    wait_for_update();
+
+    BOOST_REQUIRE_EQUAL(ds.get_score(ep1), 1);
+    BOOST_REQUIRE_LT(ds.get_score(ep2), ds.get_score(ep3));
+
+    std::vector<gms::inet_address> eps{ep1, ep2, ep3};
+    BOOST_REQUIRE(ds.sort_by_score(eps));
+    BOOST_REQUIRE(eps == std::vector<gms::inet_address>({ep2, ep3, ep1}));
+    BOOST_REQUIRE_EQUAL(ds.get_stats().reorders, 1);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_dynamic_snitch_keeps_unscored_replicas_in_place) {
+    locator::dynamic_snitch ds(make_config());
+    record(ds, ep1, 10ms);
+    record(ds, ep2, 1ms);
+    wait_for_update();
+
+    // ep3, e.g. a remote replica, has no score: it must not be moved ahead
+    // of the scored ones, nor they behind it.
+    std::vector<gms::inet_address> eps{ep1, ep2, ep3};
+    BOOST_REQUIRE(ds.sort_by_score(eps));
+    BOOST_REQUIRE(eps == std::vector<gms::inet_address>({ep2, ep1, ep3}));
+
+    eps = {ep3, ep1};
+    BOOST_REQUIRE(!ds.sort_by_score(eps));
+    BOOST_REQUIRE(eps == std::vector<gms::inet_address>({ep3, ep1}));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_dynamic_snitch_badness_threshold) {
+    locator::dynamic_snitch ds(make_config(true, 0.1));
+    record(ds, ep1, 1050us);
+    record(ds, ep2, 1000us);
+    wait_for_update();
+
+    // ep1 is slower, but by less than the threshold.
+    std::vector<gms::inet_address> eps{ep1, ep2};
+    BOOST_REQUIRE(!ds.sort_by_score(eps));
+    BOOST_REQUIRE(eps == std::vector<gms::inet_address>({ep1, ep2}));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_dynamic_snitch_accounts_for_requests_in_flight) {
+    locator::dynamic_snitch ds(make_config());
+    record(ds, ep1, 1ms);
+    record(ds, ep2, 1ms);
+    ds.on_request_sent(ep1);
+    ds.on_request_sent(ep1);
+    wait_for_update();
+
+    std::vector<gms::inet_address> eps{ep1, ep2};
+    BOOST_REQUIRE(ds.sort_by_score(eps));
+    BOOST_REQUIRE(eps == std::vector<gms::inet_address>({ep2, ep1}));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_dynamic_snitch_disabled) {
+    locator::dynamic_snitch ds(make_config(false));
+    record(ds, ep1, 10ms);
+    record(ds, ep2, 1ms);
+    wait_for_update();
+
+    std::vector<gms::inet_address> eps{ep1, ep2};
+    BOOST_REQUIRE(!ds.sort_by_score(eps));
+    BOOST_REQUIRE(eps == std::vector<gms::inet_address>({ep1, ep2}));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_dynamic_snitch_reset) {
+    locator::dynamic_snitch ds(make_config(true, 0.1, 50));
+    record(ds, ep1, 10ms);
+    record(ds, ep2, 1ms);
+    wait_for_update();
+
+    // The samples are forgotten, so ep1 gets another chance.
+    BOOST_REQUIRE(ds.get_scores().empty());
+    std::vector<gms::inet_address> eps{ep1, ep2};
+    BOOST_REQUIRE(!ds.sort_by_score(eps));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_dynamic_snitch_latency_percentile) {
+    locator::dynamic_snitch ds(make_config());
+    BOOST_REQUIRE(!ds.get_latency_percentile(ep1, 0.99));
+
+    for (int i = 0; i < 99; ++i) {
+        record(ds, ep1, 1ms);
+    }
+    // Too few samples.
+    BOOST_REQUIRE(!ds.get_latency_percentile(ep1, 0.99));
+
+    record(ds, ep1, 1ms);
+    auto p99 = ds.get_latency_percentile(ep1, 0.99);
+    BOOST_REQUIRE(p99);
+    BOOST_REQUIRE_GE(p99->count(), 500);
+    BOOST_REQUIRE_LE(p99->count(), 1500);
+
+    // Failures affect the score, not the latency distribution.
+    for (int i = 0; i < 100; ++i) {
+        ds.on_request_sent(ep1);
+        ds.on_failure(ep1, 10s);
+    }
+    BOOST_REQUIRE(ds.get_latency_percentile(ep1, 0.5) == ds.get_latency_percentile(ep1, 0.99));
+    BOOST_REQUIRE_LE(ds.get_latency_percentile(ep1, 0.99)->count(), 1500);
+}
@@ -30,6 +30,7 @@
 #include "test/lib/mutation_source_test.hh"
 #include "flat_mutation_reader.hh"
 #include "mutation_reader.hh"
+#include "partition_slice_builder.hh"
 #include "schema_builder.hh"
 #include "memtable.hh"
 #include "row_cache.hh"
@@ -823,3 +824,73 @@ SEASTAR_THREAD_TEST_CASE(test_reverse_reader_memory_limit) {
     test_with_partition(true);
     test_with_partition(false);
 }
+
+SEASTAR_THREAD_TEST_CASE(test_windowed_reversing_reader) {
+    simple_schema ss;
+    auto s = ss.schema();
+    auto pk = ss.make_pkey();
+
+    mutation m(s, pk);
+    ss.add_static_row(m, "s1");
+    for (uint32_t i = 0; i < 100; ++i) {
+        ss.add_row(m, ss.make_ckey(i), sstring(1024, 'a' + i % 26));
+    }
+    ss.delete_range(m, query::clustering_range::make({ss.make_ckey(15), true}, {ss.make_ckey(42), false}));
+    ss.delete_range(m, query::clustering_range::make({ss.make_ckey(60), false}, {ss.make_ckey(61), true}));
+
+    auto mt = make_lw_shared<memtable>(s);
+    mt->apply(m);
+    auto pr = dht::partition_range::make_singular(pk);
+
+    auto read = [&] (query::clustering_row_ranges ranges, std::vector<clustering_key_prefix> boundaries, query::max_result_size max_size) {
+        // The ranges of reversed slices are in reverse order.
+        std::reverse(ranges.begin(), ranges.end());
+        auto slice = partition_slice_builder(*s).with_ranges(std::move(ranges)).reversed().build();
+        auto rd = make_windowed_reversing_reader(mt->as_data_source(), s, tests::make_permit(), pr, slice, default_priority_class(), nullptr,
+                [boundaries = std::move(boundaries)] (const dht::decorated_key&, reader_permit, tracing::trace_state_ptr) {
+            return make_ready_future<std::vector<clustering_key_prefix>>(boundaries);
+        }, max_size);
+        auto close_rd = deferred_close(rd);
+        return rd.consume(flat_stream_consumer(s, reversed_partitions::yes), db::no_timeout).get0();
+    };
+
+    auto check = [&] (query::clustering_row_ranges ranges, std::vector<clustering_key_prefix> boundaries) {
+        testlog.info("Reading {} with boundaries {}", ranges, boundaries);
+        auto muts = read(ranges, std::move(boundaries), query::max_result_size(size_t(1) << 20));
+        BOOST_REQUIRE_EQUAL(muts.size(), 1);
+        BOOST_REQUIRE_EQUAL(muts[0].sliced(ranges), m.sliced(ranges));
+    };
+
+    auto every = [&] (uint32_t n, uint32_t offset = 0) {
+        std::vector<clustering_key_prefix> boundaries;
+        for (uint32_t i = offset; i < 100; i += n) {
+            boundaries.push_back(ss.make_ckey(i));
+        }
+        return boundaries;
+    };
+
+    const auto full = query::clustering_row_ranges{query::clustering_range::make_open_ended_both_sides()};
+    const auto partial = query::clustering_row_ranges{
+        query::clustering_range::make({ss.make_ckey(3), true}, {ss.make_ckey(20), false}),
+        query::clustering_range::make_singular(ss.make_ckey(33)),
+        query::clustering_range::make({ss.make_ckey(40), false}, {ss.make_ckey(70), true}),
+    };
+
+    for (auto& ranges : {full, partial}) {
+        check(ranges, {});
+        check(ranges, every(1));
+        check(ranges, every(7));
+        check(ranges, every(10, 5));
+        // Duplicate boundaries.
+        auto boundaries = every(13);
+        auto duplicates = boundaries;
+        boundaries.insert(boundaries.end(), duplicates.begin(), duplicates.end());
+        std::sort(boundaries.begin(), boundaries.end(), clustering_key_prefix::less_compare(*s));
+        check(ranges, std::move(boundaries));
+    }
+
+    // Only a window at a time is kept in memory.
+    const auto max_size = query::max_result_size(size_t(1) << 10, size_t(1) << 16);
+    BOOST_REQUIRE_EQUAL(read(full, every(10), max_size).size(), 1);
+    BOOST_REQUIRE_THROW(read(full, {}, max_size), std::runtime_error);
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/testing/thread_test_case.hh>
+
+#include "service/paxos/paxos_state_cache.hh"
+#include "schema_builder.hh"
+#include "mutation.hh"
+#include "types.hh"
+
+using namespace service::paxos;
+
+static schema_ptr make_schema() {
+    return schema_builder("ks", "cf")
+        .with_column("pk", int32_type, column_kind::partition_key)
+        .with_column("v", int32_type)
+        .with_column("blob", bytes_type)
+        .build();
+}
+
+static partition_key make_key(const schema& s, int32_t v) {
+    return partition_key::from_single_value(s, int32_type->decompose(v));
+}
+
+static utils::UUID ballot_at(std::chrono::microseconds ts) {
+    return utils::UUID_gen::get_random_time_UUID_from_micros(ts);
+}
+
+static proposal make_proposal(const schema_ptr& s, const partition_key& key, utils::UUID ballot, int32_t v) {
+    mutation m(s, key);
+    m.set_clustered_cell(clustering_key::make_empty(), to_bytes("v"), data_value(v), utils::UUID_gen::micros_timestamp(ballot));
+    return proposal(ballot, freeze(m));
+}
+
+static std::chrono::microseconds now_micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_paxos_state_cache_hit_and_miss) {
+    auto s = make_schema();
+    auto key = make_key(*s, 1);
+    paxos_state_cache cache(utils::updateable_value<uint32_t>(10), utils::updateable_value<uint32_t>(16));
+
+    BOOST_REQUIRE(!cache.get(*s, key, gc_clock::now()));
+    cache.populate(*s, key, paxos_state(), cache.version(*s, key));
+    auto state = cache.get(*s, key, gc_clock::now());
+    BOOST_REQUIRE(state);
+    BOOST_REQUIRE(!state->accepted_proposal());
+    BOOST_REQUIRE(!state->most_recent_commit());
+    BOOST_REQUIRE_EQUAL(cache.get_stats().hits, 1);
+    BOOST_REQUIRE_EQUAL(cache.get_stats().misses, 1);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_paxos_state_cache_populate_after_update_is_ignored) {
+    auto s = make_schema();
+    auto key = make_key(*s, 1);
+    paxos_state_cache cache(utils::updateable_value<uint32_t>(10), utils::updateable_value<uint32_t>(16));
+
+    // A write completing while the state is read from the table makes the read stale.
+    auto version = cache.version(*s, key);
+    cache.on_promise(*s, key, ballot_at(now_micros()));
+    cache.populate(*s, key, paxos_state(), version);
+    BOOST_REQUIRE(!cache.get(*s, key, gc_clock::now()));
+
+    // Writes to other keys don't, unless they share the key's version
+    // counter, which only a few of many keys do.
+    unsigned stale = 0;
+    for (int32_t i = 2; i < 102; ++i) {
+        version = cache.version(*s, key);
+        cache.on_promise(*s, make_key(*s, i), ballot_at(now_micros()));
+        if (cache.version(*s, key) != version) {
+            ++stale;
+        } else {
+            cache.populate(*s, key, paxos_state(), version);
+        }
+    }
+    BOOST_REQUIRE_LT(stale, 10u);
+    BOOST_REQUIRE(cache.get(*s, key, gc_clock::now()));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_paxos_state_cache_merges_by_ballot_timestamp) {
+    auto s = make_schema();
+    auto key = make_key(*s, 1);
+    paxos_state_cache cache(utils::updateable_value<uint32_t>(10), utils::updateable_value<uint32_t>(16));
+    cache.populate(*s, key, paxos_state(), cache.version(*s, key));
+
+    auto t = now_micros();
+    auto b1 = ballot_at(t);
+    auto b2 = ballot_at(t + std::chrono::microseconds(1));
+    auto b3 = ballot_at(t + std::chrono::microseconds(2));
+
+    cache.on_promise(*s, key, b2);
+    // An older promise doesn't override a newer one.
+    cache.on_promise(*s, key, b1);
+    BOOST_REQUIRE_EQUAL(cache.get(*s, key, gc_clock::now())->promised_ballot(), b2);
+
+    cache.on_proposal(*s, make_proposal(s, key, b2, 2));
+    auto state = cache.get(*s, key, gc_clock::now());
+    BOOST_REQUIRE(state->accepted_proposal());
+    BOOST_REQUIRE_EQUAL(state->accepted_proposal()->ballot, b2);
+
+    // A decision deletes accepted proposals which are not newer than it.
+    cache.on_decision(*s, make_proposal(s, key, b3, 3));
+    state = cache.get(*s, key, gc_clock::now());
+    BOOST_REQUIRE(!state->accepted_proposal());
+    BOOST_REQUIRE(state->most_recent_commit());
+    BOOST_REQUIRE_EQUAL(state->most_recent_commit()->ballot, b3);
+
+    // A late accept is shadowed by the deletion.
+    cache.on_proposal(*s, make_proposal(s, key, b2, 2));
+    BOOST_REQUIRE(!cache.get(*s, key, gc_clock::now())->accepted_proposal());
+
+    // Pruning keeps the ballot of the most recent commit but drops its value.
+    cache.on_prune(*s, key, b3);
+    state = cache.get(*s, key, gc_clock::now());
+    BOOST_REQUIRE_EQUAL(state->most_recent_commit()->ballot, b3);
+    BOOST_REQUIRE(state->most_recent_commit()->update.unfreeze(s).partition().empty());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_paxos_state_cache_ambiguous_update_invalidates) {
+    auto s = make_schema();
+    auto key = make_key(*s, 1);
+    paxos_state_cache cache(utils::updateable_value<uint32_t>(10), utils::updateable_value<uint32_t>(16));
+    cache.populate(*s, key, paxos_state(), cache.version(*s, key));
+
+    auto t = now_micros();
+    auto b1 = ballot_at(t);
+    auto b2 = ballot_at(t);
+    BOOST_REQUIRE(b1 != b2);
+    cache.on_promise(*s, key, b1);
+    cache.on_promise(*s, key, b2);
+    BOOST_REQUIRE(!cache.get(*s, key, gc_clock::now()));
+    BOOST_REQUIRE_EQUAL(cache.get_stats().invalidations, 1);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_paxos_state_cache_eviction) {
+    auto s = make_schema();
+    paxos_state_cache cache(utils::updateable_value<uint32_t>(2), utils::updateable_value<uint32_t>(16));
+
+    auto k1 = make_key(*s, 1);
+    auto k2 = make_key(*s, 2);
+    auto k3 = make_key(*s, 3);
+    cache.populate(*s, k1, paxos_state(), cache.version(*s, k1));
+    cache.populate(*s, k2, paxos_state(), cache.version(*s, k2));
+    // Make k1 the most recently used entry.
+    BOOST_REQUIRE(cache.get(*s, k1, gc_clock::now()));
+    cache.populate(*s, k3, paxos_state(), cache.version(*s, k3));
+
+    BOOST_REQUIRE_EQUAL(cache.size(), 2);
+    BOOST_REQUIRE_EQUAL(cache.get_stats().evictions, 1);
+    BOOST_REQUIRE(cache.get(*s, k1, gc_clock::now()));
+    BOOST_REQUIRE(!cache.get(*s, k2, gc_clock::now()));
+    BOOST_REQUIRE(cache.get(*s, k3, gc_clock::now()));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_paxos_state_cache_expiry) {
+    auto s = make_schema();
+    auto key = make_key(*s, 1);
+    paxos_state_cache cache(utils::updateable_value<uint32_t>(10), utils::updateable_value<uint32_t>(16));
+    cache.populate(*s, key, paxos_state(ballot_at(now_micros()), std::nullopt, std::nullopt), cache.version(*s, key));
+
+    BOOST_REQUIRE(cache.get(*s, key, gc_clock::now()));
+    BOOST_REQUIRE(!cache.get(*s, key, gc_clock::now() + s->paxos_grace_seconds()));
+    BOOST_REQUIRE_EQUAL(cache.size(), 0);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_paxos_state_cache_memory_limit) {
+    auto s = make_schema();
+    paxos_state_cache cache(utils::updateable_value<uint32_t>(10), utils::updateable_value<uint32_t>(1));
+    auto make_large_proposal = [&] (const partition_key& key) {
+        auto ballot = ballot_at(now_micros());
+        mutation m(s, key);
+        m.set_clustered_cell(clustering_key::make_empty(), to_bytes("blob"), data_value(bytes(400 * 1024, 'x')), utils::UUID_gen::micros_timestamp(ballot));
+        return proposal(ballot, freeze(m));
+    };
+
+    auto k1 = make_key(*s, 1);
+    auto k2 = make_key(*s, 2);
+    auto k3 = make_key(*s, 3);
+    cache.populate(*s, k1, paxos_state(), cache.version(*s, k1));
+    cache.populate(*s, k2, paxos_state(), cache.version(*s, k2));
+    cache.populate(*s, k3, paxos_state(), cache.version(*s, k3));
+    BOOST_REQUIRE_EQUAL(cache.size(), 3);
+
+    // Accepting large proposals evicts the least recently used entries to
+    // stay within the budget.
+    cache.on_proposal(*s, make_large_proposal(k1));
+    cache.on_proposal(*s, make_large_proposal(k2));
+    BOOST_REQUIRE_LE(cache.memory_usage(), 1u << 20);
+    BOOST_REQUIRE_EQUAL(cache.size(), 3);
+    cache.on_proposal(*s, make_large_proposal(k3));
+    BOOST_REQUIRE_LE(cache.memory_usage(), 1u << 20);
+    BOOST_REQUIRE_EQUAL(cache.size(), 2);
+    BOOST_REQUIRE_EQUAL(cache.get_stats().evictions, 1);
+    BOOST_REQUIRE(!cache.get(*s, k1, gc_clock::now()));
+
+    // A state larger than the budget isn't cached at all.
+    auto k4 = make_key(*s, 4);
+    auto huge = proposal(ballot_at(now_micros()), freeze([&] {
+        mutation m(s, k4);
+        m.set_clustered_cell(clustering_key::make_empty(), to_bytes("blob"), data_value(bytes(2 << 20, 'x')), 0);
+        return m;
+    }()));
+    cache.populate(*s, k4, paxos_state(huge.ballot, huge, std::nullopt), cache.version(*s, k4));
+    BOOST_REQUIRE(!cache.get(*s, k4, gc_clock::now()));
+    BOOST_REQUIRE_EQUAL(cache.size(), 2);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_paxos_state_cache_invalidate_tables) {
+    auto s1 = make_schema();
+    auto s2 = schema_builder("ks", "cf2")
+        .with_column("pk", int32_type, column_kind::partition_key)
+        .with_column("v", int32_type)
+        .build();
+    paxos_state_cache cache(utils::updateable_value<uint32_t>(10), utils::updateable_value<uint32_t>(16));
+    for (int32_t i = 0; i < 3; ++i) {
+        auto k1 = make_key(*s1, i);
+        auto k2 = make_key(*s2, i);
+        cache.populate(*s1, k1, paxos_state(), cache.version(*s1, k1));
+        cache.populate(*s2, k2, paxos_state(), cache.version(*s2, k2));
+    }
+    BOOST_REQUIRE_EQUAL(cache.size(), 6);
+
+    cache.invalidate_tables([&] (const utils::UUID& table_id) {
+        return table_id == s1->id();
+    });
+    BOOST_REQUIRE_EQUAL(cache.size(), 3);
+    BOOST_REQUIRE(!cache.get(*s1, make_key(*s1, 0), gc_clock::now()));
+    BOOST_REQUIRE(cache.get(*s2, make_key(*s2, 0), gc_clock::now()));
+}
@@ -32,6 +32,7 @@
 #include "test/lib/cql_assertions.hh"
 
 #include <seastar/core/future-util.hh>
+#include <seastar/core/sleep.hh>
 #include <seastar/core/metrics_api.hh>
 #include "transport/messages/result_message.hh"
 #include "cql3/query_processor.hh"
@@ -365,3 +366,51 @@ SEASTAR_TEST_CASE(test_select_full_scan_metrics) {
         BOOST_CHECK_EQUAL(stat_ps8, qp.get_cql_stats().select_partition_range_scan);
     });
 }
+
+SEASTAR_TEST_CASE(test_unprepared_statements_cache) {
+    return do_with_cql_env_thread([] (cql_test_env& e) {
+        auto& cache = e.local_qp().get_unprepared_statements_cache();
+        e.execute_cql("create table ks.usc (pk int, ck int, v int, primary key (pk, ck));").get();
+
+        auto hits = cache.get_stats().hits;
+        e.execute_cql("insert into ks.usc (pk, ck, v) values (0, 0, 0);").get();
+        e.execute_cql("insert into ks.usc (pk, ck, v) values (0, 0, 0);").get();
+        BOOST_REQUIRE_EQUAL(cache.get_stats().hits, hits + 1);
+
+        e.execute_cql("select * from ks.usc where pk = 0;").get();
+        assert_that(e.execute_cql("select * from ks.usc where pk = 0;").get0())
+                .is_rows().with_rows({{int32_type->decompose(0), int32_type->decompose(0), int32_type->decompose(0)}});
+        BOOST_REQUIRE_EQUAL(cache.get_stats().hits, hits + 2);
+
+        // Schema changes must invalidate the cached statements.
+        auto invalidations = cache.get_stats().invalidations;
+        e.execute_cql("alter table ks.usc add w int;").get();
+        BOOST_REQUIRE_GT(cache.get_stats().invalidations, invalidations);
+        assert_that(e.execute_cql("select * from ks.usc where pk = 0;").get0())
+                .is_rows().with_rows({{int32_type->decompose(0), int32_type->decompose(0), int32_type->decompose(0), {}}});
+
+        // Only DML statements are cached.
+        auto size = cache.size();
+        e.execute_cql("create table ks.usc2 (pk int primary key);").get();
+        BOOST_REQUIRE_EQUAL(cache.size(), size);
+
+        // Functions of the current time are evaluated on each execution,
+        // not when the cached statement was prepared.
+        e.execute_cql("create table ks.usc3 (pk int primary key, u timeuuid, ts timestamp);").get();
+        auto read_times = [&] {
+            auto rs = e.local_qp().execute_internal("select u, ts from ks.usc3 where pk = 0;").get0();
+            auto& row = rs->one();
+            return std::make_pair(row.get_as<utils::UUID>("u"), row.get_as<db_clock::time_point>("ts"));
+        };
+        const sstring update = "update ks.usc3 set u = currenttimeuuid(), ts = currenttimestamp() where pk = 0;";
+        e.execute_cql(update).get();
+        auto first = read_times();
+        seastar::sleep(std::chrono::milliseconds(2)).get();
+        hits = cache.get_stats().hits;
+        e.execute_cql(update).get();
+        BOOST_REQUIRE_EQUAL(cache.get_stats().hits, hits + 1);
+        auto second = read_times();
+        BOOST_REQUIRE(first.first != second.first);
+        BOOST_REQUIRE(first.second < second.second);
+    });
+}
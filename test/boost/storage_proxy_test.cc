@@ -22,12 +22,15 @@
 
 #include <seastar/core/thread.hh>
 #include <seastar/testing/test_case.hh>
+#include <seastar/testing/thread_test_case.hh>
 #include "query-result-writer.hh"
 
 #include "test/lib/cql_test_env.hh"
 #include "test/lib/mutation_source_test.hh"
 #include "test/lib/result_set_assertions.hh"
 #include "service/storage_proxy.hh"
+#include "service/pager/paging_state.hh"
+#include "utils/bit_cast.hh"
 #include "partition_slice_builder.hh"
 #include "schema_builder.hh"
 
@@ -112,3 +115,70 @@ SEASTAR_TEST_CASE(test_get_restricted_ranges) {
         });
     });
 }
+
+SEASTAR_THREAD_TEST_CASE(test_estimate_next_concurrency_factor) {
+    using service::estimate_next_concurrency_factor;
+    using service::max_initial_range_concurrency;
+
+    // Dense table: a single range fills the page.
+    BOOST_REQUIRE_EQUAL(estimate_next_concurrency_factor(100, 100, false, 1, 1), 1u);
+    BOOST_REQUIRE_EQUAL(estimate_next_concurrency_factor(100, 100, false, 3, 2), 3u);
+
+    // Sparse table: 10 rows over 3 ranges need 30 ranges for 100 rows.
+    BOOST_REQUIRE_EQUAL(estimate_next_concurrency_factor(100, 10, false, 3, 16), 30u);
+    // ...capped at twice the concurrency the page ended with.
+    BOOST_REQUIRE_EQUAL(estimate_next_concurrency_factor(100, 10, false, 3, 2), 4u);
+    // ...and at max_initial_range_concurrency.
+    BOOST_REQUIRE_EQUAL(estimate_next_concurrency_factor(100000, 1, false, 10, 1024), max_initial_range_concurrency);
+
+    // No rows at all: go on with the next round of this page.
+    BOOST_REQUIRE_EQUAL(estimate_next_concurrency_factor(100, 0, false, 7, 4), 8u);
+    BOOST_REQUIRE_EQUAL(estimate_next_concurrency_factor(100, 0, false, 0, 1), 2u);
+    BOOST_REQUIRE_EQUAL(estimate_next_concurrency_factor(100, 0, false, 127, 64), max_initial_range_concurrency);
+
+    // A page cut short by the size limit was not short of rows: the next one
+    // needs no more ranges than this one read.
+    BOOST_REQUIRE_EQUAL(estimate_next_concurrency_factor(100, 10, true, 3, 16), 3u);
+    BOOST_REQUIRE_EQUAL(estimate_next_concurrency_factor(100, 10, true, 1, 1), 1u);
+    BOOST_REQUIRE_EQUAL(estimate_next_concurrency_factor(100, 10, true, 100, 64), max_initial_range_concurrency);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_paging_state_range_concurrency_serialization) {
+    auto s = schema_builder("ks", "cf")
+            .with_column("pk", bytes_type, column_kind::partition_key)
+            .with_column("ck", bytes_type, column_kind::clustering_key)
+            .with_column("v", bytes_type, column_kind::regular_column)
+            .build();
+    auto pk = partition_key::from_single_value(*s, to_bytes("pk"));
+    auto ck = clustering_key::from_single_value(*s, to_bytes("ck"));
+    auto query_uuid = utils::make_random_uuid();
+
+    auto check = [&] (const service::pager::paging_state& ps, uint32_t range_concurrency) {
+        BOOST_REQUIRE(ps.get_partition_key().equal(*s, pk));
+        BOOST_REQUIRE(ps.get_clustering_key());
+        BOOST_REQUIRE(ps.get_clustering_key()->equal(*s, ck));
+        BOOST_REQUIRE_EQUAL(ps.get_remaining(), (uint64_t(1) << 33) + 10);
+        BOOST_REQUIRE_EQUAL(ps.get_query_uuid(), query_uuid);
+        BOOST_REQUIRE(ps.get_query_read_repair_decision() == db::read_repair_decision::DC_LOCAL);
+        BOOST_REQUIRE_EQUAL(ps.get_rows_fetched_for_last_partition(), 42u);
+        BOOST_REQUIRE_EQUAL(ps.get_range_concurrency(), range_concurrency);
+    };
+
+    service::pager::paging_state ps(pk, ck, (uint64_t(1) << 33) + 10, query_uuid, {}, db::read_repair_decision::DC_LOCAL, uint64_t(42), 17);
+    auto serialized = ps.serialize();
+    auto deserialized = service::pager::paging_state::deserialize(serialized);
+    BOOST_REQUIRE(deserialized);
+    check(*deserialized, 17);
+
+    // A paging state serialized by a node which doesn't know about the range
+    // concurrency, that is without its trailing field, resumes with a single
+    // range. Drop the field and shrink the frame size which follows the
+    // format id accordingly.
+    auto& data = *serialized;
+    auto old_data = bytes(data.begin(), data.end() - sizeof(uint32_t));
+    auto frame_size = le_to_cpu(read_unaligned<uint32_t>(old_data.begin() + sizeof(uint32_t)));
+    write_unaligned<uint32_t>(old_data.begin() + sizeof(uint32_t), cpu_to_le(uint32_t(frame_size - sizeof(uint32_t))));
+    auto old_deserialized = service::pager::paging_state::deserialize(bytes_opt(std::move(old_data)));
+    BOOST_REQUIRE(old_deserialized);
+    check(*old_deserialized, 1);
+}
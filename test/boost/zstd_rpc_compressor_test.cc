@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE zstd_rpc_compressor
+
+#include <boost/test/unit_test.hpp>
+#include <seastar/util/variant_utils.hh>
+#include "message/zstd_rpc_compressor.hh"
+
+using namespace seastar;
+
+namespace {
+
+sstring make_message(size_t size, unsigned seed) {
+    sstring s = uninitialized_string(size);
+    uint32_t x = seed;
+    for (size_t i = 0; i < size; ++i) {
+        x = x * 1103515245 + 12345;
+        // Mostly repetitive, so that it compresses.
+        s[i] = (i % 16) ? char('a' + i % 7) : char(x >> 16);
+    }
+    return s;
+}
+
+rpc::snd_buf make_snd_buf(const sstring& m, size_t fragment_size) {
+    if (m.size() <= fragment_size) {
+        return rpc::snd_buf(temporary_buffer<char>(m.data(), m.size()));
+    }
+    std::vector<temporary_buffer<char>> fragments;
+    for (size_t pos = 0; pos < m.size(); pos += fragment_size) {
+        fragments.emplace_back(m.data() + pos, std::min(fragment_size, m.size() - pos));
+    }
+    rpc::snd_buf buf;
+    buf.size = m.size();
+    buf.bufs = std::move(fragments);
+    return buf;
+}
+
+// Drops the head space reserved by compress(), like RPC does once it
+// wrote the frame header into it.
+rpc::rcv_buf to_rcv_buf(rpc::snd_buf buf, size_t head_space) {
+    std::visit(make_visitor(
+        [&] (temporary_buffer<char>& b) { b.trim_front(head_space); },
+        [&] (std::vector<temporary_buffer<char>>& v) { v.front().trim_front(head_space); }), buf.bufs);
+    rpc::rcv_buf ret(buf.size - head_space);
+    ret.bufs = std::move(buf.bufs);
+    return ret;
+}
+
+sstring to_sstring(rpc::rcv_buf buf) {
+    sstring s;
+    std::visit(make_visitor(
+        [&] (temporary_buffer<char>& b) { s.append(b.get(), b.size()); },
+        [&] (std::vector<temporary_buffer<char>>& v) {
+            for (auto& b : v) {
+                s.append(b.get(), b.size());
+            }
+        }), buf.bufs);
+    BOOST_REQUIRE_EQUAL(s.size(), buf.size);
+    return s;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(test_round_trip) {
+    netw::zstd_rpc_compressor::factory factory(3);
+    auto sender = factory.negotiate("ZSTD", false);
+    auto receiver = factory.negotiate("ZSTD", true);
+    BOOST_REQUIRE(sender && receiver);
+    BOOST_REQUIRE(!factory.negotiate("LZ4", true));
+
+    // The messages share the compression stream, so they must all
+    // round-trip in order.
+    unsigned seed = 0;
+    for (size_t size : {0, 1, 100, 4096, 4096, 128 * 1024, 1000 * 1000}) {
+        for (size_t fragment_size : {size_t(1000), size_t(128 * 1024)}) {
+            auto m = make_message(size, seed++);
+            auto compressed = sender->compress(4, make_snd_buf(m, fragment_size));
+            auto decompressed = receiver->decompress(to_rcv_buf(std::move(compressed), 4));
+            BOOST_REQUIRE(to_sstring(std::move(decompressed)) == m);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_repeated_messages_compress_well) {
+    netw::zstd_rpc_compressor::factory factory(1);
+    auto sender = factory.negotiate("ZSTD", false);
+    auto m = make_message(2000, 1);
+    auto first = sender->compress(0, make_snd_buf(m, m.size())).size;
+    auto second = sender->compress(0, make_snd_buf(m, m.size())).size;
+    // The second message refers to the first one.
+    BOOST_REQUIRE_LT(second * 4, first);
+}
@@ -0,0 +1,99 @@
+# Copyright 2021 ScyllaDB
+#
+# This file is part of Scylla.
+#
+# Scylla is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Scylla is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+
+#############################################################################
+# Tests for the routing of single-partition prepared statements to the shard
+# owning their partition (the route_cql_requests_to_owning_shard option).
+# These are Scylla-only tests: they read the transport metrics, and Cassandra
+# has no shards.
+#############################################################################
+
+import pytest
+import re
+import requests
+from cassandra.protocol import InvalidRequest
+from util import new_test_table
+
+@pytest.fixture(scope="module")
+def table1(cql, test_keyspace):
+    with new_test_table(cql, test_keyspace, "p int, c int, v text, primary key (p, c)") as table:
+        yield table
+
+@pytest.fixture(scope="module")
+def table2(cql, test_keyspace):
+    with new_test_table(cql, test_keyspace, "p text primary key, v int") as table:
+        yield table
+
+# Returns the sum over all shards of the transport requests_bounced metric.
+def get_requests_bounced(cql):
+    host = cql.cluster.contact_points[0]
+    metrics = requests.get(f'http://{host}:9180/metrics').text
+    total = 0
+    for line in metrics.split('\n'):
+        if re.match(r'^scylla_transport_requests_bounced\{', line):
+            total += int(float(line.split()[1]))
+    return total
+
+# Prepares `stmt` so that the driver doesn't know its partition key, and
+# doesn't send it to the owning shard itself if it is shard-aware: some of
+# the requests are then received on a shard which doesn't own their partition.
+def prepare_without_routing(cql, stmt):
+    prepared = cql.prepare(stmt)
+    prepared.routing_key_indexes = None
+    return prepared
+
+# Writes and reads back many partitions with prepared statements, some of
+# them received on a shard not owning the partition. They must be bounced to
+# the owning shard, and produce the same results as if they weren't.
+def test_bounce_to_owning_shard(cql, table1, scylla_only):
+    insert = prepare_without_routing(cql, f"INSERT INTO {table1} (p, c, v) VALUES (?, ?, ?)")
+    select = prepare_without_routing(cql, f"SELECT c, v FROM {table1} WHERE p = ?")
+    bounced_before = get_requests_bounced(cql)
+    for p in range(100):
+        for c in range(3):
+            cql.execute(insert, [p, c, f'{p}-{c}'])
+    for p in range(100):
+        assert [(r.c, r.v) for r in cql.execute(select, [p])] == [(c, f'{p}-{c}') for c in range(3)]
+    assert get_requests_bounced(cql) > bounced_before
+    # The results are the same when read by an unprepared statement, which
+    # is never routed.
+    assert len(list(cql.execute(f"SELECT * FROM {table1}"))) == 300
+
+# Invalid keys can't be routed to their shard, but must still be rejected
+# with the usual validation errors.
+def test_bounce_invalid_key(cql, table2, scylla_only):
+    insert = prepare_without_routing(cql, f"INSERT INTO {table2} (p, v) VALUES (?, ?)")
+    select = prepare_without_routing(cql, f"SELECT v FROM {table2} WHERE p = ?")
+    with pytest.raises(InvalidRequest, match='Key length'):
+        cql.execute(insert, ['x' * 65536, 1])
+    with pytest.raises(InvalidRequest, match='Key may not be empty'):
+        cql.execute(insert, ['', 1])
+    # A key which isn't valid UTF-8, see test_validation.py for how the
+    # driver is made to send it.
+    import cassandra.cqltypes
+    orig_serialize = cassandra.cqltypes.UTF8Type.serialize
+    def myserialize(ustr, protocol_version):
+        return ustr.encode('utf-8', errors='surrogateescape')
+    cassandra.cqltypes.UTF8Type.serialize = myserialize
+    try:
+        with pytest.raises(InvalidRequest, match=re.compile('validat', re.IGNORECASE)):
+            cql.execute(insert, [b'\xff'.decode(errors='surrogateescape'), 1])
+    finally:
+        cassandra.cqltypes.UTF8Type.serialize = orig_serialize
+    # The connection is still usable afterwards.
+    cql.execute(insert, ['hello', 1])
+    assert [r.v for r in cql.execute(select, ['hello'])] == [1]
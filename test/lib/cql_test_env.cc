@@ -43,6 +43,7 @@
 #include "message/messaging_service.hh"
 #include "service/storage_service.hh"
 #include "service/storage_proxy.hh"
+#include "service/forward_service.hh"
 #include "auth/service.hh"
 #include "auth/common.hh"
 #include "db/config.hh"
@@ -550,9 +551,13 @@ class single_node_cql_env : public cql_test_env {
             mm.start(std::ref(mm_notif), std::ref(feature_service), std::ref(ms)).get();
             auto stop_mm = defer([&mm] { mm.stop().get(); });
 
+            sharded<service::forward_service> forward_service;
+            forward_service.start(std::ref(ms), std::ref(proxy), std::ref(db), std::ref(mm)).get();
+            auto stop_forward_service = defer([&forward_service] { forward_service.stop().get(); });
+
             sharded<cql3::query_processor> qp;
             cql3::query_processor::memory_config qp_mcfg = {memory::stats().total_memory() / 256, memory::stats().total_memory() / 2560};
-            qp.start(std::ref(proxy), std::ref(db), std::ref(mm_notif), std::ref(mm), qp_mcfg, std::ref(cql_config), std::ref(sl_controller)).get();
+            qp.start(std::ref(proxy), std::ref(forward_service), std::ref(db), std::ref(mm_notif), std::ref(mm), qp_mcfg, std::ref(cql_config), std::ref(sl_controller)).get();
             auto stop_qp = defer([&qp] { qp.stop().get(); });
 
             // In main.cc we call db::system_keyspace::setup which calls
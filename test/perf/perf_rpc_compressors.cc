@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <seastar/rpc/lz4_compressor.hh>
+#include <seastar/rpc/lz4_fragmented_compressor.hh>
+#include <seastar/util/variant_utils.hh>
+#include "message/zstd_rpc_compressor.hh"
+#include "test/lib/random_utils.hh"
+#include "seastarx.hh"
+
+#include "seastar/include/seastar/testing/perf_tests.hh"
+
+// Compares the RPC compressors on messages resembling internode traffic:
+// many messages of a few kilobytes, sharing most of their structure. Each
+// iteration compresses and decompresses one message. The compression ratio
+// of each compressor is printed at startup.
+class rpc_compressors {
+    static constexpr size_t message_count = 256;
+
+    std::vector<sstring> _messages;
+    size_t _next = 0;
+
+    struct compressor_pair {
+        std::unique_ptr<rpc::compressor> sender;
+        std::unique_ptr<rpc::compressor> receiver;
+    };
+
+    static rpc::rcv_buf to_rcv_buf(rpc::snd_buf buf) {
+        rpc::rcv_buf ret(buf.size);
+        ret.bufs = std::move(buf.bufs);
+        return ret;
+    }
+
+    static sstring make_message() {
+        // A fixed schema-like header, then keys and values drawn from a
+        // small vocabulary, as in mutations of a table.
+        sstring m = "ks.table/0f6e4b0e-6bd1-11eb-9439-0242ac130002:";
+        auto rows = tests::random::get_int<size_t>(16, 64);
+        for (size_t i = 0; i < rows; ++i) {
+            m += format("row{}:col_a={},col_b={},ts={};", tests::random::get_int<int>(0, 100000),
+                    tests::random::get_int<int>(0, 1000), tests::random::get_sstring(8), 1612345678000000 + i);
+        }
+        return m;
+    }
+public:
+    compressor_pair lz4{rpc::lz4_compressor::factory().negotiate("LZ4", false), rpc::lz4_compressor::factory().negotiate("LZ4", true)};
+    compressor_pair lz4_fragmented{rpc::lz4_fragmented_compressor::factory().negotiate("LZ4_FRAGMENTED", false),
+            rpc::lz4_fragmented_compressor::factory().negotiate("LZ4_FRAGMENTED", true)};
+    compressor_pair zstd_1{netw::zstd_rpc_compressor::factory(1).negotiate("ZSTD", false), netw::zstd_rpc_compressor::factory(1).negotiate("ZSTD", true)};
+    compressor_pair zstd_3{netw::zstd_rpc_compressor::factory(3).negotiate("ZSTD", false), netw::zstd_rpc_compressor::factory(3).negotiate("ZSTD", true)};
+
+    rpc_compressors() {
+        size_t total = 0;
+        for (size_t i = 0; i < message_count; ++i) {
+            _messages.push_back(make_message());
+            total += _messages.back().size();
+        }
+        for (auto [name, p] : {std::pair("lz4", &lz4), std::pair("lz4_fragmented", &lz4_fragmented),
+                std::pair("zstd level 1", &zstd_1), std::pair("zstd level 3", &zstd_3)}) {
+            size_t compressed = 0;
+            for (auto& m : _messages) {
+                auto buf = p->sender->compress(0, rpc::snd_buf(temporary_buffer<char>(m.data(), m.size())));
+                compressed += buf.size;
+                p->receiver->decompress(to_rcv_buf(std::move(buf)));
+            }
+            std::cout << format("{}: {} bytes compressed to {} bytes, ratio {:.2f}", name, total, compressed, double(total) / compressed) << std::endl;
+        }
+    }
+
+    size_t round_trip(compressor_pair& p) {
+        auto& m = _messages[_next++ % _messages.size()];
+        auto buf = p.sender->compress(0, rpc::snd_buf(temporary_buffer<char>(m.data(), m.size())));
+        return p.receiver->decompress(to_rcv_buf(std::move(buf))).size;
+    }
+};
+
+PERF_TEST_F(rpc_compressors, lz4) {
+    perf_tests::do_not_optimize(round_trip(lz4));
+}
+
+PERF_TEST_F(rpc_compressors, lz4_fragmented) {
+    perf_tests::do_not_optimize(round_trip(lz4_fragmented));
+}
+
+PERF_TEST_F(rpc_compressors, zstd_level_1) {
+    perf_tests::do_not_optimize(round_trip(zstd_1));
+}
+
+PERF_TEST_F(rpc_compressors, zstd_level_3) {
+    perf_tests::do_not_optimize(round_trip(zstd_3));
+}
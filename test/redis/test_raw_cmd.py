@@ -72,3 +72,34 @@ def test_ping_and_eof(redis_host, redis_port):
 
     # a EOF char `\x04` should be triggered parse error
     verify_cmd_response(redis_host, redis_port, "*1\r\n$4\r\nping\r\n\x04", "+PONG\r\n-ERR unknown command ''\r\n", shutdown=True)
+
+def test_pipelined_requests(redis_host, redis_port):
+    # replies are in the order of the requests, including errors
+    expect_ret = "+PONG\r\n-ERR wrong number of arguments (given 0, expected 1) for 'get' command\r\n$3\r\nabc\r\n"
+    rs = RedisSocket(redis_host, redis_port)
+    rs.send('*1\r\n$4\r\nping\r\n*1\r\n$3\r\nget\r\n*2\r\n$4\r\necho\r\n$3\r\nabc\r\n'.encode())
+    rs.shutdown()
+    ret = ''
+    while len(ret) < len(expect_ret):
+        received = rs.recv().decode()
+        if not received:
+            break
+        ret += received
+    assert ret == expect_ret
+    rs.close()
+
+def test_pipelined_requests_reply_without_waiting(redis_host, redis_port):
+    # The client always has a request in flight: the reply to each request
+    # must be sent without waiting for the requests sent after it.
+    rs = RedisSocket(redis_host, redis_port)
+    rs.socket.settimeout(10)
+    ping = '*1\r\n$4\r\nping\r\n'.encode()
+    rs.send(ping)
+    for _ in range(100):
+        rs.send(ping)
+        ret = ''
+        while len(ret) < len('+PONG\r\n'):
+            ret += rs.recv(len('+PONG\r\n') - len(ret)).decode()
+        assert ret == '+PONG\r\n'
+    assert rs.recv(len('+PONG\r\n')).decode() == '+PONG\r\n'
+    rs.close()
@@ -23,6 +23,7 @@ import redis
 import logging
 import re
 import time
+import threading
 from util import random_string, connect
 
 logger = logging.getLogger('redis-test')
@@ -61,6 +62,139 @@ def test_del_non_existent_key(redis_host, redis_port):
     r.delete(key)
     assert r.delete(key) == 0
 
+def test_mset_mget(redis_host, redis_port):
+    r = connect(redis_host, redis_port)
+    keys = [random_string(10) for _ in range(10)]
+    vals = [random_string(10) for _ in range(10)]
+    missing_key = random_string(10)
+
+    assert r.mset(dict(zip(keys, vals))) == True
+    assert r.mget(keys) == vals
+    # Missing keys are nil, duplicate keys are returned as many times as requested.
+    assert r.mget([keys[0], missing_key, keys[0]]) == [vals[0], None, vals[0]]
+    assert r.delete(*keys) == len(keys)
+    assert r.mget(keys) == [None] * len(keys)
+
+def test_mset_same_key(redis_host, redis_port):
+    r = connect(redis_host, redis_port)
+    key = random_string(10)
+
+    assert r.execute_command('MSET', key, 'a', key, 'b') == True
+    assert r.get(key) == 'b'
+    r.delete(key)
+
+def test_mset_wrong_number_of_arguments(redis_host, redis_port):
+    r = connect(redis_host, redis_port)
+    key = random_string(10)
+
+    with pytest.raises(redis.exceptions.ResponseError):
+        r.execute_command('MSET', key)
+    with pytest.raises(redis.exceptions.ResponseError):
+        r.execute_command('MGET')
+
+def test_pipeline(redis_host, redis_port):
+    r = connect(redis_host, redis_port)
+    keys = [random_string(10) for _ in range(100)]
+
+    p = r.pipeline(transaction=False)
+    for key in keys:
+        p.set(key, key)
+    for key in keys:
+        p.get(key)
+    p.delete(*keys)
+    assert p.execute() == [True] * len(keys) + keys + [len(keys)]
+
+def test_incr_decr(redis_host, redis_port):
+    r = connect(redis_host, redis_port)
+    key = random_string(10)
+
+    assert r.incr(key) == 1
+    assert r.incrby(key, 41) == 42
+    assert r.decr(key) == 41
+    assert r.decrby(key, 50) == -9
+    assert r.get(key) == '-9'
+    r.delete(key)
+
+def test_incr_not_an_integer(redis_host, redis_port):
+    r = connect(redis_host, redis_port)
+    key = random_string(10)
+
+    r.set(key, 'abc')
+    with pytest.raises(redis.exceptions.ResponseError, match='not an integer'):
+        r.incr(key)
+    with pytest.raises(redis.exceptions.ResponseError, match='not an integer'):
+        r.incrby(key, 'x')
+    assert r.get(key) == 'abc'
+    r.delete(key)
+
+def test_incr_overflow(redis_host, redis_port):
+    r = connect(redis_host, redis_port)
+    key = random_string(10)
+
+    r.set(key, str(2**63 - 1))
+    with pytest.raises(redis.exceptions.ResponseError, match='overflow'):
+        r.incr(key)
+    assert r.get(key) == str(2**63 - 1)
+    r.delete(key)
+
+def test_incr_keeps_ttl(redis_host, redis_port):
+    r = connect(redis_host, redis_port)
+    key = random_string(10)
+
+    r.setex(key, 100, 1)
+    assert r.incr(key) == 2
+    assert 0 < r.ttl(key) <= 100
+    r.delete(key)
+
+def test_append(redis_host, redis_port):
+    r = connect(redis_host, redis_port)
+    key = random_string(10)
+
+    assert r.append(key, 'abc') == 3
+    assert r.append(key, 'de') == 5
+    assert r.get(key) == 'abcde'
+    r.delete(key)
+
+def test_expire(redis_host, redis_port):
+    r = connect(redis_host, redis_port)
+    key = random_string(10)
+
+    assert r.expire(key, 100) == False
+    r.set(key, 'abc')
+    assert r.ttl(key) == -1
+    assert r.expire(key, 100) == True
+    assert 0 < r.ttl(key) <= 100
+    assert r.get(key) == 'abc'
+    assert r.expire(key, 0) == True
+    assert r.get(key) == None
+
+def test_concurrent_incr(redis_host, redis_port):
+    key = random_string(10)
+    clients = [connect(redis_host, redis_port) for _ in range(4)]
+
+    # Contending lightweight transactions may time out, especially in debug
+    # builds. An increment which timed out may still have been applied, so
+    # it is counted as uncertain rather than retried.
+    succeeded = [0] * len(clients)
+    timed_out = [0] * len(clients)
+    def incr_many(i):
+        for _ in range(10):
+            try:
+                clients[i].incr(key)
+                succeeded[i] += 1
+            except redis.exceptions.ResponseError as e:
+                if not re.search('time(d)? ?out', str(e), re.IGNORECASE):
+                    raise
+                timed_out[i] += 1
+    threads = [threading.Thread(target=incr_many, args=(i,)) for i in range(len(clients))]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert sum(succeeded) + sum(timed_out) == 40
+    assert sum(succeeded) <= int(clients[0].get(key) or 0) <= 40
+    clients[0].delete(key)
+
 def test_set_empty_string(redis_host, redis_port):
     r = connect(redis_host, redis_port)
     key = random_string(10)
@@ -74,6 +74,7 @@ future<> controller::do_start_server() {
         cql_server_config.timeout_config = make_timeout_config(cfg);
         cql_server_config.max_request_size = _mem_limiter.local().total_memory();
         cql_server_config.allow_shard_aware_drivers = cfg.enable_shard_aware_drivers();
+        cql_server_config.zstd_compression_level = cfg.native_transport_compression_zstd_level();
         cql_server_config.sharding_ignore_msb = cfg.murmur3_partitioner_ignore_msb_bits();
         if (cfg.native_shard_aware_transport_port.is_set()) {
             // Needed for "SUPPORTED" message
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <zlib.h>
+#include <lz4.h>
+#include "transport/cql_segment.hh"
+#include "exceptions/exceptions.hh"
+
+namespace cql_transport {
+
+static constexpr uint64_t payload_size_mask = (uint64_t(1) << 17) - 1;
+
+static uint64_t read_le(const char* p, size_t len) noexcept {
+    uint64_t v = 0;
+    for (size_t i = 0; i < len; ++i) {
+        v |= uint64_t(uint8_t(p[i])) << (8 * i);
+    }
+    return v;
+}
+
+static void write_le(char* p, uint64_t v, size_t len) noexcept {
+    for (size_t i = 0; i < len; ++i) {
+        p[i] = char(v >> (8 * i));
+    }
+}
+
+uint32_t segment_codec::crc24(uint64_t bytes, size_t len) noexcept {
+    static constexpr uint32_t crc24_init = 0x875060;
+    static constexpr uint32_t crc24_poly = 0x1974F0B;
+    uint32_t crc = crc24_init;
+    while (len--) {
+        crc ^= (bytes & 0xff) << 16;
+        bytes >>= 8;
+        for (int i = 0; i < 8; ++i) {
+            crc <<= 1;
+            if (crc & 0x1000000) {
+                crc ^= crc24_poly;
+            }
+        }
+    }
+    return crc & 0xffffff;
+}
+
+uint32_t segment_codec::crc32(bytes_view data) noexcept {
+    // The CRC32 of payloads is seeded with these bytes, so that a payload of
+    // zeroes doesn't have a checksum of zero.
+    static const uint8_t initial_bytes[] = { 0xfa, 0x2d, 0x55, 0xca };
+    auto crc = ::crc32(0, initial_bytes, sizeof(initial_bytes));
+    return ::crc32(crc, reinterpret_cast<const Bytef*>(data.data()), data.size());
+}
+
+segment_codec::header segment_codec::parse_header(const temporary_buffer<char>& buf) const {
+    auto fields_size = header_size() - 3;
+    if (buf.size() != header_size()) {
+        throw exceptions::protocol_exception(format("Truncated segment header: {:d} bytes", buf.size()));
+    }
+    auto fields = read_le(buf.get(), fields_size);
+    auto crc = read_le(buf.get() + fields_size, 3);
+    if (crc != crc24(fields, fields_size)) {
+        throw exceptions::protocol_exception("Segment header checksum mismatch");
+    }
+    header h;
+    h.payload_size = fields & payload_size_mask;
+    if (_compress) {
+        h.uncompressed_size = (fields >> 17) & payload_size_mask;
+        h.self_contained = fields & (uint64_t(1) << 34);
+    } else {
+        h.uncompressed_size = 0;
+        h.self_contained = fields & (uint64_t(1) << 17);
+    }
+    return h;
+}
+
+temporary_buffer<char> segment_codec::decode_payload(const header& h, temporary_buffer<char> buf) const {
+    if (buf.size() != h.payload_size + trailer_size) {
+        throw exceptions::protocol_exception(format("Truncated segment: expected {:d} bytes, got {:d}", h.payload_size + trailer_size, buf.size()));
+    }
+    auto payload = bytes_view(reinterpret_cast<const int8_t*>(buf.get()), h.payload_size);
+    if (read_le(buf.get() + h.payload_size, trailer_size) != crc32(payload)) {
+        throw exceptions::protocol_exception("Segment payload checksum mismatch");
+    }
+    buf.trim(h.payload_size);
+    if (!h.uncompressed_size) {
+        return buf;
+    }
+    temporary_buffer<char> out(h.uncompressed_size);
+    auto ret = LZ4_decompress_safe(buf.get(), out.get_write(), buf.size(), out.size());
+    if (ret < 0 || size_t(ret) != out.size()) {
+        throw exceptions::protocol_exception("Segment LZ4 uncompression failure");
+    }
+    return out;
+}
+
+temporary_buffer<char> segment_codec::encode(bytes_view payload, bool self_contained) const {
+    assert(payload.size() <= max_payload_size);
+    auto hsize = header_size();
+    size_t uncompressed_size = 0;
+    temporary_buffer<char> buf;
+    if (_compress && !payload.empty()) {
+        auto bound = LZ4_compressBound(payload.size());
+        buf = temporary_buffer<char>(hsize + bound + trailer_size);
+        auto input = reinterpret_cast<const char*>(payload.data());
+#ifdef HAVE_LZ4_COMPRESS_DEFAULT
+        auto ret = LZ4_compress_default(input, buf.get_write() + hsize, payload.size(), bound);
+#else
+        auto ret = LZ4_compress(input, buf.get_write() + hsize, payload.size());
+#endif
+        // Payloads which don't compress are sent as they are.
+        if (ret > 0 && size_t(ret) < payload.size()) {
+            uncompressed_size = payload.size();
+            buf.trim(hsize + ret + trailer_size);
+        }
+    }
+    if (!uncompressed_size) {
+        buf = temporary_buffer<char>(hsize + payload.size() + trailer_size);
+        std::copy_n(reinterpret_cast<const char*>(payload.data()), payload.size(), buf.get_write() + hsize);
+    }
+    auto payload_size = buf.size() - hsize - trailer_size;
+
+    uint64_t fields = payload_size;
+    if (_compress) {
+        fields |= uint64_t(uncompressed_size) << 17;
+        fields |= uint64_t(self_contained) << 34;
+    } else {
+        fields |= uint64_t(self_contained) << 17;
+    }
+    auto fields_size = hsize - 3;
+    write_le(buf.get_write(), fields, fields_size);
+    write_le(buf.get_write() + fields_size, crc24(fields, fields_size), 3);
+    auto sent_payload = bytes_view(reinterpret_cast<const int8_t*>(buf.get() + hsize), payload_size);
+    write_le(buf.get_write() + hsize + payload_size, crc32(sent_payload), trailer_size);
+    return buf;
+}
+
+}
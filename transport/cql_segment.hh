@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2021 ScyllaDB
+ */
+
+/*
+ * This file is part of Scylla.
+ *
+ * Scylla is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Scylla is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Scylla.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <seastar/core/temporary_buffer.hh>
+#include "bytes.hh"
+
+namespace cql_transport {
+
+// The segments of the framing format introduced by native_protocol_v5.spec
+// ("modern framing"), which Scylla offers to protocol v4 connections through
+// the SCYLLA_SEGMENTED_FRAMING protocol extension.
+//
+// Once the connection is established, frames are no longer written to the
+// socket directly, but are packed into segments of at most max_payload_size
+// bytes. A self-contained segment holds one or more whole frames; a frame too
+// large to fit in a segment is split across several segments which are not
+// self-contained. Segment headers and payloads are protected by checksums,
+// and when compression is negotiated each segment is compressed on its own,
+// with LZ4, rather than each frame.
+//
+// All multi-byte fields of segment headers are little-endian.
+class segment_codec {
+    bool _compress;
+public:
+    static constexpr size_t max_payload_size = 128 * 1024 - 1;
+    // Size of the CRC32 of the payload which follows it.
+    static constexpr size_t trailer_size = 4;
+
+    struct header {
+        // Size of the payload, as sent.
+        size_t payload_size;
+        // Size of the payload once uncompressed, 0 if it was sent uncompressed.
+        size_t uncompressed_size;
+        bool self_contained;
+    };
+
+    explicit segment_codec(bool compress) noexcept : _compress(compress) {}
+
+    size_t header_size() const noexcept {
+        return _compress ? 8 : 6;
+    }
+
+    // Parses a segment header of header_size() bytes.
+    // Throws protocol_exception if it is corrupt.
+    header parse_header(const temporary_buffer<char>& buf) const;
+
+    // Checks the payload of a segment, followed by its trailer, against its
+    // checksum and uncompresses it if needed.
+    // Throws protocol_exception if it is corrupt.
+    temporary_buffer<char> decode_payload(const header& h, temporary_buffer<char> buf) const;
+
+    // Returns the whole segment carrying `payload`, which can't be larger than
+    // max_payload_size.
+    temporary_buffer<char> encode(bytes_view payload, bool self_contained) const;
+
+    // The checksums used by the format, see Cassandra's org.apache.cassandra.net.Crc.
+    static uint32_t crc24(uint64_t bytes, size_t len) noexcept;
+    static uint32_t crc32(bytes_view data) noexcept;
+};
+
+}
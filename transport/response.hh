@@ -93,7 +93,16 @@ class response {
 
     // Make a non-owning scattered_message of the response. Remains valid as long
     // as the response object is alive.
-    scattered_message<char> make_message(uint8_t version, cql_compression compression);
+    scattered_message<char> make_message(uint8_t version, cql_compression compression, int zstd_compression_level);
+
+    // The header of the frame of the response, which body() follows, for
+    // responses packed into segments.
+    sstring frame_header(uint8_t version) {
+        return make_frame(version, _body.size());
+    }
+    const bytes_ostream& body() const {
+        return _body;
+    }
 
     cql_binary_opcode opcode() const {
         return _opcode;
@@ -102,9 +111,10 @@ class response {
         return _body.size();
     }
 private:
-    void compress(cql_compression compression);
+    void compress(cql_compression compression, int zstd_compression_level);
     void compress_lz4();
     void compress_snappy();
+    void compress_zstd(int level);
 
     template <typename CqlFrameHeaderType>
     sstring make_frame_one(uint8_t version, size_t length) {
@@ -61,6 +61,7 @@
 
 #include <snappy-c.h>
 #include <lz4.h>
+#include <zstd.h>
 
 #include "response.hh"
 #include "request.hh"
@@ -69,6 +70,8 @@
 
 #include "transport/cql_protocol_extension.hh"
 #include "utils/bit_cast.hh"
+#include "utils/fb_utilities.hh"
+#include "validation.hh"
 
 namespace cql_transport {
 
@@ -198,6 +201,10 @@ cql_server::cql_server(distributed<cql3::query_processor>& qp, auth::service& au
         sm::make_derive("requests_served", _stats.requests_served,
                         sm::description("Counts a number of served requests.")),
 
+        sm::make_derive("requests_bounced", _stats.requests_bounced,
+                        sm::description("Counts the requests executed on another shard than the one of their connection, "
+                                        "such as lightweight transactions and requests routed to the shard owning their partition.")),
+
         sm::make_gauge("requests_serving", _stats.requests_serving,
                         sm::description("Holds a number of requests that are being processed right now.")),
 
@@ -358,6 +365,14 @@ cql_server::connection::read_frame() {
                 });
             });
         });
+    } else if (_segment_codec) {
+        return read_from_segments(frame_size()).then([this] (fragmented_temporary_buffer buf) {
+            if (buf.empty()) {
+                return make_ready_future<ret_type>();
+            }
+            auto header = linearized(fragmented_temporary_buffer::view(buf));
+            return make_ready_future<ret_type>(parse_frame(temporary_buffer<char>(reinterpret_cast<const char*>(header.data()), header.size())));
+        });
     } else {
         // Not the first frame, so we know the size.
         return _read_buf.read_exactly(frame_size()).then([this] (temporary_buffer<char> buf) {
@@ -589,7 +604,7 @@ future<> cql_server::connection::process_request() {
         auto stream = f.stream;
         auto mem_estimate = f.length * 2 + 8000; // Allow for extra copies and bookkeeping
         if (mem_estimate > _server._max_request_size) {
-            return _read_buf.skip(f.length).then([length = f.length, stream = f.stream, mem_estimate, this] () {
+            return skip_frame_body(f.length).then([length = f.length, stream = f.stream, mem_estimate, this] () {
                 write_response(make_error(stream, exceptions::exception_code::INVALID,
                         format("request size too large (frame size {:d}; estimate {:d}; allowed {:d}", length, mem_estimate, _server._max_request_size),
                         tracing::trace_state_ptr()));
@@ -599,7 +614,7 @@ future<> cql_server::connection::process_request() {
 
         if (_server._stats.requests_serving > _server._max_concurrent_requests) {
             ++_server._stats.requests_shed;
-            return _read_buf.skip(f.length).then([this, stream = f.stream] {
+            return skip_frame_body(f.length).then([this, stream = f.stream] {
                 write_response(make_error(stream, exceptions::exception_code::OVERLOADED,
                         format("too many in-flight requests (configured via max_concurrent_requests_per_shard): {}", _server._stats.requests_serving),
                         tracing::trace_state_ptr()));
@@ -621,16 +636,27 @@ future<> cql_server::connection::process_request() {
             _pending_requests_gate.enter();
             auto leave = defer([this] { _pending_requests_gate.leave(); });
             auto istream = buf.get_istream();
-            (void)_process_request_stage(this, istream, op, stream, seastar::ref(_client_state), tracing_requested, mem_permit)
-                    .then_wrapped([this, buf = std::move(buf), mem_permit, leave = std::move(leave)] (future<foreign_ptr<std::unique_ptr<cql_server::response>>> response_f) mutable {
+            auto f = _process_request_stage(this, istream, op, stream, seastar::ref(_client_state), tracing_requested, mem_permit)
+                    .then_wrapped([this, op, buf = std::move(buf), mem_permit, leave = std::move(leave)] (future<foreign_ptr<std::unique_ptr<cql_server::response>>> response_f) mutable {
                 try {
                     write_response(std::move(response_f.get0()), std::move(mem_permit), _compression);
                     _ready_to_respond = _ready_to_respond.finally([leave = std::move(leave)] {});
+                    // The response to STARTUP is the last frame written,
+                    // and the request the last frame read, without segments.
+                    if (static_cast<cql_binary_opcode>(op) == cql_binary_opcode::STARTUP
+                            && _client_state.is_protocol_extension_set(cql_protocol_extension::SEGMENTED_FRAMING)) {
+                        _segment_codec.emplace(_compression == cql_compression::lz4);
+                    }
                 } catch (...) {
                     clogger.error("request processing failed: {}", std::current_exception());
                 }
             });
 
+            // The framing of the next requests depends on the outcome of STARTUP.
+            if (static_cast<cql_binary_opcode>(op) == cql_binary_opcode::STARTUP) {
+                return f;
+            }
+            (void)f;
             return make_ready_future<>();
           });
         });
@@ -652,6 +678,39 @@ static thread_local size_t buffer_use_count = 0;
 static thread_local utils::reusable_buffer input_buffer;
 static thread_local utils::reusable_buffer output_buffer;
 
+struct zstd_cctx_deleter {
+    void operator()(ZSTD_CCtx* cctx) const noexcept {
+        ZSTD_freeCCtx(cctx);
+    }
+};
+struct zstd_dctx_deleter {
+    void operator()(ZSTD_DCtx* dctx) const noexcept {
+        ZSTD_freeDCtx(dctx);
+    }
+};
+static thread_local std::unique_ptr<ZSTD_CCtx, zstd_cctx_deleter> zstd_cctx;
+static thread_local std::unique_ptr<ZSTD_DCtx, zstd_dctx_deleter> zstd_dctx;
+
+ZSTD_CCtx* get_zstd_cctx() {
+    if (!zstd_cctx) {
+        zstd_cctx.reset(ZSTD_createCCtx());
+        if (!zstd_cctx) {
+            throw std::bad_alloc();
+        }
+    }
+    return zstd_cctx.get();
+}
+
+ZSTD_DCtx* get_zstd_dctx() {
+    if (!zstd_dctx) {
+        zstd_dctx.reset(ZSTD_createDCtx());
+        if (!zstd_dctx) {
+            throw std::bad_alloc();
+        }
+    }
+    return zstd_dctx.get();
+}
+
 void on_compression_buffer_use() {
     if (++buffer_use_count == clear_buffers_trigger) {
         input_buffer.clear();
@@ -662,9 +721,91 @@ void on_compression_buffer_use() {
 
 }
 
+// Frames are skipped when they are too large or shed, so on a segmented
+// connection their body is discarded segment by segment as it is read,
+// instead of being gathered in memory first.
+future<> cql_server::connection::skip_frame_body(size_t length) {
+    if (!_segment_codec) {
+        return _read_buf.skip(length);
+    }
+    return do_with(length, [this] (size_t& left) {
+        return repeat([this, &left] {
+            while (left && !_segment_payloads.empty()) {
+                auto& front = _segment_payloads.front();
+                auto size = std::min(left, front.size());
+                if (size == front.size()) {
+                    _segment_payloads.pop_front();
+                } else {
+                    front.trim_front(size);
+                }
+                _segment_payloads_size -= size;
+                left -= size;
+            }
+            if (!left || _segments_eof) {
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
+            }
+            return read_segment().then([] {
+                return stop_iteration::no;
+            });
+        });
+    });
+}
+
+future<> cql_server::connection::read_segment() {
+    return _read_buf.read_exactly(_segment_codec->header_size()).then([this] (temporary_buffer<char> buf) {
+        if (buf.empty()) {
+            _segments_eof = true;
+            return make_ready_future<>();
+        }
+        auto h = _segment_codec->parse_header(buf);
+        return _read_buf.read_exactly(h.payload_size + segment_codec::trailer_size).then([this, h] (temporary_buffer<char> buf) {
+            auto payload = _segment_codec->decode_payload(h, std::move(buf));
+            if (!payload.empty()) {
+                _segment_payloads_size += payload.size();
+                _segment_payloads.push_back(std::move(payload));
+            }
+        });
+    });
+}
+
+// Returns the next `length` bytes of the frames carried by the segments, or
+// less on EOF. Frames may span segments, so bytes are handed out regardless
+// of segment boundaries.
+future<fragmented_temporary_buffer> cql_server::connection::read_from_segments(size_t length) {
+    return do_until([this, length] { return _segment_payloads_size >= length || _segments_eof; }, [this] {
+        return read_segment();
+    }).then([this, length] {
+        auto size = std::min(length, _segment_payloads_size);
+        std::vector<temporary_buffer<char>> fragments;
+        for (auto left = size; left;) {
+            auto& front = _segment_payloads.front();
+            if (front.size() <= left) {
+                left -= front.size();
+                fragments.push_back(std::move(front));
+                _segment_payloads.pop_front();
+            } else {
+                fragments.push_back(front.share(0, left));
+                front.trim_front(left);
+                left = 0;
+            }
+        }
+        _segment_payloads_size -= size;
+        return fragmented_temporary_buffer(std::move(fragments), size);
+    });
+}
+
 future<fragmented_temporary_buffer> cql_server::connection::read_and_decompress_frame(size_t length, uint8_t flags)
 {
     using namespace compression_buffers;
+    if (_segment_codec) {
+        // Segments are compressed, frames never are.
+        return read_from_segments(length).then([length] (fragmented_temporary_buffer buf) {
+            if (buf.size_bytes() != length) {
+                throw exceptions::protocol_exception("Truncated frame");
+            }
+            return buf;
+        });
+    }
     if (flags & cql_frame_flags::compression) {
         if (_compression == cql_compression::lz4) {
             if (length < 4) {
@@ -706,6 +847,26 @@ future<fragmented_temporary_buffer> cql_server::connection::read_and_decompress_
                 on_compression_buffer_use();
                 return uncomp;
             });
+        } else if (_compression == cql_compression::zstd) {
+            return _buffer_reader.read_exactly(_read_buf, length).then([this] (fragmented_temporary_buffer buf) {
+                auto in = input_buffer.get_linearized_view(fragmented_temporary_buffer::view(buf));
+                auto uncomp_len = ZSTD_getFrameContentSize(in.data(), in.size());
+                if (uncomp_len == ZSTD_CONTENTSIZE_UNKNOWN || uncomp_len == ZSTD_CONTENTSIZE_ERROR) {
+                    throw std::runtime_error("CQL frame zstd uncompressed size is unknown");
+                }
+                if (uncomp_len > _server._max_request_size) {
+                    throw exceptions::protocol_exception(format("CQL frame zstd uncompressed size too large: {:d}", uncomp_len));
+                }
+                auto uncomp = output_buffer.make_fragmented_temporary_buffer(uncomp_len, fragmented_temporary_buffer::default_fragment_size, [&] (bytes_mutable_view out) {
+                    auto ret = ZSTD_decompressDCtx(get_zstd_dctx(), out.data(), out.size(), in.data(), in.size());
+                    if (ZSTD_isError(ret) || ret != out.size()) {
+                        throw std::runtime_error("CQL frame zstd uncompression failure");
+                    }
+                    return out.size();
+                });
+                on_compression_buffer_use();
+                return uncomp;
+            });
         } else {
             throw exceptions::protocol_exception(format("Unknown compression algorithm"));
         }
@@ -725,6 +886,8 @@ future<std::unique_ptr<cql_server::response>> cql_server::connection::process_st
              _compression = cql_compression::lz4;
          } else if (compression == "snappy") {
              _compression = cql_compression::snappy;
+         } else if (compression == "zstd") {
+             _compression = cql_compression::zstd;
          } else {
              throw exceptions::protocol_exception(format("Unknown compression algorithm: {}", compression));
          }
@@ -750,6 +913,10 @@ future<std::unique_ptr<cql_server::response>> cql_server::connection::process_st
             cql_proto_exts.set(ext);
         }
     }
+    if (cql_proto_exts.contains(cql_protocol_extension::SEGMENTED_FRAMING)
+            && _compression != cql_compression::none && _compression != cql_compression::lz4) {
+        throw exceptions::protocol_exception("Only LZ4 compression is supported with segmented framing");
+    }
     _client_state.set_protocol_extensions(std::move(cql_proto_exts));
     std::unique_ptr<cql_server::response> res;
     if (auto& a = client_state.get_auth_service()->underlying_authenticator(); a.require_authentication()) {
@@ -847,6 +1014,7 @@ cql_server::connection::process(uint16_t stream, request_reader in, service::cli
                    (std::variant<foreign_ptr<std::unique_ptr<cql_server::response>>, unsigned> msg) mutable {
         unsigned* shard = std::get_if<unsigned>(&msg);
         if (shard) {
+            ++_server._stats.requests_bounced;
             return process_on_shard(*shard, stream, is, client_state, std::move(permit), trace_state, process_fn);
         }
         return make_ready_future<foreign_ptr<std::unique_ptr<cql_server::response>>>(std::get<foreign_ptr<std::unique_ptr<cql_server::response>>>(std::move(msg)));
@@ -921,6 +1089,56 @@ future<std::unique_ptr<cql_server::response>> cql_server::connection::process_pr
     });
 }
 
+// Returns the shard owning the partition a prepared statement is bound to, if
+// the statement is cheaper to execute there than on the shard of the
+// connection.
+//
+// That's the case when this node is a replica of the partition: the
+// coordinator then works with the local replica on its own shard, instead of
+// through cross-shard calls. Shard-aware drivers already send such requests to
+// the owning shard, this covers the other clients.
+static std::optional<unsigned> owning_shard(cql3::query_processor& qp, const cql3::statements::prepared_statement& prepared,
+        const cql3::query_options& options) {
+    auto& pk_indices = prepared.partition_key_bind_indices;
+    if (pk_indices.empty() || !qp.db().get_config().route_cql_requests_to_owning_shard()) {
+        return std::nullopt;
+    }
+    auto& spec = *prepared.bound_names[pk_indices.front()];
+    if (!qp.db().has_schema(spec.ks_name, spec.cf_name)) {
+        return std::nullopt;
+    }
+    auto s = qp.db().find_schema(spec.ks_name, spec.cf_name);
+    std::vector<bytes> components;
+    components.reserve(pk_indices.size());
+    size_t key_size = 0;
+    for (auto idx : pk_indices) {
+        auto value = options.get_value_at(idx);
+        if (!value.is_value()) {
+            return std::nullopt;
+        }
+        components.push_back(to_bytes(value));
+        key_size += sizeof(uint16_t) + components.back().size();
+    }
+    // Invalid keys are left to the statement, which reports them the usual way.
+    if (key_size > validation::max_key_size) {
+        return std::nullopt;
+    }
+    auto key = partition_key::from_exploded(*s, components);
+    if (validation::is_cql_key_invalid(*s, key)) {
+        return std::nullopt;
+    }
+    auto token = dht::get_token(*s, key);
+    auto shard = dht::shard_of(*s, token);
+    if (shard == this_shard_id()) {
+        return std::nullopt;
+    }
+    auto replicas = qp.db().find_keyspace(s->ks_name()).get_replication_strategy().get_natural_endpoints(token);
+    if (std::find(replicas.begin(), replicas.end(), utils::fb_utilities::get_broadcast_address()) == replicas.end()) {
+        return std::nullopt;
+    }
+    return shard;
+}
+
 static future<std::variant<foreign_ptr<std::unique_ptr<cql_server::response>>, unsigned>>
 process_execute_internal(service::client_state& client_state, distributed<cql3::query_processor>& qp, request_reader in,
         uint16_t stream, cql_protocol_version_type version, cql_serialization_format serialization_format,
@@ -983,6 +1201,15 @@ process_execute_internal(service::client_state& client_state, distributed<cql3::
         tracing::add_prepared_query_options(trace_state, options);
     }
 
+    // Only route the request on the shard it was received on, where it is
+    // processed for the first time.
+    if (init_trace) {
+        if (auto shard = owning_shard(qp.local(), *prepared, options)) {
+            tracing::trace(trace_state, "Routing the request to shard {}, owning the partition", *shard);
+            return make_ready_future<std::variant<foreign_ptr<std::unique_ptr<cql_server::response>>, unsigned>>(*shard);
+        }
+    }
+
     tracing::trace(trace_state, "Processing a statement");
     return qp.local().execute_prepared(std::move(prepared), std::move(cache_key), query_state, options, needs_authorization)
             .then([trace_state = query_state.get_trace_state(), skip_metadata, q_state = std::move(q_state), stream, version] (auto msg) {
@@ -1281,6 +1508,7 @@ std::unique_ptr<cql_server::response> cql_server::connection::make_supported(int
     opts.insert({"CQL_VERSION", cql3::query_processor::CQL_VERSION});
     opts.insert({"COMPRESSION", "lz4"});
     opts.insert({"COMPRESSION", "snappy"});
+    opts.insert({"COMPRESSION", "zstd"});
     if (_server._config.allow_shard_aware_drivers) {
         opts.insert({"SCYLLA_SHARD", format("{:d}", this_shard_id())});
         opts.insert({"SCYLLA_NR_SHARDS", format("{:d}", smp::count)});
@@ -1427,8 +1655,19 @@ cql_server::connection::make_schema_change_event(const event::schema_change& eve
 
 void cql_server::connection::write_response(foreign_ptr<std::unique_ptr<cql_server::response>>&& response, service_permit permit, cql_compression compression)
 {
+    if (_segment_codec) {
+        // Responses completed while the previous ones are being written are
+        // packed into the same segments, and written with a single flush.
+        _pending_responses.emplace_back(std::move(response), std::move(permit));
+        if (_pending_responses.size() == 1) {
+            _ready_to_respond = _ready_to_respond.then([this] {
+                return write_segments();
+            });
+        }
+        return;
+    }
     _ready_to_respond = _ready_to_respond.then([this, compression, response = std::move(response), permit = std::move(permit)] () mutable {
-        auto message = response->make_message(_version, compression);
+        auto message = response->make_message(_version, compression, _server._config.zstd_compression_level);
         message.on_delete([response = std::move(response)] { });
         return _write_buf.write(std::move(message)).then([this] {
             return _write_buf.flush();
@@ -1436,9 +1675,63 @@ void cql_server::connection::write_response(foreign_ptr<std::unique_ptr<cql_serv
     });
 }
 
-scattered_message<char> cql_server::response::make_message(uint8_t version, cql_compression compression) {
+future<> cql_server::connection::write_segments() {
+    auto responses = std::exchange(_pending_responses, {});
+    std::vector<temporary_buffer<char>> segments;
+    bytes_ostream current;
+    auto close_segment = [&] (bool self_contained) {
+        segments.push_back(_segment_codec->encode(current.linearize(), self_contained));
+        current.clear();
+    };
+    // Frames too large for a segment are split across segments which are
+    // not self-contained, and which carry nothing else.
+    auto write_split = [&] (bytes_view v) {
+        while (!v.empty()) {
+            auto n = std::min(v.size(), segment_codec::max_payload_size - current.size());
+            current.write(v.substr(0, n));
+            v.remove_prefix(n);
+            if (current.size() == segment_codec::max_payload_size) {
+                close_segment(false);
+            }
+        }
+    };
+    for (auto& [response, permit] : responses) {
+        auto header = response->frame_header(_version);
+        auto header_view = bytes_view(reinterpret_cast<const int8_t*>(header.data()), header.size());
+        auto size = header.size() + response->size();
+        if (current.size() + size > segment_codec::max_payload_size && current.size()) {
+            close_segment(true);
+        }
+        if (size <= segment_codec::max_payload_size) {
+            current.write(header_view);
+            for (auto&& fragment : response->body().fragments()) {
+                current.write(fragment);
+            }
+        } else {
+            write_split(header_view);
+            for (auto&& fragment : response->body().fragments()) {
+                write_split(fragment);
+            }
+            if (current.size()) {
+                close_segment(false);
+            }
+        }
+    }
+    if (current.size()) {
+        close_segment(true);
+    }
+    return do_with(std::move(segments), std::move(responses), [this] (std::vector<temporary_buffer<char>>& segments, auto&) {
+        return do_for_each(segments, [this] (temporary_buffer<char>& segment) {
+            return _write_buf.write(std::move(segment));
+        }).then([this] {
+            return _write_buf.flush();
+        });
+    });
+}
+
+scattered_message<char> cql_server::response::make_message(uint8_t version, cql_compression compression, int zstd_compression_level) {
     if (compression != cql_compression::none) {
-        compress(compression);
+        compress(compression, zstd_compression_level);
     }
     scattered_message<char> msg;
     auto frame = make_frame(version, _body.size());
@@ -1449,7 +1742,7 @@ scattered_message<char> cql_server::response::make_message(uint8_t version, cql_
     return msg;
 }
 
-void cql_server::response::compress(cql_compression compression)
+void cql_server::response::compress(cql_compression compression, int zstd_compression_level)
 {
     switch (compression) {
     case cql_compression::lz4:
@@ -1458,6 +1751,9 @@ void cql_server::response::compress(cql_compression compression)
     case cql_compression::snappy:
         compress_snappy();
         break;
+    case cql_compression::zstd:
+        compress_zstd(zstd_compression_level);
+        break;
     default:
         throw std::invalid_argument("Invalid CQL compression algorithm");
     }
@@ -1509,6 +1805,25 @@ void cql_server::response::compress_snappy()
     on_compression_buffer_use();
 }
 
+// The body is replaced by a single zstd frame, which records the size of the
+// uncompressed body.
+void cql_server::response::compress_zstd(int level)
+{
+    using namespace compression_buffers;
+    auto view = input_buffer.get_linearized_view(_body);
+    size_t input_len = view.size();
+
+    size_t output_len = ZSTD_compressBound(input_len);
+    _body = output_buffer.make_buffer(output_len, [&] (bytes_mutable_view output_view) {
+        auto ret = ZSTD_compressCCtx(get_zstd_cctx(), output_view.data(), output_view.size(), view.data(), input_len, level);
+        if (ZSTD_isError(ret)) {
+            throw std::runtime_error(format("CQL frame zstd compression failure: {}", ZSTD_getErrorName(ret)));
+        }
+        return ret;
+    });
+    on_compression_buffer_use();
+}
+
 void cql_server::response::serialize(const event::schema_change& event, uint8_t version)
 {
     if (version >= 3) {
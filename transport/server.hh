@@ -35,7 +35,9 @@
 #include <boost/intrusive/list.hpp>
 #include <seastar/net/tls.hh>
 #include <seastar/core/metrics_registration.hh>
+#include <seastar/core/circular_buffer.hh>
 #include "utils/fragmented_temporary_buffer.hh"
+#include "transport/cql_segment.hh"
 #include "service_permit.hh"
 #include <seastar/core/sharded.hh>
 #include <seastar/core/execution_stage.hh>
@@ -66,6 +68,7 @@ enum class cql_compression {
     none,
     lz4,
     snappy,
+    zstd,
 };
 
 enum cql_frame_flags {
@@ -117,6 +120,7 @@ struct cql_server_config {
     std::optional<uint16_t> shard_aware_transport_port;
     std::optional<uint16_t> shard_aware_transport_port_ssl;
     bool allow_shard_aware_drivers = true;
+    int zstd_compression_level = 3;
     smp_service_group bounce_request_smp_service_group = default_smp_service_group();
 };
 
@@ -130,6 +134,7 @@ class cql_server : public seastar::peering_sharded_service<cql_server>, public g
         uint32_t requests_serving;
         uint64_t requests_blocked_memory;
         uint64_t requests_shed;
+        uint64_t requests_bounced;
 
         // cql message stats
         uint64_t startups;
@@ -182,6 +187,14 @@ class cql_server : public seastar::peering_sharded_service<cql_server>, public g
         service::client_state _client_state;
         std::unordered_map<uint16_t, cql_query_state> _query_states;
         unsigned _request_cpu = 0;
+        // Engaged once the connection uses segmented framing, see cql_segment.hh.
+        std::optional<segment_codec> _segment_codec;
+        // Payloads of the segments read, and not consumed by frames yet.
+        circular_buffer<temporary_buffer<char>> _segment_payloads;
+        size_t _segment_payloads_size = 0;
+        bool _segments_eof = false;
+        // Responses waiting to be packed into segments by write_segments().
+        std::vector<std::pair<foreign_ptr<std::unique_ptr<cql_server::response>>, service_permit>> _pending_responses;
 
         enum class tracing_request_type : uint8_t {
             not_requested,
@@ -217,6 +230,10 @@ class cql_server : public seastar::peering_sharded_service<cql_server>, public g
         cql_binary_frame_v3 parse_frame(temporary_buffer<char> buf) const;
         future<fragmented_temporary_buffer> read_and_decompress_frame(size_t length, uint8_t flags);
         future<std::optional<cql_binary_frame_v3>> read_frame();
+        future<> skip_frame_body(size_t length);
+        future<> read_segment();
+        future<fragmented_temporary_buffer> read_from_segments(size_t length);
+        future<> write_segments();
         future<std::unique_ptr<cql_server::response>> process_startup(uint16_t stream, request_reader in, service::client_state& client_state, tracing::trace_state_ptr trace_state);
         future<std::unique_ptr<cql_server::response>> process_auth_response(uint16_t stream, request_reader in, service::client_state& client_state, tracing::trace_state_ptr trace_state);
         future<std::unique_ptr<cql_server::response>> process_options(uint16_t stream, request_reader in, service::client_state& client_state, tracing::trace_state_ptr trace_state);
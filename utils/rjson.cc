@@ -87,6 +87,45 @@ class chunked_content_stream {
 
 };
 
+// chunked_content_output_stream presents the output Stream concept of the
+// rapidjson library, appending the output to a chunked_content in chunks of
+// chunk_size bytes.
+class chunked_content_output_stream {
+    chunked_content& _content;
+    temporary_buffer<char> _chunk;
+    size_t _pos = 0;
+    size_t _flushed_size = 0;
+public:
+    typedef char Ch;
+    static constexpr size_t chunk_size = 16 * 1024;
+
+    explicit chunked_content_output_stream(chunked_content& content)
+        : _content(content)
+    {}
+    size_t size() const {
+        return _flushed_size + _pos;
+    }
+    // Methods needed by rapidjson's Stream concept:
+    void Put(Ch c) {
+        if (_pos == _chunk.size()) {
+            Flush();
+            _chunk = temporary_buffer<char>(chunk_size);
+        }
+        _chunk.get_write()[_pos++] = c;
+    }
+    // Called by rapidjson's Writer once the root value is complete. The
+    // chunks of a chunked_content cannot be empty, nor be appended to.
+    void Flush() {
+        if (_pos) {
+            _chunk.trim(_pos);
+            _content.push_back(std::move(_chunk));
+            _flushed_size += _pos;
+            _pos = 0;
+        }
+        _chunk = temporary_buffer<char>();
+    }
+};
+
 /*
  * This wrapper class adds nested level checks to rapidjson's handlers.
  * Each rapidjson handler implements functions for accepting JSON values,
@@ -106,8 +145,9 @@ struct guarded_yieldable_json_handler : public Handler {
     using handler_base = Handler;
 
     explicit guarded_yieldable_json_handler(size_t max_nested_level) : _max_nested_level(max_nested_level) {}
-    guarded_yieldable_json_handler(string_buffer& buf, size_t max_nested_level)
-            : handler_base(buf), _max_nested_level(max_nested_level) {}
+    template<typename OutputStream>
+    guarded_yieldable_json_handler(OutputStream& os, size_t max_nested_level)
+            : handler_base(os), _max_nested_level(max_nested_level) {}
 
     // Parse any stream fitting https://rapidjson.org/classrapidjson_1_1_stream.html
     template<typename Stream>
@@ -219,6 +259,61 @@ std::string print(const rjson::value& value, size_t max_nested_level) {
     return std::string(buffer.GetString());
 }
 
+struct chunked_writer::impl {
+    chunked_content content;
+    chunked_content_output_stream os;
+    guarded_yieldable_json_handler<rapidjson::Writer<chunked_content_output_stream, encoding, encoding, allocator>, false> writer;
+
+    explicit impl(size_t max_nested_level)
+        : os(content)
+        , writer(os, max_nested_level)
+    {}
+};
+
+chunked_writer::chunked_writer(size_t max_nested_level)
+    : _impl(std::make_unique<impl>(max_nested_level))
+{}
+
+chunked_writer::chunked_writer(chunked_writer&&) noexcept = default;
+
+chunked_writer::~chunked_writer() = default;
+
+void chunked_writer::start_object() {
+    _impl->writer.StartObject();
+}
+
+void chunked_writer::end_object() {
+    _impl->writer.EndObject();
+}
+
+void chunked_writer::start_array() {
+    _impl->writer.StartArray();
+}
+
+void chunked_writer::end_array() {
+    _impl->writer.EndArray();
+}
+
+void chunked_writer::key(std::string_view name) {
+    _impl->writer.Key(name.data(), name.size(), true);
+}
+
+void chunked_writer::write(const rjson::value& value) {
+    value.Accept(_impl->writer);
+}
+
+size_t chunked_writer::size() const {
+    return _impl->os.size();
+}
+
+chunked_content chunked_writer::finish() && {
+    if (!_impl->writer.IsComplete()) {
+        throw rjson::error("JSON error: incomplete document");
+    }
+    _impl->os.Flush();
+    return std::move(_impl->content);
+}
+
 rjson::malformed_value::malformed_value(std::string_view name, const rjson::value& value)
     : malformed_value(name, print(value))
 {}
@@ -41,6 +41,7 @@
 
 #include <string>
 #include <stdexcept>
+#include <memory>
 
 namespace rjson {
 class error : public std::exception {
@@ -178,6 +179,33 @@ using chunked_content = std::vector<temporary_buffer<char>>;
 rjson::value parse(chunked_content&&, size_t max_nested_level = default_max_nested_level);
 rjson::value parse_yieldable(chunked_content&&, size_t max_nested_level = default_max_nested_level);
 
+// chunked_writer builds a JSON document incrementally, SAX-style, into a
+// chunked_content holding its text - the output counterpart of
+// parse(chunked_content&&). The structure of the document is emitted with
+// start_object(), key() etc., and complete values are added with write().
+// A large document made of many values, like a page of items, thus never
+// has to exist as a single rjson::value, nor as a single contiguous string.
+class chunked_writer {
+    struct impl;
+    std::unique_ptr<impl> _impl;
+public:
+    explicit chunked_writer(size_t max_nested_level = default_max_nested_level);
+    chunked_writer(chunked_writer&&) noexcept;
+    ~chunked_writer();
+
+    void start_object();
+    void end_object();
+    void start_array();
+    void end_array();
+    void key(std::string_view name);
+    void write(const rjson::value& value);
+
+    // Size of the text written so far.
+    size_t size() const;
+    // Returns the text of the document, which has to be complete.
+    chunked_content finish() &&;
+};
+
 // Creates a JSON value (of JSON string type) out of internal string representations.
 // The string value is copied, so str's liveness does not need to be persisted.
 rjson::value from_string(const char* str, size_t size);